@@ -201,6 +201,17 @@ HEADERS += src/qt/bitcoingui.h \
     src/base58.h \
     src/bignum.h \
     src/block.h \
+    src/researcher.h \
+    src/boincblock.h \
+    src/superblock.h \
+    src/appcache.h \
+    src/debuglog.h \
+    src/blockfile.h \
+    src/txindexcache.h \
+    src/voting.h \
+    src/socketevents.h \
+    src/xmlview.h \
+    src/sha256.h \
     src/beacon.h \
     src/checkpoints.h \
     src/compat.h \
@@ -224,6 +235,8 @@ HEADERS += src/qt/bitcoingui.h \
     src/init.h \
     src/irc.h \
     src/mruset.h \
+    src/checkqueue.h \
+    src/sigcache.h \
     src/json/json_spirit_writer_template.h \
     src/json/json_spirit_writer.h \
     src/json/json_spirit_value.h \
@@ -289,6 +302,17 @@ SOURCES += src/qt/bitcoin.cpp src/qt/bitcoingui.cpp \
     src/qt/votingdialog.cpp \
     src/alert.cpp \
     src/block.cpp \
+    src/researcher.cpp \
+    src/boincblock.cpp \
+    src/superblock.cpp \
+    src/appcache.cpp \
+    src/debuglog.cpp \
+    src/blockfile.cpp \
+    src/txindexcache.cpp \
+    src/voting.cpp \
+    src/socketevents.cpp \
+    src/xmlview.cpp \
+    src/sha256.cpp \
     src/beacon.cpp \
     src/version.cpp \
     src/sync.cpp \
@@ -411,7 +435,7 @@ QMAKE_EXTRA_COMPILERS += TSQM
 # "Other files" to show in Qt Creator
 OTHER_FILES += \
     doc/*.rst doc/*.txt doc/README README.md res/bitcoin-qt.rc \
-    src/test/*.cpp
+    src/test/*.cpp src/test/bench/*.cpp
 
 # platform specific defaults, if not overridden on command line
 isEmpty(BOOST_LIB_SUFFIX) {
@@ -0,0 +1,95 @@
+#include "appcache.h"
+#include "sync.h"
+#include "util.h"
+
+namespace
+{
+    // Entries are keyed by "section;key" in one ordered map. Listings match
+    // on a prefix of that key, so the entries of a section, and of any
+    // section sharing its prefix, are a single range of the map.
+    CCriticalSection cs_appcache;
+    AppCacheSection mvApplicationCache;
+
+    std::string CacheKey(const std::string& section, const std::string& key)
+    {
+        return section + ";" + key;
+    }
+}
+
+void WriteCache(
+        const std::string& section,
+        const std::string& key,
+        const std::string& value,
+        int64_t locktime)
+{
+    if (section.empty() || key.empty())
+        return;
+
+    LOCK(cs_appcache);
+    AppCacheEntry& entry = mvApplicationCache[CacheKey(section, key)];
+    entry.value = value;
+    entry.timestamp = locktime;
+}
+
+std::string ReadCache(const std::string& section, const std::string& key)
+{
+    return ReadCacheEntry(section, key).value;
+}
+
+AppCacheEntry ReadCacheEntry(const std::string& section, const std::string& key)
+{
+    if (section.empty() || key.empty())
+        return AppCacheEntry{ std::string(), 0 };
+
+    LOCK(cs_appcache);
+    return mvApplicationCache.insert(std::make_pair(CacheKey(section, key), AppCacheEntry{ std::string(), 0 })).first->second;
+}
+
+int64_t ReadCacheTimestamp(const std::string& section, const std::string& key)
+{
+    LOCK(cs_appcache);
+    AppCacheSection::const_iterator it = mvApplicationCache.find(CacheKey(section, key));
+    return it != mvApplicationCache.end()
+        ? it->second.timestamp
+        : 0;
+}
+
+AppCacheSection ReadCacheSection(const std::string& section)
+{
+    AppCacheSection entries;
+
+    LOCK(cs_appcache);
+    for (AppCacheSection::const_iterator it = mvApplicationCache.lower_bound(section);
+         it != mvApplicationCache.end() && it->first.compare(0, section.length(), section) == 0;
+         ++it)
+    {
+        if (it->first.length() > section.length())
+            entries.insert(entries.end(), *it);
+    }
+
+    return entries;
+}
+
+void ClearCache(const std::string& section)
+{
+    LOCK(cs_appcache);
+    for (AppCacheSection::iterator it = mvApplicationCache.begin(); it != mvApplicationCache.end(); ++it)
+    {
+        // Copied, as the entry added below may be the one being read
+        const std::string key_section = it->second.value;
+        if (key_section.length() > section.length() &&
+            key_section.compare(0, section.length(), section) == 0)
+        {
+            AppCacheEntry& entry = mvApplicationCache[key_section];
+            printf("\r\nClearing the cache....of value %s \r\n", entry.value.c_str());
+            entry.value = "";
+            entry.timestamp = 1;
+        }
+    }
+}
+
+void DeleteCache(const std::string& section, const std::string& key)
+{
+    LOCK(cs_appcache);
+    mvApplicationCache.erase(CacheKey(section, key));
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+//!
+//! \brief Application cache entry.
+//!
+struct AppCacheEntry
+{
+    std::string value;  //!< Cached value.
+    int64_t timestamp;  //!< Lock time of the contract which set the value.
+};
+
+//!
+//! \brief Application cache entries, keyed and ordered by \c section;key.
+//!
+typedef std::map<std::string, AppCacheEntry> AppCacheSection;
+
+//!
+//! \brief Write a value to the application cache.
+//! \param section Cache section, such as \c beacon or \c project.
+//! \param key Entry key within \p section.
+//! \param value Value to store.
+//! \param locktime Timestamp to store along with \p value.
+//!
+void WriteCache(
+        const std::string& section,
+        const std::string& key,
+        const std::string& value,
+        int64_t locktime);
+
+//!
+//! \brief Read a value from the application cache.
+//!
+//! A missing entry is added with an empty value, as the cache has always
+//! done, so it shows up in later listings.
+//!
+//! \param section Cache section.
+//! \param key Entry key within \p section.
+//! \return The cached value, or an empty string if there is none.
+//!
+std::string ReadCache(const std::string& section, const std::string& key);
+
+//!
+//! \brief Read a value and its timestamp from the application cache.
+//!
+//! Adds a missing entry the same way as \a ReadCache.
+//!
+//! \param section Cache section.
+//! \param key Entry key within \p section.
+//! \return The cached entry, or an empty one with a zero timestamp if
+//! there is none.
+//!
+AppCacheEntry ReadCacheEntry(const std::string& section, const std::string& key);
+
+//!
+//! \brief Read the timestamp of an application cache entry.
+//!
+//! Unlike \a ReadCache this does not add a missing entry.
+//!
+//! \param section Cache section.
+//! \param key Entry key within \p section.
+//! \return The timestamp, or zero if there is no entry.
+//!
+int64_t ReadCacheTimestamp(const std::string& section, const std::string& key);
+
+//!
+//! \brief Take a copy of the application cache entries of a section.
+//!
+//! Matches every entry whose \c section;key starts with \p section, so
+//! sections sharing the prefix are included (\c projectmapping under
+//! \c project) just as the listings have always included them. The copy
+//! can be iterated while other threads keep using the cache.
+//!
+//! \param section Cache section, or any prefix of \c section;key.
+//! \return Matching entries, keyed by \c section;key.
+//!
+AppCacheSection ReadCacheSection(const std::string& section);
+
+//!
+//! \brief Legacy application cache clear.
+//!
+//! This has never removed the section. It compares the \e values of the
+//! cache against \p section and, for each value starting with it, adds an
+//! empty entry keyed by that value with a timestamp of 1. Superblock
+//! acceptance depends on the neuralsecurity entries it leaves in place, so
+//! the behaviour is kept as is.
+//!
+//! \param section Cache section.
+//!
+void ClearCache(const std::string& section);
+
+//!
+//! \brief Remove an entry from the application cache.
+//! \param section Cache section.
+//! \param key Entry key within \p section.
+//!
+void DeleteCache(const std::string& section, const std::string& key);
@@ -3,6 +3,7 @@
 #include "uint256.h"
 #include "key.h"
 #include "main.h"
+#include "appcache.h"
 
 std::vector<std::string> split(std::string s, std::string delim);
 extern std::string SignBlockWithCPID(std::string sCPID, std::string sBlockHash);
@@ -103,8 +104,9 @@ std::string GetBeaconPublicKey(const std::string& cpid, bool bAdvertisingBeacon)
 
 int64_t BeaconTimeStamp(const std::string& cpid, bool bZeroOutAfterPOR)
 {
-    std::string sBeacon = mvApplicationCache["beacon;" + cpid];
-    int64_t iLocktime = mvApplicationCacheTimestamp["beacon;" + cpid];
+    AppCacheEntry beacon = ReadCacheEntry("beacon", cpid);
+    const std::string& sBeacon = beacon.value;
+    int64_t iLocktime = beacon.timestamp;
     int64_t iRSAWeight = GetRSAWeightByCPIDWithRA(cpid);
     if (fDebug10)
         printf("\r\n Beacon %s, Weight %" PRId64 ", Locktime %" PRId64 "\r\n",sBeacon.c_str(), iRSAWeight, iLocktime);
@@ -121,16 +123,15 @@ bool HasActiveBeacon(const std::string& cpid)
 
 std::string RetrieveBeaconValueWithMaxAge(const std::string& cpid, int64_t iMaxSeconds)
 {
-    const std::string key = "beacon;" + cpid;
-    const std::string& value = mvApplicationCache[key];
+    AppCacheEntry beacon = ReadCacheEntry("beacon", cpid);
 
     // Compare the age of the beacon to the age of the current block. If we have
     // no current block we assume that the beacon is valid.
     int64_t iAge = pindexBest != NULL
-          ? pindexBest->nTime - mvApplicationCacheTimestamp[key]
+          ? pindexBest->nTime - beacon.timestamp
           : 0;
 
     return (iAge > iMaxSeconds)
           ? ""
-          : value;
+          : beacon.value;
 }
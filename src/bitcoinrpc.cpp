@@ -23,6 +23,9 @@
 #include <boost/asio/ssl.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/thread.hpp>
+#include <atomic>
 #include <list>
 
 #define printf OutputDebugStringF
@@ -38,8 +41,6 @@ static std::string strRPCUserColonPass;
 
 const Object emptyobj;
 
-void ThreadRPCServer3(void* parg);
-
 static inline unsigned short GetDefaultRPCPort()
 {
     return GetBoolArg("-testnet", false) ? 25715 : 15715;
@@ -232,9 +233,9 @@ static const CRPCCommand vRPCCommands[] =
     { "getaddednodeinfo",       &getaddednodeinfo,       true,   true  },
     { "getbestblockhash",       &getbestblockhash,       true,   false },
     { "getblockcount",          &getblockcount,          true,   false },
-    { "getconnectioncount",     &getconnectioncount,     true,   false },
+    { "getconnectioncount",     &getconnectioncount,     true,   true  },
     { "getpeerinfo",            &getpeerinfo,            true,   false },
-    { "ping",                   &ping,                   true,   false },
+    { "ping",                   &ping,                   true,   true  },
     { "getnettotals",           &getnettotals,           true,   true  },
     { "getdifficulty",          &getdifficulty,          true,   false },
     { "getinfo",                &getinfo,                true,   false },
@@ -266,7 +267,7 @@ static const CRPCCommand vRPCCommands[] =
     { "sendmany",               &sendmany,               false,  false },
     { "addmultisigaddress",     &addmultisigaddress,     false,  false },
     { "addredeemscript",        &addredeemscript,        false,  false },
-    { "getrawmempool",          &getrawmempool,          true,   false },
+    { "getrawmempool",          &getrawmempool,          true,   true  },
     { "getblock",               &getblock,               false,  false },
     { "getblockbynumber",       &getblockbynumber,       false,  false },
     { "getblockhash",           &getblockhash,           false,  false },
@@ -292,9 +293,9 @@ static const CRPCCommand vRPCCommands[] =
     { "restart",                &restart,                false,  false },
     { "execute",                &execute,                false,  false },
     { "getrawtransaction",      &getrawtransaction,      false,  false },
-    { "createrawtransaction",   &createrawtransaction,   false,  false },
-    { "decoderawtransaction",   &decoderawtransaction,   false,  false },
-    { "decodescript",           &decodescript,           false,  false },
+    { "createrawtransaction",   &createrawtransaction,   false,  true  },
+    { "decoderawtransaction",   &decoderawtransaction,   false,  true  },
+    { "decodescript",           &decodescript,           false,  true  },
     { "signrawtransaction",     &signrawtransaction,     false,  false },
     { "sendrawtransaction",     &sendrawtransaction,     false,  false },
     { "getcheckpoint",          &getcheckpoint,          true,   false },
@@ -354,18 +355,24 @@ string HTTPPost(const string& strMsg, const map<string,string>& mapRequestHeader
 
 string rfc1123Time()
 {
-    char buffer[64];
-    time_t now;
-    time(&now);
-    struct tm* now_gmt = gmtime(&now);
-    string locale(setlocale(LC_TIME, NULL));
-    setlocale(LC_TIME, "C"); // we want POSIX (aka "C") weekday/month strings
-    strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S +0000", now_gmt);
-    setlocale(LC_TIME, locale.c_str());
-    return string(buffer);
+    // Formatted by hand: switching the locale to get POSIX weekday and month
+    // names is slow and not thread safe, and replies are sent concurrently.
+    static const char* const pszDays[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    static const char* const pszMonths[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                             "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+    time_t now = time(NULL);
+    struct tm now_gmt;
+#ifdef WIN32
+    gmtime_s(&now_gmt, &now);
+#else
+    gmtime_r(&now, &now_gmt);
+#endif
+    return strprintf("%s, %02d %s %04d %02d:%02d:%02d +0000",
+                     pszDays[now_gmt.tm_wday], now_gmt.tm_mday, pszMonths[now_gmt.tm_mon],
+                     now_gmt.tm_year + 1900, now_gmt.tm_hour, now_gmt.tm_min, now_gmt.tm_sec);
 }
 
-static string HTTPReply(int nStatus, const string& strMsg, bool keepalive)
+string HTTPReply(int nStatus, const string& strMsg, bool keepalive)
 {
     if (nStatus == HTTP_UNAUTHORIZED)
         return strprintf("HTTP/1.0 401 Authorization Required\r\n"
@@ -389,6 +396,7 @@ static string HTTPReply(int nStatus, const string& strMsg, bool keepalive)
     else if (nStatus == HTTP_BAD_REQUEST) cStatus = "Bad Request";
     else if (nStatus == HTTP_FORBIDDEN) cStatus = "Forbidden";
     else if (nStatus == HTTP_NOT_FOUND) cStatus = "Not Found";
+    else if (nStatus == HTTP_REQUEST_TOO_LARGE) cStatus = "Request Entity Too Large";
     else if (nStatus == HTTP_INTERNAL_SERVER_ERROR) cStatus = "Internal Server Error";
     else cStatus = "";
     return strprintf(
@@ -484,6 +492,99 @@ int ReadHTTP(std::basic_istream<char>& stream, map<string, string>& mapHeadersRe
     return nStatus;
 }
 
+/**
+ * Parse the request line and headers of an HTTP request read into memory.
+ * Header names are lower cased. Like ReadHTTP, "connection" is set from the
+ * protocol version when the client did not send it.
+ * Returns the content length, or the HTTP status to refuse the request
+ * with, negated, if the length is invalid or too large.
+ */
+int ParseHTTPRequestHeader(const char* pbegin, const char* pend, map<string, string>& mapHeadersRet)
+{
+    mapHeadersRet.clear();
+
+    int nProto = 0;
+    int nLen = 0;
+    bool fRequestLine = true;
+    while (pbegin < pend)
+    {
+        const char* pline = pbegin;
+        const char* peol = std::find(pbegin, pend, '\n');
+        pbegin = peol == pend ? pend : peol + 1;
+        if (peol > pline && peol[-1] == '\r')
+            --peol;
+
+        if (fRequestLine)
+        {
+            fRequestLine = false;
+            static const char pszVersion[] = "HTTP/1.";
+            const char* pver = std::search(pline, peol, pszVersion, pszVersion + sizeof(pszVersion) - 1);
+            if (pver != peol)
+                nProto = atoi(string(pver + sizeof(pszVersion) - 1, peol).c_str());
+            continue;
+        }
+
+        if (pline == peol)
+            break;
+        const char* pcolon = std::find(pline, peol, ':');
+        if (pcolon == peol)
+            continue;
+
+        string strHeader(pline, pcolon);
+        boost::trim(strHeader);
+        boost::to_lower(strHeader);
+        string strValue(pcolon + 1, peol);
+        boost::trim(strValue);
+        if (strHeader == "content-length")
+        {
+            int64_t nValue = atoi64(strValue);
+            if (nValue < 0)
+                return -HTTP_BAD_REQUEST;
+            if (nValue > (int64_t)MAX_SIZE)
+                return -HTTP_REQUEST_TOO_LARGE;
+            nLen = (int)nValue;
+        }
+        mapHeadersRet[strHeader] = strValue;
+    }
+
+    string& strConnection = mapHeadersRet["connection"];
+    if (strConnection != "close" && strConnection != "keep-alive")
+        strConnection = nProto >= 1 ? "keep-alive" : "close";
+
+    return nLen;
+}
+
+/**
+ * Match condition for asio::async_read_until which finds the empty line
+ * ending the HTTP headers, accepting bare "\n" line ends like ReadHTTP.
+ */
+class HTTPHeaderEnd
+{
+public:
+    template <typename Iterator>
+    std::pair<Iterator, bool> operator()(Iterator begin, Iterator end) const
+    {
+        for (Iterator it = begin; it != end; ++it)
+        {
+            if (*it != '\n')
+                continue;
+
+            Iterator next = it + 1;
+            if (next != end && *next == '\r')
+                ++next;
+            if (next == end)
+                return std::make_pair(it, false);
+            if (*next == '\n')
+                return std::make_pair(next + 1, true);
+        }
+        return std::make_pair(end, false);
+    }
+};
+
+namespace boost { namespace asio {
+    template <> struct is_match_condition<HTTPHeaderEnd> : public boost::true_type {};
+} }
+
 bool HTTPAuthorized(map<string, string>& mapHeaders)
 {
     string strAuth = mapHeaders["authorization"];
@@ -531,7 +632,7 @@ string JSONRPCReply(const Value& result, const Value& error, const Value& id)
     return write_string(Value(reply), false) + "\n";
 }
 
-void ErrorReply(std::ostream& stream, const Object& objError, const Value& id)
+string ErrorReply(const Object& objError, const Value& id)
 {
     // Send error reply from json-rpc error object
     int nStatus = HTTP_INTERNAL_SERVER_ERROR;
@@ -539,7 +640,7 @@ void ErrorReply(std::ostream& stream, const Object& objError, const Value& id)
     if (code == RPC_INVALID_REQUEST) nStatus = HTTP_BAD_REQUEST;
     else if (code == RPC_METHOD_NOT_FOUND) nStatus = HTTP_NOT_FOUND;
     string strReply = JSONRPCReply(Value::null, objError, id);
-    stream << HTTPReply(nStatus, strReply, false) << std::flush;
+    return HTTPReply(nStatus, strReply, false);
 }
 
 bool ClientAllowed(const boost::asio::ip::address& address)
@@ -618,80 +719,392 @@ private:
     asio::ssl::stream<typename Protocol::socket>& stream;
 };
 
-class AcceptedConnection
+void ThreadRPCServer(void* parg)
+{
+    // Make this thread recognisable as the RPC listener
+    RenameThread("grc-rpclist");
+
+    try
+    {
+        vnThreadsRunning[THREAD_RPCLISTENER]++;
+        ThreadRPCServer2(parg);
+        vnThreadsRunning[THREAD_RPCLISTENER]--;
+    }
+    catch (std::exception& e) {
+        vnThreadsRunning[THREAD_RPCLISTENER]--;
+        PrintException(&e, "ThreadRPCServer()");
+    } catch (...) {
+        vnThreadsRunning[THREAD_RPCLISTENER]--;
+        PrintException(NULL, "ThreadRPCServer()");
+    }
+    printf("ThreadRPCServer exited\n");
+}
+
+class JSONRequest
 {
 public:
-    virtual ~AcceptedConnection() {}
+    Value id;
+    string strMethod;
+    Array params;
 
-    virtual std::iostream& stream() = 0;
-    virtual std::string peer_address_to_string() const = 0;
-    virtual void close() = 0;
+    JSONRequest() { id = Value::null; }
+    void parse(const Value& valRequest);
 };
 
-template <typename Protocol>
-class AcceptedConnectionImpl : public AcceptedConnection
+void JSONRequest::parse(const Value& valRequest)
+{
+    // Parse request
+    if (valRequest.type() != obj_type)
+        throw JSONRPCError(RPC_INVALID_REQUEST, "Invalid Request object");
+    const Object& request = valRequest.get_obj();
+
+    // Parse id now so errors from here on will have the id
+    id = find_value(request, "id");
+
+    // Parse method
+    Value valMethod = find_value(request, "method");
+    if (valMethod.type() == null_type)
+        throw JSONRPCError(RPC_INVALID_REQUEST, "Missing method");
+    if (valMethod.type() != str_type)
+        throw JSONRPCError(RPC_INVALID_REQUEST, "Method must be a string");
+    strMethod = valMethod.get_str();
+    if (strMethod != "getwork" && strMethod != "getblocktemplate")
+        if (fDebug10) printf("ThreadRPCServer method=%s\n", strMethod.c_str());
+
+    // Parse params
+    Value valParams = find_value(request, "params");
+    if (valParams.type() == array_type)
+        params = valParams.get_array();
+    else if (valParams.type() == null_type)
+        params = Array();
+    else
+        throw JSONRPCError(RPC_INVALID_REQUEST, "Params must be an array");
+}
+
+
+
+
+static Object JSONRPCExecOne(const Value& req)
+{
+    Object rpc_result;
+
+    JSONRequest jreq;
+    try {
+        jreq.parse(req);
+
+        Value result = tableRPC.execute(jreq.strMethod, jreq.params);
+        rpc_result = JSONRPCReplyObj(result, Value::null, jreq.id);
+    }
+    catch (Object& objError)
+    {
+        rpc_result = JSONRPCReplyObj(Value::null, objError, jreq.id);
+    }
+    catch (std::exception& e)
+    {
+        rpc_result = JSONRPCReplyObj(Value::null,
+                                     JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
+    }
+
+    return rpc_result;
+}
+
+/**
+ * Entries of a batch request, executed by the worker which received the
+ * batch together with any idle RPC workers. Replies keep request order.
+ */
+class RPCBatch
 {
 public:
-    AcceptedConnectionImpl(
-            asio::io_service& io_service,
-            ssl::context &context,
-            bool fUseSSL) :
-        sslStream(io_service, context),
-        _d(sslStream, fUseSSL),
-        _stream(_d)
+    explicit RPCBatch(const Array& vReqIn) :
+        vReq(vReqIn),
+        vReply(vReqIn.size()),
+        nNext(0),
+        nDone(0)
+    {
+    }
+
+    /** Execute entries until there are none left to claim. */
+    void Run()
+    {
+        while (true)
+        {
+            unsigned int nReq = nNext++;
+            if (nReq >= vReq.size())
+                return;
+
+            vReply[nReq] = JSONRPCExecOne(vReq[nReq]);
+
+            boost::mutex::scoped_lock lock(mutex);
+            if (++nDone == vReq.size())
+                condDone.notify_all();
+        }
+    }
+
+    /** Wait for entries other workers claimed to finish. */
+    const Array& Wait()
     {
+        boost::mutex::scoped_lock lock(mutex);
+        while (nDone < vReq.size())
+            condDone.wait(lock);
+        return vReply;
     }
 
-    virtual std::iostream& stream()
+private:
+    const Array vReq;
+    Array vReply;
+    std::atomic<unsigned int> nNext;
+    unsigned int nDone;
+    boost::mutex mutex;
+    boost::condition_variable condDone;
+};
+
+static unsigned int nRPCThreads = 1;
+
+static string JSONRPCExecBatch(asio::io_service& io_service, const Array& vReq)
+{
+    // Offer entries to idle workers. The calling worker runs the batch as
+    // well, so it completes even when every other worker is busy.
+    boost::shared_ptr<RPCBatch> batch(new RPCBatch(vReq));
+    unsigned int nHelpers = std::min<size_t>(vReq.size(), nRPCThreads) - 1;
+    for (unsigned int i = 0; i < nHelpers; i++)
+        io_service.post(boost::bind(&RPCBatch::Run, batch));
+
+    batch->Run();
+    return write_string(Value(batch->Wait()), false) + "\n";
+}
+
+static CCriticalSection cs_THREAD_RPCHANDLER;
+
+/**
+ * An accepted JSON-RPC connection.
+ *
+ * Requests are read and replies written asynchronously by the RPC worker
+ * pool, so a connection kept alive between requests does not hold a
+ * thread. Requests pipelined behind the current one stay buffered and are
+ * answered in order.
+ */
+template <typename Protocol>
+class RPCSession : public boost::enable_shared_from_this< RPCSession<Protocol> >
+{
+public:
+    RPCSession(asio::io_service& io_serviceIn, ssl::context& context, bool fUseSSLIn) :
+        sslStream(io_serviceIn, context),
+        io_service(io_serviceIn),
+        fUseSSL(fUseSSLIn),
+        buffer(MAX_SIZE),
+        timer(io_service),
+        fKeepAlive(false)
     {
-        return _stream;
     }
 
-    virtual std::string peer_address_to_string() const
+    void Start()
     {
-        return peer.address().to_string();
+        if (fUseSSL)
+            sslStream.async_handshake(ssl::stream_base::server,
+                boost::bind(&RPCSession::HandleHandshake, this->shared_from_this(),
+                    asio::placeholders::error));
+        else
+            ReadHeader();
     }
 
-    virtual void close()
+    /** Send a reply and close the connection once it is written. */
+    void Close(const string& strReplyIn)
     {
-        _stream.close();
+        fKeepAlive = false;
+        Write(strReplyIn);
     }
 
     typename Protocol::endpoint peer;
     asio::ssl::stream<typename Protocol::socket> sslStream;
 
 private:
-    SSLIOStreamDevice<Protocol> _d;
-    iostreams::stream< SSLIOStreamDevice<Protocol> > _stream;
-};
+    asio::io_service& io_service;
+    bool fUseSSL;
+    asio::streambuf buffer;
+    asio::deadline_timer timer;
+    map<string, string> mapHeaders;
+    string strReply;
+    bool fKeepAlive;
 
-void ThreadRPCServer(void* parg)
-{
-    // Make this thread recognisable as the RPC listener
-    RenameThread("grc-rpclist");
+    void HandleHandshake(const boost::system::error_code& error)
+    {
+        if (!error)
+            ReadHeader();
+    }
 
-    try
+    void ReadHeader()
     {
-        vnThreadsRunning[THREAD_RPCLISTENER]++;
-        ThreadRPCServer2(parg);
-        vnThreadsRunning[THREAD_RPCLISTENER]--;
+        if (fUseSSL)
+            asio::async_read_until(sslStream, buffer, HTTPHeaderEnd(),
+                boost::bind(&RPCSession::HandleHeader, this->shared_from_this(),
+                    asio::placeholders::error, asio::placeholders::bytes_transferred));
+        else
+            asio::async_read_until(sslStream.next_layer(), buffer, HTTPHeaderEnd(),
+                boost::bind(&RPCSession::HandleHeader, this->shared_from_this(),
+                    asio::placeholders::error, asio::placeholders::bytes_transferred));
     }
-    catch (std::exception& e) {
-        vnThreadsRunning[THREAD_RPCLISTENER]--;
-        PrintException(&e, "ThreadRPCServer()");
-    } catch (...) {
-        vnThreadsRunning[THREAD_RPCLISTENER]--;
-        PrintException(NULL, "ThreadRPCServer()");
+
+    void HandleHeader(const boost::system::error_code& error, size_t nHeaderSize)
+    {
+        if (error)
+            return;
+
+        const char* pheader = asio::buffer_cast<const char*>(buffer.data());
+        int nLen = ParseHTTPRequestHeader(pheader, pheader + nHeaderSize, mapHeaders);
+        buffer.consume(nHeaderSize);
+        if (nLen < 0)
+        {
+            Close(HTTPReply(-nLen, "", false));
+            return;
+        }
+
+        // The body may already be buffered along with the header
+        if (buffer.size() >= (size_t)nLen)
+        {
+            HandleBody(boost::system::error_code(), (size_t)nLen);
+            return;
+        }
+
+        size_t nMissing = nLen - buffer.size();
+        if (fUseSSL)
+            asio::async_read(sslStream, buffer, asio::transfer_exactly(nMissing),
+                boost::bind(&RPCSession::HandleBody, this->shared_from_this(),
+                    asio::placeholders::error, (size_t)nLen));
+        else
+            asio::async_read(sslStream.next_layer(), buffer, asio::transfer_exactly(nMissing),
+                boost::bind(&RPCSession::HandleBody, this->shared_from_this(),
+                    asio::placeholders::error, (size_t)nLen));
+    }
+
+    void HandleBody(const boost::system::error_code& error, size_t nLen)
+    {
+        if (error)
+            return;
+
+        const char* pbody = asio::buffer_cast<const char*>(buffer.data());
+        string strRequest(pbody, pbody + nLen);
+        buffer.consume(nLen);
+
+        {
+            LOCK(cs_THREAD_RPCHANDLER);
+            vnThreadsRunning[THREAD_RPCHANDLER]++;
+        }
+        HandleRequest(strRequest);
+        {
+            LOCK(cs_THREAD_RPCHANDLER);
+            vnThreadsRunning[THREAD_RPCHANDLER]--;
+        }
+    }
+
+    void HandleRequest(const string& strRequest)
+    {
+        // Check authorization
+        if (mapHeaders.count("authorization") == 0)
+        {
+            Close(HTTPReply(HTTP_UNAUTHORIZED, "", false));
+            return;
+        }
+        if (!HTTPAuthorized(mapHeaders))
+        {
+            printf("ThreadRPCServer incorrect password attempt from %s\n", peer.address().to_string().c_str());
+            fKeepAlive = false;
+            strReply = HTTPReply(HTTP_UNAUTHORIZED, "", false);
+
+            /* Deter brute-forcing short passwords.
+               If this results in a DOS the user really
+               shouldn't have their RPC port exposed.
+               The delay is a timer so it holds no worker. */
+            if (mapArgs["-rpcpassword"].size() < 20)
+            {
+                timer.expires_from_now(posix_time::milliseconds(250));
+                timer.async_wait(boost::bind(&RPCSession::HandleDelay, this->shared_from_this(),
+                    asio::placeholders::error));
+            }
+            else
+                Write(strReply);
+            return;
+        }
+        fKeepAlive = mapHeaders["connection"] != "close";
+
+        JSONRequest jreq;
+        try
+        {
+            // Parse request
+            Value valRequest;
+            if (!read_string(strRequest, valRequest))
+                throw JSONRPCError(RPC_PARSE_ERROR, "Parse error");
+
+            string strResult;
+
+            // singleton request
+            if (valRequest.type() == obj_type) {
+                jreq.parse(valRequest);
+
+                Value result = tableRPC.execute(jreq.strMethod, jreq.params);
+
+                // Send reply
+                strResult = JSONRPCReply(result, Value::null, jreq.id);
+
+            // array of requests
+            } else if (valRequest.type() == array_type)
+                strResult = JSONRPCExecBatch(io_service, valRequest.get_array());
+            else
+                throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
+
+            Write(HTTPReply(HTTP_OK, strResult, fKeepAlive));
+        }
+        catch (Object& objError)
+        {
+            Close(ErrorReply(objError, jreq.id));
+        }
+        catch (std::exception& e)
+        {
+            Close(ErrorReply(JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id));
+        }
+    }
+
+    void HandleDelay(const boost::system::error_code& error)
+    {
+        if (!error)
+            Write(strReply);
     }
-    printf("ThreadRPCServer exited\n");
-}
+
+    void Write(const string& strReplyIn)
+    {
+        // The reply must stay alive until the write completes
+        if (&strReplyIn != &strReply)
+            strReply = strReplyIn;
+
+        if (fUseSSL)
+            asio::async_write(sslStream, asio::buffer(strReply),
+                boost::bind(&RPCSession::HandleWrite, this->shared_from_this(),
+                    asio::placeholders::error));
+        else
+            asio::async_write(sslStream.next_layer(), asio::buffer(strReply),
+                boost::bind(&RPCSession::HandleWrite, this->shared_from_this(),
+                    asio::placeholders::error));
+    }
+
+    void HandleWrite(const boost::system::error_code& error)
+    {
+        if (!error && fKeepAlive && !fShutdown)
+        {
+            ReadHeader();
+            return;
+        }
+
+        boost::system::error_code ignored;
+        sslStream.lowest_layer().shutdown(socket_base::shutdown_both, ignored);
+        sslStream.lowest_layer().close(ignored);
+    }
+};
 
 // Forward declaration required for RPCListen
 template <typename Protocol, typename SocketAcceptorService>
 static void RPCAcceptHandler(boost::shared_ptr< basic_socket_acceptor<Protocol, SocketAcceptorService> > acceptor,
                              ssl::context& context,
                              bool fUseSSL,
-                             AcceptedConnection* conn,
+                             boost::shared_ptr< RPCSession<Protocol> > session,
                              const boost::system::error_code& error);
 
 /**
@@ -703,16 +1116,16 @@ static void RPCListen(boost::shared_ptr< basic_socket_acceptor<Protocol, SocketA
                    const bool fUseSSL)
 {
     // Accept connection
-    AcceptedConnectionImpl<Protocol>* conn = new AcceptedConnectionImpl<Protocol>(acceptor->get_io_service(), context, fUseSSL);
+    boost::shared_ptr< RPCSession<Protocol> > session(new RPCSession<Protocol>(acceptor->get_io_service(), context, fUseSSL));
 
     acceptor->async_accept(
-            conn->sslStream.lowest_layer(),
-            conn->peer,
+            session->sslStream.lowest_layer(),
+            session->peer,
             boost::bind(&RPCAcceptHandler<Protocol, SocketAcceptorService>,
                 acceptor,
                 boost::ref(context),
                 fUseSSL,
-                conn,
+                session,
                 boost::asio::placeholders::error));
 }
 
@@ -723,7 +1136,7 @@ template <typename Protocol, typename SocketAcceptorService>
 static void RPCAcceptHandler(boost::shared_ptr< basic_socket_acceptor<Protocol, SocketAcceptorService> > acceptor,
                              ssl::context& context,
                              const bool fUseSSL,
-                             AcceptedConnection* conn,
+                             boost::shared_ptr< RPCSession<Protocol> > session,
                              const boost::system::error_code& error)
 {
     vnThreadsRunning[THREAD_RPCLISTENER]++;
@@ -733,33 +1146,66 @@ static void RPCAcceptHandler(boost::shared_ptr< basic_socket_acceptor<Protocol,
      && acceptor->is_open())
         RPCListen(acceptor, context, fUseSSL);
 
-    AcceptedConnectionImpl<ip::tcp>* tcp_conn = dynamic_cast< AcceptedConnectionImpl<ip::tcp>* >(conn);
-
     // TODO : Actually handle errors
-    if (error)
+    // On error the session is freed with this handler.
+    if (!error)
     {
-        delete conn;
+        // Restrict callers by IP.  It is important to
+        // do this before reading the request, to filter out
+        // certain DoS and misbehaving clients.
+        if (!ClientAllowed(session->peer.address()))
+        {
+            // Only send a 403 if we're not using SSL to prevent a DoS during the SSL handshake.
+            if (!fUseSSL)
+                session->Close(HTTPReply(HTTP_FORBIDDEN, "", false));
+        }
+
+        // start reading requests on the worker pool
+        else
+            session->Start();
     }
 
-    // Restrict callers by IP.  It is important to
-    // do this before starting client thread, to filter out
-    // certain DoS and misbehaving clients.
-    else if (tcp_conn
-          && !ClientAllowed(tcp_conn->peer.address()))
+    vnThreadsRunning[THREAD_RPCLISTENER]--;
+}
+
+static void RPCWorker(asio::io_service* io_service)
+{
+    RenameThread("grc-rpcworker");
+
+    // run() returns once the io_service is stopped. A handler that throws
+    // only aborts its own request.
+    while (true)
     {
-        // Only send a 403 if we're not using SSL to prevent a DoS during the SSL handshake.
-        if (!fUseSSL)
-            conn->stream() << HTTPReply(HTTP_FORBIDDEN, "", false) << std::flush;
-        delete conn;
+        try
+        {
+            io_service->run();
+            return;
+        }
+        catch (std::exception& e) {
+            PrintException(&e, "RPCWorker()");
+        } catch (...) {
+            PrintException(NULL, "RPCWorker()");
+        }
     }
+}
 
-    // start HTTP client thread
-    else if (!NewThread(ThreadRPCServer3, conn)) {
-        printf("Failed to create RPC server client thread\n");
-        delete conn;
+/**
+ * Stops the worker pool once shutdown is requested. Idle workers block in
+ * io_service::run() and would otherwise never notice fShutdown.
+ */
+static void RPCShutdownCheck(asio::io_service* io_service, asio::deadline_timer* timer, const boost::system::error_code& error)
+{
+    if (error)
+        return;
+
+    if (fShutdown)
+    {
+        io_service->stop();
+        return;
     }
 
-    vnThreadsRunning[THREAD_RPCLISTENER]--;
+    timer->expires_from_now(posix_time::milliseconds(200));
+    timer->async_wait(boost::bind(&RPCShutdownCheck, io_service, timer, asio::placeholders::error));
 }
 
 void ThreadRPCServer2(void* parg)
@@ -886,188 +1332,20 @@ void ThreadRPCServer2(void* parg)
         return;
     }
 
+    // Serve connections on a fixed pool of workers sharing the io_service
+    nRPCThreads = std::max(1, (int)GetArg("-rpcthreads", 4));
+    asio::deadline_timer shutdownTimer(io_service);
+    RPCShutdownCheck(&io_service, &shutdownTimer, boost::system::error_code());
+
     vnThreadsRunning[THREAD_RPCLISTENER]--;
-    while (!fShutdown)
-        io_service.run_one();
+    boost::thread_group workers;
+    for (unsigned int i = 0; i < nRPCThreads; i++)
+        workers.create_thread(boost::bind(&RPCWorker, &io_service));
+    workers.join_all();
     vnThreadsRunning[THREAD_RPCLISTENER]++;
     StopRequests();
 }
 
-class JSONRequest
-{
-public:
-    Value id;
-    string strMethod;
-    Array params;
-
-    JSONRequest() { id = Value::null; }
-    void parse(const Value& valRequest);
-};
-
-void JSONRequest::parse(const Value& valRequest)
-{
-    // Parse request
-    if (valRequest.type() != obj_type)
-        throw JSONRPCError(RPC_INVALID_REQUEST, "Invalid Request object");
-    const Object& request = valRequest.get_obj();
-
-    // Parse id now so errors from here on will have the id
-    id = find_value(request, "id");
-
-    // Parse method
-    Value valMethod = find_value(request, "method");
-    if (valMethod.type() == null_type)
-        throw JSONRPCError(RPC_INVALID_REQUEST, "Missing method");
-    if (valMethod.type() != str_type)
-        throw JSONRPCError(RPC_INVALID_REQUEST, "Method must be a string");
-    strMethod = valMethod.get_str();
-    if (strMethod != "getwork" && strMethod != "getblocktemplate")
-        if (fDebug10) printf("ThreadRPCServer method=%s\n", strMethod.c_str());
-
-    // Parse params
-    Value valParams = find_value(request, "params");
-    if (valParams.type() == array_type)
-        params = valParams.get_array();
-    else if (valParams.type() == null_type)
-        params = Array();
-    else
-        throw JSONRPCError(RPC_INVALID_REQUEST, "Params must be an array");
-}
-
-
-
-
-static Object JSONRPCExecOne(const Value& req)
-{
-    Object rpc_result;
-
-    JSONRequest jreq;
-    try {
-        jreq.parse(req);
-
-        Value result = tableRPC.execute(jreq.strMethod, jreq.params);
-        rpc_result = JSONRPCReplyObj(result, Value::null, jreq.id);
-    }
-    catch (Object& objError)
-    {
-        rpc_result = JSONRPCReplyObj(Value::null, objError, jreq.id);
-    }
-    catch (std::exception& e)
-    {
-        rpc_result = JSONRPCReplyObj(Value::null,
-                                     JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
-    }
-
-    return rpc_result;
-}
-
-static string JSONRPCExecBatch(const Array& vReq)
-{
-    Array ret;
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(vReq[reqIdx]));
-
-    return write_string(Value(ret), false) + "\n";
-}
-
-static CCriticalSection cs_THREAD_RPCHANDLER;
-
-void ThreadRPCServer3(void* parg)
-{
-    // Make this thread recognisable as the RPC handler
-    RenameThread("grc-rpchand");
-
-    {
-        LOCK(cs_THREAD_RPCHANDLER);
-        vnThreadsRunning[THREAD_RPCHANDLER]++;
-    }
-    AcceptedConnection *conn = (AcceptedConnection *) parg;
-
-    bool fRun = true;
-    while (true)
-    {
-        if (fShutdown || !fRun)
-        {
-            conn->close();
-            delete conn;
-            {
-                LOCK(cs_THREAD_RPCHANDLER);
-                --vnThreadsRunning[THREAD_RPCHANDLER];
-            }
-            return;
-        }
-        map<string, string> mapHeaders;
-        string strRequest;
-
-        ReadHTTP(conn->stream(), mapHeaders, strRequest);
-
-        // Check authorization
-        if (mapHeaders.count("authorization") == 0)
-        {
-            conn->stream() << HTTPReply(HTTP_UNAUTHORIZED, "", false) << std::flush;
-            break;
-        }
-        if (!HTTPAuthorized(mapHeaders))
-        {
-            printf("ThreadRPCServer incorrect password attempt from %s\n", conn->peer_address_to_string().c_str());
-            /* Deter brute-forcing short passwords.
-               If this results in a DOS the user really
-               shouldn't have their RPC port exposed.*/
-            if (mapArgs["-rpcpassword"].size() < 20)
-                MilliSleep(250);
-
-            conn->stream() << HTTPReply(HTTP_UNAUTHORIZED, "", false) << std::flush;
-            break;
-        }
-        if (mapHeaders["connection"] == "close")
-            fRun = false;
-
-        JSONRequest jreq;
-        try
-        {
-            // Parse request
-            Value valRequest;
-            if (!read_string(strRequest, valRequest))
-                throw JSONRPCError(RPC_PARSE_ERROR, "Parse error");
-
-            string strReply;
-
-            // singleton request
-            if (valRequest.type() == obj_type) {
-                jreq.parse(valRequest);
-
-                Value result = tableRPC.execute(jreq.strMethod, jreq.params);
-
-                // Send reply
-                strReply = JSONRPCReply(result, Value::null, jreq.id);
-
-            // array of requests
-            } else if (valRequest.type() == array_type)
-                strReply = JSONRPCExecBatch(valRequest.get_array());
-            else
-                throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
-
-            conn->stream() << HTTPReply(HTTP_OK, strReply, fRun) << std::flush;
-        }
-        catch (Object& objError)
-        {
-            ErrorReply(conn->stream(), objError, jreq.id);
-            break;
-        }
-        catch (std::exception& e)
-        {
-            ErrorReply(conn->stream(), JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
-            break;
-        }
-    }
-
-    delete conn;
-    {
-        LOCK(cs_THREAD_RPCHANDLER);
-        vnThreadsRunning[THREAD_RPCHANDLER]--;
-    }
-}
-
 json_spirit::Value CRPCTable::execute(const std::string &strMethod, const json_spirit::Array &params) const
 {
     // Find method
@@ -28,6 +28,7 @@ enum HTTPStatusCode
     HTTP_UNAUTHORIZED          = 401,
     HTTP_FORBIDDEN             = 403,
     HTTP_NOT_FOUND             = 404,
+    HTTP_REQUEST_TOO_LARGE     = 413,
     HTTP_INTERNAL_SERVER_ERROR = 500,
 };
 
@@ -1,41 +1,86 @@
 #include "block.h"
 #include "main.h"
 
+#include <algorithm>
 #include <cstdlib>
 
-BlockFinder::BlockFinder()
-    : cache(nullptr)
+namespace
+{
+    // Number of block index entries per arena chunk.
+    const size_t CHUNK_ENTRIES = 4096;
+}
+
+BlockIndexArena blockIndexArena;
+ActiveChain activeChain;
+
+BlockIndexArena::BlockIndexArena()
+    : used(CHUNK_ENTRIES)
 {}
 
-CBlockIndex* BlockFinder::FindByHeight(int height)
+void* BlockIndexArena::Allocate()
 {
-    // If the height is at the bottom half of the chain, start searching from
-    // the start to the end, otherwise search backwards from the end.
-    CBlockIndex *index = height < nBestHeight / 2
-            ? pindexGenesisBlock
-            : pindexBest;
-    
-    if(index != nullptr)
+    LOCK(cs);
+    if (used == CHUNK_ENTRIES)
     {
-        // Use the cache if it's closer to the target than the current
-        // start block.
-        if (cache && abs(height - index->nHeight) > std::abs(height - cache->nHeight))
-            index = cache;
-        
-        // Traverse towards the tail.
-        while (index && index->pprev && index->nHeight > height)
-            index = index->pprev;
-        
-        // Traverse towards the head.
-        while (index && index->pnext && index->nHeight < height)
-            index = index->pnext;
+        chunks.emplace_back(new char[CHUNK_ENTRIES * sizeof(CBlockIndex)]);
+        used = 0;
     }
-   
-    cache = index;
-    return index;  
+
+    return chunks.back().get() + sizeof(CBlockIndex) * used++;
+}
+
+CBlockIndex* ActiveChain::operator[](int height) const
+{
+    LOCK(cs);
+    if (height < 0 || height >= static_cast<int>(chain.size()))
+        return nullptr;
+
+    return chain[height];
+}
+
+CBlockIndex* ActiveChain::Tip() const
+{
+    LOCK(cs);
+    return chain.empty() ? nullptr : chain.back();
+}
+
+int ActiveChain::Height() const
+{
+    LOCK(cs);
+    return static_cast<int>(chain.size()) - 1;
+}
+
+void ActiveChain::SetTip(CBlockIndex* pindex)
+{
+    LOCK(cs);
+    if (pindex == nullptr)
+    {
+        chain.clear();
+        return;
+    }
+
+    chain.resize(pindex->nHeight + 1);
+    while (pindex && chain[pindex->nHeight] != pindex)
+    {
+        chain[pindex->nHeight] = pindex;
+        pindex = pindex->pprev;
+    }
+}
+
+BlockFinder::BlockFinder()
+{}
+
+CBlockIndex* BlockFinder::FindByHeight(int height)
+{
+    const int tip = activeChain.Height();
+    if (tip < 0)
+        return nullptr;
+
+    // The chain may have shrunk since its height was read; fall back to the tip.
+    CBlockIndex* index = activeChain[std::max(0, std::min(height, tip))];
+    return index ? index : activeChain.Tip();
 }
 
 void BlockFinder::Reset()
 {
-    cache = nullptr;
 }
@@ -1,6 +1,119 @@
 #pragma once
 
 #include "fwd.h"
+#include "sync.h"
+#include "uint256.h"
+
+#include <unordered_map>
+#include <vector>
+#include <memory>
+
+//!
+//! \brief Hash functor for block hashes.
+//!
+//! Block hashes are already uniformly distributed so the low 64 bits are
+//! used directly as the bucket hash.
+//!
+struct BlockHasher
+{
+    size_t operator()(const uint256& hash) const
+    {
+        return static_cast<size_t>(hash.Get64());
+    }
+};
+
+//!
+//! \brief Hash to block index lookup table.
+//!
+typedef std::unordered_map<uint256, CBlockIndex*, BlockHasher> BlockMap;
+
+//!
+//! \brief Contiguous storage for block index entries.
+//!
+//! Block index entries live for the whole lifetime of the process, so
+//! instead of allocating each of them individually they are carved out of
+//! large chunks. This saves the per allocation overhead and keeps entries
+//! that were loaded together close together in memory.
+//!
+class BlockIndexArena
+{
+public:
+    //!
+    //! \brief Constructor.
+    //!
+    BlockIndexArena();
+
+    //!
+    //! \brief Construct a new block index entry in the arena.
+    //!
+    //! \param args Arguments forwarded to the CBlockIndex constructor.
+    //! \return Pointer to the new entry. Entries are never freed.
+    //!
+    template<typename... Args>
+    CBlockIndex* Create(Args&&... args)
+    {
+        return new (Allocate()) CBlockIndex(std::forward<Args>(args)...);
+    }
+
+private:
+    void* Allocate();
+
+    CCriticalSection cs;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    size_t used;
+};
+
+//!
+//! \brief Height indexed view of the active chain.
+//!
+//! Kept in sync with \a pindexBest so that blocks in the main chain can be
+//! looked up by height in constant time.
+//!
+class ActiveChain
+{
+public:
+    //!
+    //! \brief Get block at a specific height.
+    //!
+    //! \param height Block height.
+    //! \return The block at \p height, or \a nullptr if \p height is outside
+    //! the active chain.
+    //!
+    CBlockIndex* operator[](int height) const;
+
+    //!
+    //! \brief Get the tip of the chain.
+    //!
+    //! \return The last block of the chain, or \a nullptr if the chain is
+    //! empty.
+    //!
+    CBlockIndex* Tip() const;
+
+    //!
+    //! \brief Get the height of the chain tip.
+    //!
+    //! \return Height of the tip, or -1 if the chain is empty.
+    //!
+    int Height() const;
+
+    //!
+    //! \brief Set a new chain tip.
+    //!
+    //! Rewrites the chain from \p pindex backwards until it meets the
+    //! previous chain, which makes this cheap both for new blocks and for
+    //! reorganizations.
+    //!
+    //! \param pindex New tip, or \a nullptr to clear the chain.
+    //!
+    void SetTip(CBlockIndex* pindex);
+
+private:
+    mutable CCriticalSection cs;
+    std::vector<CBlockIndex*> chain;
+};
+
+extern BlockIndexArena blockIndexArena;
+extern ActiveChain activeChain;
 
 //!
 //! \brief Chain traversing block finder.
@@ -16,8 +129,8 @@ public:
     //!
     //! \brief Find a block with a specific height.
     //! 
-    //! Traverses the chain from head or tail, depending on what's closest to
-    //! find the block that matches \p height. This is a caching operation
+    //! Looks up the block in the active chain. Heights outside the chain are
+    //! clamped to the genesis block or the chain tip.
     //! 
     //! \param nHeight Block height to find.
     //! \return The block with the height closest to \p nHeight if found, otherwise
@@ -28,11 +141,8 @@ public:
     //!
     //! \brief Reset finder cache.
     //!
-    //! Clears the block finder cache. This should be used when blocks are removed
-    //! from the chain to avoid accessing deleted memory.
+    //! Kept for compatibility. Lookups go through \a activeChain which is
+    //! updated whenever the best chain changes, so there is nothing to reset.
     //! 
     void Reset();
-    
-private:
-    CBlockIndex* cache;
 };
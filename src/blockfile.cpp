@@ -0,0 +1,130 @@
+#include "blockfile.h"
+#include "util.h"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+BlockFileMapping::BlockFileMapping(const char* data, size_t size)
+    : data(data)
+    , size(size)
+{
+}
+
+BlockFileMapping::~BlockFileMapping()
+{
+#ifndef WIN32
+    munmap(const_cast<char*>(data), size);
+#endif
+}
+
+BlockFileReader::BlockFileReader(const boost::filesystem::path& dir)
+    : dir(dir)
+{
+}
+
+void BlockFileReader::Clear()
+{
+    boost::mutex::scoped_lock lock(mutex);
+    mappings.clear();
+    setUnmappable.clear();
+}
+
+std::shared_ptr<const BlockFileMapping> BlockFileReader::GetMapping(unsigned int nFile, bool fRefresh)
+{
+    if ((nFile < 1) || (nFile == (unsigned int) -1))
+        return nullptr;
+
+    boost::mutex::scoped_lock lock(mutex);
+    std::shared_ptr<const BlockFileMapping>& mapping = mappings[nFile];
+    if (mapping && !fRefresh)
+        return mapping;
+    if (setUnmappable.count(nFile))
+        return nullptr;
+
+#ifdef WIN32
+    setUnmappable.insert(nFile);
+    return nullptr;
+#else
+    boost::filesystem::path path = dir / strprintf("blk%04u.dat", nFile);
+    int fd = open(path.string().c_str(), O_RDONLY);
+    if (fd < 0)
+        return mapping;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0 || (mapping && (size_t)st.st_size == mapping->size))
+    {
+        close(fd);
+        return mapping;
+    }
+
+    // The mapping outlives the descriptor
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        printf("BlockFileReader: cannot map %s, reading it through stdio\n", path.string().c_str());
+        setUnmappable.insert(nFile);
+        mapping.reset();
+        return nullptr;
+    }
+
+    mapping = std::make_shared<const BlockFileMapping>(static_cast<const char*>(data), st.st_size);
+    return mapping;
+#endif
+}
+
+BlockFileReader& GetBlockFileReader()
+{
+    // Allocated on first use, once the data directory is known, and never
+    // freed so that reads from threads still running at exit stay valid.
+    static BlockFileReader* reader = new BlockFileReader(GetDataDir());
+    return *reader;
+}
+
+RawBlockCache::RawBlockCache(size_t nMaxBytes)
+    : nMaxBytes(nMaxBytes)
+    , nBytes(0)
+{
+}
+
+RawBlockPtr RawBlockCache::Get(const uint256& hash)
+{
+    boost::mutex::scoped_lock lock(mutex);
+    auto it = mapBlocks.find(hash);
+    if (it == mapBlocks.end())
+        return nullptr;
+
+    blocks.splice(blocks.begin(), blocks, it->second);
+    return it->second->second;
+}
+
+void RawBlockCache::Put(const uint256& hash, const RawBlockPtr& block)
+{
+    if (!block || block->size() > nMaxBytes)
+        return;
+
+    boost::mutex::scoped_lock lock(mutex);
+    if (mapBlocks.count(hash))
+        return;
+
+    while (!blocks.empty() && nBytes + block->size() > nMaxBytes)
+    {
+        nBytes -= blocks.back().second->size();
+        mapBlocks.erase(blocks.back().first);
+        blocks.pop_back();
+    }
+
+    blocks.emplace_front(hash, block);
+    mapBlocks[hash] = blocks.begin();
+    nBytes += block->size();
+}
+
+size_t RawBlockCache::GetBytes()
+{
+    boost::mutex::scoped_lock lock(mutex);
+    return nBytes;
+}
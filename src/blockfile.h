@@ -0,0 +1,157 @@
+#pragma once
+
+#include "serialize.h"
+#include "uint256.h"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+//!
+//! \brief Read-only memory mapping of one block file.
+//!
+class BlockFileMapping
+{
+public:
+    BlockFileMapping(const char* data, size_t size);
+    ~BlockFileMapping();
+
+    BlockFileMapping(const BlockFileMapping&) = delete;
+    BlockFileMapping& operator=(const BlockFileMapping&) = delete;
+
+    const char* const data; //!< First byte of the file.
+    const size_t size;      //!< Mapped length of the file.
+};
+
+//!
+//! \brief Reads blocks and transactions straight out of memory-mapped
+//! \c blkNNNN.dat files.
+//!
+//! Each block file is mapped the first time it is read and kept mapped. A
+//! read past the end of a mapping maps the file again, since the current
+//! block file keeps growing. Where a file cannot be mapped, such as on
+//! Windows or when address space runs out, reads fail and the caller is
+//! expected to fall back to stdio.
+//!
+class BlockFileReader
+{
+public:
+    //!
+    //! \brief Create a reader.
+    //! \param dir Directory holding the block files.
+    //!
+    explicit BlockFileReader(const boost::filesystem::path& dir);
+
+    //!
+    //! \brief Deserialise an object stored in a block file.
+    //! \param nFile Block file number.
+    //! \param nPos Offset of the object within the file.
+    //! \param obj Object to read into. Left partly read on failure.
+    //! \param nType Serialisation type.
+    //! \param nVersion Serialisation version.
+    //! \return \c false if the file cannot be mapped or the object cannot
+    //! be read from it.
+    //!
+    template<typename T>
+    bool Read(unsigned int nFile, unsigned int nPos, T& obj, int nType, int nVersion)
+    {
+        // A read past the end of the mapping may be of data appended after
+        // the file was mapped, so map it once more before giving up.
+        for (int nTry = 0; nTry < 2; ++nTry)
+        {
+            std::shared_ptr<const BlockFileMapping> mapping = GetMapping(nFile, nTry > 0);
+            if (!mapping)
+                return false;
+            if (nPos >= mapping->size)
+                continue;
+
+            try
+            {
+                CBufferReader s(mapping->data + nPos, mapping->data + mapping->size, nType, nVersion);
+                s >> obj;
+                return true;
+            }
+            catch (const std::ios_base::failure&)
+            {
+            }
+        }
+
+        return false;
+    }
+
+    //!
+    //! \brief Drop every mapping. Reads in progress keep theirs alive.
+    //!
+    void Clear();
+
+private:
+    std::shared_ptr<const BlockFileMapping> GetMapping(unsigned int nFile, bool fRefresh);
+
+    const boost::filesystem::path dir;
+    boost::mutex mutex;
+    std::map<unsigned int, std::shared_ptr<const BlockFileMapping>> mappings;
+    std::set<unsigned int> setUnmappable;
+};
+
+//!
+//! \brief Get the reader for the block files in the data directory.
+//!
+BlockFileReader& GetBlockFileReader();
+
+//!
+//! \brief A block as serialised on disk, which is also how it goes out on
+//! the wire.
+//!
+typedef std::vector<char> RawBlock;
+typedef std::shared_ptr<const RawBlock> RawBlockPtr;
+
+//!
+//! \brief Least recently used cache of serialised blocks, bounded by their
+//! total size.
+//!
+//! Peers downloading the chain ask for the same ranges of blocks, so the
+//! blocks served to one are kept around for the next.
+//!
+class RawBlockCache
+{
+public:
+    //!
+    //! \brief Create a cache.
+    //! \param nMaxBytes Most block data to hold. Zero disables the cache.
+    //!
+    explicit RawBlockCache(size_t nMaxBytes);
+
+    //!
+    //! \brief Look up a block and mark it as recently used.
+    //! \param hash Block hash.
+    //! \return The block, or an empty pointer if it is not cached.
+    //!
+    RawBlockPtr Get(const uint256& hash);
+
+    //!
+    //! \brief Add a block, evicting the least recently used ones to make
+    //! room.
+    //! \param hash Block hash.
+    //! \param block Serialised block.
+    //!
+    void Put(const uint256& hash, const RawBlockPtr& block);
+
+    //!
+    //! \brief Get the size of the cached blocks in bytes.
+    //!
+    size_t GetBytes();
+
+private:
+    typedef std::list<std::pair<uint256, RawBlockPtr>> BlockList;
+
+    boost::mutex mutex;
+    const size_t nMaxBytes;
+    size_t nBytes;
+    BlockList blocks; //!< Most recently used first.
+    std::map<uint256, BlockList::iterator> mapBlocks;
+};
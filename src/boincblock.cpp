@@ -0,0 +1,102 @@
+#include "boincblock.h"
+#include "util.h"
+
+#include <cstdlib>
+#include <cstring>
+
+double cdbl(std::string s, int place);
+
+namespace
+{
+    const char DELIMITER[] = "<|>";
+    const size_t DELIMITER_LENGTH = sizeof(DELIMITER) - 1;
+
+    // Longest field converted without going through cdbl
+    const size_t MAX_NUMBER_LENGTH = 64;
+
+    // Numeric fields in the order DeserializeBoincBlock converts them
+    const BoincBlockView::Field NUMERIC_FIELDS[] =
+    {
+        BoincBlockView::RAC,
+        BoincBlockView::POB_DIFFICULTY,
+        BoincBlockView::DIFF_BYTES,
+        BoincBlockView::NONCE,
+        BoincBlockView::NETWORK_RAC,
+        BoincBlockView::RESEARCH_SUBSIDY,
+        BoincBlockView::LAST_PAYMENT_TIME,
+        BoincBlockView::RSA_WEIGHT,
+        BoincBlockView::MAGNITUDE,
+        BoincBlockView::INTEREST_SUBSIDY,
+        BoincBlockView::RESEARCH_SUBSIDY_2,
+        BoincBlockView::RESEARCH_AGE,
+        BoincBlockView::RESEARCH_MAGNITUDE_UNIT,
+        BoincBlockView::RESEARCH_AVERAGE_MAGNITUDE,
+    };
+
+    // Sentinel for a valid field count which has not been computed yet
+    const size_t UNKNOWN = static_cast<size_t>(-1);
+}
+
+BoincBlockView::BoincBlockView(const std::string& data)
+    : count(0)
+    , validCount(UNKNOWN)
+{
+    size_t start = 0;
+    while (true)
+    {
+        size_t end = data.find(DELIMITER, start, DELIMITER_LENGTH);
+        size_t length = (end == std::string::npos ? data.size() : end) - start;
+        if (count < FIELD_COUNT)
+            fields[count] = boost::string_ref(data.data() + start, length);
+        ++count;
+        if (end == std::string::npos)
+            break;
+        start = end + DELIMITER_LENGTH;
+    }
+}
+
+double BoincBlockView::GetDouble(size_t field, int place) const
+{
+    boost::string_ref value = (*this)[field];
+    if (value.empty())
+        return 0;
+
+    // cdbl strips a few characters and then hands the rest to lexical_cast.
+    // For fields made of digits, signs and a decimal point that is the same
+    // as strtod consuming the whole field, so only those are done here.
+    if (value.size() <= MAX_NUMBER_LENGTH &&
+        value.find_first_not_of("0123456789.+-") == boost::string_ref::npos)
+    {
+        char buffer[MAX_NUMBER_LENGTH + 1];
+        memcpy(buffer, value.data(), value.size());
+        buffer[value.size()] = 0;
+
+        char* end;
+        double d = strtod(buffer, &end);
+        if (end == buffer + value.size())
+            return Round(d, place);
+    }
+
+    return cdbl(value.to_string(), place);
+}
+
+size_t BoincBlockView::GetValidFieldCount() const
+{
+    if (validCount != UNKNOWN)
+        return validCount;
+
+    validCount = count > 7 ? static_cast<size_t>(FIELD_COUNT) : 0;
+    for (size_t i = 0; i < sizeof(NUMERIC_FIELDS) / sizeof(NUMERIC_FIELDS[0]) && NUMERIC_FIELDS[i] < validCount; ++i)
+    {
+        try
+        {
+            GetDouble(NUMERIC_FIELDS[i], 0);
+        }
+        catch (...)
+        {
+            validCount = NUMERIC_FIELDS[i];
+        }
+    }
+
+    return validCount;
+}
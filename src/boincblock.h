@@ -0,0 +1,133 @@
+#pragma once
+
+#include <boost/utility/string_ref.hpp>
+
+#include <array>
+#include <string>
+
+//!
+//! \brief Non-owning view of a serialized BOINC block.
+//!
+//! The BOINC block carried in \a CTransaction::hashBoinc of the coinbase is
+//! a list of fields separated by \c <|>. The view records where each field
+//! starts and ends in the original string without copying anything, which
+//! makes it cheap to pick a few fields out of many blocks. The referenced
+//! string must outlive the view.
+//!
+class BoincBlockView
+{
+public:
+    //!
+    //! \brief Field positions in the serialized block.
+    //!
+    enum Field
+    {
+        CPID,
+        PROJECT_NAME,
+        AES_SKEIN,
+        RAC,
+        POB_DIFFICULTY,
+        DIFF_BYTES,
+        ENC_CPID,
+        ENC_AES,
+        NONCE,
+        NETWORK_RAC,
+        CLIENT_VERSION,
+        RESEARCH_SUBSIDY,
+        LAST_PAYMENT_TIME,
+        RSA_WEIGHT,
+        CPID_V2,
+        MAGNITUDE,
+        GRC_ADDRESS,
+        LAST_BLOCK_HASH,
+        INTEREST_SUBSIDY,
+        ORGANIZATION,
+        ORGANIZATION_KEY,
+        NEURAL_HASH,
+        SUPERBLOCK,
+        RESEARCH_SUBSIDY_2,
+        RESEARCH_AGE,
+        RESEARCH_MAGNITUDE_UNIT,
+        RESEARCH_AVERAGE_MAGNITUDE,
+        LAST_POR_BLOCK_HASH,
+        CURRENT_NEURAL_HASH,
+        BOINC_PUBLIC_KEY,
+        BOINC_SIGNATURE,
+
+        FIELD_COUNT
+    };
+
+    //!
+    //! \brief Constructor.
+    //!
+    //! \param data Serialized block to split into fields.
+    //!
+    explicit BoincBlockView(const std::string& data);
+
+    //!
+    //! \brief Get the number of fields in the block.
+    //!
+    //! Counts every field in the block, including those past the last
+    //! known one.
+    //!
+    size_t size() const { return count; }
+
+    //!
+    //! \brief Get a field.
+    //!
+    //! \param field Field to get.
+    //! \return The field contents, or an empty reference if the block is too
+    //! short to contain \p field.
+    //!
+    boost::string_ref operator[](size_t field) const
+    {
+        return field < FIELD_COUNT ? fields[field] : boost::string_ref();
+    }
+
+    //!
+    //! \brief Get a field as a string.
+    //!
+    std::string GetString(size_t field) const
+    {
+        return (*this)[field].to_string();
+    }
+
+    //!
+    //! \brief Get a numeric field.
+    //!
+    //! Gives the same result as passing the field to \a cdbl. Plain decimal
+    //! numbers are converted in place, anything else goes through \a cdbl,
+    //! including the exception it throws for invalid numbers.
+    //!
+    //! \param field Field to convert.
+    //! \param place Number of decimals to round to.
+    //! \return The field as a number, 0 for an empty field.
+    //!
+    double GetDouble(size_t field, int place) const;
+
+    //!
+    //! \brief Get the number of leading fields that deserialize.
+    //!
+    //! \a DeserializeBoincBlock ignores blocks of eight fields or less and
+    //! stops at the first malformed number, leaving the fields after it
+    //! empty. Fields before the returned index are the ones it would fill.
+    //!
+    size_t GetValidFieldCount() const;
+
+    //!
+    //! \brief Get a field as a string if it would be deserialized.
+    //!
+    //! \param field Field to get.
+    //! \return The field contents, or an empty string for fields at or past
+    //! \a GetValidFieldCount().
+    //!
+    std::string GetValidString(size_t field) const
+    {
+        return field < GetValidFieldCount() ? GetString(field) : std::string();
+    }
+
+private:
+    std::array<boost::string_ref, FIELD_COUNT> fields;
+    size_t count;
+    mutable size_t validCount;
+};
@@ -0,0 +1,279 @@
+#include "debuglog.h"
+#include "util.h"
+
+#include <boost/thread.hpp>
+
+#include <cstdio>
+
+namespace
+{
+    const size_t QUEUE_SLOTS = 8192;
+    const size_t QUEUE_MAX_BYTES = 8 * 1024 * 1024;
+    const size_t FILE_BUFFER_SIZE = 64 * 1024;
+
+    // Longest a queued line waits when the writer missed a wakeup
+    const int WRITER_IDLE_MS = 100;
+
+    struct DebugLog
+    {
+        DebugLog()
+            : file(nullptr)
+            , fStartedNewLine(true)
+            , nLastTime(-1)
+            , queue(QUEUE_SLOTS, QUEUE_MAX_BYTES)
+            , fAsync(false)
+            , nProducers(0)
+            , fWriterIdle(false)
+            , fStopWriter(false)
+            , pthreadWriter(nullptr)
+        {
+        }
+
+        // File state, guarded by mutexFile
+        boost::mutex mutexFile;
+        FILE* file;
+        bool fStartedNewLine;
+        int64_t nLastTime;
+        std::string strLastTime;
+
+        DebugLogQueue queue;
+        std::atomic<bool> fAsync;
+        std::atomic<int> nProducers;
+
+        // Writer thread
+        boost::mutex mutexWake;
+        boost::condition_variable condWake;
+        std::atomic<bool> fWriterIdle;
+        std::atomic<bool> fStopWriter;
+        boost::thread* pthreadWriter;
+    };
+
+    // This may be called by global destructors during shutdown. Since the
+    // order of destruction of static/global objects is undefined, the log
+    // is allocated on the heap the first time it is used and never freed.
+    DebugLog& GetDebugLog()
+    {
+        static DebugLog* log = new DebugLog();
+        return *log;
+    }
+
+    // Open or reopen debug.log. Requires mutexFile.
+    bool OpenFile(DebugLog& log)
+    {
+        boost::filesystem::path pathDebug = GetDataDir() / "debug.log";
+        if (!log.file)
+        {
+            log.file = fopen(pathDebug.string().c_str(), "a");
+            if (log.file)
+                setvbuf(log.file, NULL, _IOFBF, FILE_BUFFER_SIZE);
+        }
+        else if (fReopenDebugLog)
+        {
+            fReopenDebugLog = false;
+            log.file = freopen(pathDebug.string().c_str(), "a", log.file);
+            if (log.file)
+                setvbuf(log.file, NULL, _IOFBF, FILE_BUFFER_SIZE);
+        }
+
+        return log.file != nullptr;
+    }
+
+    // Requires mutexFile and an open file.
+    void WriteLine(DebugLog& log, int64_t nTime, const std::string& str)
+    {
+        if (fLogTimestamps && log.fStartedNewLine)
+        {
+            // Consecutive lines mostly share a timestamp
+            if (nTime != log.nLastTime)
+            {
+                log.strLastTime = DateTimeStrFormat("%x %H:%M:%S", nTime) + " ";
+                log.nLastTime = nTime;
+            }
+            fwrite(log.strLastTime.data(), 1, log.strLastTime.size(), log.file);
+        }
+
+        fwrite(str.data(), 1, str.size(), log.file);
+        if (!str.empty())
+            log.fStartedNewLine = str[str.size() - 1] == '\n';
+    }
+
+    void ThreadDebugLogWriter()
+    {
+        RenameThread("grc-debuglog");
+
+        DebugLog& log = GetDebugLog();
+        int64_t nTime;
+        std::string str;
+        while (true)
+        {
+            // Read before draining so that nothing queued ahead of the stop is lost
+            bool fStop = log.fStopWriter;
+            size_t nWritten = 0;
+            {
+                boost::mutex::scoped_lock lock(log.mutexFile);
+                bool fOpen = OpenFile(log);
+                while (log.queue.Pop(nTime, str))
+                {
+                    if (fOpen)
+                        WriteLine(log, nTime, str);
+                    nWritten++;
+                }
+
+                uint64_t nDropped = log.queue.TakeDropped();
+                if (nDropped && fOpen)
+                {
+                    WriteLine(log, GetAdjustedTime(), std::string(log.fStartedNewLine ? "" : "\n")
+                              + "*** " + std::to_string(nDropped) + " debug.log messages dropped ***\n");
+                    nWritten++;
+                }
+
+                if (nWritten && fOpen)
+                    fflush(log.file);
+            }
+
+            if (nWritten == 0)
+            {
+                if (fStop)
+                    break;
+
+                boost::mutex::scoped_lock lock(log.mutexWake);
+                log.fWriterIdle = true;
+                log.condWake.timed_wait(lock, boost::posix_time::milliseconds(WRITER_IDLE_MS));
+                log.fWriterIdle = false;
+            }
+        }
+    }
+}
+
+DebugLogQueue::DebugLogQueue(size_t nSlots, size_t nMaxBytesIn)
+    : nMask(0)
+    , nMaxBytes(nMaxBytesIn)
+    , nQueuedBytes(0)
+    , nDropped(0)
+    , nPushPos(0)
+    , nPopPos(0)
+{
+    size_t nSize = 1;
+    while (nSize < nSlots)
+        nSize <<= 1;
+
+    slots.reset(new Slot[nSize]);
+    for (size_t i = 0; i < nSize; ++i)
+        slots[i].nSequence.store(i, std::memory_order_relaxed);
+    nMask = nSize - 1;
+}
+
+bool DebugLogQueue::Push(int64_t nTime, std::string& str)
+{
+    const size_t nSize = str.size();
+    if (nQueuedBytes.fetch_add(nSize) + nSize > nMaxBytes)
+    {
+        nQueuedBytes.fetch_sub(nSize);
+        nDropped++;
+        return false;
+    }
+
+    // A slot is free for position n when its sequence is n, and holds the
+    // line pushed at n once its sequence is n + 1.
+    size_t nPos = nPushPos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot& slot = slots[nPos & nMask];
+        intptr_t nDiff = (intptr_t)slot.nSequence.load(std::memory_order_acquire) - (intptr_t)nPos;
+        if (nDiff == 0)
+        {
+            if (nPushPos.compare_exchange_weak(nPos, nPos + 1, std::memory_order_relaxed))
+            {
+                slot.nTime = nTime;
+                slot.str.swap(str);
+                slot.nSequence.store(nPos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (nDiff < 0)
+        {
+            // Every slot is still waiting for the writer
+            nQueuedBytes.fetch_sub(nSize);
+            nDropped++;
+            return false;
+        }
+        else
+        {
+            nPos = nPushPos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool DebugLogQueue::Pop(int64_t& nTime, std::string& str)
+{
+    Slot& slot = slots[nPopPos & nMask];
+    if (slot.nSequence.load(std::memory_order_acquire) != nPopPos + 1)
+        return false;
+
+    // Leave an empty string behind so idle slots hold no memory
+    nTime = slot.nTime;
+    str.swap(slot.str);
+    std::string().swap(slot.str);
+    slot.nSequence.store(nPopPos + nMask + 1, std::memory_order_release);
+    nPopPos++;
+    nQueuedBytes.fetch_sub(str.size());
+    return true;
+}
+
+uint64_t DebugLogQueue::TakeDropped()
+{
+    return nDropped.exchange(0);
+}
+
+void WriteDebugLog(std::string& str)
+{
+    DebugLog& log = GetDebugLog();
+    int64_t nTime = fLogTimestamps ? GetAdjustedTime() : 0;
+
+    // StopDebugLog waits for producers which saw the writer running
+    log.nProducers++;
+    if (log.fAsync)
+    {
+        log.queue.Push(nTime, str);
+        log.nProducers--;
+        if (log.fWriterIdle.exchange(false))
+            log.condWake.notify_one();
+        return;
+    }
+    log.nProducers--;
+
+    boost::mutex::scoped_lock lock(log.mutexFile);
+    if (OpenFile(log))
+    {
+        WriteLine(log, nTime, str);
+        fflush(log.file);
+    }
+}
+
+void StartDebugLog()
+{
+    DebugLog& log = GetDebugLog();
+    if (log.pthreadWriter)
+        return;
+
+    log.fStopWriter = false;
+    log.pthreadWriter = new boost::thread(&ThreadDebugLogWriter);
+    log.fAsync = true;
+}
+
+void StopDebugLog()
+{
+    DebugLog& log = GetDebugLog();
+    if (!log.pthreadWriter)
+        return;
+
+    log.fAsync = false;
+    while (log.nProducers != 0)
+        boost::this_thread::yield();
+
+    log.fStopWriter = true;
+    log.condWake.notify_one();
+    log.pthreadWriter->join();
+    delete log.pthreadWriter;
+    log.pthreadWriter = nullptr;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+//!
+//! \brief Bounded multi-producer, single-consumer queue of log lines.
+//!
+//! Producers claim a slot with a single compare-and-swap and never block;
+//! when every slot is taken, or the queued text would exceed the byte
+//! budget, the line is dropped and counted instead. Only one thread may
+//! pop.
+//!
+class DebugLogQueue
+{
+public:
+    //!
+    //! \brief Create a queue.
+    //! \param nSlots Number of lines the queue can hold. Rounded up to a
+    //! power of two.
+    //! \param nMaxBytes Most text the queue holds at a time.
+    //!
+    DebugLogQueue(size_t nSlots, size_t nMaxBytes);
+
+    //!
+    //! \brief Queue a line.
+    //! \param nTime Time to stamp the line with.
+    //! \param str Text to log. Moved from when queued.
+    //! \return \c false if the line was dropped.
+    //!
+    bool Push(int64_t nTime, std::string& str);
+
+    //!
+    //! \brief Take the oldest line off the queue. Single consumer only.
+    //! \return \c false if the queue is empty.
+    //!
+    bool Pop(int64_t& nTime, std::string& str);
+
+    //!
+    //! \brief Get and reset the number of dropped lines.
+    //!
+    uint64_t TakeDropped();
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> nSequence;
+        int64_t nTime;
+        std::string str;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t nMask;
+    size_t nMaxBytes;
+    std::atomic<size_t> nQueuedBytes;
+    std::atomic<uint64_t> nDropped;
+    std::atomic<size_t> nPushPos;
+    size_t nPopPos;
+};
+
+//!
+//! \brief Write a formatted message to debug.log.
+//!
+//! Once \a StartDebugLog has run the message is queued for the writer
+//! thread; before that, and after \a StopDebugLog, it is written directly.
+//!
+//! \param str Formatted message.
+//!
+void WriteDebugLog(std::string& str);
+
+//!
+//! \brief Start the debug.log writer thread.
+//!
+void StartDebugLog();
+
+//!
+//! \brief Write out everything queued and stop the writer thread.
+//!
+void StopDebugLog();
@@ -10,6 +10,8 @@
 #include "util.h"
 #include "ui_interface.h"
 #include "checkpoints.h"
+#include "appcache.h"
+#include "debuglog.h"
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/filesystem/convenience.hpp>
@@ -125,36 +127,27 @@ void InitializeBoincProjects()
         GlobalCPUMiningCPID.RSAWeight = 0;
 
         //Loop through projects saved in the Gridcoin Persisted Data System
-        std::string sType = "project";
-        for(map<string,string>::iterator ii=mvApplicationCache.begin(); ii!=mvApplicationCache.end(); ++ii)
+        for(const auto& item : ReadCacheSection("project"))
         {
-                std::string key_name  = (*ii).first;
-                if (key_name.length() > sType.length())
+                const std::string& key_name = item.first;
+                std::vector<std::string> vKey = split(key_name,";");
+                if (vKey.size() > 0)
                 {
-                    if (key_name.substr(0,sType.length())==sType)
-                    {
-                            std::string key_value = mvApplicationCache[(*ii).first];
-                            std::vector<std::string> vKey = split(key_name,";");
-                            if (vKey.size() > 0)
-                            {
-
-                                std::string project_name = vKey[1];
-                                printf("Proj %s ",project_name.c_str());
-                                std::string project_value = key_value;
-                                boost::to_lower(project_name);
-                                std::string mainProject = ToOfficialName(project_name);
-                                boost::to_lower(mainProject);
-                                StructCPID structcpid = GetStructCPID();
-                                mvBoincProjects.insert(map<string,StructCPID>::value_type(mainProject,structcpid));
-                                structcpid = mvBoincProjects[mainProject];
-                                structcpid.initialized = true;
-                                structcpid.link = "http://";
-                                structcpid.projectname = mainProject;
-                                mvBoincProjects[mainProject] = structcpid;
-                                WHITELISTED_PROJECTS++;
-
-                            }
-                     }
+
+                    std::string project_name = vKey[1];
+                    printf("Proj %s ",project_name.c_str());
+                    boost::to_lower(project_name);
+                    std::string mainProject = ToOfficialName(project_name);
+                    boost::to_lower(mainProject);
+                    StructCPID structcpid = GetStructCPID();
+                    mvBoincProjects.insert(map<string,StructCPID>::value_type(mainProject,structcpid));
+                    structcpid = mvBoincProjects[mainProject];
+                    structcpid.initialized = true;
+                    structcpid.link = "http://";
+                    structcpid.projectname = mainProject;
+                    mvBoincProjects[mainProject] = structcpid;
+                    WHITELISTED_PROJECTS++;
+
                 }
        }
 
@@ -188,6 +181,10 @@ void Shutdown(void* parg)
         //        CTxDB().Close();
         bitdb.Flush(false);
         StopNode();
+        {
+            LOCK(cs_main);
+            CTxDB().WriteDerivedStateSnapshot();
+        }
         bitdb.Flush(true);
         boost::filesystem::remove(GetPidFile());
         UnregisterWallet(pwalletMain);
@@ -195,6 +192,7 @@ void Shutdown(void* parg)
         NewThread(ExitTimeout, NULL);
         MilliSleep(50);
         printf("Gridcoin exited\n\n");
+        StopDebugLog();
         fExit = true;
 #ifndef QT_GUI
         // ensure non-UI client gets exited here, but let Bitcoin-Qt reach 'return 0;' in bitcoin.cpp
@@ -344,6 +342,7 @@ std::string HelpMessage()
         "  -datadir=<dir>         " + _("Specify data directory") + "\n" +
         "  -wallet=<dir>          " + _("Specify wallet file (within data directory)") + "\n" +
         "  -dbcache=<n>           " + _("Set database cache size in megabytes (default: 25)") + "\n" +
+        "  -txindexcache=<n>      " + _("Set transaction index cache size in megabytes (default: 32)") + "\n" +
         "  -dblogsize=<n>         " + _("Set database disk log size in megabytes (default: 100)") + "\n" +
         "  -timeout=<n>           " + _("Specify connection timeout in milliseconds (default: 5000)") + "\n" +
         "  -proxy=<ip:port>       " + _("Connect through socks proxy") + "\n" +
@@ -369,6 +368,9 @@ std::string HelpMessage()
         "  -bantime=<n>           " + _("Number of seconds to keep misbehaving peers from reconnecting (default: 86400)") + "\n" +
         "  -maxreceivebuffer=<n>  " + _("Maximum per-connection receive buffer, <n>*1000 bytes (default: 5000)") + "\n" +
         "  -maxsendbuffer=<n>     " + _("Maximum per-connection send buffer, <n>*1000 bytes (default: 1000)") + "\n" +
+        "  -blockservecache=<n>   " + _("Keep up to <n> MB of recently served blocks in memory (default: 32)") + "\n" +
+        "  -socketevents=<mode>   " + _("Wait for peer sockets with epoll or select (default: epoll where available)") + "\n" +
+        "  -msgthreads=<n>        " + _("Set the number of threads processing peer messages (up to 4, 0 = auto, default: 0)") + "\n" +
 #ifdef USE_UPNP
 #if USE_UPNP
         "  -upnp                  " + _("Use UPnP to map the listening port (default: 1 when listening)") + "\n" +
@@ -396,6 +398,7 @@ std::string HelpMessage()
         "  -rpcuser=<user>        " + _("Username for JSON-RPC connections") + "\n" +
         "  -rpcpassword=<pw>      " + _("Password for JSON-RPC connections") + "\n" +
         "  -rpcport=<port>        " + _("Listen for JSON-RPC connections on <port> (default: 15715 or testnet: 25715)") + "\n" +
+        "  -rpcthreads=<n>        " + _("Set the number of threads to service RPC calls (default: 4)") + "\n" +
         "  -rpcallowip=<ip>       " + _("Allow JSON-RPC connections from specified IP address") + "\n" +
         "  -rpcconnect=<ip>       " + _("Send commands to node running on <ip> (default: 127.0.0.1)") + "\n" +
         "  -blocknotify=<cmd>     " + _("Execute command when the best block changes (%s in cmd is replaced by block hash)") + "\n" +
@@ -410,6 +413,7 @@ std::string HelpMessage()
         "  -zapwallettxes=<mode>  " + _("Delete all wallet transactions and only recover those parts of the blockchain through -rescan on startup\n") +
         "  -checkblocks=<n>       " + _("How many blocks to check at startup (default: 2500, 0 = all)") + "\n" +
         "  -checklevel=<n>        " + _("How thorough the block verification is (0-6, default: 1)") + "\n" +
+        "  -par=<n>               " + _("Set the number of script verification threads (up to 16, 0 = auto, <0 = leave that many cores free, default: 0)") + "\n" +
         "  -loadblock=<file>      " + _("Imports blocks from external blk000?.dat file") + "\n" +
 
         "\n" + _("Block creation options:") + "\n" +
@@ -536,6 +540,15 @@ bool AppInit2()
 
     nMinerSleep = GetArg("-minersleep", 8000);
 
+    // -par=0 means autodetect, but nScriptCheckThreads==0 means no concurrency
+    nScriptCheckThreads = GetArg("-par", 0);
+    if (nScriptCheckThreads <= 0)
+        nScriptCheckThreads += boost::thread::hardware_concurrency();
+    if (nScriptCheckThreads <= 1)
+        nScriptCheckThreads = 0;
+    else if (nScriptCheckThreads > MAX_SCRIPTCHECK_THREADS)
+        nScriptCheckThreads = MAX_SCRIPTCHECK_THREADS;
+
     CheckpointsMode = Checkpoints::STRICT;
     //CheckpointsMode = Checkpoints::ADVISORY;
 
@@ -718,6 +731,7 @@ bool AppInit2()
 #endif
 
     ShrinkDebugFile();
+    StartDebugLog();
     printf("\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n");
     printf("***************************************** GRIDCOIN RESEARCH ***************************************************\r\n");
 
@@ -732,6 +746,14 @@ bool AppInit2()
     if (fDaemon)
         fprintf(stdout, "Gridcoin server starting\n");
 
+    if (nScriptCheckThreads)
+    {
+        printf("Using %d threads for script verification\n", nScriptCheckThreads);
+        for (int i=0; i<nScriptCheckThreads-1; i++)
+            if (!NewThread(ThreadScriptCheck, NULL))
+                printf("Error: NewThread(ThreadScriptCheck) failed\n");
+    }
+
     int64_t nStart;
 
     // ********************************************************* Step 5: verify database integrity
@@ -925,7 +947,7 @@ bool AppInit2()
     {
         string strMatch = mapArgs["-printblock"];
         int nFound = 0;
-        for (map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.begin(); mi != mapBlockIndex.end(); ++mi)
+        for (BlockMap::iterator mi = mapBlockIndex.begin(); mi != mapBlockIndex.end(); ++mi)
         {
             uint256 hash = (*mi).first;
             if (strncmp(hash.ToString().c_str(), strMatch.c_str(), strMatch.size()) == 0)
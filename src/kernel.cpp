@@ -606,10 +606,18 @@ CBigNum CalculateStakeHashV3(
     const CBlock &CoinBlock, const CTransaction &CoinTx,
     unsigned CoinTxN, unsigned nTimeTx,
     const MiningCPID &BoincData, double por_nonce)
+{
+    return CalculateStakeHashV3(CoinBlock.nTime, CoinTx, CoinTxN, nTimeTx, BoincData, por_nonce);
+}
+
+CBigNum CalculateStakeHashV3(
+    unsigned int CoinBlockTime, const CTransaction &CoinTx,
+    unsigned CoinTxN, unsigned nTimeTx,
+    const MiningCPID &BoincData, double por_nonce)
 {
     int64_t RSA_WEIGHT = GetRSAWeightByBlock(BoincData);
     CDataStream ss(SER_GETHASH, 0);
-    ss << RSA_WEIGHT << CoinBlock.nTime << CoinTx.nTime << CoinTx.GetHash() << CoinTxN << nTimeTx <<  por_nonce;
+    ss << RSA_WEIGHT << CoinBlockTime << CoinTx.nTime << CoinTx.GetHash() << CoinTxN << nTimeTx <<  por_nonce;
     CBigNum hashProofOfStake( Hash(ss.begin(), ss.end()) );
     return hashProofOfStake;
 }
@@ -823,16 +831,37 @@ CBigNum CalculateStakeHashV8(
     uint64_t StakeModifier,
     const MiningCPID &BoincData)
 {
-    CDataStream ss(SER_GETHASH, 0);
-    ss << StakeModifier;
-    ss << (CoinBlock.nTime & ~STAKE_TIMESTAMP_MASK);
-    ss << CoinTx.GetHash();
-    ss << CoinTxN;
-    ss << (nTimeTx & ~STAKE_TIMESTAMP_MASK);
-    CBigNum hashProofOfStake( Hash(ss.begin(), ss.end()) );
+    return CalculateStakeHashV8(CoinBlock.nTime, CoinTx, CoinTxN, nTimeTx, StakeModifier);
+}
+
+CBigNum CalculateStakeHashV8(
+    unsigned int CoinBlockTime, const CTransaction &CoinTx,
+    unsigned CoinTxN, unsigned nTimeTx,
+    uint64_t StakeModifier)
+{
+    unsigned char Kernel[STAKE_KERNEL_V8_SIZE];
+    GetStakeKernelV8(Kernel,CoinBlockTime,CoinTx,CoinTxN,nTimeTx,StakeModifier);
+    CBigNum hashProofOfStake( Hash(Kernel, Kernel + sizeof(Kernel)) );
     return hashProofOfStake;
 }
 
+// Same bytes as serializing the fields one after the other
+void GetStakeKernelV8(
+    unsigned char *Kernel,
+    unsigned int CoinBlockTime, const CTransaction &CoinTx,
+    unsigned CoinTxN, unsigned nTimeTx,
+    uint64_t StakeModifier)
+{
+    uint256 CoinTxHash = CoinTx.GetHash();
+    const unsigned int BlockTime = CoinBlockTime & ~STAKE_TIMESTAMP_MASK;
+    const unsigned int TxTime = nTimeTx & ~STAKE_TIMESTAMP_MASK;
+    memcpy(Kernel, &StakeModifier, 8);
+    memcpy(Kernel + 8, &BlockTime, 4);
+    memcpy(Kernel + 12, CoinTxHash.begin(), 32);
+    memcpy(Kernel + 44, &CoinTxN, 4);
+    memcpy(Kernel + 48, &TxTime, 4);
+}
+
 int64_t CalculateStakeWeightV8(
     const CTransaction &CoinTx, unsigned CoinTxN,
     const MiningCPID &BoincData)
@@ -34,6 +34,11 @@ CBigNum CalculateStakeHashV3(
     const CBlock &CoinBlock, const CTransaction &CoinTx,
     unsigned CoinTxN, unsigned TxTime,
     const MiningCPID &BoincData, double mdPORNonce);
+// Same, from the time of the block holding the coin
+CBigNum CalculateStakeHashV3(
+    unsigned int CoinBlockTime, const CTransaction &CoinTx,
+    unsigned CoinTxN, unsigned TxTime,
+    const MiningCPID &BoincData, double mdPORNonce);
 
 int64_t CalculateStakeWeightV3(
     const CTransaction &CoinTx, unsigned CoinTxN,
@@ -65,6 +70,21 @@ CBigNum CalculateStakeHashV8(
     unsigned CoinTxN, unsigned nTimeTx,
     uint64_t StakeModifier,
     const MiningCPID &BoincData);
+CBigNum CalculateStakeHashV8(
+    unsigned int CoinBlockTime, const CTransaction &CoinTx,
+    unsigned CoinTxN, unsigned nTimeTx,
+    uint64_t StakeModifier);
+
+// Size of the V8 kernel as hashed
+static const unsigned int STAKE_KERNEL_V8_SIZE = 52;
+
+// Serialize the V8 kernel of a coin into STAKE_KERNEL_V8_SIZE bytes, for
+// hashing many of them at once
+void GetStakeKernelV8(
+    unsigned char *Kernel,
+    unsigned int CoinBlockTime, const CTransaction &CoinTx,
+    unsigned CoinTxN, unsigned nTimeTx,
+    uint64_t StakeModifier);
 int64_t CalculateStakeWeightV8(
     const CTransaction &CoinTx, unsigned CoinTxN,
     const MiningCPID &BoincData);
@@ -12,6 +12,12 @@
 #include "ui_interface.h"
 #include "kernel.h"
 #include "block.h"
+#include "researcher.h"
+#include "boincblock.h"
+#include "superblock.h"
+#include "appcache.h"
+#include "voting.h"
+#include "xmlview.h"
 #include "scrypt.h"
 #include "global_objects_noui.hpp"
 #include "util.h"
@@ -21,6 +27,7 @@
 #include "boinc.h"
 #include "beacon.h"
 #include "miner.h"
+#include "checkqueue.h"
 
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
@@ -35,6 +42,9 @@
 #include <openssl/md5.h>
 #include <ctime>
 #include <math.h>
+#include <atomic>
+#include <climits>
+#include <deque>
 
 extern std::string NodeAddress(CNode* pfrom);
 extern std::string ConvertBinToHex(std::string a);
@@ -69,13 +79,12 @@ extern bool NeedASuperblock();
 extern double SnapToGrid(double d);
 extern bool StrLessThanReferenceHash(std::string rh);
 void BusyWaitForTally();
+void TallyWindowDisconnect(CBlockIndex* pindex);
 extern bool TallyNetworkAverages(bool Forcefully);
 extern bool IsContract(CBlockIndex* pIndex);
 std::string ExtractValue(std::string data, std::string delimiter, int pos);
 extern MiningCPID GetBoincBlockByIndex(CBlockIndex* pblockindex);
 json_spirit::Array MagnitudeReport(std::string cpid);
-extern void AddCPIDBlockHash(const std::string& cpid, const uint256& blockhash);
-extern void ZeroOutResearcherTotals(std::string cpid);
 extern StructCPID GetLifetimeCPID(const std::string& cpid, const std::string& sFrom);
 extern std::string getCpuHash();
 std::string getMacAddress();
@@ -106,7 +115,6 @@ std::string qtExecuteDotNetStringFunction(std::string function, std::string data
 
 
 bool CheckMessageSignature(std::string sMessageAction, std::string sMessageType, std::string sMsg, std::string sSig,std::string opt_pubkey);
-extern std::string ReadCache(std::string section, std::string key);
 extern std::string strReplace(std::string& str, const std::string& oldStr, const std::string& newStr);
 extern bool GetEarliestStakeTime(std::string grcaddress, std::string cpid);
 extern double GetTotalBalance();
@@ -123,10 +131,7 @@ extern double GetOutstandingAmountOwed(StructCPID &mag, std::string cpid, int64_
 extern double GetOwedAmount(std::string cpid);
 extern bool ComputeNeuralNetworkSupermajorityHashes();
 
-extern void DeleteCache(std::string section, std::string keyname);
-extern void ClearCache(std::string section);
 bool TallyMagnitudesInSuperblock();
-extern void WriteCache(std::string section, std::string key, std::string value, int64_t locktime);
 std::string qtGetNeuralContract(std::string data);
 extern std::string GetNeuralNetworkReport();
 void qtSyncWithDPORNodes(std::string data);
@@ -176,6 +181,8 @@ int64_t nLastTalliedNeural = 0;
 int64_t nLastLoadAdminMessages = 0;
 int64_t nCPIDsLoaded = 0;
 int64_t nLastGRCtallied = 0;
+int64_t nEarliestGRCTime = 0;
+int64_t nEarliestCPIDTime = 0;
 int64_t nLastCleaned = 0;
 
 
@@ -226,7 +233,7 @@ extern double CalculatedMagnitude(int64_t locktime,bool bUseLederstrumpf);
 extern int64_t GetCoinYearReward(int64_t nTime);
 
 
-map<uint256, CBlockIndex*> mapBlockIndex;
+BlockMap mapBlockIndex;
 set<pair<COutPoint, unsigned int> > setStakeSeen;
 
 CBigNum bnProofOfWorkLimit(~uint256(0) >> 20); // "standard" scrypt target limit for proof of work, results with 0,000244140625 proof-of-work difficulty
@@ -271,8 +278,6 @@ int64_t nTransactionFee = MIN_TX_FEE;
 int64_t nReserveBalance = 0;
 int64_t nMinimumInputValue = 0;
 
-std::map<std::string, std::string> mvApplicationCache;
-std::map<std::string, int64_t> mvApplicationCacheTimestamp;
 std::map<std::string, double> mvNeuralNetworkHash;
 std::map<std::string, double> mvCurrentNeuralNetworkHash;
 
@@ -282,7 +287,6 @@ std::map<std::string, StructCPID> mvDPOR;
 std::map<std::string, StructCPID> mvDPORCopy;
 
 std::map<std::string, StructCPID> mvResearchAge;
-std::map<std::string, HashSet> mvCPIDBlockHashes;
 
 enum Checkpoints::CPMode CheckpointsMode;
 BlockFinder blockFinder;
@@ -324,7 +328,6 @@ extern bool IsCPIDValidv2(MiningCPID& mc, int height);
 extern std::string getfilecontents(std::string filename);
 extern std::string ToOfficialName(std::string proj);
 extern bool LessVerbose(int iMax1000);
-extern std::string ExtractXML(std::string XMLdata, std::string key, std::string key_end);
 extern MiningCPID GetNextProject(bool bForce);
 extern void HarvestCPIDs(bool cleardata);
 
@@ -372,6 +375,7 @@ globalStatusType GlobalStatusStruct;
 bool fColdBoot = true;
 bool fEnforceCanonical = true;
 bool fUseFastIndex = false;
+int nScriptCheckThreads = 0;
 
 // Gridcoin status    *************
 MiningCPID GlobalCPUMiningCPID = GetMiningCPID();
@@ -422,13 +426,13 @@ bool UpdateNeuralNetworkQuorumData()
             #if defined(WIN32) && defined(QT_GUI)
                 if (!bGlobalcomInitialized) return false;
                 std::string errors1 = "";
-                int64_t superblock_age = GetAdjustedTime() - mvApplicationCacheTimestamp["superblock;magnitudes"];
+                int64_t superblock_age = GetAdjustedTime() - ReadCacheTimestamp("superblock","magnitudes");
                 std::string myNeuralHash = "";
                 double popularity = 0;
                 std::string consensus_hash = GetNeuralNetworkSupermajorityHash(popularity);
                 std::string sAge = ToString(superblock_age);
-                std::string sBlock = mvApplicationCache["superblock;block_number"];
-                std::string sTimestamp = TimestampToHRDate(mvApplicationCacheTimestamp["superblock;magnitudes"]);
+                std::string sBlock = ReadCache("superblock","block_number");
+                std::string sTimestamp = TimestampToHRDate(ReadCacheTimestamp("superblock","magnitudes"));
                 std::string data = "<QUORUMDATA><AGE>" + sAge + "</AGE><HASH>" + consensus_hash + "</HASH><BLOCKNUMBER>" + sBlock + "</BLOCKNUMBER><TIMESTAMP>"
                     + sTimestamp + "</TIMESTAMP><PRIMARYCPID>" + msPrimaryCPID + "</PRIMARYCPID></QUORUMDATA>";
                 std::string testnet_flag = fTestNet ? "TESTNET" : "MAINNET";
@@ -447,12 +451,12 @@ bool PushGridcoinDiagnostics()
                 LoadAdminMessages(false,errors1);
                 std::string cpiddata = GetListOf("beacon");
                 std::string sWhitelist = GetListOf("project");
-                int64_t superblock_age = GetAdjustedTime() - mvApplicationCacheTimestamp["superblock;magnitudes"];
+                int64_t superblock_age = GetAdjustedTime() - ReadCacheTimestamp("superblock","magnitudes");
                 double popularity = 0;
                 std::string consensus_hash = GetNeuralNetworkSupermajorityHash(popularity);
                 std::string sAge = ToString(superblock_age);
-                std::string sBlock = mvApplicationCache["superblock;block_number"];
-                std::string sTimestamp = TimestampToHRDate(mvApplicationCacheTimestamp["superblock;magnitudes"]);
+                std::string sBlock = ReadCache("superblock","block_number");
+                std::string sTimestamp = TimestampToHRDate(ReadCacheTimestamp("superblock","magnitudes"));
                 printf("Pushing diagnostic data...");
                 double lastblockage = PreviousBlockAge();
                 double PORDiff = GetDifficulty(GetLastBlockIndex(pindexBest, true));
@@ -491,13 +495,13 @@ bool FullSyncWithDPORNodes()
                 LoadAdminMessages(false,errors1);
                 std::string cpiddata = GetListOfWithConsensus("beacon");
 		        std::string sWhitelist = GetListOf("project");
-                int64_t superblock_age = GetAdjustedTime() - mvApplicationCacheTimestamp["superblock;magnitudes"];
+                int64_t superblock_age = GetAdjustedTime() - ReadCacheTimestamp("superblock","magnitudes");
 				printf(" list of cpids %s \r\n",cpiddata.c_str());
                 double popularity = 0;
                 std::string consensus_hash = GetNeuralNetworkSupermajorityHash(popularity);
                 std::string sAge = ToString(superblock_age);
-                std::string sBlock = mvApplicationCache["superblock;block_number"];
-                std::string sTimestamp = TimestampToHRDate(mvApplicationCacheTimestamp["superblock;magnitudes"]);
+                std::string sBlock = ReadCache("superblock","block_number");
+                std::string sTimestamp = TimestampToHRDate(ReadCacheTimestamp("superblock","magnitudes"));
                 std::string data = "<WHITELIST>" + sWhitelist + "</WHITELIST><CPIDDATA>"
                     + cpiddata + "</CPIDDATA><QUORUMDATA><AGE>" + sAge + "</AGE><HASH>" + consensus_hash + "</HASH><BLOCKNUMBER>" + sBlock + "</BLOCKNUMBER><TIMESTAMP>"
                     + sTimestamp + "</TIMESTAMP><PRIMARYCPID>" + msPrimaryCPID + "</PRIMARYCPID></QUORUMDATA>";
@@ -1339,7 +1343,7 @@ int CMerkleTx::SetMerkleBranch(const CBlock* pblock)
     vMerkleBranch = pblock->GetMerkleBranch(nIndex);
 
     // Is the tx in a block that's in the main chain
-    map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(hashBlock);
+    BlockMap::iterator mi = mapBlockIndex.find(hashBlock);
     if (mi == mapBlockIndex.end())
         return 0;
     CBlockIndex* pindex = (*mi).second;
@@ -1673,7 +1677,7 @@ int CMerkleTx::GetDepthInMainChainINTERNAL(CBlockIndex* &pindexRet) const
     AssertLockHeld(cs_main);
 
     // Find the block it claims to be in
-    map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(hashBlock);
+    BlockMap::iterator mi = mapBlockIndex.find(hashBlock);
     if (mi == mapBlockIndex.end())
         return 0;
     CBlockIndex* pindex = (*mi).second;
@@ -1749,7 +1753,7 @@ int CTxIndex::GetDepthInMainChain() const
     if (!block.ReadFromDisk(pos.nFile, pos.nBlockPos, false))
         return 0;
     // Find the block in the index
-    map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(block.GetHash());
+    BlockMap::iterator mi = mapBlockIndex.find(block.GetHash());
     if (mi == mapBlockIndex.end())
         return 0;
     CBlockIndex* pindex = (*mi).second;
@@ -1805,6 +1809,71 @@ bool CBlock::ReadFromDisk(const CBlockIndex* pindex, bool fReadTransactions)
     return true;
 }
 
+bool ReadRawBlockFromDisk(const CBlockIndex* pindex, RawBlock& vchBlockRet)
+{
+    // CBlock::WriteToDisk stores the size of the block just ahead of it
+    unsigned int nSize = 0;
+    if (pindex->nBlockPos < sizeof(nSize))
+        return error("ReadRawBlockFromDisk() : bad block position");
+
+    BlockFileReader& reader = GetBlockFileReader();
+    bool fRead = reader.Read(pindex->nFile, pindex->nBlockPos - sizeof(nSize), nSize, SER_DISK, CLIENT_VERSION);
+    if (fRead)
+    {
+        if (nSize == 0 || nSize > MAX_BLOCK_SIZE)
+            return error("ReadRawBlockFromDisk() : bad block size %u", nSize);
+
+        vchBlockRet.resize(nSize);
+        CFlatData data(&vchBlockRet[0], &vchBlockRet[0] + nSize);
+        fRead = reader.Read(pindex->nFile, pindex->nBlockPos, data, SER_DISK, CLIENT_VERSION);
+    }
+
+    if (!fRead)
+    {
+        CAutoFile filein = CAutoFile(OpenBlockFile(pindex->nFile, pindex->nBlockPos - sizeof(nSize), "rb"), SER_DISK, CLIENT_VERSION);
+        if (!filein)
+            return error("ReadRawBlockFromDisk() : OpenBlockFile failed");
+
+        try {
+            filein >> nSize;
+            if (nSize == 0 || nSize > MAX_BLOCK_SIZE)
+                return error("ReadRawBlockFromDisk() : bad block size %u", nSize);
+
+            vchBlockRet.resize(nSize);
+            filein.read(&vchBlockRet[0], nSize);
+        }
+        catch (std::exception &e) {
+            return error("%s() : I/O error", __PRETTY_FUNCTION__);
+        }
+    }
+
+    // Check that the bytes start with the header of the indexed block
+    CDataStream ssHeader(SER_DISK | SER_BLOCKHEADERONLY, CLIENT_VERSION);
+    ssHeader << pindex->GetBlockHeader();
+    if (vchBlockRet.size() < ssHeader.size() || !std::equal(ssHeader.begin(), ssHeader.end(), vchBlockRet.begin()))
+        return error("ReadRawBlockFromDisk() : block header doesn't match index");
+
+    return true;
+}
+
+// Blocks recently sent to peers, as they are on disk
+static RawBlockPtr GetBlockToServe(const CBlockIndex* pindex)
+{
+    static RawBlockCache cache(max<int64_t>(0, GetArg("-blockservecache", 32)) * 1000000);
+
+    const uint256 hash = pindex->GetBlockHash();
+    RawBlockPtr block = cache.Get(hash);
+    if (block)
+        return block;
+
+    std::shared_ptr<RawBlock> blockRead = std::make_shared<RawBlock>();
+    if (!ReadRawBlockFromDisk(pindex, *blockRead))
+        return nullptr;
+
+    cache.Put(hash, blockRead);
+    return blockRead;
+}
+
 uint256 static GetOrphanRoot(const CBlock* pblock)
 {
     // Work back to the first block in the orphan chain
@@ -2549,8 +2618,31 @@ unsigned int CTransaction::GetP2SHSigOpCount(const MapPrevTx& inputs) const
     return nSigOps;
 }
 
+bool CScriptCheck::operator()() const
+{
+    const CScript &scriptSig = ptxTo->vin[nIn].scriptSig;
+    if (!VerifyScript(scriptSig, scriptPubKey, *ptxTo, nIn, nHashType))
+        return error("CScriptCheck() : %s VerifySignature failed", ptxTo->GetHash().ToString().substr(0,10).c_str());
+    return true;
+}
+
+static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
+
+void ThreadScriptCheck(void* parg)
+{
+    RenameThread("grc-scriptch");
+    vnThreadsRunning[THREAD_SCRIPTCHECK]++;
+    scriptcheckqueue.Thread();
+    vnThreadsRunning[THREAD_SCRIPTCHECK]--;
+}
+
+void InterruptScriptCheck()
+{
+    scriptcheckqueue.Interrupt();
+}
+
 bool CTransaction::ConnectInputs(CTxDB& txdb, MapPrevTx inputs, map<uint256, CTxIndex>& mapTestPool, const CDiskTxPos& posThisTx,
-    const CBlockIndex* pindexBlock, bool fBlock, bool fMiner)
+    const CBlockIndex* pindexBlock, bool fBlock, bool fMiner, std::vector<CScriptCheck> *pvChecks)
 {
     // Take over previous transactions' spent pointers
     // fBlock is true when this is called from AcceptBlock when a new best-block is added to the blockchain
@@ -2634,8 +2726,14 @@ bool CTransaction::ConnectInputs(CTxDB& txdb, MapPrevTx inputs, map<uint256, CTx
 
             if (!(fBlock && (nBestHeight < Checkpoints::GetTotalBlocksEstimate())))
             {
-                // Verify signature
-                if (!VerifySignature(txPrev, *this, i, 0))
+                // Verify signature, or hand it to the script check threads
+                CScriptCheck check(txPrev, *this, i, 0);
+                if (pvChecks)
+                {
+                    pvChecks->push_back(CScriptCheck());
+                    check.swap(pvChecks->back());
+                }
+                else if (!check())
                 {
                     return DoS(100,error("ConnectInputs() : %s VerifySignature failed", GetHash().ToString().substr(0,10).c_str()));
                 }
@@ -2705,6 +2803,7 @@ bool CBlock::DisconnectBlock(CTxDB& txdb, CBlockIndex* pindex)
         SyncWithWallets(tx, this, false, false);
 
     StructCPID stCPID = GetLifetimeCPID(pindex->GetCPID(),"DisconnectBlock()");
+    TallyWindowDisconnect(pindex);
     // We normally fail to disconnect a block if we can't find the previous input due to "DisconnectInputs() : ReadTxIndex failed".  Imo, I believe we should let this call succeed, otherwise a chain can never be re-organized in this circumstance.
     if (bDiscTxFailed && fDebug3) printf("!DisconnectBlock()::Failed, recovering. ");
     return true;
@@ -2742,9 +2841,10 @@ std::string PubKeyToAddress(const CScript& scriptPubKey)
 
 bool LoadSuperblock(std::string data, int64_t nTime, double height)
 {
-        WriteCache("superblock","magnitudes",ExtractXML(data,"<MAGNITUDES>","</MAGNITUDES>"),nTime);
-        WriteCache("superblock","averages",ExtractXML(data,"<AVERAGES>","</AVERAGES>"),nTime);
-        WriteCache("superblock","quotes",ExtractXML(data,"<QUOTES>","</QUOTES>"),nTime);
+        const XMLView sections(data, {"MAGNITUDES", "AVERAGES", "QUOTES"});
+        WriteCache("superblock","magnitudes",sections.GetString(0),nTime);
+        WriteCache("superblock","averages",sections.GetString(1),nTime);
+        WriteCache("superblock","quotes",sections.GetString(2),nTime);
         WriteCache("superblock","all",data,nTime);
         WriteCache("superblock","block_number",ToString(height),nTime);
         return true;
@@ -2802,14 +2902,6 @@ std::string ConvertHexToBin(std::string a)
 }
 
 
-double ConvertHexToDouble(std::string hex)
-{
-    int d = HexToInt(hex);
-    double dOut = (double)d;
-    return dOut;
-}
-
-
 std::string ConvertBinToHex(std::string a) 
 {
       if (a.empty()) return "0";
@@ -2827,79 +2919,13 @@ std::string ConvertBinToHex(std::string a)
 std::string UnpackBinarySuperblock(std::string sBlock)
 {
     // 12-21-2015: R HALFORD: If the block is not binary, return the legacy format for backward compatibility
-    std::string sBinary = ExtractXML(sBlock,"<BINARY>","</BINARY>");
-    if (sBinary.empty()) return sBlock;
-    std::string sZero = ExtractXML(sBlock,"<ZERO>","</ZERO>");
-    double dZero = cdbl(sZero,0);
-    // Binary data support structure:
-    // Each CPID consumes 16 bytes and 2 bytes for magnitude: (Except CPIDs with zero magnitude - the count of those is stored in XML node <ZERO> to save space)
-    // 1234567890123456MM
-    // MM = Magnitude stored as 2 bytes
-    // No delimiter between CPIDs, Step Rate = 18
-    std::string sReconstructedMagnitudes = "";
-    for (unsigned int x = 0; x < sBinary.length(); x += 18)
-    {
-        if (sBinary.length() >= x+18)
-        {
-            std::string bCPID = sBinary.substr(x,16);
-            std::string bMagnitude = sBinary.substr(x+16,2);
-            std::string sCPID = ConvertBinToHex(bCPID);
-            std::string sHexMagnitude = ConvertBinToHex(bMagnitude);
-            double dMagnitude = ConvertHexToDouble("0x" + sHexMagnitude);
-            std::string sRow = sCPID + "," + RoundToString(dMagnitude,0) + ";";
-            sReconstructedMagnitudes += sRow;
-            // if (fDebug3) printf("\r\n HEX CPID %s, HEX MAG %s, dMag %f, Row %s   ",sCPID.c_str(),sHexMagnitude.c_str(),dMagnitude,sRow.c_str());
-        }
-    }
-    // Append zero magnitude researchers so the beacon count matches
-    for (double d0 = 1; d0 <= dZero; d0++)
-    {
-            std::string sZeroCPID = "0";
-            std::string sRow1 = sZeroCPID + ",15;";
-            sReconstructedMagnitudes += sRow1;
-    }
-    std::string sAverages   = ExtractXML(sBlock,"<AVERAGES>","</AVERAGES>");
-    std::string sQuotes     = ExtractXML(sBlock,"<QUOTES>","</QUOTES>");
-    std::string sReconstructedBlock = "<AVERAGES>" + sAverages + "</AVERAGES><QUOTES>" + sQuotes + "</QUOTES><MAGNITUDES>" + sReconstructedMagnitudes + "</MAGNITUDES>";
-    return sReconstructedBlock;
+    if (ExtractXMLView(sBlock,"<BINARY>","</BINARY>").empty()) return sBlock;
+    return Superblock::Parse(sBlock).Unpack();
 }
 
 std::string PackBinarySuperblock(std::string sBlock)
 {
-    std::string sMagnitudes = ExtractXML(sBlock,"<MAGNITUDES>","</MAGNITUDES>");
-    std::string sAverages   = ExtractXML(sBlock,"<AVERAGES>","</AVERAGES>");
-    std::string sQuotes     = ExtractXML(sBlock,"<QUOTES>","</QUOTES>");
-    // For each CPID in the superblock, convert data to binary
-    std::vector<std::string> vSuperblock = split(sMagnitudes.c_str(),";");
-    std::string sBinary = "";
-    double dZeroMagCPIDCount = 0;
-    for (unsigned int i = 0; i < vSuperblock.size(); i++)
-    {
-            if (vSuperblock[i].length() > 1)
-            {
-                std::string sPrefix = "00000000000000000000000000000000000" + ExtractValue(vSuperblock[i],",",0);
-                std::string sCPID = sPrefix.substr(sPrefix.length()-32,32);
-                double magnitude = cdbl(ExtractValue("0"+vSuperblock[i],",",1),0);
-                if (magnitude < 0)     magnitude=0;
-                if (magnitude > 32767) magnitude = 32767;  // Ensure we do not blow out the binary space (technically we can handle 0-65535)
-                std::string sBinaryCPID   = ConvertHexToBin(sCPID);
-                std::string sHexMagnitude = DoubleToHexStr(magnitude,4);
-                std::string sBinaryMagnitude = ConvertHexToBin(sHexMagnitude);
-                std::string sBinaryEntry  = sBinaryCPID+sBinaryMagnitude;
-                // if (fDebug3) printf("\r\n PackBinarySuperblock: DecMag %f HEX MAG %s bin_cpid_len %f bm_len %f be_len %f,",  magnitude,sHexMagnitude.c_str(),(double)sBinaryCPID.length(),(double)sBinaryMagnitude.length(),(double)sBinaryEntry.length());
-                if (sCPID=="00000000000000000000000000000000")
-                {
-                    dZeroMagCPIDCount += 1;
-                }
-                else
-                {
-                    sBinary += sBinaryEntry;
-                }
-
-            }
-    }
-    std::string sReconstructedBinarySuperblock = "<ZERO>" + RoundToString(dZeroMagCPIDCount,0) + "</ZERO><BINARY>" + sBinary + "</BINARY><AVERAGES>" + sAverages + "</AVERAGES><QUOTES>" + sQuotes + "</QUOTES>";
-    return sReconstructedBinarySuperblock;
+    return Superblock::Parse(sBlock).PackBinary();
 }
 
 
@@ -2982,6 +3008,9 @@ bool CBlock::ConnectBlock(CTxDB& txdb, CBlockIndex* pindex, bool fJustCheck, boo
 
     bool bIsDPOR = false;
 
+    // Script checks are queued to the script check threads while the
+    // remaining inputs are fetched; the results are collected below.
+    CCheckQueueControl<CScriptCheck> control(nScriptCheckThreads ? &scriptcheckqueue : NULL);
 
     BOOST_FOREACH(CTransaction& tx, vtx)
     {
@@ -3073,8 +3102,10 @@ bool CBlock::ConnectBlock(CTxDB& txdb, CBlockIndex* pindex, bool fJustCheck, boo
                 }
             }
 
-            if (!tx.ConnectInputs(txdb, mapInputs, mapQueuedChanges, posThisTx, pindex, true, false))
+            std::vector<CScriptCheck> vChecks;
+            if (!tx.ConnectInputs(txdb, mapInputs, mapQueuedChanges, posThisTx, pindex, true, false, nScriptCheckThreads ? &vChecks : NULL))
                 return false;
+            control.Add(vChecks);
         }
 
         mapQueuedChanges[hashTx] = CTxIndex(posThisTx, tx.vout.size());
@@ -3137,8 +3168,9 @@ bool CBlock::ConnectBlock(CTxDB& txdb, CBlockIndex* pindex, bool fJustCheck, boo
 
     }
 
-
-    AddCPIDBlockHash(bb.cpid, pindex->GetBlockHash());
+    // All signatures must be verified before any state below is touched
+    if (!control.Wait())
+        return DoS(100, error("ConnectBlock[] : script verification failed"));
 
     // Track money supply and mint amount info
     pindex->nMint = nValueOut - nValueIn + nFees;
@@ -3745,8 +3777,9 @@ bool CBlock::SetBestChain(CTxDB& txdb, CBlockIndex* pindexNew)
 
     // New best block
     hashBestChain = hash;
+    researcherTotals.SetTip(activeChain.Tip(), pindexNew);
     pindexBest = pindexNew;
-    blockFinder.Reset();
+    activeChain.SetTip(pindexBest);
     nBestHeight = pindexBest->nHeight;
     nBestChainTrust = pindexNew->nChainTrust;
     nTimeBestReceived =  GetAdjustedTime();
@@ -3871,11 +3904,11 @@ bool CBlock::AddToBlockIndex(unsigned int nFile, unsigned int nBlockPos, const u
         return error("AddToBlockIndex() : %s already exists", hash.ToString().substr(0,20).c_str());
 
     // Construct new block index object
-    CBlockIndex* pindexNew = new CBlockIndex(nFile, nBlockPos, *this);
+    CBlockIndex* pindexNew = blockIndexArena.Create(nFile, nBlockPos, *this);
     if (!pindexNew)
         return error("AddToBlockIndex() : new CBlockIndex failed");
     pindexNew->phashBlock = &hash;
-    map<uint256, CBlockIndex*>::iterator miPrev = mapBlockIndex.find(hashPrevBlock);
+    BlockMap::iterator miPrev = mapBlockIndex.find(hashPrevBlock);
     if (miPrev != mapBlockIndex.end())
     {
         pindexNew->pprev = (*miPrev).second;
@@ -3903,7 +3936,7 @@ bool CBlock::AddToBlockIndex(unsigned int nFile, unsigned int nBlockPos, const u
     pindexNew->nStakeModifierChecksum = GetStakeModifierChecksum(pindexNew);
 
     // Add to mapBlockIndex
-    map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.insert(make_pair(hash, pindexNew)).first;
+    BlockMap::iterator mi = mapBlockIndex.insert(make_pair(hash, pindexNew)).first;
     if (pindexNew->IsProofOfStake())
         setStakeSeen.insert(make_pair(pindexNew->prevoutStake, pindexNew->nStakeTime));
     pindexNew->phashBlock = &((*mi).first);
@@ -4146,7 +4179,7 @@ bool CBlock::AcceptBlock(bool generated_by_me)
         return error("AcceptBlock() : block already in mapBlockIndex");
 
     // Get prev block index
-    map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(hashPrevBlock);
+    BlockMap::iterator mi = mapBlockIndex.find(hashPrevBlock);
     if (mi == mapBlockIndex.end())
         return DoS(10, error("AcceptBlock() : prev block not found"));
     CBlockIndex* pindexPrev = (*mi).second;
@@ -4280,6 +4313,7 @@ bool CBlock::AcceptBlock(bool generated_by_me)
         BOOST_FOREACH(CNode* pnode, vNodes)
             if (nBestHeight > (pnode->nStartingHeight != -1 ? pnode->nStartingHeight - 2000 : nBlockEstimate))
                 pnode->PushInventory(CInv(MSG_BLOCK, hash));
+        WakeMessageHandler();
     }
 
     // ppcoin: check pending sync-checkpoint
@@ -4389,7 +4423,7 @@ bool NeedASuperblock()
          GetSuperblockProjectCount(superblock, out_project_count, out_whitelist_count);
          */
     }
-    int64_t superblock_age = GetAdjustedTime() - mvApplicationCacheTimestamp["superblock;magnitudes"];
+    int64_t superblock_age = GetAdjustedTime() - ReadCacheTimestamp("superblock","magnitudes");
     if (superblock_age > GetSuperblockAgeSpacing(nBestHeight))
         bDireNeedOfSuperblock = true;
 
@@ -4494,7 +4528,7 @@ void GridcoinServices()
         }
     }
 
-    int64_t superblock_age = GetAdjustedTime() - mvApplicationCacheTimestamp["superblock;magnitudes"];
+    int64_t superblock_age = GetAdjustedTime() - ReadCacheTimestamp("superblock","magnitudes");
     bool bNeedSuperblock = ((double)superblock_age > (double)(GetSuperblockAgeSpacing(nBestHeight)));
     if ( nBestHeight % 3 == 0 && NeedASuperblock() ) bNeedSuperblock=true;
 
@@ -5135,23 +5169,6 @@ bool LoadBlockIndex(bool fAllowNew)
     return true;
 }
 
-std::string ExtractXML(std::string XMLdata, std::string key, std::string key_end)
-{
-
-    std::string extraction = "";
-    string::size_type loc = XMLdata.find( key, 0 );
-    if( loc != string::npos )
-    {
-        string::size_type loc_end = XMLdata.find( key_end, loc+3);
-        if (loc_end != string::npos )
-        {
-            extraction = XMLdata.substr(loc+(key.length()),loc_end-loc-(key.length()));
-
-        }
-    }
-    return extraction;
-}
-
 std::string ExtractHTML(std::string HTMLdata, std::string tagstartprefix,  std::string tagstart_suffix, std::string tag_end)
 {
 
@@ -5490,14 +5507,14 @@ void AdjustTimestamps(StructCPID& strCPID, double timestamp, double subsidy)
         if (timestamp < strCPID.EarliestPaymentTime) strCPID.EarliestPaymentTime = timestamp;
 }
 
-void AddResearchMagnitude(CBlockIndex* pIndex)
+void AddResearchMagnitude(CBlockIndex* pIndex, std::map<std::string, StructCPID>& mvTarget)
 {
     // Headless critical section
     if (pIndex->nResearchSubsidy > 0)
     {
         try
         {
-            StructCPID stMag = GetInitializedStructCPID2(pIndex->GetCPID(),mvMagnitudesCopy);
+            StructCPID stMag = GetInitializedStructCPID2(pIndex->GetCPID(),mvTarget);
             stMag.cpid = pIndex->GetCPID();
             stMag.GRCAddress = pIndex->sGRCAddress;
             if (pIndex->nHeight > stMag.LastBlock)
@@ -5521,7 +5538,7 @@ void AddResearchMagnitude(CBlockIndex* pIndex)
                                                   pIndex->GetCPID(), pIndex->nTime, total_owed, pIndex->nMagnitude);
 
             stMag.totalowed = total_owed;
-            mvMagnitudesCopy[pIndex->GetCPID()] = stMag;
+            mvTarget[pIndex->GetCPID()] = stMag;
         }
         catch (const std::bad_alloc& ba)
         {
@@ -5539,13 +5556,13 @@ bool GetEarliestStakeTime(std::string grcaddress, std::string cpid)
 {
     if (nBestHeight < 15)
     {
-        mvApplicationCacheTimestamp["nGRCTime"] = GetAdjustedTime();
-        mvApplicationCacheTimestamp["nCPIDTime"] = GetAdjustedTime();
+        nEarliestGRCTime = GetAdjustedTime();
+        nEarliestCPIDTime = GetAdjustedTime();
         return true;
     }
 
-    if (IsLockTimeWithinMinutes(nLastGRCtallied,100) && (mvApplicationCacheTimestamp["nGRCTime"] > 0 ||
-		 mvApplicationCacheTimestamp["nCPIDTime"] > 0))  return true;
+    if (IsLockTimeWithinMinutes(nLastGRCtallied,100) && (nEarliestGRCTime > 0 ||
+		 nEarliestCPIDTime > 0))  return true;
 
     nLastGRCtallied = GetAdjustedTime();
     int64_t nGRCTime = 0;
@@ -5596,25 +5613,11 @@ bool GetEarliestStakeTime(std::string grcaddress, std::string cpid)
 
     printf("Loaded staketime from index in %f", (double)(GetTimeMillis() - nStart));
     printf("CPIDTime %f, GRCTime %f, WalletTime %f \r\n",(double)nCPIDTime,(double)nGRCTime,(double)EarliestStakedWalletTx);
-    mvApplicationCacheTimestamp["nGRCTime"] = nGRCTime;
-    mvApplicationCacheTimestamp["nCPIDTime"] = nCPIDTime;
+    nEarliestGRCTime = nGRCTime;
+    nEarliestCPIDTime = nCPIDTime;
     return true;
 }
 
-HashSet GetCPIDBlockHashes(const std::string& cpid)
-{
-    auto hashes = mvCPIDBlockHashes.find(cpid);
-    return hashes != mvCPIDBlockHashes.end()
-        ? hashes->second
-        : HashSet();
-}
-
-void AddCPIDBlockHash(const std::string& cpid, const uint256& blockhash)
-{
-    // Add block hash to CPID hash set.
-    mvCPIDBlockHashes[cpid].insert(blockhash);
-}
-
 StructCPID GetLifetimeCPID(const std::string& cpid, const std::string& sCalledFrom)
 {
     //Eliminates issues with reorgs, disconnects, double counting, etc.. 
@@ -5623,44 +5626,9 @@ StructCPID GetLifetimeCPID(const std::string& cpid, const std::string& sCalledFr
     
     if (fDebug10) printf(" {GLC %s} ",sCalledFrom.c_str());
 
-    const HashSet& hashes = GetCPIDBlockHashes(cpid);
-    ZeroOutResearcherTotals(cpid);
-
-
+    // Lifetime totals follow the main chain as blocks are connected and disconnected
     StructCPID stCPID = GetInitializedStructCPID2(cpid, mvResearchAge);
-    for (HashSet::iterator it = hashes.begin(); it != hashes.end(); ++it)
-    {
-        const uint256& uHash = *it;
-
-        // Ensure that we have this block.
-        if (mapBlockIndex.count(uHash) == 0)
-           continue;
-        
-        // Ensure that the block is valid
-        CBlockIndex* pblockindex = mapBlockIndex[uHash];
-        if(pblockindex == NULL ||
-           pblockindex->IsInMainChain() == false ||
-           pblockindex->GetCPID() != cpid)
-            continue;
-
-        // Block located and verified.
-        if (pblockindex->nHeight > stCPID.LastBlock && pblockindex->nResearchSubsidy > 0)
-        {
-            stCPID.LastBlock = pblockindex->nHeight;
-            stCPID.BlockHash = pblockindex->GetBlockHash().GetHex();
-        }
-        stCPID.InterestSubsidy += pblockindex->nInterestSubsidy;
-        stCPID.ResearchSubsidy += pblockindex->nResearchSubsidy;
-        stCPID.Accuracy++;
-        if (pblockindex->nMagnitude > 0)
-        {
-            stCPID.TotalMagnitude += pblockindex->nMagnitude;
-            stCPID.ResearchAverageMagnitude = stCPID.TotalMagnitude/(stCPID.Accuracy+.01);
-        }
-
-        if (pblockindex->nTime < stCPID.LowLockTime)  stCPID.LowLockTime  = pblockindex->nTime;
-        if (pblockindex->nTime > stCPID.HighLockTime) stCPID.HighLockTime = pblockindex->nTime;
-    }
+    researcherTotals.Get(cpid, stCPID);
 
     // Save updated CPID data holder.
     mvResearchAge[cpid] = stCPID;
@@ -5748,21 +5716,23 @@ bool ComputeNeuralNetworkSupermajorityHashes()
             if (block.vtx.size() > 0) hashboinc = block.vtx[0].hashBoinc;
             if (!hashboinc.empty())
             {
-                MiningCPID bb = DeserializeBoincBlock(hashboinc,block.nVersion);
+                // Only a few fields are needed, so look at them in place instead of deserializing the block
+                const BoincBlockView bb(hashboinc);
                 //If block is pending: 7-25-2015
-                if (bb.superblock.length() > 20)
+                if (BoincBlockView::SUPERBLOCK < bb.GetValidFieldCount() && bb[BoincBlockView::SUPERBLOCK].length() > 20)
                 {
-                    std::string superblock = UnpackBinarySuperblock(bb.superblock);
+                    std::string superblock = UnpackBinarySuperblock(bb.GetString(BoincBlockView::SUPERBLOCK));
                     if (VerifySuperblock(superblock, pblockindex))
                     {
                         WriteCache("neuralsecurity","pending",ToString(pblockindex->nHeight),GetAdjustedTime());
                     }
                 }
 
-                IncrementVersionCount(bb.clientversion);
+                const std::string grcaddress = bb.GetValidString(BoincBlockView::GRC_ADDRESS);
+                IncrementVersionCount(bb.GetValidString(BoincBlockView::CLIENT_VERSION));
                 //Increment Neural Network Hashes Supermajority (over the last N blocks)
-                IncrementNeuralNetworkSupermajority(bb.NeuralHash,bb.GRCAddress,(nMaxDepth-pblockindex->nHeight)+10,pblockindex);
-                IncrementCurrentNeuralNetworkSupermajority(bb.CurrentNeuralHash,bb.GRCAddress,(nMaxDepth-pblockindex->nHeight)+10);
+                IncrementNeuralNetworkSupermajority(bb.GetValidString(BoincBlockView::NEURAL_HASH),grcaddress,(nMaxDepth-pblockindex->nHeight)+10,pblockindex);
+                IncrementCurrentNeuralNetworkSupermajority(bb.GetValidString(BoincBlockView::CURRENT_NEURAL_HASH),grcaddress,(nMaxDepth-pblockindex->nHeight)+10);
 
             }
         }
@@ -5782,6 +5752,130 @@ bool ComputeNeuralNetworkSupermajorityHashes()
 }
 
 
+// Blocks counted by TallyResearchAverages are kept as a sliding window over
+// the main chain, so that a tally only accounts for the blocks that entered or
+// left the window since the previous one instead of rescanning 14 days.
+CCriticalSection cs_tally;
+static std::deque<CBlockIndex*> vTallyWindow;                               // Main chain blocks in the window by ascending height
+static std::map<std::string, std::deque<CBlockIndex*> > mvTallyWindowCPID;  // Research paying blocks in the window per CPID
+static std::map<std::string, StructCPID> mvTallyWindowMagnitudes;           // AddResearchMagnitude() totals per CPID
+static std::set<std::string> setTallyWindowDirty;                           // CPIDs whose totals have to be replayed
+static double dTallyWindowPayments = 0;
+static double dTallyWindowInterest = 0;
+static CBlockIndex* pindexTallySuperblock = NULL;                           // Most recent valid superblock in the window
+static bool fTallySuperblockStale = false;
+static std::string sTallySuperblockLoaded;
+// Lowest height disconnected since the last tally, set without taking cs_tally
+static std::atomic<int> nTallyWindowDisconnected(INT_MAX);
+
+void TallyWindowDisconnect(CBlockIndex* pindex)
+{
+    int nHeight = nTallyWindowDisconnected;
+    while (pindex->nHeight < nHeight && !nTallyWindowDisconnected.compare_exchange_weak(nHeight, pindex->nHeight))
+        ;
+}
+
+static void TallyWindowClear()
+{
+    vTallyWindow.clear();
+    mvTallyWindowCPID.clear();
+    mvTallyWindowMagnitudes.clear();
+    setTallyWindowDirty.clear();
+    dTallyWindowPayments = 0;
+    dTallyWindowInterest = 0;
+    pindexTallySuperblock = NULL;
+    fTallySuperblockStale = false;
+}
+
+static void TallyWindowPush(CBlockIndex* pindex)
+{
+    vTallyWindow.push_back(pindex);
+    dTallyWindowPayments += pindex->nResearchSubsidy;
+    dTallyWindowInterest += pindex->nInterestSubsidy;
+    if (pindex->nResearchSubsidy > 0)
+    {
+        std::string cpid = pindex->GetCPID();
+        mvTallyWindowCPID[cpid].push_back(pindex);
+        setTallyWindowDirty.insert(cpid);
+    }
+    if (IsSuperBlock(pindex)) fTallySuperblockStale = true;
+}
+
+static void TallyWindowPop(bool fOldest)
+{
+    CBlockIndex* pindex = fOldest ? vTallyWindow.front() : vTallyWindow.back();
+    if (fOldest) vTallyWindow.pop_front(); else vTallyWindow.pop_back();
+    dTallyWindowPayments -= pindex->nResearchSubsidy;
+    dTallyWindowInterest -= pindex->nInterestSubsidy;
+    if (pindex->nResearchSubsidy > 0)
+    {
+        std::string cpid = pindex->GetCPID();
+        std::deque<CBlockIndex*>& blocks = mvTallyWindowCPID[cpid];
+        if (fOldest) blocks.pop_front(); else blocks.pop_back();
+        if (blocks.empty()) mvTallyWindowCPID.erase(cpid);
+        setTallyWindowDirty.insert(cpid);
+    }
+    // A superblock ageing out leaves nothing newer to load, one rolled back
+    // by a reorganize may leave an older one behind it in the window
+    if (pindex == pindexTallySuperblock)
+    {
+        pindexTallySuperblock = NULL;
+        if (!fOldest) fTallySuperblockStale = true;
+    }
+}
+
+static bool GetTallySuperblock(CBlockIndex* pindex, std::string& superblock)
+{
+    MiningCPID bb = GetBoincBlockByIndex(pindex);
+    if (bb.superblock.length() <= 20) return false;
+    superblock = UnpackBinarySuperblock(bb.superblock);
+    return VerifySuperblock(superblock, pindex);
+}
+
+// Move the window to cover heights nMinDepth to nMaxDepth-1 of the main chain
+static bool UpdateTallyWindow(int nMinDepth, int nMaxDepth)
+{
+    int nDisconnected = nTallyWindowDisconnected.exchange(INT_MAX);
+    while (!vTallyWindow.empty() && (vTallyWindow.back()->nHeight >= std::min(nMaxDepth, nDisconnected)
+           || activeChain[vTallyWindow.back()->nHeight] != vTallyWindow.back()))
+        TallyWindowPop(false);
+    while (!vTallyWindow.empty() && vTallyWindow.front()->nHeight < nMinDepth)
+        TallyWindowPop(true);
+
+    // The window can only grow at the bottom if the chain got shorter
+    if (!vTallyWindow.empty() && vTallyWindow.front()->nHeight > nMinDepth)
+        TallyWindowClear();
+
+    int nHeight = vTallyWindow.empty() ? nMinDepth : vTallyWindow.back()->nHeight + 1;
+    for (; nHeight < nMaxDepth; nHeight++)
+    {
+        CBlockIndex* pindex = activeChain[nHeight];
+        if (!pindex || (!vTallyWindow.empty() && pindex->pprev != vTallyWindow.back()))
+        {
+            // The best chain moved while we were reading it
+            TallyWindowClear();
+            return false;
+        }
+        TallyWindowPush(pindex);
+    }
+
+    if (fTallySuperblockStale)
+    {
+        fTallySuperblockStale = false;
+        pindexTallySuperblock = NULL;
+        std::string superblock;
+        for (std::deque<CBlockIndex*>::reverse_iterator it = vTallyWindow.rbegin(); it != vTallyWindow.rend(); ++it)
+        {
+            if (IsSuperBlock(*it) && GetTallySuperblock(*it, superblock))
+            {
+                pindexTallySuperblock = *it;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
 bool TallyResearchAverages(bool Forcefully)
 {
     //Iterate throught last 14 days, tally network averages
@@ -5791,6 +5885,7 @@ bool TallyResearchAverages(bool Forcefully)
         return true;
     }
 
+    LOCK(cs_tally);
     //if (Forcefully) nLastTallied = 0;
     int timespan = fTestNet ? 2 : 6;
     if (IsLockTimeWithinMinutes(nLastTallied,timespan))
@@ -5806,85 +5901,83 @@ bool TallyResearchAverages(bool Forcefully)
     if (fDebug) printf("Tallying Research Averages (begin) ");
     nLastTallied = GetAdjustedTime();
     bNetAveragesLoaded = false;
-    bool superblockloaded = false;
-    double NetworkPayments = 0;
-    double NetworkInterest = 0;
     
-                        //Consensus Start/End block:
-                        int nMaxDepth = (nBestHeight-CONSENSUS_LOOKBACK) - ( (nBestHeight-CONSENSUS_LOOKBACK) % BLOCK_GRANULARITY);
-                        int nLookback = BLOCKS_PER_DAY * 14; //Daily block count * Lookback in days
-                        int nMinDepth = (nMaxDepth - nLookback) - ( (nMaxDepth-nLookback) % BLOCK_GRANULARITY);
-                        if (fDebug3) printf("START BLOCK %f, END BLOCK %f ",(double)nMaxDepth,(double)nMinDepth);
-                        if (nMinDepth < 2)              nMinDepth = 2;
-                        mvMagnitudesCopy.clear();
-                        int iRow = 0;
-                        //CBlock block;
-                        CBlockIndex* pblockindex = pindexBest;
-                        if (!pblockindex)
+                        CBlockIndex* pindexTip = activeChain.Tip();
+                        if (!pindexTip)
                         {
                                 bTallyStarted = false;
                                 bNetAveragesLoaded = true;
                                 return true;
                         }
-                        while (pblockindex->nHeight > nMaxDepth)
-                        {
-                            if (!pblockindex || !pblockindex->pprev || pblockindex == pindexGenesisBlock) return false;
-                            pblockindex = pblockindex->pprev;
-                        }
-
-                        if (fDebug3) printf("Max block %f, seektime %f",(double)pblockindex->nHeight,(double)GetTimeMillis()-nStart);
-                        nStart=GetTimeMillis();
+                        //Consensus Start/End block:
+                        int nMaxDepth = (pindexTip->nHeight-CONSENSUS_LOOKBACK) - ( (pindexTip->nHeight-CONSENSUS_LOOKBACK) % BLOCK_GRANULARITY);
+                        int nLookback = BLOCKS_PER_DAY * 14; //Daily block count * Lookback in days
+                        int nMinDepth = (nMaxDepth - nLookback) - ( (nMaxDepth-nLookback) % BLOCK_GRANULARITY);
+                        if (fDebug3) printf("START BLOCK %f, END BLOCK %f ",(double)nMaxDepth,(double)nMinDepth);
+                        if (nMinDepth < 2)              nMinDepth = 2;
 
    
                         // Headless critical section ()
         try
         {
-                        while (pblockindex->nHeight > nMinDepth)
+                        if (!UpdateTallyWindow(nMinDepth, nMaxDepth))
                         {
-                            if (!pblockindex || !pblockindex->pprev) return false;
-                            pblockindex = pblockindex->pprev;
-                            if (pblockindex == pindexGenesisBlock) return false;
-                            if (!pblockindex->IsInMainChain()) continue;
-                            NetworkPayments += pblockindex->nResearchSubsidy;
-                            NetworkInterest += pblockindex->nInterestSubsidy;
-                            AddResearchMagnitude(pblockindex);
+                            nLastTallied = 0;
+                            bNetAveragesLoaded = true;
+                            return false;
+                        }
 
-                            iRow++;
-                            if (IsSuperBlock(pblockindex) && !superblockloaded)
+                        // Replay the blocks of every CPID that gained or lost a block, oldest last as in a full scan
+                        int iReplayed = setTallyWindowDirty.size();
+                        BOOST_FOREACH(const std::string& cpid, setTallyWindowDirty)
+                        {
+                            mvTallyWindowMagnitudes.erase(cpid);
+                            std::map<std::string, std::deque<CBlockIndex*> >::iterator it = mvTallyWindowCPID.find(cpid);
+                            if (it == mvTallyWindowCPID.end()) continue;
+                            for (std::deque<CBlockIndex*>::reverse_iterator rit = it->second.rbegin(); rit != it->second.rend(); ++rit)
+                                AddResearchMagnitude(*rit, mvTallyWindowMagnitudes);
+                        }
+                        setTallyWindowDirty.clear();
+
+                        // Amounts owed depend on the current time and magnitudes, so refresh them for everyone
+                        mvMagnitudesCopy = mvTallyWindowMagnitudes;
+                        for (std::map<std::string, StructCPID>::iterator it = mvMagnitudesCopy.begin(); it != mvMagnitudesCopy.end(); ++it)
+                        {
+                            std::map<std::string, std::deque<CBlockIndex*> >::iterator itBlocks = mvTallyWindowCPID.find(it->first);
+                            if (itBlocks == mvTallyWindowCPID.end()) continue;
+                            CBlockIndex* pindexOldest = itBlocks->second.front();
+                            double total_owed = 0;
+                            it->second.owed = GetOutstandingAmountOwed(it->second, it->first, pindexOldest->nTime, total_owed, pindexOldest->nMagnitude);
+                            it->second.totalowed = total_owed;
+                        }
+
+                        if (pindexTallySuperblock && (pindexTallySuperblock->GetBlockHash().GetHex() != sTallySuperblockLoaded
+                            || ReadCache("superblock","block_number") != ToString((double)pindexTallySuperblock->nHeight)))
+                        {
+                            std::string superblock;
+                            if (GetTallySuperblock(pindexTallySuperblock, superblock))
                             {
-                                MiningCPID bb = GetBoincBlockByIndex(pblockindex);
-                                if (bb.superblock.length() > 20)
-                                {
-                                        std::string superblock = UnpackBinarySuperblock(bb.superblock);
-                                        if (VerifySuperblock(superblock, pblockindex))
-                                        {
-                                                LoadSuperblock(superblock,pblockindex->nTime,pblockindex->nHeight);
-                                                superblockloaded=true;
-                                                if (fDebug)
-                                                   printf(" Superblock Loaded %i", pblockindex->nHeight);
-                                        }
-                                }
+                                LoadSuperblock(superblock,pindexTallySuperblock->nTime,pindexTallySuperblock->nHeight);
+                                sTallySuperblockLoaded = pindexTallySuperblock->GetBlockHash().GetHex();
+                                if (fDebug)
+                                   printf(" Superblock Loaded %i", pindexTallySuperblock->nHeight);
                             }
-
                         }
                         // End of critical section
                         if (fDebug3) printf("TNA loaded in %" PRId64, GetTimeMillis()-nStart);
                         nStart=GetTimeMillis();
 
 
-                        if (pblockindex)
-                        {
-                            if (fDebug3)
-                               printf("Min block %i, Rows %i", pblockindex->nHeight, iRow);
-
-                            StructCPID network = GetInitializedStructCPID2("NETWORK",mvNetworkCopy);
-                            network.projectname="NETWORK";
-                            network.payments = NetworkPayments;
-                            network.InterestSubsidy = NetworkInterest;
-                            mvNetworkCopy["NETWORK"] = network;
-                            if(fDebug3) printf(" TMIS1 ");
-                            TallyMagnitudesInSuperblock();
-                        }
+                        if (fDebug3)
+                           printf("Min block %i, Rows %i, Replayed %i", nMinDepth, (int)vTallyWindow.size(), iReplayed);
+
+                        StructCPID network = GetInitializedStructCPID2("NETWORK",mvNetworkCopy);
+                        network.projectname="NETWORK";
+                        network.payments = dTallyWindowPayments;
+                        network.InterestSubsidy = dTallyWindowInterest;
+                        mvNetworkCopy["NETWORK"] = network;
+                        if(fDebug3) printf(" TMIS1 ");
+                        TallyMagnitudesInSuperblock();
                         // 11-19-2015 Copy dictionaries to live RAM
                         mvDPOR = mvDPORCopy;
                         mvMagnitudes = mvMagnitudesCopy;
@@ -5896,12 +5989,14 @@ bool TallyResearchAverages(bool Forcefully)
         catch (bad_alloc ba)
         {
             printf("Bad Alloc while tallying network averages. [1]\r\n");
+            TallyWindowClear();
             bNetAveragesLoaded=true;
             nLastTallied = 0;
         }
         catch(...)
         {
             printf("Error while tallying network averages. [1]\r\n");
+            TallyWindowClear();
             bNetAveragesLoaded=true;
             nLastTallied = 0;
         }
@@ -5930,7 +6025,7 @@ void PrintBlockTree()
     AssertLockHeld(cs_main);
     // pre-compute tree structure
     map<CBlockIndex*, vector<CBlockIndex*> > mapNext;
-    for (map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.begin(); mi != mapBlockIndex.end(); ++mi)
+    for (BlockMap::iterator mi = mapBlockIndex.begin(); mi != mapBlockIndex.end(); ++mi)
     {
         CBlockIndex* pindex = (*mi).second;
         mapNext[pindex->pprev].push_back(pindex);
@@ -6315,6 +6410,14 @@ bool PreventCommandAbuse(std::string sNeuralRequestID, std::string sCommandName)
                 return bIgnore;
 }
 
+// Commands which only touch the peer and the address manager. They are
+// processed without cs_main, so must not reach chain or wallet state.
+static bool IsNetworkCommand(const string& strCommand)
+{
+    return strCommand == "verack" || strCommand == "gridaddr" || strCommand == "getaddr" ||
+           strCommand == "ping" || strCommand == "pong";
+}
+
 bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv, int64_t nTimeReceived)
 {
     RandAddSeedPerfmon();
@@ -6327,7 +6430,7 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
     }
 
     // Stay in Sync - 8-9-2016
-    if (!IsLockTimeWithinMinutes(nBootup,15))
+    if (!IsNetworkCommand(strCommand) && !IsLockTimeWithinMinutes(nBootup,15))
     {
         if ((!IsLockTimeWithinMinutes(nLastAskedForBlocks,5) && WalletOutOfSync()) || (WalletOutOfSync() && fTestNet))
         {
@@ -6744,15 +6847,17 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
 
             if (inv.type == MSG_BLOCK)
             {
-                // Send block from disk
-                map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(inv.hash);
+                // Send block from disk, exactly as it is stored there
+                BlockMap::iterator mi = mapBlockIndex.find(inv.hash);
+                RawBlockPtr block;
                 if (mi != mapBlockIndex.end())
+                    block = GetBlockToServe((*mi).second);
+                if (block)
                 {
-                    CBlock block;
-                    block.ReadFromDisk((*mi).second);
                     //HALFORD 12-26-2014
                     std::string acid = GetCommandNonce("encrypt");
-                    pfrom->PushMessage("encrypt", block, acid);
+                    CFlatData data((void*)&(*block)[0], (void*)(&(*block)[0] + block->size()));
+                    pfrom->PushMessage("encrypt", data, acid);
 
                     // Trigger them to send a getblocks request for the next batch of inventory
                     if (inv.hash == pfrom->hashContinue)
@@ -6773,9 +6878,9 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
                 bool pushed = false;
                 {
                     LOCK(cs_mapRelay);
-                    map<CInv, CDataStream>::iterator mi = mapRelay.find(inv);
+                    map<CInv, CMessageDataPtr>::iterator mi = mapRelay.find(inv);
                     if (mi != mapRelay.end()) {
-                        pfrom->PushMessage(inv.GetCommand(), (*mi).second);
+                        pfrom->PushMessageData((*mi).second);
                         pushed = true;
                     }
                 }
@@ -6876,7 +6981,7 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
         if (locator.IsNull())
         {
             // If locator is null, return the hashStop block
-            map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(hashStop);
+            BlockMap::iterator mi = mapBlockIndex.find(hashStop);
             if (mi == mapBlockIndex.end())
                 return true;
             pindex = (*mi).second;
@@ -7006,8 +7111,9 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
     {
         // Don't return addresses older than nCutOff timestamp
         int64_t nCutOff =  GetAdjustedTime() - (nNodeLifespan * 24 * 60 * 60);
-        pfrom->vAddrToSend.clear();
         vector<CAddress> vAddr = addrman.GetAddr();
+        LOCK(pfrom->cs_addr);
+        pfrom->vAddrToSend.clear();
         BOOST_FOREACH(const CAddress &addr, vAddr)
             if(addr.nTime > nCutOff)
                 pfrom->PushAddress(addr);
@@ -7322,6 +7428,8 @@ void AddPeek(std::string data)
 
 
 // requires LOCK(cs_vRecvMsg)
+// Called from the message workers of several nodes at once. Only commands
+// which reach chain state are serialised on cs_main.
 bool ProcessMessages(CNode* pfrom)
 {
     //
@@ -7422,6 +7530,9 @@ bool ProcessMessages(CNode* pfrom)
         bool fRet = false;
         try
         {
+            if (pfrom->nVersion != 0 && IsNetworkCommand(strCommand))
+                fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.nTime);
+            else
             {
                 LOCK(cs_main);
                 fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.nTime);
@@ -7494,7 +7605,7 @@ double PendingSuperblockHeight()
 std::string GetNeuralNetworkSuperBlock()
 {
     //Only try to stake a superblock if the contract expired And the superblock is the highest popularity block And we do not have a pending superblock
-    int64_t superblock_age = GetAdjustedTime() - mvApplicationCacheTimestamp["superblock;magnitudes"];
+    int64_t superblock_age = GetAdjustedTime() - ReadCacheTimestamp("superblock","magnitudes");
     if (IsNeuralNodeParticipant(DefaultWalletAddress(), GetAdjustedTime()) && NeedASuperblock() && PendingSuperblockHeight()==0)
     {
         std::string myNeuralHash = "";
@@ -7606,107 +7717,107 @@ MiningCPID DeserializeBoincBlock(std::string block, int BlockVersion)
     try
     {
 
-    std::vector<std::string> s = split(block,"<|>");
+    const BoincBlockView s(block);
     if (s.size() > 7)
     {
-        surrogate.cpid = s[0];
-        surrogate.projectname = s[1];
+        surrogate.cpid = s.GetString(BoincBlockView::CPID);
+        surrogate.projectname = s.GetString(BoincBlockView::PROJECT_NAME);
         boost::to_lower(surrogate.projectname);
-        surrogate.aesskein = s[2];
-        surrogate.rac = cdbl(s[3],0);
-        surrogate.pobdifficulty = cdbl(s[4],6);
-        surrogate.diffbytes = (unsigned int)cdbl(s[5],0);
-        surrogate.enccpid = s[6];
-        surrogate.encboincpublickey = s[6];
-        surrogate.encaes = s[7];
-        surrogate.nonce = cdbl(s[8],0);
+        surrogate.aesskein = s.GetString(BoincBlockView::AES_SKEIN);
+        surrogate.rac = s.GetDouble(BoincBlockView::RAC,0);
+        surrogate.pobdifficulty = s.GetDouble(BoincBlockView::POB_DIFFICULTY,6);
+        surrogate.diffbytes = (unsigned int)s.GetDouble(BoincBlockView::DIFF_BYTES,0);
+        surrogate.enccpid = s.GetString(BoincBlockView::ENC_CPID);
+        surrogate.encboincpublickey = surrogate.enccpid;
+        surrogate.encaes = s.GetString(BoincBlockView::ENC_AES);
+        surrogate.nonce = s.GetDouble(BoincBlockView::NONCE,0);
         if (s.size() > 9)
         {
-            surrogate.NetworkRAC = cdbl(s[9],0);
+            surrogate.NetworkRAC = s.GetDouble(BoincBlockView::NETWORK_RAC,0);
         }
         if (s.size() > 10)
         {
-            surrogate.clientversion = s[10];
+            surrogate.clientversion = s.GetString(BoincBlockView::CLIENT_VERSION);
         }
         if (s.size() > 11)
         {
-            surrogate.ResearchSubsidy = cdbl(s[11],2);
+            surrogate.ResearchSubsidy = s.GetDouble(BoincBlockView::RESEARCH_SUBSIDY,2);
         }
         if (s.size() > 12)
         {
-            surrogate.LastPaymentTime = cdbl(s[12],0);
+            surrogate.LastPaymentTime = s.GetDouble(BoincBlockView::LAST_PAYMENT_TIME,0);
         }
         if (s.size() > 13)
         {
-            surrogate.RSAWeight = cdbl(s[13],0);
+            surrogate.RSAWeight = s.GetDouble(BoincBlockView::RSA_WEIGHT,0);
         }
         if (s.size() > 14)
         {
-            surrogate.cpidv2 = s[14];
+            surrogate.cpidv2 = s.GetString(BoincBlockView::CPID_V2);
         }
         if (s.size() > 15)
         {
-            surrogate.Magnitude = cdbl(s[15],0);
+            surrogate.Magnitude = s.GetDouble(BoincBlockView::MAGNITUDE,0);
         }
         if (s.size() > 16)
         {
-            surrogate.GRCAddress = s[16];
+            surrogate.GRCAddress = s.GetString(BoincBlockView::GRC_ADDRESS);
         }
         if (s.size() > 17)
         {
-            surrogate.lastblockhash = s[17];
+            surrogate.lastblockhash = s.GetString(BoincBlockView::LAST_BLOCK_HASH);
         }
         if (s.size() > 18)
         {
-            surrogate.InterestSubsidy = cdbl(s[18],subsidy_places);
+            surrogate.InterestSubsidy = s.GetDouble(BoincBlockView::INTEREST_SUBSIDY,subsidy_places);
         }
         if (s.size() > 19)
         {
-            surrogate.Organization = s[19];
+            surrogate.Organization = s.GetString(BoincBlockView::ORGANIZATION);
         }
         if (s.size() > 20)
         {
-            surrogate.OrganizationKey = s[20];
+            surrogate.OrganizationKey = s.GetString(BoincBlockView::ORGANIZATION_KEY);
         }
         if (s.size() > 21)
         {
-            surrogate.NeuralHash = s[21];
+            surrogate.NeuralHash = s.GetString(BoincBlockView::NEURAL_HASH);
         }
         if (s.size() > 22)
         {
-            surrogate.superblock = s[22];
+            surrogate.superblock = s.GetString(BoincBlockView::SUPERBLOCK);
         }
         if (s.size() > 23)
         {
-            surrogate.ResearchSubsidy2 = cdbl(s[23],subsidy_places);
+            surrogate.ResearchSubsidy2 = s.GetDouble(BoincBlockView::RESEARCH_SUBSIDY_2,subsidy_places);
         }
         if (s.size() > 24)
         {
-            surrogate.ResearchAge = cdbl(s[24],6);
+            surrogate.ResearchAge = s.GetDouble(BoincBlockView::RESEARCH_AGE,6);
         }
         if (s.size() > 25)
         {
-            surrogate.ResearchMagnitudeUnit = cdbl(s[25],6);
+            surrogate.ResearchMagnitudeUnit = s.GetDouble(BoincBlockView::RESEARCH_MAGNITUDE_UNIT,6);
         }
         if (s.size() > 26)
         {
-            surrogate.ResearchAverageMagnitude = cdbl(s[26],2);
+            surrogate.ResearchAverageMagnitude = s.GetDouble(BoincBlockView::RESEARCH_AVERAGE_MAGNITUDE,2);
         }
         if (s.size() > 27)
         {
-            surrogate.LastPORBlockHash = s[27];
+            surrogate.LastPORBlockHash = s.GetString(BoincBlockView::LAST_POR_BLOCK_HASH);
         }
         if (s.size() > 28)
         {
-            surrogate.CurrentNeuralHash = s[28];
+            surrogate.CurrentNeuralHash = s.GetString(BoincBlockView::CURRENT_NEURAL_HASH);
         }
         if (s.size() > 29)
         {
-            surrogate.BoincPublicKey = s[29];
+            surrogate.BoincPublicKey = s.GetString(BoincBlockView::BOINC_PUBLIC_KEY);
         }
         if (s.size() > 30)
         {
-            surrogate.BoincSignature = s[30];
+            surrogate.BoincSignature = s.GetString(BoincBlockView::BOINC_SIGNATURE);
         }
 
     }
@@ -7798,26 +7909,17 @@ std::string ToOfficialNameNew(std::string proj)
 {
         proj = LowerUnderscore(proj);
         //Convert local XML project name [On the Left] to official [Netsoft] projectname:
-        std::string sType = "projectmapping";
-        for(map<string,string>::iterator ii=mvApplicationCache.begin(); ii!=mvApplicationCache.end(); ++ii)
+        for(const auto& item : ReadCacheSection("projectmapping"))
         {
-                std::string key_name  = (*ii).first;
-                if (key_name.length() > sType.length())
+                std::vector<std::string> vKey = split(item.first,";");
+                if (vKey.size() > 0)
                 {
-                    if (key_name.substr(0,sType.length())==sType)
-                    {
-                            std::string key_value = mvApplicationCache[(*ii).first];
-                            std::vector<std::string> vKey = split(key_name,";");
-                            if (vKey.size() > 0)
-                            {
-                                std::string project_boinc   = vKey[1];
-                                std::string project_netsoft = key_value;
-                                proj=LowerUnderscore(proj);
-                                project_boinc=LowerUnderscore(project_boinc);
-                                project_netsoft=LowerUnderscore(project_netsoft);
-                                if (proj==project_boinc) proj=project_netsoft;
-                            }
-                     }
+                    std::string project_boinc   = vKey[1];
+                    std::string project_netsoft = item.second.value;
+                    proj=LowerUnderscore(proj);
+                    project_boinc=LowerUnderscore(project_boinc);
+                    project_netsoft=LowerUnderscore(project_netsoft);
+                    if (proj==project_boinc) proj=project_netsoft;
                 }
         }
         return proj;
@@ -7926,14 +8028,16 @@ void HarvestCPIDs(bool cleardata)
             {
                 for (unsigned int i = 0; i < vCPID.size(); i++)
                 {
-                    std::string email_hash = ExtractXML(vCPID[i],"<email_hash>","</email_hash>");
-                    std::string cpidhash = ExtractXML(vCPID[i],"<cross_project_id>","</cross_project_id>");
-                    std::string externalcpid = ExtractXML(vCPID[i],"<external_cpid>","</external_cpid>");
-                    std::string utc=ExtractXML(vCPID[i],"<user_total_credit>","</user_total_credit>");
-                    std::string rac=ExtractXML(vCPID[i],"<user_expavg_credit>","</user_expavg_credit>");
-                    std::string proj=ExtractXML(vCPID[i],"<project_name>","</project_name>");
-                    std::string team=ExtractXML(vCPID[i],"<team_name>","</team_name>");
-                    std::string rectime = ExtractXML(vCPID[i],"<rec_time>","</rec_time>");
+                    const XMLView project(vCPID[i], {"email_hash", "cross_project_id", "external_cpid", "user_total_credit",
+                                                     "user_expavg_credit", "project_name", "team_name", "rec_time"});
+                    std::string email_hash = project.GetString(0);
+                    std::string cpidhash = project.GetString(1);
+                    std::string externalcpid = project.GetString(2);
+                    std::string utc = project.GetString(3);
+                    std::string rac = project.GetString(4);
+                    std::string proj = project.GetString(5);
+                    std::string team = project.GetString(6);
+                    std::string rectime = project.GetString(7);
 
                     boost::to_lower(proj);
                     proj = ToOfficialName(proj);
@@ -8231,7 +8335,10 @@ bool SendMessages(CNode* pto, bool fSendTrickle)
                 {
                     // Periodically clear setAddrKnown to allow refresh broadcasts
                     if (nLastRebroadcast)
+                    {
+                        LOCK(pnode->cs_addr);
                         pnode->setAddrKnown.clear();
+                    }
 
                     // Rebroadcast our address
                     if (!fNoListen)
@@ -8250,6 +8357,7 @@ bool SendMessages(CNode* pto, bool fSendTrickle)
         //
         if (fSendTrickle)
         {
+            LOCK(pto->cs_addr);
             vector<CAddress> vAddr;
             vAddr.reserve(pto->vAddrToSend.size());
             BOOST_FOREACH(const CAddress& addr, pto->vAddrToSend)
@@ -8382,76 +8490,6 @@ bool SendMessages(CNode* pto, bool fSendTrickle)
 
 
 
-std::string ReadCache(std::string section, std::string key)
-{
-    if (section.empty() || key.empty()) return "";
-
-    try
-    {
-            std::string value = mvApplicationCache[section + ";" + key];
-            if (value.empty())
-            {
-                mvApplicationCache.insert(map<std::string,std::string>::value_type(section + ";" + key,""));
-                mvApplicationCache[section + ";" + key]="";
-                return "";
-            }
-            return value;
-    }
-    catch(...)
-    {
-        printf("readcache error %s",section.c_str());
-        return "";
-    }
-}
-
-
-void WriteCache(std::string section, std::string key, std::string value, int64_t locktime)
-{
-    if (section.empty() || key.empty()) return;
-    std::string temp_value = mvApplicationCache[section + ";" + key];
-    if (temp_value.empty())
-    {
-        mvApplicationCache.insert(map<std::string,std::string>::value_type(section + ";" + key,value));
-        mvApplicationCache[section + ";" + key]=value;
-    }
-    mvApplicationCache[section + ";" + key]=value;
-    // Record Cache Entry timestamp
-    int64_t temp_locktime = mvApplicationCacheTimestamp[section + ";" + key];
-    if (temp_locktime == 0)
-    {
-        mvApplicationCacheTimestamp.insert(map<std::string,int64_t>::value_type(section+";"+key,1));
-        mvApplicationCacheTimestamp[section+";"+key]=locktime;
-    }
-    mvApplicationCacheTimestamp[section+";"+key] = locktime;
-
-}
-
-
-void ClearCache(std::string section)
-{
-       for(map<string,string>::iterator ii=mvApplicationCache.begin(); ii!=mvApplicationCache.end(); ++ii)
-       {
-                std::string key_section = mvApplicationCache[(*ii).first];
-                if (key_section.length() > section.length())
-                {
-                    if (key_section.substr(0,section.length())==section)
-                    {
-                        printf("\r\nClearing the cache....of value %s \r\n",mvApplicationCache[key_section].c_str());
-                        mvApplicationCache[key_section]="";
-                        mvApplicationCacheTimestamp[key_section]=1;
-                    }
-                }
-       }
-
-}
-
-
-void DeleteCache(std::string section, std::string keyname)
-{
-       std::string pk = section + ";" +keyname;
-       mvApplicationCache.erase(pk);
-       mvApplicationCacheTimestamp.erase(pk);
-}
 
 
 
@@ -8618,12 +8656,13 @@ bool MemorizeMessage(std::string msg, int64_t nTime, double dAmount, std::string
 
           if (Contains(msg,"<MT>"))
           {
-              std::string sMessageType      = ExtractXML(msg,"<MT>","</MT>");
-              std::string sMessageKey       = ExtractXML(msg,"<MK>","</MK>");
-              std::string sMessageValue     = ExtractXML(msg,"<MV>","</MV>");
-              std::string sMessageAction    = ExtractXML(msg,"<MA>","</MA>");
-              std::string sSignature        = ExtractXML(msg,"<MS>","</MS>");
-              std::string sMessagePublicKey = ExtractXML(msg,"<MPK>","</MPK>");
+              const XMLView fields(msg, {"MT", "MK", "MV", "MA", "MS", "MPK"});
+              std::string sMessageType      = fields.GetString(0);
+              std::string sMessageKey       = fields.GetString(1);
+              std::string sMessageValue     = fields.GetString(2);
+              std::string sMessageAction    = fields.GetString(3);
+              std::string sSignature        = fields.GetString(4);
+              std::string sMessagePublicKey = fields.GetString(5);
               if (sMessageType=="beacon" && Contains(sMessageValue,"INVESTOR"))
               {
                     sMessageValue="";
@@ -8682,6 +8721,8 @@ bool MemorizeMessage(std::string msg, int64_t nTime, double dAmount, std::string
                                     WriteCache(sMessageType,sMessageKey+";BurnAmount",RoundToString(dAmount,2),nTime);
                                 }
                                 WriteCache(sMessageType,sMessageKey,sMessageValue,nTime);
+                                if (sMessageType=="vote")
+                                    IndexVote(sMessageKey,sMessageValue);
                                 if(fDebug && sMessageType=="beacon" ){
                                     printf("BEACON add %s %s %s\r\n",sMessageKey.c_str(),DecodeBase64(sMessageValue).c_str(),TimestampToHRDate(nTime).c_str());
                                 }
@@ -8707,6 +8748,8 @@ bool MemorizeMessage(std::string msg, int64_t nTime, double dAmount, std::string
                                     printf("BEACON DEL %s - %s\r\n",sMessageKey.c_str(),TimestampToHRDate(nTime).c_str());
                                 }
                                 DeleteCache(sMessageType,sMessageKey);
+                                if (sMessageType=="vote")
+                                    UnindexVote(sMessageKey);
                                 fMessageLoaded = true;
                         }
                         // If this is a boinc project, load the projects into the coin:
@@ -8960,26 +9003,6 @@ CBlockIndex* GetHistoricalMagnitude(std::string cpid)
     }
 }
 
-void ZeroOutResearcherTotals(std::string cpid)
-{
-    if (!cpid.empty())
-    {
-                StructCPID stCPID = GetInitializedStructCPID2(cpid,mvResearchAge);
-                stCPID.LastBlock = 0;
-                stCPID.BlockHash = "";
-                stCPID.InterestSubsidy = 0;
-                stCPID.ResearchSubsidy = 0;
-                stCPID.Accuracy = 0;
-                stCPID.LowLockTime = std::numeric_limits<unsigned int>::max();
-                stCPID.HighLockTime = 0;
-                stCPID.TotalMagnitude = 0;
-                stCPID.ResearchAverageMagnitude = 0;
-
-                mvResearchAge[cpid]=stCPID;
-    }
-}
-
-
 bool LoadAdminMessages(bool bFullTableScan, std::string& out_errors)
 {
     int nMaxDepth = nBestHeight;
@@ -9,9 +9,13 @@
 #include "net.h"
 #include "script.h"
 #include "scrypt.h"
+#include "block.h"
+#include "blockfile.h"
+#include "sha256.h"
 
 #include "global_objects_noui.hpp"
 
+#include <atomic>
 #include <map>
 #include <set>
 
@@ -25,6 +29,7 @@ class CAddress;
 class CInv;
 class CNode;
 class CTxMemPool;
+class CScriptCheck;
 
 static const int LAST_POW_BLOCK = 2050;
 extern unsigned int REORGANIZE_FAILED;
@@ -71,6 +76,8 @@ inline bool MoneyRange(int64_t nValue) { return (nValue >= 0 && nValue <= MAX_MO
 /** Threshold for nLockTime: below this value it is interpreted as block number, otherwise as UNIX timestamp. */
 static const unsigned int LOCKTIME_THRESHOLD = 500000000; // Tue Nov  5 00:53:20 1985 UTC
 static const unsigned int MINIMUM_CHECKPOINT_TRANSMISSION_BALANCE = 4000000;
+/** Maximum number of script-checking threads allowed */
+static const int MAX_SCRIPTCHECK_THREADS = 16;
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -119,8 +126,6 @@ inline unsigned int GetTargetSpacing(int nHeight) { return IsProtocolV2(nHeight)
 extern bool IsNeuralNodeParticipant(const std::string& addr, int64_t locktime);
 bool VerifySuperblock(const std::string& superblock, const CBlockIndex* parent);
 
-extern std::map<std::string, std::string> mvApplicationCache;
-extern std::map<std::string, int64_t> mvApplicationCacheTimestamp;
 extern std::map<std::string, double> mvNeuralNetworkHash;
 extern std::map<std::string, double> mvCurrentNeuralNetworkHash;
 extern std::map<std::string, double> mvNeuralVersion;
@@ -132,13 +137,10 @@ extern std::map<std::string, StructCPID> mvDPORCopy;
 extern std::map<std::string, StructCPID> mvResearchAge;
 extern std::map<std::string, MiningCPID> mvBlockIndex;
 
-typedef std::set<uint256> HashSet;
-extern std::map<std::string, HashSet> mvCPIDBlockHashes;
-
 
 extern CScript COINBASE_FLAGS;
 extern CCriticalSection cs_main;
-extern std::map<uint256, CBlockIndex*> mapBlockIndex;
+extern BlockMap mapBlockIndex;
 extern std::set<std::pair<COutPoint, unsigned int> > setStakeSeen;
 extern CBlockIndex* pindexGenesisBlock;
 extern unsigned int nStakeMinAge;
@@ -175,10 +177,13 @@ extern int nLastMedianPeerCount;
 extern int64_t nLastTalliedNeural;
 extern int64_t nCPIDsLoaded;
 extern int64_t nLastGRCtallied;
+extern int64_t nEarliestGRCTime;
+extern int64_t nEarliestCPIDTime;
 extern int64_t nLastCleaned;
 extern int64_t nLastTallyBusyWait;
 
 extern bool fUseFastIndex;
+extern int nScriptCheckThreads;
 extern unsigned int nDerivationMethodIndex;
 
 extern bool fEnforceCanonical;
@@ -247,12 +252,17 @@ bool ProcessBlock(CNode* pfrom, CBlock* pblock, bool Generated_By_Me);
 bool CheckDiskSpace(uint64_t nAdditionalBytes=0);
 FILE* OpenBlockFile(unsigned int nFile, unsigned int nBlockPos, const char* pszMode="rb");
 FILE* AppendBlockFile(unsigned int& nFileRet);
+bool ReadRawBlockFromDisk(const CBlockIndex* pindex, RawBlock& vchBlockRet);
 bool LoadBlockIndex(bool fAllowNew=true);
 void PrintBlockTree();
 
 bool ProcessMessages(CNode* pfrom);
 bool SendMessages(CNode* pto, bool fSendTrickle);
 bool LoadExternalBlockFile(FILE* fileIn);
+/** Run an instance of the script checking thread */
+void ThreadScriptCheck(void* parg);
+/** Stop the script checking threads once their queue has drained */
+void InterruptScriptCheck();
 bool WriteKey(std::string sKey, std::string sValue);
 
 bool CheckProofOfWork(uint256 hash, unsigned int nBits);
@@ -578,6 +588,56 @@ enum GetMinFee_mode
 
 typedef std::map<uint256, std::pair<CTxIndex, CTransaction> > MapPrevTx;
 
+/** Memoised transaction hash. A copy keeps the cached value. The hash is
+ * published with release ordering, so a reader on another thread either sees
+ * the complete hash or computes it again.
+ */
+class CTxHashCache
+{
+public:
+    CTxHashCache() : fValid(false) {}
+
+    CTxHashCache(const CTxHashCache& other) : fValid(false)
+    {
+        uint256 hashOther;
+        if (other.Get(hashOther))
+            Set(hashOther);
+    }
+
+    CTxHashCache& operator=(const CTxHashCache& other)
+    {
+        uint256 hashOther;
+        if (other.Get(hashOther))
+            Set(hashOther);
+        else
+            Clear();
+        return *this;
+    }
+
+    bool Get(uint256& hashRet) const
+    {
+        if (!fValid.load(std::memory_order_acquire))
+            return false;
+        hashRet = hash;
+        return true;
+    }
+
+    void Set(const uint256& hashIn) const
+    {
+        hash = hashIn;
+        fValid.store(true, std::memory_order_release);
+    }
+
+    void Clear() const
+    {
+        fValid.store(false, std::memory_order_release);
+    }
+
+private:
+    mutable uint256 hash;
+    mutable std::atomic<bool> fValid;
+};
+
 /** The basic transaction that is broadcasted on the network and contained in
  * blocks.  A transaction can contain multiple inputs and outputs.
  */
@@ -603,6 +663,8 @@ public:
 
     IMPLEMENT_SERIALIZE
     (
+        if (fRead)
+            hashCache.Clear();
         READWRITE(this->nVersion);
         nVersion = this->nVersion;
         READWRITE(nTime);
@@ -622,6 +684,7 @@ public:
         nLockTime = 0;
         nDoS = 0;  // Denial-of-service prevention
 		hashBoinc="";
+        hashCache.Clear();
     }
 
     bool IsNull() const
@@ -631,7 +694,20 @@ public:
 
     uint256 GetHash() const
     {
-        return SerializeHash(*this);
+        uint256 hash;
+        if (!hashCache.Get(hash))
+        {
+            hash = SerializeHash(*this);
+            hashCache.Set(hash);
+        }
+        return hash;
+    }
+
+    /** Forget the cached hash. Must be called after changing any serialized
+        field of a transaction whose hash may already have been taken. */
+    void InvalidateHash()
+    {
+        hashCache.Clear();
     }
 
     bool IsNewerThan(const CTransaction& old) const
@@ -728,6 +804,10 @@ public:
 
     bool ReadFromDisk(CDiskTxPos pos, FILE** pfileRet=NULL)
     {
+        // Read from the mapped block file unless the caller wants the file
+        if (!pfileRet && GetBlockFileReader().Read(pos.nFile, pos.nTxPos, *this, SER_DISK, CLIENT_VERSION))
+            return true;
+
         CAutoFile filein = CAutoFile(OpenBlockFile(pos.nFile, 0, pfileRet ? "rb+" : "rb"), SER_DISK, CLIENT_VERSION);
         if (!filein)
             return error("CTransaction::ReadFromDisk() : OpenBlockFile failed");
@@ -825,16 +905,21 @@ public:
         @param[in] pindexBlock
         @param[in] fBlock	true if called from ConnectBlock
         @param[in] fMiner	true if called from CreateNewBlock
+        @param[out] pvChecks	if non-NULL, script checks are appended here instead of being run inline
         @return Returns true if all checks succeed
      */
     bool ConnectInputs(CTxDB& txdb, MapPrevTx inputs,
                        std::map<uint256, CTxIndex>& mapTestPool, const CDiskTxPos& posThisTx,
-                       const CBlockIndex* pindexBlock, bool fBlock, bool fMiner);
+                       const CBlockIndex* pindexBlock, bool fBlock, bool fMiner,
+                       std::vector<CScriptCheck> *pvChecks = NULL);
     bool CheckTransaction() const;
     bool GetCoinAge(CTxDB& txdb, uint64_t& nCoinAge) const;  // ppcoin: get transaction coin age
 
 protected:
     const CTxOut& GetOutputFor(const CTxIn& input, const MapPrevTx& inputs) const;
+
+private:
+    CTxHashCache hashCache;
 };
 
 /** Check for standard transaction types
@@ -844,6 +929,32 @@ bool IsStandardTx(const CTransaction& tx);
 
 bool IsFinalTx(const CTransaction &tx, int nBlockHeight = 0, int64_t nBlockTime = 0);
 
+/** Closure representing one script verification
+ *  Note that this stores references to the spending transaction */
+class CScriptCheck
+{
+private:
+    CScript scriptPubKey;
+    const CTransaction *ptxTo;
+    unsigned int nIn;
+    int nHashType;
+
+public:
+    CScriptCheck() : ptxTo(0), nIn(0), nHashType(0) {}
+    CScriptCheck(const CTransaction& txFromIn, const CTransaction& txToIn, unsigned int nInIn, int nHashTypeIn) :
+        scriptPubKey(txFromIn.vout[txToIn.vin[nInIn].prevout.n].scriptPubKey),
+        ptxTo(&txToIn), nIn(nInIn), nHashType(nHashTypeIn) { }
+
+    bool operator()() const;
+
+    void swap(CScriptCheck &check) {
+        scriptPubKey.swap(check.scriptPubKey);
+        std::swap(ptxTo, check.ptxTo);
+        std::swap(nIn, check.nIn);
+        std::swap(nHashType, check.nHashType);
+    }
+};
+
 
 
 /** A transaction with a merkle branch linking it to the block chain. */
@@ -1134,12 +1245,13 @@ public:
         int j = 0;
         for (int nSize = vtx.size(); nSize > 1; nSize = (nSize + 1) / 2)
         {
-            for (int i = 0; i < nSize; i += 2)
-            {
-                int i2 = std::min(i+1, nSize-1);
-                vMerkleTree.push_back(Hash(BEGIN(vMerkleTree[j+i]),  END(vMerkleTree[j+i]),
-                                           BEGIN(vMerkleTree[j+i2]), END(vMerkleTree[j+i2])));
-            }
+            // The pairs of a level lie next to each other, so hash them all
+            // at once. An odd one out is paired with itself.
+            vMerkleTree.resize(j + nSize + (nSize + 1) / 2);
+            Sha256DBatch(vMerkleTree[j+nSize].begin(), vMerkleTree[j].begin(), 2 * sizeof(uint256), nSize / 2);
+            if (nSize & 1)
+                vMerkleTree[j+nSize+nSize/2] = Hash(BEGIN(vMerkleTree[j+nSize-1]), END(vMerkleTree[j+nSize-1]),
+                                                    BEGIN(vMerkleTree[j+nSize-1]), END(vMerkleTree[j+nSize-1]));
             j += nSize;
         }
         return (vMerkleTree.empty() ? 0 : vMerkleTree.back());
@@ -1207,19 +1319,24 @@ public:
     {
         SetNull();
 
-        // Open history file to read
-        CAutoFile filein = CAutoFile(OpenBlockFile(nFile, nBlockPos, "rb"), SER_DISK, CLIENT_VERSION);
-        if (!filein)
-            return error("CBlock::ReadFromDisk() : OpenBlockFile failed");
-        if (!fReadTransactions)
-            filein.nType |= SER_BLOCKHEADERONLY;
+        // Read from the mapped block file, or through stdio if it cannot be mapped
+        int nType = SER_DISK | (fReadTransactions ? 0 : SER_BLOCKHEADERONLY);
+        if (!GetBlockFileReader().Read(nFile, nBlockPos, *this, nType, CLIENT_VERSION))
+        {
+            SetNull();
 
-        // Read block
-        try {
-            filein >> *this;
-        }
-        catch (std::exception &e) {
-            return error("%s() : deserialize or I/O error", __PRETTY_FUNCTION__);
+            // Open history file to read
+            CAutoFile filein = CAutoFile(OpenBlockFile(nFile, nBlockPos, "rb"), nType, CLIENT_VERSION);
+            if (!filein)
+                return error("CBlock::ReadFromDisk() : OpenBlockFile failed");
+
+            // Read block
+            try {
+                filein >> *this;
+            }
+            catch (std::exception &e) {
+                return error("%s() : deserialize or I/O error", __PRETTY_FUNCTION__);
+            }
         }
 
         // Check the header
@@ -1687,7 +1804,7 @@ public:
 
     explicit CBlockLocator(uint256 hashBlock)
     {
-        std::map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(hashBlock);
+        BlockMap::iterator mi = mapBlockIndex.find(hashBlock);
         if (mi != mapBlockIndex.end())
             Set((*mi).second);
     }
@@ -1738,7 +1855,7 @@ public:
         int nStep = 1;
         BOOST_FOREACH(const uint256& hash, vHave)
         {
-            std::map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(hash);
+            BlockMap::iterator mi = mapBlockIndex.find(hash);
             if (mi != mapBlockIndex.end())
             {
                 CBlockIndex* pindex = (*mi).second;
@@ -1757,7 +1874,7 @@ public:
         // Find the first block the caller has in the main chain
         BOOST_FOREACH(const uint256& hash, vHave)
         {
-            std::map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(hash);
+            BlockMap::iterator mi = mapBlockIndex.find(hash);
             if (mi != mapBlockIndex.end())
             {
                 CBlockIndex* pindex = (*mi).second;
@@ -1773,7 +1890,7 @@ public:
         // Find the first block the caller has in the main chain
         BOOST_FOREACH(const uint256& hash, vHave)
         {
-            std::map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(hash);
+            BlockMap::iterator mi = mapBlockIndex.find(hash);
             if (mi != mapBlockIndex.end())
             {
                 CBlockIndex* pindex = (*mi).second;
@@ -10,6 +10,7 @@
 #include "cpid.h"
 #include "util.h"
 #include "main.h"
+#include "sha256.h"
 
 #include <memory>
 
@@ -69,6 +70,8 @@ void CMinerStatus::Clear()
     Version= 0;
     CoinAgeSum= 0;
     nLastCoinStakeSearchInterval = 0;
+    nLastRoundCoins = 0;
+    nLastRoundMicros = nLastRoundReadMicros = 0;
 }
 
 CMinerStatus MinerStatus;
@@ -419,15 +422,60 @@ bool CreateRestOfTheBlock(CBlock &block, CBlockIndex* pindexPrev)
     // Fill in header  
     block.hashPrevBlock  = pindexPrev->GetBlockHash();
     block.vtx[0].nTime=block.nTime;
+    block.vtx[0].InvalidateHash();
 
     return true;
 }
 
 
+// Times of the blocks holding the coins a wallet stakes, by transaction
+// hash, with the hash of the block they were read from. They are kept from
+// one round to the next so that only new coins need their transaction index
+// entry and block header read. An entry holds while its block is in the
+// main chain.
+typedef std::map<uint256, std::pair<uint256, unsigned int> > StakeBlockTimes;
+
+static bool GetStakeBlockTime(CTxDB& txdb, const StakeBlockTimes& mapTimesLast, StakeBlockTimes& mapTimes,
+    const uint256& hashTx, unsigned int& nBlockTime)
+{
+    AssertLockHeld(cs_main);
+    StakeBlockTimes::const_iterator it = mapTimes.find(hashTx);
+    if (it != mapTimes.end())
+    {
+        nBlockTime = it->second.second;
+        return true;
+    }
+
+    it = mapTimesLast.find(hashTx);
+    if (it != mapTimesLast.end())
+    {
+        BlockMap::const_iterator mi = mapBlockIndex.find(it->second.first);
+        if (mi != mapBlockIndex.end() && mi->second->IsInMainChain())
+        {
+            nBlockTime = it->second.second;
+            mapTimes.insert(*it);
+            return true;
+        }
+    }
+
+    CTxIndex txindex;
+    if (!txdb.ReadTxIndex(hashTx, txindex))
+        return false;
+
+    CBlock CoinBlock; //Block which contains the coin
+    if (!CoinBlock.ReadFromDisk(txindex.pos.nFile, txindex.pos.nBlockPos, false))
+        return false;
+
+    nBlockTime = CoinBlock.nTime;
+    mapTimes[hashTx] = make_pair(CoinBlock.GetHash(), nBlockTime);
+    return true;
+}
+
 bool CreateCoinStake( CBlock &blocknew, CKey &key,
     vector<const CWalletTx*> &StakeInputs, uint64_t &CoinAge,
-    CWallet &wallet, CBlockIndex* pindexPrev )
+    CWallet &wallet, CBlockIndex* pindexPrev, StakeBlockTimes &BlockTimes )
 {
+    int64_t RoundStart = GetTimeMicros();
     int64_t CoinWeight;
     CBigNum StakeKernelHash;
     CTxDB txdb("r");
@@ -463,27 +511,48 @@ bool CreateCoinStake( CBlock &blocknew, CKey &key,
     if(fDebug2) printf("\nCreateCoinStake: Staking nTime/16= %d Bits= %u\n",
     txnew.nTime/16,blocknew.nBits);
 
-    for(const auto& pcoin : CoinsToStake)
+    // Find the block time of every coin before searching for a kernel,
+    // dropping those of coins no longer staked
+    vector<pair<pair<const CWalletTx*,unsigned int>, unsigned int> > Candidates;
     {
-        const CTransaction &CoinTx =*pcoin.first; //transaction that produced this coin
-        unsigned int CoinTxN =pcoin.second; //index of this coin inside it
-
-        CTxIndex txindex;
+        StakeBlockTimes BlockTimesRound;
+        for(const auto& pcoin : CoinsToStake)
         {
+            unsigned int CoinBlockTime;
             LOCK2(cs_main, wallet.cs_wallet);
-            if (!txdb.ReadTxIndex(pcoin.first->GetHash(), txindex))
-                continue; //error?
+            if (GetStakeBlockTime(txdb, BlockTimes, BlockTimesRound, pcoin.first->GetHash(), CoinBlockTime))
+                Candidates.push_back(make_pair(pcoin, CoinBlockTime));
         }
+        BlockTimes.swap(BlockTimesRound);
+    }
+    int64_t RoundReadTime = GetTimeMicros() - RoundStart;
 
-        CBlock CoinBlock; //Block which contains CoinTx
-        {
-            LOCK2(cs_main, wallet.cs_wallet);
-            if (!CoinBlock.ReadFromDisk(txindex.pos.nFile, txindex.pos.nBlockPos, false))
-                continue;
-        }
+    // The stake modifier is the same for every coin
+    uint64_t StakeModifier = 0;
+    bool fStakeModifier = blocknew.nVersion==8 && FindStakeModifierRev(StakeModifier,pindexPrev);
+
+    // Nothing in a V8 kernel changes during the search, so hash them all at once
+    vector<uint256> KernelHashes;
+    if (fStakeModifier && !Candidates.empty())
+    {
+        vector<unsigned char> Kernels(Candidates.size() * STAKE_KERNEL_V8_SIZE);
+        for (size_t i = 0; i < Candidates.size(); i++)
+            GetStakeKernelV8(&Kernels[i * STAKE_KERNEL_V8_SIZE], Candidates[i].second,
+                *Candidates[i].first.first, Candidates[i].first.second, txnew.nTime, StakeModifier);
+        KernelHashes.resize(Candidates.size());
+        Sha256DBatch(KernelHashes[0].begin(), &Kernels[0], STAKE_KERNEL_V8_SIZE, Candidates.size());
+    }
+
+    for(size_t CandidateN = 0; CandidateN < Candidates.size(); CandidateN++)
+    {
+        const auto& candidate = Candidates[CandidateN];
+        const auto& pcoin = candidate.first;
+        const CTransaction &CoinTx =*pcoin.first; //transaction that produced this coin
+        unsigned int CoinTxN =pcoin.second; //index of this coin inside it
+        unsigned int CoinBlockTime =candidate.second; //time of the block which contains CoinTx
 
         // only count coins meeting min age requirement
-        if (CoinBlock.GetBlockTime() + nStakeMinAge > txnew.nTime)
+        if ((int64_t)CoinBlockTime + nStakeMinAge > txnew.nTime)
             continue;
 
         if (CoinTx.vout[CoinTxN].nValue > BalanceToStake)
@@ -504,15 +573,14 @@ bool CreateCoinStake( CBlock &blocknew, CKey &key,
         {
             NetworkTimer();
             CoinWeight = CalculateStakeWeightV3(CoinTx,CoinTxN,GlobalCPUMiningCPID);
-            StakeKernelHash= CalculateStakeHashV3(CoinBlock,CoinTx,CoinTxN,txnew.nTime,GlobalCPUMiningCPID,mdPORNonce);
+            StakeKernelHash= CalculateStakeHashV3(CoinBlockTime,CoinTx,CoinTxN,txnew.nTime,GlobalCPUMiningCPID,mdPORNonce);
         }
         else if(blocknew.nVersion==8)
         {
-            uint64_t StakeModifier = 0;
-            if(!FindStakeModifierRev(StakeModifier,pindexPrev))
+            if(!fStakeModifier)
                 continue;
             CoinWeight = CalculateStakeWeightV8(CoinTx,CoinTxN,GlobalCPUMiningCPID);
-            StakeKernelHash= CalculateStakeHashV8(CoinBlock,CoinTx,CoinTxN,txnew.nTime,StakeModifier,GlobalCPUMiningCPID);
+            StakeKernelHash= CBigNum(KernelHashes[CandidateN]);
         }
         else return false;
 
@@ -590,12 +658,16 @@ bool CreateCoinStake( CBlock &blocknew, CKey &key,
             txnew.vout.push_back(CTxOut(0, CScript())); // First Must be empty
             txnew.vout.push_back(CTxOut(nCredit, scriptPubKeyOut));
             //txnew.vout.push_back(CTxOut(0, scriptPubKeyOut));
+            txnew.InvalidateHash();
 
             printf("CreateCoinStake: added kernel type=%d credit=%f\n", whichType,CoinToDouble(nCredit));
 
             LOCK(MinerStatus.lock);
             MinerStatus.Message+="Found Kernel "+ ToString(CoinToDouble(nCredit))+"; ";
             MinerStatus.KernelsFound++;
+            MinerStatus.nLastRoundCoins = Candidates.size();
+            MinerStatus.nLastRoundMicros = GetTimeMicros() - RoundStart;
+            MinerStatus.nLastRoundReadMicros = RoundReadTime;
             return true;
         }
     }
@@ -608,6 +680,9 @@ bool CreateCoinStake( CBlock &blocknew, CKey &key,
     MinerStatus.WeightMax=StakeWeightMax;
     MinerStatus.CoinAgeSum=StakeCoinAgeSum;
     MinerStatus.nLastCoinStakeSearchInterval= txnew.nTime;
+    MinerStatus.nLastRoundCoins = Candidates.size();
+    MinerStatus.nLastRoundMicros = GetTimeMicros() - RoundStart;
+    MinerStatus.nLastRoundReadMicros = RoundReadTime;
     return false;
 }
 
@@ -621,6 +696,7 @@ bool SignStakeBlock(CBlock &block, CKey &key, vector<const CWalletTx*> &StakeInp
             GlobalCPUMiningCPID.cpid,GlobalCPUMiningCPID.lastblockhash);
         if(fDebug3) printf("Signing BoincBlock for cpid %s and blockhash %s with sig %s\r\n",GlobalCPUMiningCPID.cpid.c_str(),GlobalCPUMiningCPID.lastblockhash.c_str(),BoincSignature.c_str());
         block.vtx[0].hashBoinc += BoincSignature;
+        block.vtx[0].InvalidateHash();
     }
 
     //Sign the coinstake transaction
@@ -726,6 +802,8 @@ bool CreateGridcoinReward(CBlock &blocknew, uint64_t &nCoinAge, CBlockIndex* pin
     //fill in reward and boinc
     blocknew.vtx[1].vout[1].nValue += nReward;
     blocknew.vtx[0].hashBoinc= SerializedBoincData;
+    blocknew.vtx[0].InvalidateHash();
+    blocknew.vtx[1].InvalidateHash();
     LOCK(MinerStatus.lock);
     MinerStatus.Message+="Added Reward "+RoundToString(mint,3)
         +"("+RoundToString(CoinToDouble(nFees),4)+" "
@@ -792,6 +870,7 @@ void StakeMiner(CWallet *pwallet)
 
     MinerAutoUnlockFeature(pwallet);
 
+    StakeBlockTimes BlockTimes;
     while (!fShutdown)
     {
 
@@ -834,7 +913,7 @@ void StakeMiner(CWallet *pwallet)
         CKey BlockKey;
         vector<const CWalletTx*> StakeInputs;
         uint64_t StakeCoinAge;
-        if( !CreateCoinStake( StakeBlock, BlockKey, StakeInputs, StakeCoinAge, *pwallet, pindexPrev ) )
+        if( !CreateCoinStake( StakeBlock, BlockKey, StakeInputs, StakeCoinAge, *pwallet, pindexPrev, BlockTimes ) )
             continue;
         StakeBlock.nTime= StakeTX.nTime;
 
@@ -22,6 +22,9 @@ struct CMinerStatus
     uint64_t AcceptedCnt;
     uint64_t KernelsFound;
     int64_t nLastCoinStakeSearchInterval;
+    uint64_t nLastRoundCoins;      // coins tried by the last kernel search
+    int64_t nLastRoundMicros;      // time the last kernel search took
+    int64_t nLastRoundReadMicros;  // part of it spent finding coin block times
 
     void Clear();
     CMinerStatus()
@@ -6,10 +6,13 @@
 #include "irc.h"
 #include "db.h"
 #include "net.h"
+#include "socketevents.h"
 #include "init.h"
 #include "addrman.h"
 #include "ui_interface.h"
 #include "util.h"
+#include "checkqueue.h"
+#include "xmlview.h"
 
 #include <boost/algorithm/string/case_conv.hpp> // for to_lower()
 #include <boost/thread.hpp>
@@ -17,6 +20,8 @@
 
 #ifdef WIN32
   #include <string.h>
+#else
+  #include <sys/uio.h>
 #endif 
  
 #ifdef USE_UPNP
@@ -46,7 +51,6 @@ extern std::string OrgId();
 std::string DefaultBoincHashArgs();
 bool IsCPIDValidv3(std::string cpidv2, bool allow_investor);
 extern int nMaxConnections;
-std::string ExtractXML(std::string XMLdata, std::string key, std::string key_end);
 std::string RetrieveMd5(std::string s1);
 
 int MAX_OUTBOUND_CONNECTIONS = 8;
@@ -89,7 +93,7 @@ CCriticalSection cs_vNodes;
 vector<std::string> vAddedNodes;
 CCriticalSection cs_vAddedNodes;
 
-map<CInv, CDataStream> mapRelay;
+map<CInv, CMessageDataPtr> mapRelay;
 deque<pair<int64_t, CInv> > vRelayExpiration;
 CCriticalSection cs_mapRelay;
 map<CInv, int64_t> mapAlreadyAskedFor;
@@ -102,6 +106,13 @@ CCriticalSection cs_setservAddNodeAddresses;
 
 static CSemaphore *semOutbound = NULL;
 
+// Wakes the message handler when there are messages to process
+static CWakeSignal wakeMessageHandler;
+
+// Threads processing messages, counting the message handler. With none the
+// message handler processes every node itself.
+static int nMessageThreads = 0;
+
 void AddOneShot(string strDest)
 {
     LOCK(cs_vOneShots);
@@ -836,8 +847,9 @@ void CNode::copyStats(CNodeStats &stats)
 #undef X
 
 // requires LOCK(cs_vRecvMsg)
-bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes)
+bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes, bool& fComplete)
 {
+    fComplete = false;
     while (nBytes > 0) {
 
         // get current incomplete message, or create a new one
@@ -860,8 +872,10 @@ bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes)
         pch += handled;
         nBytes -= handled;
 
-        if (msg.complete())
+        if (msg.complete()) {
             msg.nTime = GetTimeMicros();
+            fComplete = true;
+        }
     }
 
     return true;
@@ -916,26 +930,83 @@ int CNetMessage::readData(const char *pch, unsigned int nBytes)
 
 
 
+CMessageDataPtr MakeMessage(const char* pszCommand, const CDataStream& ssPayload)
+{
+    CMessageHeader hdr(pszCommand, ssPayload.size());
+    uint256 hash = Hash(ssPayload.begin(), ssPayload.end());
+    memcpy(&hdr.nChecksum, &hash, sizeof(hdr.nChecksum));
+
+    CDataStream ssHeader(SER_NETWORK, PROTOCOL_VERSION);
+    ssHeader << hdr;
+    std::shared_ptr<CMessageData> message = std::make_shared<CMessageData>();
+    message->reserve(ssHeader.size() + ssPayload.size());
+    message->insert(message->end(), ssHeader.begin(), ssHeader.end());
+    message->insert(message->end(), ssPayload.begin(), ssPayload.end());
+    return message;
+}
+
+// Most queued messages handed to the socket by one call
+static const int MAX_SEND_BUFFERS = 64;
+
+// Send the front of the send queue, gathering several messages into one
+// call where the platform allows. nOffered is set to the bytes offered.
+static int SendQueuedData(CNode *pnode, size_t& nOffered)
+{
+#ifdef WIN32
+    const CMessageData& data = *pnode->vSendMsg.front();
+    nOffered = data.size() - pnode->nSendOffset;
+    return send(pnode->hSocket, &data[pnode->nSendOffset], nOffered, MSG_NOSIGNAL | MSG_DONTWAIT);
+#else
+    struct iovec vBuffers[MAX_SEND_BUFFERS];
+    int nBuffers = 0;
+    nOffered = 0;
+    for (std::deque<CMessageDataPtr>::const_iterator it = pnode->vSendMsg.begin();
+         it != pnode->vSendMsg.end() && nBuffers < MAX_SEND_BUFFERS; ++it, ++nBuffers)
+    {
+        const CMessageData& data = **it;
+        size_t nSkip = nBuffers == 0 ? pnode->nSendOffset : 0;
+        vBuffers[nBuffers].iov_base = (void*)&data[nSkip];
+        vBuffers[nBuffers].iov_len = data.size() - nSkip;
+        nOffered += data.size() - nSkip;
+    }
+
+    struct msghdr msg = {};
+    msg.msg_iov = vBuffers;
+    msg.msg_iovlen = nBuffers;
+    return sendmsg(pnode->hSocket, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+#endif
+}
+
 // requires LOCK(cs_vSend)
 void SocketSendData(CNode *pnode)
 {
-    std::deque<CSerializeData>::iterator it = pnode->vSendMsg.begin();
-
-    while (it != pnode->vSendMsg.end())
+    while (!pnode->vSendMsg.empty())
     {
-        const CSerializeData &data = *it;
-        assert(data.size() > pnode->nSendOffset);
-        int nBytes = send(pnode->hSocket, &data[pnode->nSendOffset], data.size() - pnode->nSendOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+        assert(pnode->vSendMsg.front()->size() > pnode->nSendOffset);
+        size_t nOffered;
+        int nBytes = SendQueuedData(pnode, nOffered);
         if (nBytes > 0) {
             pnode->nLastSend = GetAdjustedTime();
-            pnode->nSendOffset += nBytes;
             pnode->RecordBytesSent(nBytes);
-            if (pnode->nSendOffset == data.size()) {
+
+            // Drop the messages sent in full
+            size_t nSent = nBytes;
+            while (nSent > 0)
+            {
+                const CMessageData& data = *pnode->vSendMsg.front();
+                size_t nLeft = data.size() - pnode->nSendOffset;
+                if (nSent < nLeft) {
+                    pnode->nSendOffset += nSent;
+                    break;
+                }
+                nSent -= nLeft;
                 pnode->nSendOffset = 0;
                 pnode->nSendSize -= data.size();
-                it++;
-            } else {
-                // could not send full message; stop sending more
+                pnode->vSendMsg.pop_front();
+            }
+
+            if ((size_t)nBytes < nOffered) {
+                // could not send everything offered; stop sending more
                 break;
             }
         }
@@ -955,11 +1026,10 @@ void SocketSendData(CNode *pnode)
         }
     }
 
-    if (it == pnode->vSendMsg.end()) {
+    if (pnode->vSendMsg.empty()) {
         assert(pnode->nSendOffset == 0);
         assert(pnode->nSendSize == 0);
     }
-    pnode->vSendMsg.erase(pnode->vSendMsg.begin(), it);
 }
 
 void ThreadSocketHandler(void* parg)
@@ -983,12 +1053,30 @@ void ThreadSocketHandler(void* parg)
     printf("ThreadSocketHandler exited\n");
 }
 
+static SocketEvents::Backend GetSocketEventsBackend()
+{
+    std::string strBackend = GetArg("-socketevents", "");
+    if (strBackend == SocketEvents::GetName(SocketEvents::SELECT))
+        return SocketEvents::SELECT;
+    if (!strBackend.empty() && strBackend != SocketEvents::GetName(SocketEvents::EPOLL))
+        printf("Unknown -socketevents=%s, using the default\n", strBackend.c_str());
+    return SocketEvents::IsSupported(SocketEvents::EPOLL) ? SocketEvents::EPOLL : SocketEvents::SELECT;
+}
+
 void ThreadSocketHandler2(void* parg)
 {
     if (fDebug10) printf("ThreadSocketHandler started\n");
     list<CNode*> vNodesDisconnected;
     unsigned int nPrevNodeCount = 0;
 
+    SocketEvents events(GetSocketEventsBackend());
+    printf("Waiting for sockets with %s\n", SocketEvents::GetName(events.GetBackend()));
+    BOOST_FOREACH(SOCKET hListenSocket, vhListenSocket)
+        events.Add(hListenSocket, true);
+    SocketEventMap mapEvents;
+    bool fPendingRecv = false;
+    bool fBusyRecv = false;
+
     while (true)
     {
         //
@@ -1069,23 +1157,13 @@ void ThreadSocketHandler2(void* parg)
         //
         // Find which sockets have data to receive
         //
-        struct timeval timeout;
-        timeout.tv_sec  = 0;
-        timeout.tv_usec = 50000; // frequency to poll pnode->vSend
-
-        fd_set fdsetRecv;
-        fd_set fdsetSend;
-        fd_set fdsetError;
-        FD_ZERO(&fdsetRecv);
-        FD_ZERO(&fdsetSend);
-        FD_ZERO(&fdsetError);
-        SOCKET hSocketMax = 0;
-        bool have_fds = false;
-
-        BOOST_FOREACH(SOCKET hListenSocket, vhListenSocket) {
-            FD_SET(hListenSocket, &fdsetRecv);
-            hSocketMax = max(hSocketMax, hListenSocket);
-            have_fds = true;
+        const int nTimeoutMillis = 50; // frequency to poll pnode->vSend
+        const int nBusyTimeoutMillis = 5; // frequency to retry a node busy in ProcessMessages
+
+        if (!events.IsEdgeTriggered())
+        {
+            BOOST_FOREACH(SOCKET hListenSocket, vhListenSocket)
+                events.Watch(hListenSocket, true, false);
         }
         {
             LOCK(cs_vNodes);
@@ -1093,40 +1171,34 @@ void ThreadSocketHandler2(void* parg)
             {
                 if (pnode->hSocket == INVALID_SOCKET)
                     continue;
+                if (events.IsEdgeTriggered())
+                {
+                    // Registered once, a socket stays registered until closed
+                    if (!pnode->fSocketAdded)
+                        pnode->fSocketAdded = events.Add(pnode->hSocket, false);
+                    continue;
+                }
                 {
                     TRY_LOCK(pnode->cs_vSend, lockSend);
                     if (lockSend) {
                         // do not read, if draining write queue
-                        if (!pnode->vSendMsg.empty())
-                            FD_SET(pnode->hSocket, &fdsetSend);
-                        else
-                            FD_SET(pnode->hSocket, &fdsetRecv);
-                        FD_SET(pnode->hSocket, &fdsetError);
-                        hSocketMax = max(hSocketMax, pnode->hSocket);
-                        have_fds = true;
+                        events.Watch(pnode->hSocket, pnode->vSendMsg.empty(), !pnode->vSendMsg.empty());
                     }
                 }
             }
         }
 
         vnThreadsRunning[THREAD_SOCKETHANDLER]--;
-        int nSelect = select(have_fds ? hSocketMax + 1 : 0,
-                             &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
+        // Data left unread last time will not be reported again
+        bool fWaited = events.Wait(mapEvents, fPendingRecv ? 0 : fBusyRecv ? nBusyTimeoutMillis : nTimeoutMillis);
         vnThreadsRunning[THREAD_SOCKETHANDLER]++;
         if (fShutdown)
             return;
-        if (nSelect == SOCKET_ERROR)
+        if (!fWaited)
         {
-            if (have_fds)
-            {
-                int nErr = WSAGetLastError();
-                if (fDebug10) printf("socket select error %d\n", nErr);
-                for (unsigned int i = 0; i <= hSocketMax; i++)
-                    FD_SET(i, &fdsetRecv);
-            }
-            FD_ZERO(&fdsetSend);
-            FD_ZERO(&fdsetError);
-            MilliSleep(timeout.tv_usec/1000);
+            int nErr = WSAGetLastError();
+            if (fDebug10) printf("socket %s error %d\n", SocketEvents::GetName(events.GetBackend()), nErr);
+            MilliSleep(nTimeoutMillis);
         }
 
 
@@ -1134,7 +1206,7 @@ void ThreadSocketHandler2(void* parg)
         // Accept new connections
         //
         BOOST_FOREACH(SOCKET hListenSocket, vhListenSocket)
-        if (hListenSocket != INVALID_SOCKET && FD_ISSET(hListenSocket, &fdsetRecv))
+        if (hListenSocket != INVALID_SOCKET && mapEvents.count(hListenSocket) && mapEvents[hListenSocket].fRecv)
         {
             struct sockaddr_storage sockaddr;
             socklen_t len = sizeof(sockaddr);
@@ -1170,6 +1242,11 @@ void ThreadSocketHandler2(void* parg)
                 if (fDebug10) printf("connection from %s dropped (banned)\n", addr.ToString().c_str());
                 closesocket(hSocket);
             }
+            else if (!events.CanWatch(hSocket))
+            {
+                printf("connection from %s dropped (socket %u is too high for %s)\n", addr.ToString().c_str(), (unsigned int)hSocket, SocketEvents::GetName(events.GetBackend()));
+                closesocket(hSocket);
+            }
             else
             {
                 if (fDebug10) printf("accepted connection %s\n", addr.ToString().c_str());
@@ -1193,6 +1270,8 @@ void ThreadSocketHandler2(void* parg)
             BOOST_FOREACH(CNode* pnode, vNodesCopy)
                 pnode->AddRef();
         }
+        fPendingRecv = false;
+        fBusyRecv = false;
         BOOST_FOREACH(CNode* pnode, vNodesCopy)
         {
             if (fShutdown)
@@ -1203,7 +1282,23 @@ void ThreadSocketHandler2(void* parg)
             //
             if (pnode->hSocket == INVALID_SOCKET)
                 continue;
-            if (FD_ISSET(pnode->hSocket, &fdsetRecv) || FD_ISSET(pnode->hSocket, &fdsetError))
+            if (!events.IsEdgeTriggered())
+            {
+                // select reports every ready socket again each time
+                pnode->fHasRecvData = false;
+                pnode->fCanSendData = false;
+            }
+            SocketEventMap::const_iterator itEvent = mapEvents.find(pnode->hSocket);
+            if (itEvent != mapEvents.end())
+            {
+                if (itEvent->second.fRecv || itEvent->second.fError)
+                    pnode->fHasRecvData = true;
+                if (itEvent->second.fSend)
+                    pnode->fCanSendData = true;
+            }
+            // do not read, if draining write queue
+            bool fFilledBuffer = false;
+            if (pnode->fHasRecvData && (!events.IsEdgeTriggered() || pnode->nSendSize == 0))
             {
                 TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
                 if (lockRecv)
@@ -1219,8 +1314,16 @@ void ThreadSocketHandler2(void* parg)
                         int nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
                         if (nBytes > 0)
                         {
-                            if (!pnode->ReceiveMsgBytes(pchBuf, nBytes))
+                            // A short read emptied the socket buffer
+                            if (nBytes < (int)sizeof(pchBuf))
+                                pnode->fHasRecvData = false;
+                            else
+                                fFilledBuffer = true;
+                            bool fComplete;
+                            if (!pnode->ReceiveMsgBytes(pchBuf, nBytes, fComplete))
                                 pnode->CloseSocketDisconnect();
+                            else if (fComplete)
+                                WakeMessageHandler();
                             pnode->nLastRecv = GetAdjustedTime();
                             pnode->RecordBytesRecv(nBytes);
                         }
@@ -1237,6 +1340,8 @@ void ThreadSocketHandler2(void* parg)
                         {
                             // error
                             int nErr = WSAGetLastError();
+                            if (nErr == WSAEWOULDBLOCK)
+                                pnode->fHasRecvData = false;
                             if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
                             {
                                 if (!pnode->fDisconnect)
@@ -1249,17 +1354,39 @@ void ThreadSocketHandler2(void* parg)
                     }
                 }
             }
+            if (events.IsEdgeTriggered() && pnode->fHasRecvData && pnode->hSocket != INVALID_SOCKET && pnode->nSendSize == 0)
+            {
+                // Only a read cut off by the buffer size is sure to have more
+                // waiting. A node whose messages a worker holds may do so for
+                // as long as ConnectBlock takes, so retry it after a short wait
+                // rather than polling it without one.
+                if (fFilledBuffer)
+                    fPendingRecv = true;
+                else
+                    fBusyRecv = true;
+            }
 
             //
             // Send
             //
             if (pnode->hSocket == INVALID_SOCKET)
                 continue;
-            if (FD_ISSET(pnode->hSocket, &fdsetSend))
+            if (pnode->fCanSendData)
             {
                 TRY_LOCK(pnode->cs_vSend, lockSend);
-                if (lockSend)
+                if (lockSend && !pnode->vSendMsg.empty())
+                {
+                    // Messages are left unprocessed while the send buffer is full
+                    bool fSendBufferFull = pnode->nSendSize >= SendBufferSize();
                     SocketSendData(pnode);
+                    if (fSendBufferFull && pnode->nSendSize < SendBufferSize())
+                        WakeMessageHandler();
+
+                    // Only this thread sets or clears the flag, so a write
+                    // that would block here is sure to be reported again
+                    if (!pnode->vSendMsg.empty())
+                        pnode->fCanSendData = false;
+                }
             }
 
             //
@@ -2066,6 +2193,34 @@ bool OpenNetworkConnection(const CAddress& addrConnect, CSemaphoreGrant *grantOu
 
 
 
+bool CMessageWork::operator()()
+{
+    TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
+    if (lockRecv)
+    {
+        if (!ProcessMessages(pnode))
+            pnode->CloseSocketDisconnect();
+
+        // Messages left over while there is room to reply
+        if (!pnode->fDisconnect && !pnode->vRecvMsg.empty() && pnode->vRecvMsg.front().complete() &&
+            pnode->nSendSize < SendBufferSize())
+            *pfMoreWork = true;
+    }
+
+    // A failed check would make the queue skip the remaining nodes
+    return true;
+}
+
+static CCheckQueue<CMessageWork> messagequeue(1);
+
+void ThreadMessageWorker(void* parg)
+{
+    RenameThread("grc-msgwork");
+    vnThreadsRunning[THREAD_MESSAGEWORKER]++;
+    messagequeue.Thread();
+    vnThreadsRunning[THREAD_MESSAGEWORKER]--;
+}
+
 void ThreadMessageHandler(void* parg)
 {
     // Make this thread recognisable as the message handling thread
@@ -2087,11 +2242,17 @@ void ThreadMessageHandler(void* parg)
     printf("ThreadMessageHandler exited\n");
 }
 
+void WakeMessageHandler()
+{
+    wakeMessageHandler.Signal();
+}
+
 void ThreadMessageHandler2(void* parg)
 {
     if (fDebug10) printf("ThreadMessageHandler started\n");
     while (!fShutdown)
     {
+        bool fMoreWork = false;
         vector<CNode*> vNodesCopy;
         {
             LOCK(cs_vNodes);
@@ -2100,25 +2261,39 @@ void ThreadMessageHandler2(void* parg)
                 pnode->AddRef();
         }
 
-        // Poll the connected nodes for messages
+        // Receive messages, the nodes shared out over the message workers
+        // while this thread joins them until all are done
+        {
+            vector<char> vfMoreWork(vNodesCopy.size(), false);
+            vector<CMessageWork> vWork;
+            for (size_t i = 0; i < vNodesCopy.size(); i++)
+                if (!vNodesCopy[i]->fDisconnect)
+                    vWork.push_back(CMessageWork(vNodesCopy[i], &vfMoreWork[i]));
+
+            if (nMessageThreads)
+            {
+                CCheckQueueControl<CMessageWork> control(&messagequeue);
+                control.Add(vWork);
+                control.Wait();
+            }
+            else
+                BOOST_FOREACH(CMessageWork& work, vWork)
+                    work();
+
+            BOOST_FOREACH(char fNodeMoreWork, vfMoreWork)
+                fMoreWork |= fNodeMoreWork;
+        }
+        if (fShutdown)
+            return;
+
+        // Poll the connected nodes for messages to send
         CNode* pnodeTrickle = NULL;
         if (!vNodesCopy.empty())
             pnodeTrickle = vNodesCopy[GetRand(vNodesCopy.size())];
         BOOST_FOREACH(CNode* pnode, vNodesCopy)
         {
-
             if (pnode->fDisconnect)
                 continue;
-            //11-25-2015
-            // Receive messages
-            {
-                TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
-                if (lockRecv)
-                    if (!ProcessMessages(pnode))
-                        pnode->CloseSocketDisconnect();
-            }
-            if (fShutdown)
-                return;
 
             // Send messages
             {
@@ -2136,11 +2311,13 @@ void ThreadMessageHandler2(void* parg)
                 pnode->Release();
         }
 
-        // Wait and allow messages to bunch up.
+        // Wait for messages to arrive, or for the next round of pings and
+        // trickled inventory.
         // Reduce vnThreadsRunning so StopNode has permission to exit while
         // we're sleeping, but we must always check fShutdown after doing this.
         vnThreadsRunning[THREAD_MESSAGEHANDLER]--;
-        MilliSleep(100);
+        if (!fMoreWork)
+            wakeMessageHandler.Wait(100);
         if (fRequestShutdown)
             StartShutdown();
         vnThreadsRunning[THREAD_MESSAGEHANDLER]++;
@@ -2361,6 +2538,23 @@ void StartNode(void* parg)
     if (!NewThread(ThreadOpenConnections, NULL))
         printf("Error: NewThread(ThreadOpenConnections) failed\n");
 
+    // -msgthreads=0 means autodetect, but nMessageThreads==0 means the
+    // message handler works alone
+    nMessageThreads = GetArg("-msgthreads", 0);
+    if (nMessageThreads <= 0)
+        nMessageThreads += boost::thread::hardware_concurrency();
+    if (nMessageThreads <= 1)
+        nMessageThreads = 0;
+    else if (nMessageThreads > MAX_MESSAGE_THREADS)
+        nMessageThreads = MAX_MESSAGE_THREADS;
+    if (nMessageThreads)
+    {
+        printf("Using %d threads for message processing\n", nMessageThreads);
+        for (int i = 0; i < nMessageThreads - 1; i++)
+            if (!NewThread(ThreadMessageWorker, NULL))
+                printf("Error: NewThread(ThreadMessageWorker) failed\n");
+    }
+
     // Process messages
     if (!NewThread(ThreadMessageHandler, NULL))
         printf("Error: NewThread(ThreadMessageHandler) failed\n");
@@ -2394,6 +2588,9 @@ bool StopNode()
     if (semOutbound)
         for (int i=0; i<MAX_OUTBOUND_CONNECTIONS; i++)
             semOutbound->post();
+    WakeMessageHandler();
+    messagequeue.Interrupt();
+    InterruptScriptCheck();
     do
     {
         int nThreadsRunning = 0;
@@ -2419,6 +2616,8 @@ bool StopNode()
     if (vnThreadsRunning[THREAD_TALLY] > 0)            printf("ThreadTally still running\n");
     if (vnThreadsRunning[THREAD_SERVICES] > 0)         printf("ThreadServices still running\n");
     if (vnThreadsRunning[THREAD_STAKE_MINER] > 0)      printf("ThreadStakeMiner still running\n");
+    if (vnThreadsRunning[THREAD_SCRIPTCHECK] > 0)      printf("ThreadScriptCheck still running\n");
+    if (vnThreadsRunning[THREAD_MESSAGEWORKER] > 0)    printf("ThreadMessageWorker still running\n");
     while (vnThreadsRunning[THREAD_MESSAGEHANDLER] > 0 || vnThreadsRunning[THREAD_RPCHANDLER] > 0)
         MilliSleep(20);
     MilliSleep(50);
@@ -2471,8 +2670,9 @@ void RelayTransaction(const CTransaction& tx, const uint256& hash, const CDataSt
             vRelayExpiration.pop_front();
         }
 
-        // Save original serialized message so newer versions are preserved
-        mapRelay.insert(std::make_pair(inv, ss));
+        // Save original serialized message so newer versions are preserved,
+        // as one message shared by every node asking for it
+        mapRelay.insert(std::make_pair(inv, MakeMessage("tx", ss)));
         vRelayExpiration.push_back(std::make_pair(GetAdjustedTime() + 15 * 60, inv));
     }
 
@@ -8,6 +8,7 @@
 #include <deque>
 #include <array>
 #include <atomic>
+#include <memory>
 #include <boost/foreach.hpp>
 #include <openssl/rand.h>
 
@@ -36,6 +37,77 @@ extern int MAX_OUTBOUND_CONNECTIONS;
 
 inline unsigned int ReceiveFloodSize() { return 1000*GetArg("-maxreceivebuffer", 5*1000); }
 inline unsigned int SendBufferSize() { return 1000*GetArg("-maxsendbuffer", 1*1000); }
+/** Most threads processing peer messages, counting the message handler */
+static const int MAX_MESSAGE_THREADS = 4;
+
+/** A complete message, header included, as queued to be sent. It is not
+ *  changed once queued, so one message can be queued to many nodes, and
+ *  holds only what goes out on the wire, so it is not zeroed when freed. */
+typedef std::vector<char> CMessageData;
+typedef std::shared_ptr<const CMessageData> CMessageDataPtr;
+
+/** Serializes one message for one node straight into the buffer that gets
+ *  queued, so pushing a message does not copy it and the node keeps no send
+ *  buffer between messages. */
+class CMessageStream
+{
+protected:
+    std::shared_ptr<CMessageData> pdata;
+
+public:
+    int nType;
+    int nVersion;
+
+    CMessageStream(int nTypeIn, int nVersionIn) : nType(nTypeIn), nVersion(nVersionIn) {}
+
+    void SetType(int n)          { nType = n; }
+    int GetType()                { return nType; }
+    void SetVersion(int n)       { nVersion = n; }
+    int GetVersion()             { return nVersion; }
+
+    size_t size() const          { return pdata ? pdata->size() : 0; }
+    bool empty() const           { return size() == 0; }
+    char* begin()                { return &(*pdata)[0]; }
+    char* end()                  { return begin() + pdata->size(); }
+    char& operator[](size_t pos) { return (*pdata)[pos]; }
+
+    void reserve(size_t n)
+    {
+        if (!pdata)
+            pdata = std::make_shared<CMessageData>();
+        pdata->reserve(n);
+    }
+
+    void clear()                 { pdata.reset(); }
+
+    CMessageStream& write(const char* pch, int nSize)
+    {
+        assert(nSize >= 0);
+        if (!pdata)
+            pdata = std::make_shared<CMessageData>();
+        pdata->insert(pdata->end(), pch, pch + nSize);
+        return (*this);
+    }
+
+    template<typename T>
+    CMessageStream& operator<<(const T& obj)
+    {
+        ::Serialize(*this, obj, nType, nVersion);
+        return (*this);
+    }
+
+    // Hand over the message, leaving the stream empty
+    CMessageDataPtr Release()
+    {
+        CMessageDataPtr message = pdata;
+        pdata.reset();
+        return message;
+    }
+};
+
+/** Serialize a message once, to be queued to any number of nodes by
+ *  CNode::PushMessageData. */
+CMessageDataPtr MakeMessage(const char* pszCommand, const CDataStream& ssPayload);
 
 void AddOneShot(std::string strDest);
 bool RecvLine(SOCKET hSocket, std::string& strLine);
@@ -50,6 +122,7 @@ bool BindListenPort(const CService &bindAddr, std::string& strError=REF(std::str
 void StartNode(void* parg);
 bool StopNode();
 void SocketSendData(CNode *pnode);
+void WakeMessageHandler();
 extern std::vector<CNode*> vNodes;
 extern CCriticalSection cs_vNodes;
 
@@ -122,6 +195,8 @@ enum threadId
     THREAD_STAKE_MINER,
 	THREAD_TALLY,
 	THREAD_SERVICES,
+    THREAD_SCRIPTCHECK,
+    THREAD_MESSAGEWORKER,
     THREAD_MAX
 };
 
@@ -132,7 +207,7 @@ extern uint64_t nLocalHostNonce;
 extern CAddress addrSeenByPeer;
 extern std::array<int, THREAD_MAX> vnThreadsRunning;
 extern CAddrMan addrman;
-extern std::map<CInv, CDataStream> mapRelay;
+extern std::map<CInv, CMessageDataPtr> mapRelay;
 extern std::deque<std::pair<int64_t, CInv> > vRelayExpiration;
 extern CCriticalSection cs_mapRelay;
 extern std::map<CInv, int64_t> mapAlreadyAskedFor;
@@ -218,10 +293,10 @@ public:
     // socket
     uint64_t nServices;
     SOCKET hSocket;
-    CDataStream ssSend;
+    CMessageStream ssSend;
     size_t nSendSize; // total size of all vSendMsg entries
     size_t nSendOffset; // offset inside the first vSendMsg already sent
-    std::deque<CSerializeData> vSendMsg;
+    std::deque<CMessageDataPtr> vSendMsg;
     CCriticalSection cs_vSend;
 
     std::deque<CNetMessage> vRecvMsg;
@@ -260,6 +335,11 @@ public:
     bool fNetworkNode;
     bool fSuccessfullyConnected;
     bool fDisconnect;
+    // Readiness of the socket, kept by the socket handler until a read or
+    // write would block, since edge triggered waits only report changes
+    bool fSocketAdded;
+    bool fHasRecvData;
+    bool fCanSendData;
     CSemaphoreGrant grantOutbound;
     int nRefCount;
 protected:
@@ -279,8 +359,11 @@ public:
     int nStartingHeight;
 
     // flood relay
+    // The message workers of other nodes relay addresses to this one, so
+    // the queued and known addresses are guarded by cs_addr
     std::vector<CAddress> vAddrToSend;
     mruset<CAddress> setAddrKnown;
+    CCriticalSection cs_addr;
     bool fGetAddr;
     std::set<uint256> setKnown;
     uint256 hashCheckpointKnown; // ppcoin: known sent sync-checkpoint
@@ -320,6 +403,9 @@ public:
         fNetworkNode = false;
         fSuccessfullyConnected = false;
         fDisconnect = false;
+        fSocketAdded = false;
+        fHasRecvData = false;
+        fCanSendData = false;
         nRefCount = 0;
         nSendSize = 0;
         nSendOffset = 0;
@@ -387,7 +473,8 @@ public:
     }
 
     // requires LOCK(cs_vRecvMsg)
-    bool ReceiveMsgBytes(const char *pch, unsigned int nBytes);
+    // fComplete is set when a message was completed
+    bool ReceiveMsgBytes(const char *pch, unsigned int nBytes, bool& fComplete);
 
     // requires LOCK(cs_vRecvMsg)
     void SetRecvVersion(int nVersionIn)
@@ -412,7 +499,10 @@ public:
 
     void AddAddressKnown(const CAddress& addr)
     {
-        setAddrKnown.insert(addr);
+        {
+            LOCK(cs_addr);
+            setAddrKnown.insert(addr);
+        }
     }
 
     void PushAddress(const CAddress& addr)
@@ -420,8 +510,11 @@ public:
         // Known checking here is only to save space from duplicates.
         // SendMessages will filter it again for knowns that were added
         // after addresses were pushed.
-        if (addr.IsValid() && !setAddrKnown.count(addr))
-            vAddrToSend.push_back(addr);
+        {
+            LOCK(cs_addr);
+            if (addr.IsValid() && !setAddrKnown.count(addr))
+                vAddrToSend.push_back(addr);
+        }
     }
 
 
@@ -462,10 +555,11 @@ public:
         mapAskFor.insert(std::make_pair(nRequestTime, inv));
     }
 
-    void BeginMessage(const char* pszCommand)
+    void BeginMessage(const char* pszCommand, unsigned int nPayloadSize = 0)
     {
         ENTER_CRITICAL_SECTION(cs_vSend);
         assert(ssSend.size() == 0);
+        ssSend.reserve(CMessageHeader::HEADER_SIZE + nPayloadSize);
         ssSend << CMessageHeader(pszCommand, 0);
     }
 
@@ -507,15 +601,28 @@ public:
             printf("(%d bytes)\n", nSize);
         }
 
-        std::deque<CSerializeData>::iterator it = vSendMsg.insert(vSendMsg.end(), CSerializeData());
-        ssSend.GetAndClear(*it);
-        nSendSize += (*it).size();
+        QueueMessage(ssSend.Release());
+
+        LEAVE_CRITICAL_SECTION(cs_vSend);
+    }
+
+    // Queue a message built by MakeMessage, sharing its buffer with the
+    // other nodes it is queued to
+    void PushMessageData(const CMessageDataPtr& message)
+    {
+        LOCK(cs_vSend);
+        QueueMessage(message);
+    }
+
+    // requires LOCK(cs_vSend)
+    void QueueMessage(const CMessageDataPtr& message)
+    {
+        vSendMsg.push_back(message);
+        nSendSize += message->size();
 
         // If write queue empty, attempt "optimistic write"
-        if (it == vSendMsg.begin())
+        if (vSendMsg.size() == 1)
             SocketSendData(this);
-
-        LEAVE_CRITICAL_SECTION(cs_vSend);
     }
 
     void PushVersion();
@@ -547,12 +654,24 @@ public:
         }
     }
     
+    template<typename T>
+    unsigned int GetFieldsSize(const T& field)
+    {
+        return ::GetSerializeSize(field, ssSend.nType, ssSend.nVersion);
+    }
+
+    template<typename T, typename... Tfields>
+    unsigned int GetFieldsSize(const T& field, const Tfields&... fields)
+    {
+        return GetFieldsSize(field) + GetFieldsSize(fields...);
+    }
+
     template<typename... Args>
     void PushMessage(const char* pszCommand, Args... args)
     {
         try
         {
-            BeginMessage(pszCommand);
+            BeginMessage(pszCommand, GetFieldsSize(args...));
             PushFields(args...);
             EndMessage();
         }
@@ -656,6 +775,28 @@ inline void RelayInventory(const CInv& inv)
     }
 }
 
+// Processes the received messages of one node on the message worker pool.
+// A node is handed to one worker at a time, so its messages keep their
+// order, and verifying checksums is spread over the workers as well.
+class CMessageWork
+{
+private:
+    CNode* pnode;
+    char* pfMoreWork;
+
+public:
+    CMessageWork() : pnode(NULL), pfMoreWork(NULL) {}
+    CMessageWork(CNode* pnodeIn, char* pfMoreWorkIn) : pnode(pnodeIn), pfMoreWork(pfMoreWorkIn) {}
+
+    bool operator()();
+
+    void swap(CMessageWork& work)
+    {
+        std::swap(pnode, work.pnode);
+        std::swap(pfMoreWork, work.pfMoreWork);
+    }
+};
+
 class CTransaction;
 void RelayTransaction(const CTransaction& tx, const uint256& hash);
 void RelayTransaction(const CTransaction& tx, const uint256& hash, const CDataStream& ss);
@@ -49,6 +49,7 @@
 #include "init.h"
 #include "block.h"
 #include "miner.h"
+#include "xmlview.h"
 
 #ifdef Q_OS_MAC
 #include "macdockiconhandler.h"
@@ -114,7 +115,6 @@ std::string ExecuteRPCCommand(std::string method, std::string arg1, std::string
 std::string ExecuteRPCCommand(std::string method, std::string arg1, std::string arg2, std::string arg3, std::string arg4, std::string arg5);
 std::string ExecuteRPCCommand(std::string method, std::string arg1, std::string arg2, std::string arg3, std::string arg4, std::string arg5, std::string arg6);
 
-std::string ExtractXML(std::string XMLdata, std::string key, std::string key_end);
 
 extern std::string qtGetNeuralHash(std::string data);
 extern std::string qtGetNeuralContract(std::string data);
@@ -9,6 +9,7 @@
 #include "base58.h"
 #include "bitcoingui.h"
 #include "util.h"
+#include "xmlview.h"
 
 #include <QInputDialog>
 #include <QPushButton>
@@ -17,7 +18,6 @@
 
 std::string GetTxProject(uint256 hash, int& out_blocknumber, int& out_blocktype, double& out_rac);
 std::string GetTxProject(uint256 hash, int& out_blocknumber, int& out_blocktype, int& out_rac);
-extern std::string ExtractXML(std::string XMLdata, std::string key, std::string key_end);
 
 QString ToQString(std::string s)
 {
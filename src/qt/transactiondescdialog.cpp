@@ -2,12 +2,12 @@
 #include "ui_transactiondescdialog.h"
 #include "main.h"
 #include "util.h"
+#include "xmlview.h"
 #include "transactiontablemodel.h"
 #include <QMessageBox>
 #include <QModelIndex>
 
 void ExecuteCode();
-extern std::string ExtractXML(std::string XMLdata, std::string key, std::string key_end);
 QString ToQString(std::string s);
 std::string qtExecuteDotNetStringFunction(std::string function, std::string data);
 
@@ -0,0 +1,275 @@
+#include "researcher.h"
+#include "main.h"
+#include "block.h"
+
+#include <limits>
+
+ResearcherTotals researcherTotals;
+
+ResearcherTotals::Entry::Entry()
+    : research(0)
+    , interest(0)
+    , magnitude(0)
+    , nLowLockTime(std::numeric_limits<uint32_t>::max())
+    , nHighLockTime(0)
+    , pindexLastPaid(nullptr)
+    , fHasMagnitude(false)
+    , hashLastMagnitude(0)
+    , nTrailingZeroMagnitude(0)
+{
+}
+
+void ResearcherTotals::Accumulate(Entry& entry, CBlockIndex* pindex)
+{
+    entry.research += pindex->nResearchSubsidy;
+    entry.interest += pindex->nInterestSubsidy;
+    if (pindex->nResearchSubsidy > 0 &&
+        (entry.pindexLastPaid == nullptr || pindex->nHeight > entry.pindexLastPaid->nHeight))
+        entry.pindexLastPaid = pindex;
+
+    if (pindex->nTime < entry.nLowLockTime)  entry.nLowLockTime  = pindex->nTime;
+    if (pindex->nTime > entry.nHighLockTime) entry.nHighLockTime = pindex->nTime;
+
+    // The average magnitude has always been taken at the last block with a
+    // magnitude when walking the blocks in hash order, which leaves out the
+    // zero magnitude blocks sorting after it. Track how many of those there
+    // are. A recount is only needed when a new block sorts last, which for
+    // random hashes becomes rarer the more blocks a CPID has.
+    const uint256 hash = pindex->GetBlockHash();
+    if (pindex->nMagnitude > 0)
+    {
+        entry.magnitude += pindex->nMagnitude;
+        if (!entry.fHasMagnitude || entry.hashLastMagnitude < hash)
+        {
+            entry.fHasMagnitude = true;
+            entry.hashLastMagnitude = hash;
+            entry.nTrailingZeroMagnitude = 0;
+            for (CBlockIndex* pblock : entry.blocks)
+                if (pblock->nMagnitude <= 0 && hash < pblock->GetBlockHash())
+                    ++entry.nTrailingZeroMagnitude;
+        }
+    }
+    else if (entry.fHasMagnitude && entry.hashLastMagnitude < hash)
+        ++entry.nTrailingZeroMagnitude;
+}
+
+void ResearcherTotals::Add(CBlockIndex* pindex)
+{
+    if (!pindex->IsUserCPID())
+        return;
+
+    LOCK(cs);
+    Entry& entry = researchers[pindex->GetCPID()];
+    if (!entry.blocks.empty() && entry.blocks.back()->nHeight >= pindex->nHeight)
+        return;
+
+    entry.blocks.push_back(pindex);
+    Accumulate(entry, pindex);
+}
+
+void ResearcherTotals::Remove(CBlockIndex* pindex)
+{
+    if (!pindex->IsUserCPID())
+        return;
+
+    LOCK(cs);
+    auto it = researchers.find(pindex->GetCPID());
+    if (it == researchers.end() || it->second.blocks.back() != pindex)
+        return;
+
+    // Blocks only leave during reorganizations, so simply recount the rest
+    std::vector<CBlockIndex*> blocks;
+    blocks.swap(it->second.blocks);
+    blocks.pop_back();
+    if (blocks.empty())
+    {
+        researchers.erase(it);
+        return;
+    }
+
+    Entry& entry = it->second;
+    entry = Entry();
+    for (CBlockIndex* pblock : blocks)
+    {
+        Accumulate(entry, pblock);
+        entry.blocks.push_back(pblock);
+    }
+}
+
+void ResearcherTotals::SetTip(CBlockIndex* pindexOld, CBlockIndex* pindexNew)
+{
+    std::vector<CBlockIndex*> connect;
+    while (pindexOld != pindexNew)
+    {
+        if (pindexOld && (!pindexNew || pindexOld->nHeight >= pindexNew->nHeight))
+        {
+            Remove(pindexOld);
+            pindexOld = pindexOld->pprev;
+        }
+        else
+        {
+            connect.push_back(pindexNew);
+            pindexNew = pindexNew->pprev;
+        }
+    }
+
+    for (auto it = connect.rbegin(); it != connect.rend(); ++it)
+        Add(*it);
+}
+
+void ResearcherTotals::Get(const std::string& cpid, StructCPID& stCPID) const
+{
+    static const Entry empty;
+
+    LOCK(cs);
+    auto it = researchers.find(cpid);
+    const Entry& entry = it != researchers.end() ? it->second : empty;
+
+    stCPID.LastBlock = entry.pindexLastPaid ? entry.pindexLastPaid->nHeight : 0;
+    stCPID.BlockHash = entry.pindexLastPaid ? entry.pindexLastPaid->GetBlockHash().GetHex() : "";
+    stCPID.InterestSubsidy = entry.interest;
+    stCPID.ResearchSubsidy = entry.research;
+    stCPID.Accuracy = entry.blocks.size();
+    stCPID.LowLockTime = entry.nLowLockTime;
+    stCPID.HighLockTime = entry.nHighLockTime;
+    stCPID.TotalMagnitude = entry.magnitude;
+    stCPID.ResearchAverageMagnitude = entry.fHasMagnitude
+        ? entry.magnitude / ((entry.blocks.size() - entry.nTrailingZeroMagnitude) + .01)
+        : 0;
+}
+
+std::map<std::string, std::vector<int>> ResearcherTotals::GetHeights() const
+{
+    std::map<std::string, std::vector<int>> heights;
+
+    LOCK(cs);
+    for (const auto& researcher : researchers)
+    {
+        std::vector<int>& vHeights = heights[researcher.first];
+        vHeights.reserve(researcher.second.blocks.size());
+        for (const CBlockIndex* pindex : researcher.second.blocks)
+            vHeights.push_back(pindex->nHeight);
+    }
+
+    return heights;
+}
+
+void ResearcherTotals::Clear()
+{
+    LOCK(cs);
+    researchers.clear();
+}
+
+void CountResearchAge(CBlockIndex* pindex, std::map<std::string, StructCPID>& mvResearchAgeRet, ResearcherTotals& totalsRet)
+{
+    if (pindex->nResearchSubsidy <= 0 || !pindex->IsUserCPID())
+        return;
+
+    const std::string& scpid = pindex->GetCPID();
+    StructCPID stCPID = GetInitializedStructCPID2(scpid, mvResearchAgeRet);
+
+    stCPID.InterestSubsidy += pindex->nInterestSubsidy;
+    stCPID.ResearchSubsidy += pindex->nResearchSubsidy;
+    if (pindex->nHeight > stCPID.LastBlock)
+    {
+        stCPID.LastBlock = pindex->nHeight;
+        stCPID.BlockHash = pindex->GetBlockHash().GetHex();
+    }
+
+    if (pindex->nMagnitude > 0)
+    {
+        stCPID.Accuracy++;
+        stCPID.TotalMagnitude += pindex->nMagnitude;
+        stCPID.ResearchAverageMagnitude = stCPID.TotalMagnitude/(stCPID.Accuracy+.01);
+    }
+
+    if (pindex->nTime < stCPID.LowLockTime)  stCPID.LowLockTime = pindex->nTime;
+    if (pindex->nTime > stCPID.HighLockTime) stCPID.HighLockTime = pindex->nTime;
+
+    // Store the updated struct.
+    mvResearchAgeRet[scpid] = stCPID;
+    totalsRet.Add(pindex);
+}
+
+ResearchAgeSnapshot::Record::Record()
+{
+}
+
+ResearchAgeSnapshot::Record::Record(const StructCPID& stCPID)
+    : InterestSubsidy(stCPID.InterestSubsidy)
+    , ResearchSubsidy(stCPID.ResearchSubsidy)
+    , LastBlock(stCPID.LastBlock)
+    , BlockHash(stCPID.BlockHash)
+    , Accuracy(stCPID.Accuracy)
+    , TotalMagnitude(stCPID.TotalMagnitude)
+    , ResearchAverageMagnitude(stCPID.ResearchAverageMagnitude)
+    , LowLockTime(stCPID.LowLockTime)
+    , HighLockTime(stCPID.HighLockTime)
+{
+}
+
+void ResearchAgeSnapshot::Record::Restore(StructCPID& stCPID) const
+{
+    stCPID.InterestSubsidy = InterestSubsidy;
+    stCPID.ResearchSubsidy = ResearchSubsidy;
+    stCPID.LastBlock = LastBlock;
+    stCPID.BlockHash = BlockHash;
+    stCPID.Accuracy = Accuracy;
+    stCPID.TotalMagnitude = TotalMagnitude;
+    stCPID.ResearchAverageMagnitude = ResearchAverageMagnitude;
+    stCPID.LowLockTime = LowLockTime;
+    stCPID.HighLockTime = HighLockTime;
+}
+
+void ResearchAgeSnapshot::Count(const ActiveChain& chain)
+{
+    std::map<std::string, StructCPID> mvCounted;
+    ResearcherTotals totals;
+
+    const int nTip = chain.Height();
+    if (nTip > 10)
+        for (int nHeight = 2; nHeight < nTip; ++nHeight)
+            CountResearchAge(chain[nHeight], mvCounted, totals);
+
+    mapResearchAge.clear();
+    for (const auto& item : mvCounted)
+        if (item.second.initialized)
+            mapResearchAge[item.first] = Record(item.second);
+    mapHeights = totals.GetHeights();
+}
+
+bool ResearchAgeSnapshot::Restore(const ActiveChain& chain, std::map<std::string, StructCPID>& mvResearchAgeRet, ResearcherTotals& totalsRet) const
+{
+    // Find every counted block before changing anything
+    std::vector<CBlockIndex*> vCounted;
+    for (const auto& researcher : mapHeights)
+    {
+        for (int nHeight : researcher.second)
+        {
+            CBlockIndex* pindex = chain[nHeight];
+            if (!pindex || pindex->GetCPID() != researcher.first)
+                return false;
+            vCounted.push_back(pindex);
+        }
+    }
+
+    for (const auto& record : mapResearchAge)
+    {
+        CBlockIndex* pindex = chain[record.second.LastBlock];
+        if (!record.second.BlockHash.empty() &&
+            (!pindex || pindex->GetBlockHash().GetHex() != record.second.BlockHash))
+            return false;
+    }
+
+    for (CBlockIndex* pindex : vCounted)
+        totalsRet.Add(pindex);
+
+    for (const auto& record : mapResearchAge)
+    {
+        StructCPID stCPID = GetInitializedStructCPID2(record.first, mvResearchAgeRet);
+        record.second.Restore(stCPID);
+        mvResearchAgeRet[record.first] = stCPID;
+    }
+
+    return true;
+}
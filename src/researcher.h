@@ -0,0 +1,193 @@
+#pragma once
+
+#include "fwd.h"
+#include "serialize.h"
+#include "sync.h"
+#include "uint256.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//!
+//! \brief Lifetime research totals per CPID.
+//!
+//! Totals are updated as blocks join and leave the main chain, so querying
+//! the lifetime statistics of a researcher no longer needs a walk over all
+//! the blocks they ever staked.
+//!
+class ResearcherTotals
+{
+public:
+    //!
+    //! \brief Count a main chain block towards its CPID.
+    //!
+    //! Blocks of a CPID must be added in ascending height order. Blocks
+    //! without a researcher CPID are ignored.
+    //!
+    //! \param pindex Block to count.
+    //!
+    void Add(CBlockIndex* pindex);
+
+    //!
+    //! \brief Stop counting a block which left the main chain.
+    //!
+    //! Only the most recent block of a CPID can be removed. Blocks which
+    //! were never counted are ignored.
+    //!
+    //! \param pindex Block to remove.
+    //!
+    void Remove(CBlockIndex* pindex);
+
+    //!
+    //! \brief Move the counted chain from one tip to another.
+    //!
+    //! Removes the blocks from \p pindexOld back to the fork point and adds
+    //! the blocks from the fork point up to \p pindexNew.
+    //!
+    //! \param pindexOld Previous chain tip, or \a nullptr.
+    //! \param pindexNew New chain tip.
+    //!
+    void SetTip(CBlockIndex* pindexOld, CBlockIndex* pindexNew);
+
+    //!
+    //! \brief Get the lifetime totals of a CPID.
+    //!
+    //! Overwrites the lifetime fields of \p stCPID (subsidies, magnitudes,
+    //! lock times and last paid block) and leaves the others untouched.
+    //!
+    //! \param cpid CPID to look up.
+    //! \param stCPID Destination for the totals. Totals of a CPID without
+    //! blocks are zero.
+    //!
+    void Get(const std::string& cpid, StructCPID& stCPID) const;
+
+    //!
+    //! \brief Get the heights of the counted blocks of every CPID.
+    //!
+    //! Counted blocks are all in the main chain, so the heights are enough
+    //! to count the same blocks again with \a Add.
+    //!
+    //! \return Heights of the counted blocks by CPID, in the order they
+    //! were added.
+    //!
+    std::map<std::string, std::vector<int>> GetHeights() const;
+
+    //!
+    //! \brief Forget all counted blocks.
+    //!
+    void Clear();
+
+private:
+    struct Entry
+    {
+        Entry();
+
+        std::vector<CBlockIndex*> blocks;
+        double research;
+        double interest;
+        double magnitude;
+        uint32_t nLowLockTime;
+        uint32_t nHighLockTime;
+        CBlockIndex* pindexLastPaid;
+        bool fHasMagnitude;
+        uint256 hashLastMagnitude;
+        unsigned int nTrailingZeroMagnitude;
+    };
+
+    static void Accumulate(Entry& entry, CBlockIndex* pindex);
+
+    mutable CCriticalSection cs;
+    std::unordered_map<std::string, Entry> researchers;
+};
+
+extern ResearcherTotals researcherTotals;
+
+class ActiveChain;
+
+//!
+//! \brief Count a main chain block towards the research age of its CPID.
+//!
+//! This is how the research age is set up at startup. Blocks without a
+//! research subsidy or a researcher CPID are ignored.
+//!
+//! \param pindex Block to count.
+//! \param mvResearchAgeRet Lifetime fields by CPID to update.
+//! \param totalsRet Totals to count the block in.
+//!
+void CountResearchAge(CBlockIndex* pindex, std::map<std::string, StructCPID>& mvResearchAgeRet, ResearcherTotals& totalsRet);
+
+//!
+//! \brief Research age of the main chain, kept between runs.
+//!
+//! Holds the same state as a start without a snapshot counts, so whether a
+//! node reused it does not change what research age lookups see.
+//!
+class ResearchAgeSnapshot
+{
+public:
+    //!
+    //! \brief Count the research age of a chain.
+    //!
+    //! Counts the blocks from height 2 up to, but not including, the tip,
+    //! and nothing for chains of ten blocks or less, as \a LoadBlockIndex
+    //! does without a snapshot.
+    //!
+    //! \param chain Main chain to count.
+    //!
+    void Count(const ActiveChain& chain);
+
+    //!
+    //! \brief Restore the research age of a chain.
+    //!
+    //! \param chain Main chain the snapshot was counted from.
+    //! \param mvResearchAgeRet Lifetime fields by CPID to restore.
+    //! \param totalsRet Totals to count the blocks in.
+    //! \return \c false, with nothing changed, if a counted block is not in
+    //! \p chain or belongs to another CPID.
+    //!
+    bool Restore(const ActiveChain& chain, std::map<std::string, StructCPID>& mvResearchAgeRet, ResearcherTotals& totalsRet) const;
+
+    IMPLEMENT_SERIALIZE
+    (
+        READWRITE(mapResearchAge);
+        READWRITE(mapHeights);
+    )
+
+private:
+    // Lifetime research fields of a CPID in mvResearchAge
+    struct Record
+    {
+        double InterestSubsidy;
+        double ResearchSubsidy;
+        int LastBlock;
+        std::string BlockHash;
+        double Accuracy;
+        double TotalMagnitude;
+        double ResearchAverageMagnitude;
+        unsigned int LowLockTime;
+        unsigned int HighLockTime;
+
+        Record();
+        explicit Record(const StructCPID& stCPID);
+        void Restore(StructCPID& stCPID) const;
+
+        IMPLEMENT_SERIALIZE
+        (
+            READWRITE(InterestSubsidy);
+            READWRITE(ResearchSubsidy);
+            READWRITE(LastBlock);
+            READWRITE(BlockHash);
+            READWRITE(Accuracy);
+            READWRITE(TotalMagnitude);
+            READWRITE(ResearchAverageMagnitude);
+            READWRITE(LowLockTime);
+            READWRITE(HighLockTime);
+        )
+    };
+
+    std::map<std::string, Record> mapResearchAge;
+    std::map<std::string, std::vector<int>> mapHeights;
+};
@@ -9,8 +9,13 @@
 #include "kernel.h"
 #include "init.h" // for pwalletMain
 #include "block.h"
+#include "boincblock.h"
+#include "superblock.h"
+#include "appcache.h"
+#include "voting.h"
 #include "txdb.h"
 #include "beacon.h"
+#include "xmlview.h"
 #include "util.h"
 
 #include <boost/filesystem.hpp>
@@ -54,7 +59,6 @@ extern std::string ExtractValue(std::string data, std::string delimiter, int pos
 extern Array SuperblockReport(std::string cpid);
 bool IsSuperBlock(CBlockIndex* pIndex);
 MiningCPID GetBoincBlockByIndex(CBlockIndex* pblockindex);
-extern double GetSuperblockMagnitudeByCPID(std::string data, std::string cpid);
 extern bool VerifyCPIDSignature(std::string sCPID, std::string sBlockHash, std::string sSignature);
 bool NeedASuperblock();
 double ExtractMagnitudeFromExplainMagnitude();
@@ -66,13 +70,11 @@ extern Array LifetimeReport(std::string cpid);
 Array StakingReport();
 extern std::string AddContract(std::string sType, std::string sName, std::string sContract);
 StructCPID GetLifetimeCPID(const std::string& cpid, const std::string& sFrom);
-void WriteCache(std::string section, std::string key, std::string value, int64_t locktime);
 int64_t GetEarliestWalletTransaction();
 extern bool CheckMessageSignature(std::string sAction,std::string messagetype, std::string sMsg, std::string sSig, std::string opt_pubkey);
 bool LoadAdminMessages(bool bFullTableScan,std::string& out_errors);
 int64_t GetMaximumBoincSubsidy(int64_t nTime);
 double GRCMagnitudeUnit(int64_t locktime);
-std::string ExtractXML(std::string XMLdata, std::string key, std::string key_end);
 std::string ExtractHTML(std::string HTMLdata, std::string tagstartprefix,  std::string tagstart_suffix, std::string tag_end);
 std::string NeuralRequest(std::string MyNeuralRequest);
 extern bool AdvertiseBeacon(bool bFromService, std::string &sOutPrivKey, std::string &sOutPubKey, std::string &sError, std::string &sMessage);
@@ -132,7 +134,6 @@ extern bool TallyMagnitudesInSuperblock();
 double GetTotalBalance();
 
 std::string strReplace(std::string& str, const std::string& oldStr, const std::string& newStr);
-std::string ReadCache(std::string section, std::string key);
 MiningCPID GetNextProject(bool bForce);
 std::string SerializeBoincBlock(MiningCPID mcpid);
 extern std::string TimestampToHRDate(double dtm);
@@ -546,14 +547,11 @@ Value getblockbynumber(const Array& params, bool fHelp)
     if (nHeight < 0 || nHeight > nBestHeight)
         throw runtime_error("Block number out of range.");
 
-    CBlock block;
-    CBlockIndex* pblockindex = mapBlockIndex[hashBestChain];
-    while (pblockindex->nHeight > nHeight)
-        pblockindex = pblockindex->pprev;
-
-    uint256 hash = *pblockindex->phashBlock;
+    CBlockIndex* pblockindex = activeChain[nHeight];
+    if (pblockindex == NULL)
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
 
-    pblockindex = mapBlockIndex[hash];
+    CBlock block;
     block.ReadFromDisk(pblockindex, true);
 
     return blockToJSON(block, pblockindex, params.size() > 1 ? params[1].get_bool() : false);
@@ -862,33 +860,11 @@ double GetAverageInList(std::string superblock,double& out_count)
 
 
 
-double GetSuperblockMagnitudeByCPID(std::string data, std::string cpid)
+double GetSuperblockMagnitudeByCPID(const Superblock& superblock, const std::string& cpid)
 {
-        std::string mags = ExtractXML(data,"<MAGNITUDES>","</MAGNITUDES>");
-        std::vector<std::string> vSuperblock = split(mags.c_str(),";");
-        if  (vSuperblock.size() < 2) return -2;
+        if  (superblock.empty()) return -2;
         if  (cpid.length() < 31) return -3;
-        for (unsigned int i = 0; i < vSuperblock.size(); i++)
-        {
-            // For each CPID in the contract
-            printf(".");
-            if (vSuperblock[i].length() > 1)
-            {
-                std::string sTempCPID = ExtractValue(vSuperblock[i],",",0);
-                double magnitude = cdbl(ExtractValue("0"+vSuperblock[i],",",1),0);
-                boost::to_lower(sTempCPID);
-                boost::to_lower(cpid);
-                // For each CPID in the contract
-                if (sTempCPID.length() > 31 && cpid.length() > 31)
-                {
-                    if (sTempCPID.substr(0,31) == cpid.substr(0,31))
-                    {
-                        return magnitude;
-                    }
-                }
-            }
-        }
-        return -1;
+        return superblock.GetMagnitude(cpid);
 }
 
 
@@ -906,8 +882,9 @@ double GetSuperblockAvgMag(std::string data,double& out_beacon_count,double& out
 {
     try
     {
-        std::string mags = ExtractXML(data,"<MAGNITUDES>","</MAGNITUDES>");
-        std::string avgs = ExtractXML(data,"<AVERAGES>","</AVERAGES>");
+        const XMLView sections(data, {"MAGNITUDES", "AVERAGES"});
+        std::string mags = sections.GetString(0);
+        std::string avgs = sections.GetString(1);
         double mag_count = 0;
         double avg_count = 0;
         if (mags.empty()) return 0;
@@ -1081,21 +1058,18 @@ double GetCountOf(std::string datatype)
 std::string GetListOf(std::string datatype)
 {
     std::string rows;
-    for(const auto& item : mvApplicationCache)
+    for(const auto& item : ReadCacheSection(datatype))
     {
         const std::string& key_name = item.first;
-        if (boost::algorithm::starts_with(key_name, datatype))
-        {
-            const std::string& key_value = item.second;
-            const std::string& subkey = key_name.substr(datatype.length()+1,key_name.length()-datatype.length()-1);
-            std::string row = subkey + "<COL>" + key_value;
+        const std::string& subkey = key_name.substr(datatype.length()+1,key_name.length()-datatype.length()-1);
+        const std::string& key_value = item.second.value;
+        std::string row = subkey + "<COL>" + key_value;
 
-            if (datatype=="beacon" && Contains(row,"INVESTOR"))
-                continue;
+        if (datatype=="beacon" && Contains(row,"INVESTOR"))
+            continue;
 
-            if (!row.empty())
-                rows += row + "<ROW>";
-        }
+        if (!row.empty())
+            rows += row + "<ROW>";
     }
 
     return rows;
@@ -1109,26 +1083,19 @@ std::string GetListOfWithConsensus(std::string datatype)
        int64_t nLookback = 30 * 6 * 86400; 
        int64_t iStartTime = (iEndTime - nLookback) - ( (iEndTime - nLookback) % BLOCK_GRANULARITY);
        printf(" getlistofwithconsensus startime %f , endtime %f, lookback %f \r\n ",(double)iStartTime,(double)iEndTime, (double)nLookback);
-	   for(map<string,string>::iterator ii=mvApplicationCache.begin(); ii!=mvApplicationCache.end(); ++ii) 
+       for(const auto& item : ReadCacheSection(datatype))
        {
-             std::string key_name  = (*ii).first;
-             if (key_name.length() > datatype.length())
+             int64_t iBeaconTimestamp = item.second.timestamp;
+             if (iBeaconTimestamp > iStartTime && iBeaconTimestamp < iEndTime)
              {
-                 if (key_name.substr(0,datatype.length())==datatype)
+                 const std::string& key_name = item.first;
+                 std::string subkey = key_name.substr(datatype.length()+1,key_name.length()-datatype.length()-1);
+                 row = subkey + "<COL>" + item.second.value;
+                 if (Contains(row,"INVESTOR") && datatype=="beacon") row = "";
+                 if (row != "")
                  {
- 			           int64_t iBeaconTimestamp = mvApplicationCacheTimestamp[(*ii).first];
-				       if (iBeaconTimestamp > iStartTime && iBeaconTimestamp < iEndTime)
-					   {		
-							std::string key_value = mvApplicationCache[(*ii).first];
-							std::string subkey = key_name.substr(datatype.length()+1,key_name.length()-datatype.length()-1);
-							row = subkey + "<COL>" + key_value;
-							if (Contains(row,"INVESTOR") && datatype=="beacon") row = "";
-							if (row != "")
-							{
-								rows += row + "<ROW>";
-							}
-						}
-                  }
+                     rows += row + "<ROW>";
+                 }
              }
        }
        return rows;
@@ -1805,11 +1772,11 @@ Value execute(const Array& params, bool fHelp)
     }
     else if (sItem == "superblockage")
     {
-        int64_t superblock_age = GetAdjustedTime() - mvApplicationCacheTimestamp["superblock;magnitudes"];
+        int64_t superblock_age = GetAdjustedTime() - ReadCacheTimestamp("superblock","magnitudes");
         entry.push_back(Pair("Superblock Age",superblock_age));
-        std::string timestamp = TimestampToHRDate(mvApplicationCacheTimestamp["superblock;magnitudes"]);
+        std::string timestamp = TimestampToHRDate(ReadCacheTimestamp("superblock","magnitudes"));
         entry.push_back(Pair("Superblock Timestamp",timestamp));
-        entry.push_back(Pair("Superblock Block Number",mvApplicationCache["superblock;block_number"]));
+        entry.push_back(Pair("Superblock Block Number",ReadCache("superblock","block_number")));
         double height = cdbl(ReadCache("neuralsecurity","pending"),0);
         entry.push_back(Pair("Pending Superblock Height",height));
         results.push_back(entry);
@@ -1984,8 +1951,8 @@ Value execute(const Array& params, bool fHelp)
                                 std::string cpid1 = GlobalCPUMiningCPID.cpid;
                                 std::string GRCAddress1 = DefaultWalletAddress();
                                 GetEarliestStakeTime(GRCAddress1,cpid1);
-                                int64_t nGRCTime = mvApplicationCacheTimestamp["nGRCTime"];
-                                int64_t nCPIDTime = mvApplicationCacheTimestamp["nCPIDTime"];
+                                int64_t nGRCTime = nEarliestGRCTime;
+                                int64_t nCPIDTime = nEarliestCPIDTime;
                                 double cpid_age = GetAdjustedTime() - nCPIDTime;
                                 double stake_age = GetAdjustedTime() - nGRCTime;
 
@@ -2207,8 +2174,8 @@ Value execute(const Array& params, bool fHelp)
             std::string cpid = GlobalCPUMiningCPID.cpid;
             std::string GRCAddress = DefaultWalletAddress();
             GetEarliestStakeTime(GRCAddress,cpid);
-            entry.push_back(Pair("GRCTime",mvApplicationCacheTimestamp["nGRCTime"]));
-            entry.push_back(Pair("CPIDTime",mvApplicationCacheTimestamp["nCPIDTime"]));
+            entry.push_back(Pair("GRCTime",nEarliestGRCTime));
+            entry.push_back(Pair("CPIDTime",nEarliestCPIDTime));
             results.push_back(entry);
     }
     else if (sItem=="testnewcontract")
@@ -2445,7 +2412,7 @@ Value execute(const Array& params, bool fHelp)
         entry.push_back(Pair("beacon_participant_count",out_participant_count));
         entry.push_back(Pair("average_magnitude",out_avg));
         entry.push_back(Pair("superblock_valid", VerifySuperblock(superblock, pindexBest)));
-        int64_t superblock_age = GetAdjustedTime() - mvApplicationCacheTimestamp["superblock;magnitudes"];
+        int64_t superblock_age = GetAdjustedTime() - ReadCacheTimestamp("superblock","magnitudes");
         entry.push_back(Pair("Superblock Age",superblock_age));
         bool bDireNeed = NeedASuperblock();
         entry.push_back(Pair("Dire Need of Superblock",bDireNeed));
@@ -2512,19 +2479,10 @@ Value execute(const Array& params, bool fHelp)
         {
             std::string sType = params[1].get_str();
             entry.push_back(Pair("Key Type",sType));
-            for(map<string,string>::iterator ii=mvApplicationCache.begin(); ii!=mvApplicationCache.end(); ++ii) 
+            for(const auto& item : ReadCacheSection(sType))
             {
-                std::string key_name  = (*ii).first;
-                if (key_name.length() > sType.length())
-                {
-                    if (key_name.substr(0,sType.length())==sType)
-                    {
-                                std::string key_value = mvApplicationCache[(*ii).first];
-                                entry.push_back(Pair(key_name,key_value));
-                    }
-               
-                }
-           }
+                entry.push_back(Pair(item.first,item.second.value));
+            }
            results.push_back(entry);
         }
 
@@ -2860,7 +2818,8 @@ Array SuperblockReport(std::string cpid)
                 double out_participant_count = 0;
                 double out_avg = 0;
                 // Binary Support 12-20-2015
-                std::string superblock = UnpackBinarySuperblock(bb.superblock);
+                Superblock decoded = Superblock::Parse(bb.superblock);
+                std::string superblock = ExtractXMLView(bb.superblock,"<BINARY>","</BINARY>").empty() ? bb.superblock : decoded.Unpack();
                 double avg_mag = GetSuperblockAvgMag(superblock,out_beacon_count,out_participant_count,out_avg,true,pblockindex->nHeight);
 
                 Object c;
@@ -2868,7 +2827,7 @@ Array SuperblockReport(std::string cpid)
                 c.push_back(Pair("Date",TimestampToHRDate(pblockindex->nTime)));
                 c.push_back(Pair("Average Mag",out_avg));
                 c.push_back(Pair("Wallet Version",bb.clientversion));
-                double mag = GetSuperblockMagnitudeByCPID(superblock, cpid);
+                double mag = GetSuperblockMagnitudeByCPID(decoded, cpid);
                 if (!cpid.empty())
                 {
                     c.push_back(Pair("Magnitude",mag));
@@ -3052,16 +3011,12 @@ std::string SignBlockWithCPID(std::string sCPID, std::string sBlockHash)
 
 std::string GetPollContractByTitle(std::string objecttype, std::string title)
 {
-    for(const auto& item : mvApplicationCache)
+    for(const auto& item : ReadCacheSection(objecttype))
     {
-        const std::string& key_name = item.first;
-        const std::string& contract = item.second;
-        if (boost::algorithm::starts_with(key_name, objecttype))
-        {
-            const std::string& PollTitle = ExtractXML(contract,"<TITLE>","</TITLE>");
-            if(boost::iequals(PollTitle, title))
-                return contract;
-        }
+        const std::string& contract = item.second.value;
+        const std::string& PollTitle = ExtractXML(contract,"<TITLE>","</TITLE>");
+        if(boost::iequals(PollTitle, title))
+            return contract;
     }
 
     return std::string();
@@ -3119,8 +3074,7 @@ double GetMoneySupplyFactor()
 
 double PollCalculateShares(std::string contract, double sharetype, double MoneySupplyFactor, unsigned int VoteAnswerCount)
 {
-    std::string address = ExtractXML(contract,"<GRCADDRESS>","</GRCADDRESS>");
-    std::string cpid = ExtractXML(contract,"<CPID>","</CPID>");
+    boost::string_ref address = ExtractXMLView(contract,"<GRCADDRESS>","</GRCADDRESS>");
    	double magnitude = ReturnVerifiedVotingMagnitude(contract,PollCreatedAfterSecurityUpgrade(contract));
 	double balance = ReturnVerifiedVotingBalance(contract,PollCreatedAfterSecurityUpgrade(contract));
 	if (VoteAnswerCount < 1) VoteAnswerCount=1;
@@ -3148,37 +3102,15 @@ double PollCalculateShares(std::string contract, double sharetype, double MoneyS
 }
                             
 
-double VotesCount(std::string pollname, std::string answer, double sharetype, double& out_participants)
+double VotesCount(const PollTallies& tallies, std::string answer, double sharetype, double MoneySupplyFactor, double& out_participants)
 {
-    double total_shares = 0;
     out_participants = 0;
-    std::string objecttype="vote";
-    
-    double MoneySupplyFactor = GetMoneySupplyFactor();
-
-    for(const auto& item : mvApplicationCache)
-    {
-        const std::string& key_name = item.first;
-        const std::string& contract = item.second;
-
-        if (boost::algorithm::starts_with(key_name, objecttype))
-        {
-            const std::string& Title = ExtractXML(contract,"<TITLE>","</TITLE>");
-            const std::string& VoterAnswer = ExtractXML(contract,"<ANSWER>","</ANSWER>");
-            const std::vector<std::string>& vVoterAnswers = split(VoterAnswer.c_str(),";");
-            for (const std::string& voterAnswers : vVoterAnswers)
-            {
-                if (boost::iequals(pollname, Title) && boost::iequals(answer, voterAnswers))
-                {
-                    double shares = PollCalculateShares(contract, sharetype, MoneySupplyFactor, vVoterAnswers.size());
-                    total_shares += shares;
-                    out_participants += 1.0 / vVoterAnswers.size();
-                }
-            }
-        }
-    }
+    PollTallies::const_iterator it = tallies.find(boost::to_lower_copy(answer));
+    if (it == tallies.end())
+        return 0;
 
-    return total_shares;
+    out_participants = it->second.participants;
+    return GetVoteTallyShares(it->second, sharetype, MoneySupplyFactor);
 }
 
 
@@ -3636,36 +3568,32 @@ Array GetJsonVoteDetailsReport(std::string pollname)
     entry.push_back(Pair("GRCAddress,CPID,Question,Answer,ShareType,URL", "Shares"));
 
     boost::to_lower(pollname);
-    for(const auto& item : mvApplicationCache)
+    for(const auto& item : ReadCacheSection(objecttype))
     {
-        const std::string& key_name = item.first;
-        const std::string& contract = item.second;
-        if (boost::algorithm::starts_with(key_name, objecttype))
+        const std::string& contract = item.second.value;
+        const std::string& Title = ExtractXML(contract,"<TITLE>","</TITLE>");
+        if(boost::iequals(pollname, Title))
         {
-            const std::string& Title = ExtractXML(contract,"<TITLE>","</TITLE>");
-            if(boost::iequals(pollname, Title))
-            {
-                const std::string& OriginalContract = GetPollContractByTitle("poll",Title);
-                const std::string& Question = ExtractXML(OriginalContract,"<QUESTION>","</QUESTION>");
-                const std::string& GRCAddress = ExtractXML(contract,"<GRCADDRESS>","</GRCADDRESS>");
-                const std::string& CPID = ExtractXML(contract,"<CPID>","</CPID>");
+            const std::string& OriginalContract = GetPollContractByTitle("poll",Title);
+            const std::string& Question = ExtractXML(OriginalContract,"<QUESTION>","</QUESTION>");
+            const std::string& GRCAddress = ExtractXML(contract,"<GRCADDRESS>","</GRCADDRESS>");
+            const std::string& CPID = ExtractXML(contract,"<CPID>","</CPID>");
 
-                double dShareType = cdbl(GetPollXMLElementByPollTitle(Title,"<SHARETYPE>","</SHARETYPE>"),0);
-                std::string sShareType= GetShareType(dShareType);
-                std::string sURL = ExtractXML(contract,"<URL>","</URL>");
+            double dShareType = cdbl(GetPollXMLElementByPollTitle(Title,"<SHARETYPE>","</SHARETYPE>"),0);
+            std::string sShareType= GetShareType(dShareType);
+            std::string sURL = ExtractXML(contract,"<URL>","</URL>");
 
-                std::string Balance = ExtractXML(contract,"<BALANCE>","</BALANCE>");
+            std::string Balance = ExtractXML(contract,"<BALANCE>","</BALANCE>");
 
-                const std::string& VoterAnswer = boost::to_lower_copy(ExtractXML(contract,"<ANSWER>","</ANSWER>"));
-                const std::vector<std::string>& vVoterAnswers = split(VoterAnswer.c_str(),";");
-                for (const auto& answer : vVoterAnswers)
-                {
-                    double shares = PollCalculateShares(contract, dShareType, MoneySupplyFactor, vVoterAnswers.size());
-                    total_shares += shares;
-                    participants += 1.0 / vVoterAnswers.size();
-                    const std::string& voter = GRCAddress + "," + CPID + "," + Question + "," + answer + "," + sShareType + "," + sURL;
-                    entry.push_back(Pair(voter,RoundToString(shares,0)));
-                }
+            const std::string& VoterAnswer = boost::to_lower_copy(ExtractXML(contract,"<ANSWER>","</ANSWER>"));
+            const std::vector<std::string>& vVoterAnswers = split(VoterAnswer.c_str(),";");
+            for (const auto& answer : vVoterAnswers)
+            {
+                double shares = PollCalculateShares(contract, dShareType, MoneySupplyFactor, vVoterAnswers.size());
+                total_shares += shares;
+                participants += 1.0 / vVoterAnswers.size();
+                const std::string& voter = GRCAddress + "," + CPID + "," + Question + "," + answer + "," + sShareType + "," + sURL;
+                entry.push_back(Pair(voter,RoundToString(shares,0)));
             }
         }
     }
@@ -3692,75 +3620,73 @@ Array GetJSONPollsReport(bool bDetail, std::string QueryByTitle, std::string& ou
     std::string sExport;
     std::string sExportRow;
     out_export.clear();
+    double MoneySupplyFactor = GetMoneySupplyFactor();
 
-    for(const auto& item : mvApplicationCache)
+    for(const auto& item : ReadCacheSection(datatype))
     {
+        const std::string& contract = item.second.value;
         const std::string& key_name = item.first;
-        const std::string& contract = item.second;
-
-        if (boost::algorithm::starts_with(key_name, datatype))
+        std::string Title = key_name.substr(datatype.length()+1,key_name.length()-datatype.length()-1);
+        std::string Expiration = ExtractXML(contract,"<EXPIRATION>","</EXPIRATION>");
+        std::string Question = ExtractXML(contract,"<QUESTION>","</QUESTION>");
+        std::string Answers = ExtractXML(contract,"<ANSWERS>","</ANSWERS>");
+        std::string ShareType = ExtractXML(contract,"<SHARETYPE>","</SHARETYPE>");
+        std::string sURL = ExtractXML(contract,"<URL>","</URL>");
+        boost::to_lower(Title);
+        if (!PollExpired(Title) || IncludeExpired)
         {
-            std::string Title = key_name.substr(datatype.length()+1,key_name.length()-datatype.length()-1);
-            std::string Expiration = ExtractXML(contract,"<EXPIRATION>","</EXPIRATION>");
-            std::string Question = ExtractXML(contract,"<QUESTION>","</QUESTION>");
-            std::string Answers = ExtractXML(contract,"<ANSWERS>","</ANSWERS>");
-            std::string ShareType = ExtractXML(contract,"<SHARETYPE>","</SHARETYPE>");
-            std::string sURL = ExtractXML(contract,"<URL>","</URL>");
-            boost::to_lower(Title);
-            if (!PollExpired(Title) || IncludeExpired)
+            if (QueryByTitle.empty() || QueryByTitle == Title)
             {
-                if (QueryByTitle.empty() || QueryByTitle == Title)
+                iPollNumber++;
+                total_participants = 0;
+                total_shares=0;
+                std::string BestAnswer;
+                double highest_share = 0;
+                std::string ExpirationDate = TimestampToHRDate(cdbl(Expiration,0));
+                std::string sShareType = GetShareType(cdbl(ShareType,0));
+                std::string TitleNarr = "Poll #" + RoundToString((double)iPollNumber,0)
+                                        + " (" + ExpirationDate + " ) - " + sShareType;
+
+                entry.push_back(Pair(TitleNarr,Title));
+                sExportRow = "<POLL><URL>" + sURL + "</URL><TITLE>" + Title + "</TITLE><EXPIRATION>" + ExpirationDate + "</EXPIRATION><SHARETYPE>" + sShareType + "</SHARETYPE><QUESTION>" + Question + "</QUESTION><ANSWERS>"+Answers+"</ANSWERS>";
+
+                if (bDetail)
                 {
-                    iPollNumber++;
-                    total_participants = 0;
-                    total_shares=0;
-                    std::string BestAnswer;
-                    double highest_share = 0;
-                    std::string ExpirationDate = TimestampToHRDate(cdbl(Expiration,0));
-                    std::string sShareType = GetShareType(cdbl(ShareType,0));
-                    std::string TitleNarr = "Poll #" + RoundToString((double)iPollNumber,0)
-                                            + " (" + ExpirationDate + " ) - " + sShareType;
-
-                    entry.push_back(Pair(TitleNarr,Title));
-                    sExportRow = "<POLL><URL>" + sURL + "</URL><TITLE>" + Title + "</TITLE><EXPIRATION>" + ExpirationDate + "</EXPIRATION><SHARETYPE>" + sShareType + "</SHARETYPE><QUESTION>" + Question + "</QUESTION><ANSWERS>"+Answers+"</ANSWERS>";
-
-                    if (bDetail)
+                    const PollTallies& tallies = GetPollTallies(Title);
+                    entry.push_back(Pair("Question",Question));
+                    const std::vector<std::string>& vAnswers = split(Answers.c_str(),";");
+                    sExportRow += "<ARRAYANSWERS>";
+                    size_t i = 0;
+                    for (const std::string& answer : vAnswers)
                     {
-                        entry.push_back(Pair("Question",Question));
-                        const std::vector<std::string>& vAnswers = split(Answers.c_str(),";");
-                        sExportRow += "<ARRAYANSWERS>";
-                        size_t i = 0;
-                        for (const std::string& answer : vAnswers)
+                        double participants=0;
+                        double dShares = VotesCount(tallies, answer, cdbl(ShareType,0), MoneySupplyFactor, participants);
+                        if (dShares > highest_share)
                         {
-                            double participants=0;
-                            double dShares = VotesCount(Title, answer, cdbl(ShareType,0),participants);
-                            if (dShares > highest_share)
-                            {
-                                highest_share = dShares;
-                                BestAnswer = answer;
-                            }
-
-                            entry.push_back(Pair("#" + ToString(++i) + " [" + RoundToString(participants,3) + "]. " + answer,dShares));
-                            total_participants += participants;
-                            total_shares += dShares;
-                            sExportRow += "<RESERVED></RESERVED><ANSWERNAME>" + answer + "</ANSWERNAME><PARTICIPANTS>" + RoundToString(participants,0) + "</PARTICIPANTS><SHARES>" + RoundToString(dShares,0) + "</SHARES>";
+                            highest_share = dShares;
+                            BestAnswer = answer;
                         }
-                        sExportRow += "</ARRAYANSWERS>";
 
-                        //Totals:
-                        entry.push_back(Pair("Participants",total_participants));
-                        entry.push_back(Pair("Total Shares",total_shares));
-                        if (total_participants < 3) BestAnswer = "";
+                        entry.push_back(Pair("#" + ToString(++i) + " [" + RoundToString(participants,3) + "]. " + answer,dShares));
+                        total_participants += participants;
+                        total_shares += dShares;
+                        sExportRow += "<RESERVED></RESERVED><ANSWERNAME>" + answer + "</ANSWERNAME><PARTICIPANTS>" + RoundToString(participants,0) + "</PARTICIPANTS><SHARES>" + RoundToString(dShares,0) + "</SHARES>";
+                    }
+                    sExportRow += "</ARRAYANSWERS>";
+
+                    //Totals:
+                    entry.push_back(Pair("Participants",total_participants));
+                    entry.push_back(Pair("Total Shares",total_shares));
+                    if (total_participants < 3) BestAnswer = "";
 
-                        entry.push_back(Pair("Best Answer",BestAnswer));
-                        sExportRow += "<TOTALPARTICIPANTS>" + RoundToString(total_participants,0)
-                                      + "</TOTALPARTICIPANTS><TOTALSHARES>" + RoundToString(total_shares,0)
-                                      + "</TOTALSHARES><BESTANSWER>" + BestAnswer + "</BESTANSWER>";
+                    entry.push_back(Pair("Best Answer",BestAnswer));
+                    sExportRow += "<TOTALPARTICIPANTS>" + RoundToString(total_participants,0)
+                                  + "</TOTALPARTICIPANTS><TOTALSHARES>" + RoundToString(total_shares,0)
+                                  + "</TOTALSHARES><BESTANSWER>" + BestAnswer + "</BESTANSWER>";
 
-                    }
-                    sExportRow += "</POLL>";
-                    sExport += sExportRow;
                 }
+                sExportRow += "</POLL>";
+                sExport += sExportRow;
             }
         }
     }
@@ -3780,28 +3706,15 @@ Array GetUpgradedBeaconReport()
         Object entry;
         entry.push_back(Pair("Report","Upgraded Beacon Report 1.0"));
         std::string datatype="beacon";
-        std::string rows = "";
-        std::string row = "";
         int iBeaconCount = 0;
         int iUpgradedBeaconCount = 0;
-        for(map<string,string>::iterator ii=mvApplicationCache.begin(); ii!=mvApplicationCache.end(); ++ii) 
+        for(const auto& item : ReadCacheSection(datatype))
         {
-                std::string key_name  = (*ii).first;
-                if (key_name.length() > datatype.length())
-                {
-                    if (key_name.substr(0,datatype.length())==datatype)
-                    {
-                                std::string key_value = mvApplicationCache[(*ii).first];
-                                std::string subkey = key_name.substr(datatype.length()+1,key_name.length()-datatype.length()-1);
-                                std::string contract = DecodeBase64(key_value);
-                                std::string cpidv2 = ExtractValue(contract,";",0);
-                                std::string grcaddress = ExtractValue(contract,";",2);
-                                std::string sPublicKey = ExtractValue(contract,";",3);
-                                if (!sPublicKey.empty()) iUpgradedBeaconCount++;
-                                iBeaconCount++;
-                    }
-                }
-      }
+                std::string contract = DecodeBase64(item.second.value);
+                std::string sPublicKey = ExtractValue(contract,";",3);
+                if (!sPublicKey.empty()) iUpgradedBeaconCount++;
+                iBeaconCount++;
+        }
       entry.push_back(Pair("Total Beacons",(double)iBeaconCount));
       entry.push_back(Pair("Upgraded Beacon Count",(double)iUpgradedBeaconCount));
       double dPct = ((double)iUpgradedBeaconCount / ((double)iBeaconCount) + .01);
@@ -3820,26 +3733,15 @@ Array GetJSONBeaconReport()
         Object entry;
         entry.push_back(Pair("CPID","GRCAddress"));
         std::string datatype="beacon";
-        std::string row = "";
-        for(map<string,string>::iterator ii=mvApplicationCache.begin(); ii!=mvApplicationCache.end(); ++ii) 
+        for(const auto& item : ReadCacheSection(datatype))
         {
-                std::string key_name  = (*ii).first;
-                if (key_name.length() > datatype.length())
-                {
-                    if (key_name.substr(0,datatype.length())==datatype)
-                    {
-                                std::string key_value = mvApplicationCache[(*ii).first];
-                                std::string subkey = key_name.substr(datatype.length()+1,key_name.length()-datatype.length()-1);
-                                row = subkey + "<COL>" + key_value;
-                                //                              std::string contract = GlobalCPUMiningCPID.cpidv2 + ";" + hashRand.GetHex() + ";" + GRCAddress;
-                                std::string contract = DecodeBase64(key_value);
-                                std::string cpid = subkey;
-                                std::string cpidv2 = ExtractValue(contract,";",0);
-                                std::string grcaddress = ExtractValue(contract,";",2);
-                                entry.push_back(Pair(cpid,grcaddress));
-                    }
-                }
-       }
+                //                              std::string contract = GlobalCPUMiningCPID.cpidv2 + ";" + hashRand.GetHex() + ";" + GRCAddress;
+                std::string contract = DecodeBase64(item.second.value);
+                const std::string& key_name = item.first;
+                std::string cpid = key_name.substr(datatype.length()+1,key_name.length()-datatype.length()-1);
+                std::string grcaddress = ExtractValue(contract,";",2);
+                entry.push_back(Pair(cpid,grcaddress));
+        }
     
       results.push_back(entry);
       return results;
@@ -3916,7 +3818,7 @@ Array GetJSONNeuralNetworkReport()
       {
           entry.push_back(Pair("Pending",SuperblockHeight));
       }
-      int64_t superblock_age = GetAdjustedTime() - mvApplicationCacheTimestamp["superblock;magnitudes"];
+      int64_t superblock_age = GetAdjustedTime() - ReadCacheTimestamp("superblock","magnitudes");
      
       entry.push_back(Pair("Superblock Age",superblock_age));
       if (superblock_age > GetSuperblockAgeSpacing(nBestHeight))
@@ -3969,7 +3871,7 @@ Array GetJSONCurrentNeuralNetworkReport()
       {
           entry.push_back(Pair("Pending",SuperblockHeight));
       }
-      int64_t superblock_age = GetAdjustedTime() - mvApplicationCacheTimestamp["superblock;magnitudes"];
+      int64_t superblock_age = GetAdjustedTime() - ReadCacheTimestamp("superblock","magnitudes");
      
       entry.push_back(Pair("Superblock Age",superblock_age));
       if (superblock_age > GetSuperblockAgeSpacing(nBestHeight))
@@ -4762,13 +4664,16 @@ json_spirit::Value rpc_getblockstats(const json_spirit::Array& params, bool fHel
         transactioncount+=txcountinblock;
         emptyblockscount+=(txcountinblock==0);
         c_blockversion[block.nVersion]++;
-        MiningCPID bb = DeserializeBoincBlock(block.vtx[0].hashBoinc, block.nVersion);
-        c_cpid[bb.cpid]++;
-        c_org[bb.Organization]++;
-        c_version[bb.clientversion]++;
-        researchtotal+=bb.ResearchSubsidy;
-        interesttotal+=bb.InterestSubsidy;
-        researchcount+=(bb.ResearchSubsidy>0.001);
+        const BoincBlockView bb(block.vtx[0].hashBoinc);
+        const size_t nValidFields = bb.GetValidFieldCount();
+        const double dResearchSubsidy = BoincBlockView::RESEARCH_SUBSIDY < nValidFields ? bb.GetDouble(BoincBlockView::RESEARCH_SUBSIDY, 2) : 0;
+        c_cpid[bb.GetValidString(BoincBlockView::CPID)]++;
+        c_org[bb.GetValidString(BoincBlockView::ORGANIZATION)]++;
+        c_version[bb.GetValidString(BoincBlockView::CLIENT_VERSION)]++;
+        researchtotal+=dResearchSubsidy;
+        if (BoincBlockView::INTEREST_SUBSIDY < nValidFields)
+            interesttotal+=bb.GetDouble(BoincBlockView::INTEREST_SUBSIDY, block.nVersion<8 ? 2 : 8);
+        researchcount+=(dResearchSubsidy>0.001);
         minttotal+=cur->nMint;
         unsigned sizeblock = block.GetSerializeSize(SER_NETWORK, PROTOCOL_VERSION);
         size_min_blk=std::min(size_min_blk,sizeblock);
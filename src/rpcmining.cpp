@@ -76,6 +76,9 @@ Value getmininginfo(const Array& params, bool fHelp)
         obj.push_back(Pair("mining-created", MinerStatus.CreatedCnt));
         obj.push_back(Pair("mining-accepted", MinerStatus.AcceptedCnt));
         obj.push_back(Pair("mining-kernels-found", MinerStatus.KernelsFound));
+        obj.push_back(Pair("mining-round-coins", MinerStatus.nLastRoundCoins));
+        obj.push_back(Pair("mining-round-ms", MinerStatus.nLastRoundMicros / 1000.0));
+        obj.push_back(Pair("mining-round-read-ms", MinerStatus.nLastRoundReadMicros / 1000.0));
         // Avoid calculating coinage of all coins just to get interest,
         // reuse value found by miner which has to load blocks anyway
         double dInterest = MinerStatus.CoinAgeSum * GetCoinYearReward(nTime) * 33 / (365 * 33 + 8);
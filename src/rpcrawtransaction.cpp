@@ -45,7 +45,7 @@ std::string GetTxProject(uint256 hash, int& out_blocknumber, int& out_blocktype,
     string strHex = HexStr(ssTx.begin(), ssTx.end());
     CBlockIndex* pindexPrev = NULL;
     CBlock block;
-    map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(hashBlock);
+    BlockMap::iterator mi = mapBlockIndex.find(hashBlock);
     if (mi == mapBlockIndex.end())
     {
             return ""; //not found
@@ -273,7 +273,7 @@ void TxToJSON(const CTransaction& tx, const uint256 hashBlock, Object& entry)
     if (hashBlock != 0)
     {
         entry.push_back(Pair("blockhash", hashBlock.GetHex()));
-        map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(hashBlock);
+        BlockMap::iterator mi = mapBlockIndex.find(hashBlock);
         if (mi != mapBlockIndex.end() && (*mi).second)
         {
             CBlockIndex* pindex = (*mi).second;
@@ -727,6 +727,7 @@ Value signrawtransaction(const Array& params, bool fHelp)
         if (!VerifyScript(txin.scriptSig, prevPubKey, mergedTx, i, 0))
             fComplete = false;
     }
+    mergedTx.InvalidateHash();
 
     Object result;
     CDataStream ssTx(SER_NETWORK, PROTOCOL_VERSION);
@@ -10,6 +10,7 @@
 #include "init.h"
 #include "base58.h"
 #include "util.h"
+#include "xmlview.h"
 
 using namespace json_spirit;
 using namespace std;
@@ -20,7 +21,6 @@ static CCriticalSection cs_nWalletUnlockTime;
 extern void ThreadTopUpKeyPool(void* parg);
 
 double CoinToDouble(double surrogate);
-std::string ExtractXML(std::string XMLdata, std::string key, std::string key_end);
 
 extern Array StakingReport();
 
@@ -1631,7 +1631,7 @@ Value listsinceblock(const Array& params, bool fHelp)
         uint256 blockId = 0;
 
         blockId.SetHex(params[0].get_str());
-        std::map<uint256, CBlockIndex*>::iterator it = mapBlockIndex.find(blockId);
+        BlockMap::iterator it = mapBlockIndex.find(blockId);
         if (it != mapBlockIndex.end())
             pindex = it->second;
 
@@ -1731,7 +1731,7 @@ Value gettransaction(const Array& params, bool fHelp)
             else
             {
                 entry.push_back(Pair("blockhash", hashBlock.GetHex()));
-                map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(hashBlock);
+                BlockMap::iterator mi = mapBlockIndex.find(hashBlock);
                 if (mi != mapBlockIndex.end() && (*mi).second)
                 {
                     CBlockIndex* pindex = (*mi).second;
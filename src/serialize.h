@@ -1003,6 +1003,11 @@ public:
             s.write((char*)&vch[0], vch.size() * sizeof(vch[0]));
     }
 
+    unsigned int GetSerializeSize(int nType, int nVersion) const
+    {
+        return vch.size() * sizeof(vch[0]);
+    }
+
     template<typename T>
     unsigned int GetSerializeSize(const T& obj)
     {
@@ -1156,4 +1161,53 @@ public:
     }
 };
 
+/** Read-only stream over a byte range owned by the caller, such as a
+ * memory-mapped file. Reads never copy the range itself.
+ */
+class CBufferReader
+{
+protected:
+    const char* pbegin;
+    const char* pend;
+    const char* pcur;
+public:
+    int nType;
+    int nVersion;
+
+    CBufferReader(const char* pbeginIn, const char* pendIn, int nTypeIn, int nVersionIn)
+    {
+        pbegin = pbeginIn;
+        pend = pendIn;
+        pcur = pbeginIn;
+        nType = nTypeIn;
+        nVersion = nVersionIn;
+    }
+
+    size_t size() const          { return pend - pcur; }
+    bool empty() const           { return pcur == pend; }
+    size_t GetReadPos() const    { return pcur - pbegin; }
+
+    void SetType(int n)          { nType = n; }
+    int GetType()                { return nType; }
+    void SetVersion(int n)       { nVersion = n; }
+    int GetVersion()             { return nVersion; }
+
+    CBufferReader& read(char* pch, size_t nSize)
+    {
+        if (nSize > (size_t)(pend - pcur))
+            throw std::ios_base::failure("CBufferReader::read : end of data");
+        memcpy(pch, pcur, nSize);
+        pcur += nSize;
+        return (*this);
+    }
+
+    template<typename T>
+    CBufferReader& operator>>(T& obj)
+    {
+        // Unserialize from this stream
+        ::Unserialize(*this, obj, nType, nVersion);
+        return (*this);
+    }
+};
+
 #endif
@@ -0,0 +1,247 @@
+#include "sha256.h"
+
+#include <openssl/sha.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA256D_MULTI
+#endif
+
+namespace
+{
+    void Sha256DScalar(unsigned char* out, const unsigned char* in, size_t nSize, size_t nCount)
+    {
+        unsigned char hash[32];
+        for (size_t i = 0; i < nCount; i++)
+        {
+            SHA256(in + i * nSize, nSize, hash);
+            SHA256(hash, sizeof(hash), out + i * 32);
+        }
+    }
+
+#ifdef SHA256D_MULTI
+    // The multi-message implementations keep word i of every message in
+    // one vector and run the compression function over all of them at once.
+    // The code is generic over the vector type, and is inlined into
+    // functions built for the instruction set the vector width calls for.
+
+#define SHA256D_INLINE inline __attribute__((always_inline))
+
+#if !defined(__clang__)
+    // Nothing taking or returning a vector is ever called, it is all inlined
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+    typedef uint32_t Vec4 __attribute__((vector_size(16)));
+    typedef uint32_t Vec8 __attribute__((vector_size(32)));
+
+    const uint32_t K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+    };
+
+    const uint32_t IV[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+
+    uint32_t ReadBE32(const unsigned char* p)
+    {
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+
+    void WriteBE32(unsigned char* p, uint32_t x)
+    {
+        p[0] = x >> 24;
+        p[1] = x >> 16;
+        p[2] = x >> 8;
+        p[3] = x;
+    }
+
+    template<typename V> SHA256D_INLINE V Splat(uint32_t x) { V v = {}; return v + x; }
+    template<typename V> SHA256D_INLINE V Ror(const V& x, int n) { return (x >> n) | (x << (32 - n)); }
+    template<typename V> SHA256D_INLINE V Ch(const V& x, const V& y, const V& z) { return z ^ (x & (y ^ z)); }
+    template<typename V> SHA256D_INLINE V Maj(const V& x, const V& y, const V& z) { return (x & y) | (z & (x | y)); }
+    template<typename V> SHA256D_INLINE V Sigma0(const V& x) { return Ror(x, 2) ^ Ror(x, 13) ^ Ror(x, 22); }
+    template<typename V> SHA256D_INLINE V Sigma1(const V& x) { return Ror(x, 6) ^ Ror(x, 11) ^ Ror(x, 25); }
+    template<typename V> SHA256D_INLINE V sigma0(const V& x) { return Ror(x, 7) ^ Ror(x, 18) ^ (x >> 3); }
+    template<typename V> SHA256D_INLINE V sigma1(const V& x) { return Ror(x, 17) ^ Ror(x, 19) ^ (x >> 10); }
+
+    // Compress one block of every message, given as its 16 words, into the state
+    template<typename V>
+    SHA256D_INLINE void Transform(V s[8], V w[16])
+    {
+        V a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+        for (int i = 0; i < 64; i++)
+        {
+            if (i >= 16)
+                w[i & 15] += sigma1(w[(i + 14) & 15]) + w[(i + 9) & 15] + sigma0(w[(i + 1) & 15]);
+            V t1 = h + Sigma1(e) + Ch(e, f, g) + K[i] + w[i & 15];
+            V t2 = Sigma0(a) + Maj(a, b, c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        s[0] += a;
+        s[1] += b;
+        s[2] += c;
+        s[3] += d;
+        s[4] += e;
+        s[5] += f;
+        s[6] += g;
+        s[7] += h;
+    }
+
+    template<typename V>
+    SHA256D_INLINE void Initialize(V s[8])
+    {
+        for (int i = 0; i < 8; i++)
+            s[i] = Splat<V>(IV[i]);
+    }
+
+    // Words of a block holding nothing but the padding of a message of nBits
+    template<typename V>
+    SHA256D_INLINE void PaddingBlock(V w[16], uint32_t nBits)
+    {
+        w[0] = Splat<V>(0x80000000);
+        for (int i = 1; i < 15; i++)
+            w[i] = Splat<V>(0);
+        w[15] = Splat<V>(nBits);
+    }
+
+    template<typename V, int N>
+    SHA256D_INLINE void Load(V w[16], const unsigned char* in, size_t nStride)
+    {
+        for (int i = 0; i < 16; i++)
+            for (int l = 0; l < N; l++)
+                w[i][l] = ReadBE32(in + l * nStride + 4 * i);
+    }
+
+    // Hash N messages of nSize bytes, where nSize is at most 55 or is 64
+    template<typename V, int N>
+    SHA256D_INLINE void Sha256DLanes(unsigned char* out, const unsigned char* in, size_t nSize)
+    {
+        V s[8], w[16];
+        Initialize(s);
+        if (nSize == 64)
+        {
+            Load<V, N>(w, in, nSize);
+            Transform(s, w);
+            PaddingBlock(w, 512);
+            Transform(s, w);
+        }
+        else
+        {
+            unsigned char block[N][64];
+            for (int l = 0; l < N; l++)
+            {
+                memcpy(block[l], in + l * nSize, nSize);
+                block[l][nSize] = 0x80;
+                memset(block[l] + nSize + 1, 0, 64 - nSize - 1);
+                WriteBE32(block[l] + 60, nSize * 8);
+            }
+            Load<V, N>(w, block[0], 64);
+            Transform(s, w);
+        }
+
+        // The digest is the only block of the second hash but for its padding
+        for (int i = 0; i < 8; i++)
+            w[i] = s[i];
+        w[8] = Splat<V>(0x80000000);
+        for (int i = 9; i < 15; i++)
+            w[i] = Splat<V>(0);
+        w[15] = Splat<V>(256);
+        Initialize(s);
+        Transform(s, w);
+
+        for (int l = 0; l < N; l++)
+            for (int i = 0; i < 8; i++)
+                WriteBE32(out + l * 32 + 4 * i, s[i][l]);
+    }
+
+    __attribute__((target("sse4.1")))
+    void Sha256DSse41(unsigned char* out, const unsigned char* in, size_t nSize, size_t nCount)
+    {
+        size_t i = 0;
+        if (nSize <= 55 || nSize == 64)
+            for (; i + 4 <= nCount; i += 4)
+                Sha256DLanes<Vec4, 4>(out + i * 32, in + i * nSize, nSize);
+        Sha256DScalar(out + i * 32, in + i * nSize, nSize, nCount - i);
+    }
+
+    __attribute__((target("avx2")))
+    void Sha256DAvx2(unsigned char* out, const unsigned char* in, size_t nSize, size_t nCount)
+    {
+        size_t i = 0;
+        if (nSize <= 55 || nSize == 64)
+            for (; i + 8 <= nCount; i += 8)
+                Sha256DLanes<Vec8, 8>(out + i * 32, in + i * nSize, nSize);
+        Sha256DSse41(out + i * 32, in + i * nSize, nSize, nCount - i);
+    }
+
+#endif
+}
+
+const char* Sha256DName(Sha256DImplementation impl)
+{
+    switch (impl)
+    {
+    case SHA256D_SSE41: return "sse4.1";
+    case SHA256D_AVX2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+bool Sha256DSupported(Sha256DImplementation impl)
+{
+    switch (impl)
+    {
+#ifdef SHA256D_MULTI
+    case SHA256D_SSE41: return __builtin_cpu_supports("sse4.1");
+    case SHA256D_AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.1");
+#endif
+    case SHA256D_SCALAR: return true;
+    default: return false;
+    }
+}
+
+Sha256DImplementation Sha256DBest()
+{
+    static const Sha256DImplementation best = []
+    {
+        if (Sha256DSupported(SHA256D_AVX2))
+            return SHA256D_AVX2;
+        if (Sha256DSupported(SHA256D_SSE41))
+            return SHA256D_SSE41;
+        return SHA256D_SCALAR;
+    }();
+    return best;
+}
+
+void Sha256DBatch(unsigned char* out, const unsigned char* in, size_t nSize, size_t nCount, Sha256DImplementation impl)
+{
+    switch (impl)
+    {
+#ifdef SHA256D_MULTI
+    case SHA256D_SSE41: Sha256DSse41(out, in, nSize, nCount); break;
+    case SHA256D_AVX2: Sha256DAvx2(out, in, nSize, nCount); break;
+#endif
+    default: Sha256DScalar(out, in, nSize, nCount); break;
+    }
+}
+
+void Sha256DBatch(unsigned char* out, const unsigned char* in, size_t nSize, size_t nCount)
+{
+    Sha256DBatch(out, in, nSize, nCount, Sha256DBest());
+}
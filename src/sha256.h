@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stddef.h>
+
+//!
+//! \brief Ways of computing double SHA-256 over many messages.
+//!
+enum Sha256DImplementation
+{
+    SHA256D_SCALAR, //!< One message at a time through OpenSSL.
+    SHA256D_SSE41,  //!< Four messages at a time with SSE4.1.
+    SHA256D_AVX2,   //!< Eight messages at a time with AVX2.
+};
+
+//!
+//! \brief Get the name of an implementation.
+//!
+const char* Sha256DName(Sha256DImplementation impl);
+
+//!
+//! \brief Check whether this build and CPU can run an implementation.
+//!
+bool Sha256DSupported(Sha256DImplementation impl);
+
+//!
+//! \brief Get the implementation used when none is given: the widest one
+//! the CPU supports.
+//!
+Sha256DImplementation Sha256DBest();
+
+//!
+//! \brief Compute the double SHA-256 of messages of the same size.
+//! \param out Receives \p nCount digests of 32 bytes, back to back.
+//! \param in \p nCount messages of \p nSize bytes, back to back.
+//! \param nSize Size of each message. The multi-message implementations
+//! handle messages of up to 55 bytes, which fit in one block, and of 64
+//! bytes, such as the pairs of a merkle tree. Others are hashed one at a
+//! time.
+//! \param nCount Number of messages.
+//! \param impl Implementation to use. Must be supported.
+//!
+void Sha256DBatch(unsigned char* out, const unsigned char* in, size_t nSize, size_t nCount, Sha256DImplementation impl);
+
+//!
+//! \brief Compute the double SHA-256 of messages of the same size with the
+//! best implementation.
+//!
+void Sha256DBatch(unsigned char* out, const unsigned char* in, size_t nSize, size_t nCount);
@@ -0,0 +1,129 @@
+// Copyright (c) 2009-2012 The Bitcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#ifndef BITCOIN_SIGCACHE_H
+#define BITCOIN_SIGCACHE_H
+
+#include "sync.h"
+#include "uint256.h"
+
+#include <openssl/sha.h>
+
+#include <vector>
+
+/** Valid signature cache, to avoid doing expensive ECDSA signature checking
+ *  twice for every transaction (once when accepted into memory pool, and
+ *  again when accepted into the block chain).
+ *
+ *  Entries are a salted SHA256 of (signature hash, signature, public key),
+ *  so a lookup neither copies the signature data nor allocates. The table is
+ *  a fixed size array split into independently locked shards, each made of
+ *  small sets of WAYS slots. Eviction overwrites a slot chosen by the salted
+ *  entry itself, which an attacker cannot predict without knowing the salt.
+ */
+class CSignatureCache
+{
+private:
+    static const unsigned int SHARDS = 16;
+    static const unsigned int WAYS = 4;
+
+    struct Shard
+    {
+        CCriticalSection cs;
+        std::vector<uint256> vEntries;
+    };
+
+    uint256 salt;
+    unsigned int nSetsPerShard;
+    Shard shards[SHARDS];
+
+    uint256 ComputeEntry(const uint256& hash, const std::vector<unsigned char>& vchSig, const std::vector<unsigned char>& pubKey) const
+    {
+        // Lengths are hashed too so that (sig, pubkey) pairs can't be shifted into each other
+        unsigned int nSigSize = vchSig.size();
+        unsigned int nPubKeySize = pubKey.size();
+        uint256 entry;
+        SHA256_CTX ctx;
+        SHA256_Init(&ctx);
+        SHA256_Update(&ctx, (const unsigned char*)&salt, sizeof(salt));
+        SHA256_Update(&ctx, (const unsigned char*)&hash, sizeof(hash));
+        SHA256_Update(&ctx, &nSigSize, sizeof(nSigSize));
+        if (nSigSize)
+            SHA256_Update(&ctx, &vchSig[0], nSigSize);
+        SHA256_Update(&ctx, &nPubKeySize, sizeof(nPubKeySize));
+        if (nPubKeySize)
+            SHA256_Update(&ctx, &pubKey[0], nPubKeySize);
+        SHA256_Final((unsigned char*)&entry, &ctx);
+        return entry;
+    }
+
+    Shard& ShardFor(const uint256& entry)
+    {
+        return shards[entry.Get64(0) % SHARDS];
+    }
+
+    unsigned int SetFor(const uint256& entry) const
+    {
+        return ((entry.Get64(0) / SHARDS) % nSetsPerShard) * WAYS;
+    }
+
+public:
+    /** nMaxEntries <= 0 disables the cache */
+    CSignatureCache(const uint256& saltIn, int64_t nMaxEntries) : salt(saltIn), nSetsPerShard(0)
+    {
+        if (nMaxEntries <= 0)
+            return;
+        nSetsPerShard = (nMaxEntries + SHARDS * WAYS - 1) / (SHARDS * WAYS);
+        for (unsigned int i = 0; i < SHARDS; i++)
+            shards[i].vEntries.resize(nSetsPerShard * WAYS);
+    }
+
+    bool Get(const uint256& hash, const std::vector<unsigned char>& vchSig, const std::vector<unsigned char>& pubKey)
+    {
+        if (nSetsPerShard == 0)
+            return false;
+
+        uint256 entry = ComputeEntry(hash, vchSig, pubKey);
+        Shard& shard = ShardFor(entry);
+        unsigned int nSet = SetFor(entry);
+
+        LOCK(shard.cs);
+        for (unsigned int i = 0; i < WAYS; i++)
+            if (shard.vEntries[nSet + i] == entry)
+                return true;
+        return false;
+    }
+
+    void Set(const uint256& hash, const std::vector<unsigned char>& vchSig, const std::vector<unsigned char>& pubKey)
+    {
+        if (nSetsPerShard == 0)
+            return;
+
+        uint256 entry = ComputeEntry(hash, vchSig, pubKey);
+        Shard& shard = ShardFor(entry);
+        unsigned int nSet = SetFor(entry);
+
+        LOCK(shard.cs);
+        for (unsigned int i = 0; i < WAYS; i++)
+        {
+            uint256& slot = shard.vEntries[nSet + i];
+            if (slot == entry)
+                return;
+            if (slot == 0)
+            {
+                slot = entry;
+                return;
+            }
+        }
+        // Set is full: evict a slot picked by the salted entry
+        shard.vEntries[nSet + entry.Get64(1) % WAYS] = entry;
+    }
+
+    /** Number of entries the cache can hold */
+    size_t Capacity() const
+    {
+        return (size_t)nSetsPerShard * WAYS * SHARDS;
+    }
+};
+
+#endif
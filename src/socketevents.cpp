@@ -0,0 +1,186 @@
+#include "socketevents.h"
+
+#include <algorithm>
+
+#if defined(__linux__)
+#define USE_EPOLL
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Most events taken from the kernel by one epoll_wait. More ready
+    // sockets are reported by the next wait.
+    const int MAX_EPOLL_EVENTS = 1024;
+}
+
+bool SocketEvents::IsSupported(Backend backend)
+{
+    switch (backend)
+    {
+#ifdef USE_EPOLL
+    case EPOLL: return true;
+#endif
+    case SELECT: return true;
+    default: return false;
+    }
+}
+
+const char* SocketEvents::GetName(Backend backend)
+{
+    return backend == EPOLL ? "epoll" : "select";
+}
+
+SocketEvents::SocketEvents(Backend backend)
+    : backend(SELECT)
+    , hEpoll(-1)
+{
+#ifdef USE_EPOLL
+    if (backend == EPOLL)
+    {
+        hEpoll = epoll_create1(EPOLL_CLOEXEC);
+        if (hEpoll != -1)
+            this->backend = EPOLL;
+    }
+#endif
+}
+
+SocketEvents::~SocketEvents()
+{
+#ifdef USE_EPOLL
+    if (hEpoll != -1)
+        close(hEpoll);
+#endif
+}
+
+SocketEvents::Backend SocketEvents::GetBackend() const
+{
+    return backend;
+}
+
+bool SocketEvents::IsEdgeTriggered() const
+{
+    return backend == EPOLL;
+}
+
+bool SocketEvents::CanWatch(SOCKET hSocket) const
+{
+    if (hSocket == INVALID_SOCKET)
+        return false;
+#ifndef WIN32
+    // Windows fd_sets are arrays of sockets rather than bitmaps indexed by
+    // socket, so only elsewhere does the socket number matter
+    if (backend == SELECT)
+        return hSocket < FD_SETSIZE;
+#endif
+    return true;
+}
+
+bool SocketEvents::Add(SOCKET hSocket, bool fListen)
+{
+#ifdef USE_EPOLL
+    if (backend == EPOLL)
+    {
+        struct epoll_event event = {};
+        event.events = fListen ? EPOLLIN : (EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET);
+        event.data.fd = hSocket;
+        if (epoll_ctl(hEpoll, EPOLL_CTL_ADD, hSocket, &event) == 0)
+            return true;
+
+        // A socket closed while a copy of it lives on in a child process
+        // stays registered, and its number can come back for a new socket
+        return errno == EEXIST && epoll_ctl(hEpoll, EPOLL_CTL_MOD, hSocket, &event) == 0;
+    }
+#endif
+    return false;
+}
+
+void SocketEvents::Watch(SOCKET hSocket, bool fRecv, bool fSend)
+{
+    if (backend != SELECT || !CanWatch(hSocket))
+        return;
+    if (fRecv)
+        vWatchRecv.push_back(hSocket);
+    if (fSend)
+        vWatchSend.push_back(hSocket);
+}
+
+bool SocketEvents::Wait(SocketEventMap& mapEvents, int nTimeoutMillis)
+{
+    mapEvents.clear();
+
+#ifdef USE_EPOLL
+    if (backend == EPOLL)
+    {
+        struct epoll_event events[MAX_EPOLL_EVENTS];
+        int nEvents = epoll_wait(hEpoll, events, MAX_EPOLL_EVENTS, nTimeoutMillis);
+        if (nEvents < 0)
+            return errno == EINTR;
+
+        for (int i = 0; i < nEvents; i++)
+        {
+            SocketEvent& event = mapEvents[events[i].data.fd];
+            event.fRecv = events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP);
+            event.fSend = events[i].events & EPOLLOUT;
+            event.fError = events[i].events & EPOLLERR;
+        }
+        return true;
+    }
+#endif
+
+    struct timeval timeout;
+    timeout.tv_sec  = nTimeoutMillis / 1000;
+    timeout.tv_usec = (nTimeoutMillis % 1000) * 1000;
+
+    fd_set fdsetRecv;
+    fd_set fdsetSend;
+    fd_set fdsetError;
+    FD_ZERO(&fdsetRecv);
+    FD_ZERO(&fdsetSend);
+    FD_ZERO(&fdsetError);
+    SOCKET hSocketMax = 0;
+    bool have_fds = false;
+
+    for (SOCKET hSocket : vWatchRecv)
+    {
+        FD_SET(hSocket, &fdsetRecv);
+        FD_SET(hSocket, &fdsetError);
+        hSocketMax = std::max(hSocketMax, hSocket);
+        have_fds = true;
+    }
+    for (SOCKET hSocket : vWatchSend)
+    {
+        FD_SET(hSocket, &fdsetSend);
+        FD_SET(hSocket, &fdsetError);
+        hSocketMax = std::max(hSocketMax, hSocket);
+        have_fds = true;
+    }
+
+    int nSelect = select(have_fds ? hSocketMax + 1 : 0,
+                         &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
+    bool fResult = nSelect != SOCKET_ERROR;
+    for (SOCKET hSocket : vWatchRecv)
+        if (!fResult || FD_ISSET(hSocket, &fdsetRecv))
+            mapEvents[hSocket].fRecv = true;
+    for (SOCKET hSocket : vWatchSend)
+    {
+        if (!fResult)
+            mapEvents[hSocket].fRecv = true;
+        else if (FD_ISSET(hSocket, &fdsetSend))
+            mapEvents[hSocket].fSend = true;
+    }
+    if (fResult)
+    {
+        for (SOCKET hSocket : vWatchRecv)
+            if (FD_ISSET(hSocket, &fdsetError))
+                mapEvents[hSocket].fError = true;
+        for (SOCKET hSocket : vWatchSend)
+            if (FD_ISSET(hSocket, &fdsetError))
+                mapEvents[hSocket].fError = true;
+    }
+
+    vWatchRecv.clear();
+    vWatchSend.clear();
+    return fResult;
+}
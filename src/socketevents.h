@@ -0,0 +1,113 @@
+#pragma once
+
+#include "netbase.h"
+
+#include <map>
+#include <vector>
+
+//!
+//! \brief Readiness of a socket reported by SocketEvents::Wait.
+//!
+struct SocketEvent
+{
+    bool fRecv;  //!< Data or a connection can be received, or the peer closed.
+    bool fSend;  //!< Data can be sent.
+    bool fError; //!< The socket has an error pending.
+};
+
+//!
+//! \brief Ready sockets keyed by socket.
+//!
+typedef std::map<SOCKET, SocketEvent> SocketEventMap;
+
+//!
+//! \brief Waits for sockets to become ready.
+//!
+//! With select the sockets to wait for are given again before every wait,
+//! and every ready socket is reported by each wait. With epoll they are
+//! added once and stay registered until they are closed. Peer sockets are
+//! then edge triggered: a direction is only reported when it becomes ready
+//! again, so callers remember readiness until a read or write would block.
+//!
+class SocketEvents
+{
+public:
+    enum Backend
+    {
+        SELECT, //!< select(), available everywhere, limited to FD_SETSIZE.
+        EPOLL,  //!< Edge triggered epoll, on Linux.
+    };
+
+    //!
+    //! \brief Check whether a backend is available on this platform.
+    //!
+    static bool IsSupported(Backend backend);
+
+    //!
+    //! \brief Get the name of a backend, as used by \c -socketevents.
+    //!
+    static const char* GetName(Backend backend);
+
+    //!
+    //! \brief Create a waiter.
+    //! \param backend Backend to use. Falls back to select if it is not
+    //! available.
+    //!
+    explicit SocketEvents(Backend backend);
+    ~SocketEvents();
+
+    //!
+    //! \brief Get the backend in use.
+    //!
+    Backend GetBackend() const;
+
+    //!
+    //! \brief Check whether sockets are added once and edge triggered.
+    //!
+    bool IsEdgeTriggered() const;
+
+    //!
+    //! \brief Check whether a socket can be waited for. Select cannot wait
+    //! for sockets numbered FD_SETSIZE or above.
+    //!
+    bool CanWatch(SOCKET hSocket) const;
+
+    //!
+    //! \brief Register a socket with an edge triggered backend. Does
+    //! nothing for select.
+    //! \param hSocket Socket to register.
+    //! \param fListen Whether \p hSocket is a listening socket. Listening
+    //! sockets are level triggered so that connections left pending after
+    //! an accept are reported again.
+    //! \return \c true if the socket was registered.
+    //!
+    bool Add(SOCKET hSocket, bool fListen);
+
+    //!
+    //! \brief Wait for a socket in the next select. Does nothing for edge
+    //! triggered backends.
+    //! \param hSocket Socket to wait for.
+    //! \param fRecv Wait for data to receive.
+    //! \param fSend Wait for room to send.
+    //!
+    void Watch(SOCKET hSocket, bool fRecv, bool fSend);
+
+    //!
+    //! \brief Wait until sockets are ready or a timeout passes.
+    //! \param mapEvents Receives the ready sockets.
+    //! \param nTimeoutMillis Longest time to wait.
+    //! \return \c false if waiting failed. Select then reports every
+    //! watched socket as ready to receive, so that reads find the sockets
+    //! which failed it.
+    //!
+    bool Wait(SocketEventMap& mapEvents, int nTimeoutMillis);
+
+private:
+    SocketEvents(const SocketEvents&);
+    void operator=(const SocketEvents&);
+
+    Backend backend;
+    int hEpoll;
+    std::vector<SOCKET> vWatchRecv;
+    std::vector<SOCKET> vWatchSend;
+};
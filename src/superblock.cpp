@@ -0,0 +1,137 @@
+#include "superblock.h"
+#include "util.h"
+#include "xmlview.h"
+
+#include <algorithm>
+
+double cdbl(std::string s, int place);
+std::vector<std::string> split(std::string s, std::string delim);
+
+namespace
+{
+    // Packed entry layout: big endian CPID followed by big endian magnitude
+    const size_t CPID_SIZE = 16;
+    const size_t ENTRY_SIZE = CPID_SIZE + 2;
+    const double MAX_PACKED_MAGNITUDE = 32767;
+
+    bool CompareCpid(const Superblock::Entry& a, const Superblock::Entry& b)
+    {
+        return a.cpid < b.cpid;
+    }
+}
+
+Superblock::Superblock()
+    : zeroCount(0)
+{
+}
+
+Superblock Superblock::Parse(const std::string& data)
+{
+    const XMLView sections(data, {"AVERAGES", "QUOTES", "BINARY", "ZERO", "MAGNITUDES"});
+    Superblock superblock;
+    superblock.averages = sections.GetString(0);
+    superblock.quotes = sections.GetString(1);
+
+    const boost::string_ref binary = sections[2];
+    if (!binary.empty())
+    {
+        double zero = cdbl(sections.GetString(3), 0);
+        if (zero > 0)
+            superblock.zeroCount = zero;
+
+        // A trailing partial entry is ignored
+        superblock.entries.reserve(binary.size() / ENTRY_SIZE);
+        for (size_t x = 0; x + ENTRY_SIZE <= binary.size(); x += ENTRY_SIZE)
+        {
+            const unsigned char* p = (const unsigned char*)&binary[x];
+            Entry entry;
+            for (size_t i = 0; i < CPID_SIZE; ++i)
+                entry.cpid.begin()[CPID_SIZE - 1 - i] = p[i];
+            entry.magnitude = (p[CPID_SIZE] << 8) | p[CPID_SIZE + 1];
+            superblock.entries.push_back(entry);
+        }
+    }
+    else
+    {
+        const std::vector<std::string> rows = split(sections.GetString(4), ";");
+        superblock.entries.reserve(rows.size());
+        for (const std::string& row : rows)
+        {
+            if (row.length() <= 1)
+                continue;
+
+            const std::vector<std::string> fields = split(row, ",");
+            const std::string padded = "00000000000000000000000000000000000" + fields[0];
+            Entry entry;
+            entry.cpid.SetHex(padded.substr(padded.length() - 32, 32));
+            entry.magnitude = cdbl(fields.size() > 1 ? fields[1] : "", 0);
+            if (entry.cpid == 0)
+                superblock.zeroCount++;
+            else
+                superblock.entries.push_back(entry);
+        }
+    }
+
+    superblock.sorted = superblock.entries;
+    std::stable_sort(superblock.sorted.begin(), superblock.sorted.end(), CompareCpid);
+    return superblock;
+}
+
+std::string Superblock::PackBinary() const
+{
+    std::string binary;
+    binary.reserve(entries.size() * ENTRY_SIZE);
+    for (const Entry& entry : entries)
+    {
+        uint128 cpid = entry.cpid;
+        for (size_t i = 0; i < CPID_SIZE; ++i)
+            binary.push_back(cpid.begin()[CPID_SIZE - 1 - i]);
+
+        // Clamp so we do not blow out the binary space (technically we can handle 0-65535)
+        double magnitude = std::min(std::max(entry.magnitude, 0.0), MAX_PACKED_MAGNITUDE);
+        unsigned int nMagnitude = (unsigned int)Round(magnitude, 0);
+        binary.push_back((char)(nMagnitude >> 8));
+        binary.push_back((char)(nMagnitude & 0xff));
+    }
+
+    return "<ZERO>" + RoundToString(zeroCount, 0) + "</ZERO><BINARY>" + binary + "</BINARY>"
+         + "<AVERAGES>" + averages + "</AVERAGES><QUOTES>" + quotes + "</QUOTES>";
+}
+
+std::string Superblock::Unpack() const
+{
+    std::string magnitudes;
+    magnitudes.reserve(entries.size() * 40 + zeroCount * 5);
+    for (const Entry& entry : entries)
+        magnitudes += entry.cpid.GetHex() + "," + RoundToString(entry.magnitude, 0) + ";";
+
+    // Append zero magnitude researchers so the beacon count matches
+    for (unsigned int i = 0; i < zeroCount; ++i)
+        magnitudes += "0,15;";
+
+    return "<AVERAGES>" + averages + "</AVERAGES><QUOTES>" + quotes + "</QUOTES><MAGNITUDES>" + magnitudes + "</MAGNITUDES>";
+}
+
+double Superblock::GetMagnitude(const uint128& cpid) const
+{
+    // Entries sharing the first 31 digits sort next to each other, starting
+    // at the one whose last digit is zero.
+    const uint128 prefix = cpid >> 4;
+    Entry first;
+    first.cpid = prefix << 4;
+    auto it = std::lower_bound(sorted.begin(), sorted.end(), first, CompareCpid);
+    if (it != sorted.end() && (it->cpid >> 4) == prefix)
+        return it->magnitude;
+
+    return -1;
+}
+
+double Superblock::GetMagnitude(const std::string& cpid) const
+{
+    if (cpid.length() < 32)
+        return -1;
+
+    uint128 value;
+    value.SetHex(cpid.substr(0, 32));
+    return GetMagnitude(value);
+}
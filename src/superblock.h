@@ -0,0 +1,110 @@
+#pragma once
+
+#include "uint256.h"
+
+#include <string>
+#include <vector>
+
+//!
+//! \brief Decoded neural network superblock.
+//!
+//! Superblocks travel either as the legacy text contract, where the
+//! magnitudes are \c ; separated \c cpid,magnitude rows inside a
+//! \c <MAGNITUDES> node, or in the packed form where every researcher takes
+//! 16 bytes of CPID and 2 bytes of magnitude inside a \c <BINARY> node and
+//! zero magnitude researchers are only counted in \c <ZERO>. Both decode to
+//! the same structure, which keeps the rows in contract order (the quorum
+//! hash depends on it) and a copy sorted by CPID for lookups.
+//!
+class Superblock
+{
+public:
+    //!
+    //! \brief Magnitude of a single researcher.
+    //!
+    struct Entry
+    {
+        uint128 cpid;
+        double magnitude;
+    };
+
+    //!
+    //! \brief Create an empty superblock.
+    //!
+    Superblock();
+
+    //!
+    //! \brief Decode a superblock contract.
+    //!
+    //! Accepts both the packed and the text form. Text rows are read the way
+    //! \a PackBinarySuperblock always read them: the CPID is zero padded to
+    //! 32 hex digits and an all zero CPID is counted as a zero magnitude
+    //! researcher.
+    //!
+    //! \param data Superblock contract.
+    //! \return Decoded superblock.
+    //! \throws boost::bad_lexical_cast if a magnitude is not a number.
+    //!
+    static Superblock Parse(const std::string& data);
+
+    //!
+    //! \brief Encode the superblock in the packed form.
+    //!
+    //! Magnitudes are clamped to 0-32767 to fit the two byte field.
+    //!
+    std::string PackBinary() const;
+
+    //!
+    //! \brief Encode the superblock in the text form.
+    //!
+    //! Zero magnitude researchers are written as \c 0,15 rows after the
+    //! others so that the row count matches the beacon count.
+    //!
+    std::string Unpack() const;
+
+    //!
+    //! \brief Look up the magnitude of a researcher.
+    //!
+    //! As with the text scan this replaces, only the first 31 hex digits of
+    //! the CPID are compared.
+    //!
+    //! \param cpid CPID to look up.
+    //! \return Magnitude of \p cpid, or -1 if it is not in the superblock.
+    //!
+    double GetMagnitude(const uint128& cpid) const;
+
+    //!
+    //! \copydoc GetMagnitude(const uint128&) const
+    //!
+    double GetMagnitude(const std::string& cpid) const;
+
+    //!
+    //! \brief Researchers with a magnitude, in contract order.
+    //!
+    const std::vector<Entry>& GetEntries() const { return entries; }
+
+    //!
+    //! \brief Number of zero magnitude researchers.
+    //!
+    unsigned int GetZeroCount() const { return zeroCount; }
+
+    //!
+    //! \brief Number of researchers including the zero magnitude ones.
+    //!
+    size_t size() const { return entries.size() + zeroCount; }
+
+    //!
+    //! \brief Check if the superblock lists no researchers.
+    //!
+    bool empty() const { return size() == 0; }
+
+    const std::string& GetAverages() const { return averages; }
+    const std::string& GetQuotes() const { return quotes; }
+
+private:
+    std::vector<Entry> entries;
+    std::vector<Entry> sorted;
+    unsigned int zeroCount;
+    std::string averages;
+    std::string quotes;
+};
@@ -286,4 +286,38 @@ public:
     }
 };
 
+/** Wakes a thread sleeping in Wait. A signal sent while the thread is not
+ *  sleeping makes its next Wait return at once. */
+class CWakeSignal
+{
+private:
+    boost::condition_variable condition;
+    boost::mutex mutex;
+    bool fSignalled;
+
+public:
+    CWakeSignal() : fSignalled(false) {}
+
+    void Signal()
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            fSignalled = true;
+        }
+        condition.notify_one();
+    }
+
+    /** Sleep until signalled or for at most nMilliseconds. Returns whether
+     *  it was signalled. */
+    bool Wait(int64_t nMilliseconds)
+    {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        if (!fSignalled)
+            condition.timed_wait(lock, boost::posix_time::milliseconds(nMilliseconds));
+        bool fWoken = fSignalled;
+        fSignalled = false;
+        return fWoken;
+    }
+};
+
 #endif // BITCOIN_SYNC_H
@@ -0,0 +1,95 @@
+#include "appcache.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(appcache_tests);
+
+BOOST_AUTO_TEST_CASE(ReadShouldReturnWrittenEntry)
+{
+   WriteCache("appcache_test", "key", "value", 12345);
+   BOOST_CHECK_EQUAL(ReadCache("appcache_test", "key"), "value");
+
+   AppCacheEntry entry = ReadCacheEntry("appcache_test", "key");
+   BOOST_CHECK_EQUAL(entry.value, "value");
+   BOOST_CHECK_EQUAL(entry.timestamp, 12345);
+   BOOST_CHECK_EQUAL(ReadCacheTimestamp("appcache_test", "key"), 12345);
+
+   WriteCache("appcache_test", "key", "other", 23456);
+   entry = ReadCacheEntry("appcache_test", "key");
+   BOOST_CHECK_EQUAL(entry.value, "other");
+   BOOST_CHECK_EQUAL(entry.timestamp, 23456);
+
+   DeleteCache("appcache_test", "key");
+}
+
+BOOST_AUTO_TEST_CASE(ReadsShouldAddMissingEntries)
+{
+   // A timestamp read leaves the cache alone
+   BOOST_CHECK_EQUAL(ReadCacheTimestamp("appcache_test", "missing"), 0);
+   BOOST_CHECK(ReadCacheSection("appcache_test").empty());
+
+   // A value read adds an empty entry which later listings include
+   BOOST_CHECK_EQUAL(ReadCache("appcache_test", "missing"), "");
+   BOOST_CHECK_EQUAL(ReadCacheEntry("appcache_test", "other").timestamp, 0);
+   AppCacheSection section = ReadCacheSection("appcache_test");
+   BOOST_REQUIRE_EQUAL(section.size(), 2U);
+   BOOST_CHECK_EQUAL(section.begin()->first, "appcache_test;missing");
+   BOOST_CHECK_EQUAL(section.begin()->second.value, "");
+
+   // Empty sections and keys are ignored
+   WriteCache("", "key", "value", 1);
+   WriteCache("appcache_test", "", "value", 1);
+   ReadCache("", "key");
+   BOOST_CHECK_EQUAL(ReadCacheSection("appcache_test").size(), 2U);
+   BOOST_CHECK(ReadCacheSection(";").empty());
+
+   DeleteCache("appcache_test", "missing");
+   DeleteCache("appcache_test", "other");
+   BOOST_CHECK(ReadCacheSection("appcache_test").empty());
+}
+
+BOOST_AUTO_TEST_CASE(SectionsShouldMatchByPrefix)
+{
+   WriteCache("appcache_test", "b", "2", 2);
+   WriteCache("appcache_test", "a", "1", 1);
+   WriteCache("appcache_testmapping", "a", "x", 3);
+
+   // Entries are listed in key order, including the section sharing the
+   // prefix
+   AppCacheSection section = ReadCacheSection("appcache_test");
+   BOOST_REQUIRE_EQUAL(section.size(), 3U);
+   AppCacheSection::const_iterator it = section.begin();
+   BOOST_CHECK_EQUAL(it->first, "appcache_test;a");
+   BOOST_CHECK_EQUAL(it->second.value, "1");
+   BOOST_CHECK_EQUAL((++it)->first, "appcache_test;b");
+   BOOST_CHECK_EQUAL((++it)->first, "appcache_testmapping;a");
+   BOOST_CHECK_EQUAL(ReadCacheSection("appcache_testmapping").size(), 1U);
+
+   DeleteCache("appcache_test", "a");
+   BOOST_CHECK_EQUAL(ReadCacheSection("appcache_test").size(), 2U);
+
+   DeleteCache("appcache_test", "b");
+   DeleteCache("appcache_testmapping", "a");
+}
+
+BOOST_AUTO_TEST_CASE(ClearShouldOnlyTouchMatchingValues)
+{
+   WriteCache("appcache_test", "key", "value", 5);
+   WriteCache("appcache_test", "pointer", "appcache_test;cleared", 6);
+   WriteCache("appcache_test", "cleared", "kept", 7);
+
+   // Keys are left alone; the entry named by a value starting with the
+   // section is blanked with a timestamp of 1
+   ClearCache("appcache_test");
+   BOOST_CHECK_EQUAL(ReadCache("appcache_test", "key"), "value");
+   BOOST_CHECK_EQUAL(ReadCache("appcache_test", "pointer"), "appcache_test;cleared");
+   AppCacheEntry entry = ReadCacheEntry("appcache_test", "cleared");
+   BOOST_CHECK_EQUAL(entry.value, "");
+   BOOST_CHECK_EQUAL(entry.timestamp, 1);
+
+   DeleteCache("appcache_test", "key");
+   DeleteCache("appcache_test", "pointer");
+   DeleteCache("appcache_test", "cleared");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
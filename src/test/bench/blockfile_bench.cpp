@@ -0,0 +1,56 @@
+#include <boost/test/unit_test.hpp>
+
+#include "blockfile.h"
+#include "main.h"
+#include "util.h"
+#include "test/blockfile_tests.h"
+
+using namespace std;
+
+// A block read the way OpenBlockFile served every read before the reader.
+static bool ReadBlockStdio(const boost::filesystem::path& path, unsigned int nPos, CBlock& block)
+{
+    CAutoFile filein(fopen(path.string().c_str(), "rb"), SER_DISK, CLIENT_VERSION);
+    if (!filein || fseek(filein, nPos, SEEK_SET) != 0)
+        return false;
+    filein >> block;
+    return true;
+}
+
+BOOST_FIXTURE_TEST_SUITE(blockfile_bench, BlockFileSetup)
+
+#ifndef WIN32
+BOOST_AUTO_TEST_CASE(blockfile_random_read_benchmark)
+{
+    const unsigned int nBlocks = 500;
+    const unsigned int nReads = 20000;
+
+    vector<CBlock> vBlocks;
+    for (unsigned int n = 0; n < nBlocks; n++)
+        vBlocks.push_back(TestBlock(n, 1 + n % 8));
+    vector<unsigned int> vPos = AppendBlocks(path, vBlocks);
+
+    vector<unsigned int> vOrder;
+    for (unsigned int i = 0; i < nReads; i++)
+        vOrder.push_back(GetRandInt(nBlocks));
+
+    CBlock block;
+    int64_t nStart = GetTimeMicros();
+    BOOST_FOREACH(unsigned int n, vOrder)
+        BOOST_REQUIRE(ReadBlockStdio(path, vPos[n], block));
+    int64_t nStdio = GetTimeMicros() - nStart;
+
+    BlockFileReader reader(dir);
+    nStart = GetTimeMicros();
+    BOOST_FOREACH(unsigned int n, vOrder)
+        BOOST_REQUIRE(reader.Read(1, vPos[n], block, SER_DISK, CLIENT_VERSION));
+    int64_t nMapped = GetTimeMicros() - nStart;
+    BOOST_CHECK(block.GetHash() == vBlocks[vOrder.back()].GetHash());
+
+    BOOST_TEST_MESSAGE("blockfile: " << nReads << " random block reads, fopen/fseek "
+                       << 1000000.0 * nReads / max<int64_t>(nStdio, 1) << " reads/s, mapped "
+                       << 1000000.0 * nReads / max<int64_t>(nMapped, 1) << " reads/s");
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,45 @@
+#include "boincblock.h"
+#include "main.h"
+#include "util.h"
+#include "test/boincblock_tests.h"
+
+#include <boost/test/unit_test.hpp>
+
+MiningCPID DeserializeBoincBlock(std::string block, int BlockVersion);
+
+BOOST_AUTO_TEST_SUITE(boincblock_bench);
+
+// Micro-benchmark: split/cdbl parsing against the view based parser
+BOOST_AUTO_TEST_CASE(DeserializeBenchmark)
+{
+   const int nRounds = 20000;
+   const int nSamples = sizeof(SAMPLES) / sizeof(SAMPLES[0]);
+   size_t nCheck = 0;
+
+   int64_t nStart = GetTimeMicros();
+   for (int i = 0; i < nRounds; ++i)
+      nCheck += LegacyDeserialize(SAMPLES[i % nSamples], 8).cpid.size();
+   int64_t nLegacy = GetTimeMicros() - nStart;
+
+   nStart = GetTimeMicros();
+   for (int i = 0; i < nRounds; ++i)
+      nCheck -= DeserializeBoincBlock(SAMPLES[i % nSamples], 8).cpid.size();
+   int64_t nDeserialize = GetTimeMicros() - nStart;
+
+   // What ComputeNeuralNetworkSupermajorityHashes needs from every block
+   nStart = GetTimeMicros();
+   for (int i = 0; i < nRounds; ++i)
+   {
+      BoincBlockView view(SAMPLES[i % nSamples]);
+      nCheck += view.GetValidString(BoincBlockView::NEURAL_HASH).size();
+      nCheck += view.GetValidString(BoincBlockView::GRC_ADDRESS).size();
+   }
+   int64_t nView = GetTimeMicros() - nStart;
+
+   BOOST_TEST_MESSAGE("boincblock: " << nRounds << " blocks, split/cdbl " << 1000.0 * nLegacy / nRounds
+                      << " ns/block, DeserializeBoincBlock " << 1000.0 * nDeserialize / nRounds
+                      << " ns/block, view of two fields " << 1000.0 * nView / nRounds << " ns/block");
+   BOOST_CHECK(nCheck > 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,108 @@
+#include "debuglog.h"
+#include "util.h"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <cstdio>
+
+namespace
+{
+   // Both benchmark sides log the same, already formatted, line
+   const std::string BENCH_LINE = "ProcessBlock: ACCEPTED 0000000000000000000000000000000000000000000000000000000000000000\n";
+
+   // Debug.log as it was written before the writer thread: every call
+   // serialized on one mutex with an unbuffered, flushed file.
+   void LegacyLog(FILE* file, boost::mutex* mutex, unsigned int nLines)
+   {
+      for (unsigned int i = 0; i < nLines; ++i)
+      {
+         std::string str = BENCH_LINE;
+         boost::mutex::scoped_lock lock(*mutex);
+         fprintf(file, "%s", str.c_str());
+         fflush(file);
+      }
+   }
+
+   void QueueLog(DebugLogQueue* queue, unsigned int nLines)
+   {
+      for (unsigned int i = 0; i < nLines; ++i)
+      {
+         std::string str = BENCH_LINE;
+         queue->Push(0, str);
+      }
+   }
+
+   void DrainQueue(DebugLogQueue* queue, FILE* file, const std::atomic<bool>* fStop)
+   {
+      int64_t nTime;
+      std::string str;
+      while (true)
+      {
+         bool fStopped = *fStop;
+         size_t nWritten = 0;
+         while (queue->Pop(nTime, str))
+         {
+            fwrite(str.data(), 1, str.size(), file);
+            nWritten++;
+         }
+
+         if (nWritten)
+            fflush(file);
+         else if (fStopped)
+            break;
+         else
+            boost::this_thread::yield();
+      }
+   }
+
+   // Run nThreads copies of fn and return the elapsed time in microseconds.
+   template<typename Fn>
+   int64_t TimeThreads(unsigned int nThreads, Fn fn)
+   {
+      boost::thread_group threads;
+      int64_t nStart = GetTimeMicros();
+      for (unsigned int i = 0; i < nThreads; ++i)
+         threads.create_thread(fn);
+      threads.join_all();
+      return GetTimeMicros() - nStart;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(debuglog_bench);
+
+BOOST_AUTO_TEST_CASE(ContentionBenchmark)
+{
+   const unsigned int nThreads = 4;
+   const unsigned int nLines = 20000;
+   const unsigned int nCalls = nThreads * nLines;
+
+   FILE* fileLegacy = tmpfile();
+   FILE* fileQueued = tmpfile();
+   BOOST_REQUIRE(fileLegacy && fileQueued);
+   setbuf(fileLegacy, NULL);
+   setvbuf(fileQueued, NULL, _IOFBF, 64 * 1024);
+
+   boost::mutex mutex;
+   int64_t nLegacy = TimeThreads(nThreads, boost::bind(&LegacyLog, fileLegacy, &mutex, nLines));
+
+   // Sized so that no line is dropped and both write the same text
+   DebugLogQueue queue(nCalls, 64 * 1024 * 1024);
+   std::atomic<bool> fStop(false);
+   boost::thread writer(boost::bind(&DrainQueue, &queue, fileQueued, &fStop));
+   int64_t nQueued = TimeThreads(nThreads, boost::bind(&QueueLog, &queue, nLines));
+   fStop = true;
+   writer.join();
+
+   BOOST_CHECK_EQUAL(queue.TakeDropped(), 0);
+   BOOST_CHECK_EQUAL(ftell(fileQueued), ftell(fileLegacy));
+   fclose(fileLegacy);
+   fclose(fileQueued);
+
+   BOOST_TEST_MESSAGE("debuglog: " << nThreads << " threads, mutex + unbuffered file "
+                      << 1000.0 * nLegacy / nCalls << " ns/call, queued "
+                      << 1000.0 * nQueued / nCalls << " ns/call");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,68 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/foreach.hpp>
+
+#include "net.h"
+#include "util.h"
+#include "test/net_tests.h"
+
+#include <ctime>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(net_bench)
+
+// CPU spent relaying a transaction to a full set of peers, each pushing its
+// own copy of the message or all sharing one
+BOOST_AUTO_TEST_CASE(net_relay_benchmark)
+{
+    const size_t nPeers = 125;
+    const int nTransactions = 1000;
+    const int nBatch = 50;
+    TestPeers peers(nPeers);
+
+    for (int fShared = 0; fShared < 2; fShared++)
+    {
+        clock_t nCpu = 0;
+        size_t nReceived = 0;
+        size_t nExpected = 0;
+        for (int n = 0; n < nTransactions; n += nBatch)
+        {
+            clock_t nStartCpu = clock();
+            for (int i = n; i < n + nBatch; i++)
+            {
+                CDataStream ss = TestPayload(i, 250);
+                if (fShared)
+                {
+                    CMessageDataPtr message = MakeMessage("tx", ss);
+                    BOOST_FOREACH(TestPeer* peer, peers.vPeers)
+                        peer->pnode->PushMessageData(message);
+                }
+                else
+                {
+                    BOOST_FOREACH(TestPeer* peer, peers.vPeers)
+                        peer->pnode->PushMessage("tx", ss);
+                }
+                nExpected += nPeers * (CMessageHeader::HEADER_SIZE + ss.size());
+            }
+            nCpu += clock() - nStartCpu;
+
+            BOOST_FOREACH(TestPeer* peer, peers.vPeers)
+                nReceived += peer->Drain();
+        }
+
+        // The last bytes sent may still be on their way through the
+        // loopback, and would otherwise be counted for the next round
+        for (int nTries = 0; nReceived < nExpected && nTries < 1000; nTries++)
+        {
+            MilliSleep(1);
+            BOOST_FOREACH(TestPeer* peer, peers.vPeers)
+                nReceived += peer->Drain();
+        }
+
+        BOOST_CHECK_EQUAL(nReceived, nExpected);
+        BOOST_TEST_MESSAGE("net: " << (fShared ? "shared message" : "message per peer") << ", " << nPeers << " peers: "
+                           << (int)((double)nCpu / CLOCKS_PER_SEC * 1000000 / nTransactions) << "us cpu per relayed transaction");
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,38 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/foreach.hpp>
+
+#include "kernel.h"
+#include "sha256.h"
+#include "util.h"
+#include "test/sha256_tests.h"
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(sha256_bench)
+
+BOOST_AUTO_TEST_CASE(sha256d_benchmark)
+{
+    const size_t nCount = 1 << 14;
+    const size_t vSizes[] = { STAKE_KERNEL_V8_SIZE, 2 * sizeof(uint256) };
+    BOOST_FOREACH(size_t nSize, vSizes)
+    {
+        vector<unsigned char> vIn = TestMessages(nSize, nCount);
+        vector<uint256> vOut(nCount);
+        BOOST_FOREACH(Sha256DImplementation impl, IMPLEMENTATIONS)
+        {
+            if (!Sha256DSupported(impl))
+                continue;
+
+            int64_t nStart = GetTimeMicros();
+            Sha256DBatch(vOut[0].begin(), &vIn[0], nSize, nCount, impl);
+            int64_t nElapsed = std::max<int64_t>(1, GetTimeMicros() - nStart);
+
+            BOOST_CHECK(vOut[nCount - 1] == Hash(vIn.begin() + (nCount - 1) * nSize, vIn.begin() + nCount * nSize));
+            BOOST_TEST_MESSAGE("sha256d: " << Sha256DName(impl) << (impl == Sha256DBest() ? " (best)" : "")
+                               << ", " << nSize << " byte messages: "
+                               << (int64_t)(nCount * 1000000.0 / nElapsed) << " hashes/s");
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
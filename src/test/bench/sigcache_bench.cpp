@@ -0,0 +1,59 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread.hpp>
+
+#include "sigcache.h"
+#include "util.h"
+#include "test/sigcache_tests.h"
+
+using namespace std;
+
+static void SigCacheWorker(CSignatureCache* pcache, const vector<uint256>* pvKeys, unsigned int* pnHits)
+{
+    vector<unsigned char> vchSig = TestVch(3, 71);
+    vector<unsigned char> vchPubKey = TestVch(4, 33);
+    unsigned int nHits = 0;
+    BOOST_FOREACH(const uint256& sighash, *pvKeys)
+    {
+        if (pcache->Get(sighash, vchSig, vchPubKey))
+            nHits++;
+        else
+            pcache->Set(sighash, vchSig, vchPubKey);
+    }
+    *pnHits = nHits;
+}
+
+BOOST_AUTO_TEST_SUITE(sigcache_bench)
+
+// Micro-benchmark: reports hit rate and ns/lookup with several threads hammering one cache
+BOOST_AUTO_TEST_CASE(sigcache_concurrent_benchmark)
+{
+    const int nThreads = 4;
+    const int nLookups = 100000;
+    CSignatureCache cache(TestHash(1), 50000);
+    unsigned int vnHits[nThreads];
+
+    // Half the keys are shared with other threads, half are private
+    vector<vector<uint256> > vKeys(nThreads);
+    for (int nThread = 0; nThread < nThreads; nThread++)
+        for (int i = 0; i < nLookups; i++)
+            vKeys[nThread].push_back(TestHash((i % 2) ? i % 20000 : 1000000 * (nThread + 1) + i));
+
+    int64_t nStart = GetTimeMicros();
+    boost::thread_group threads;
+    for (int i = 0; i < nThreads; i++)
+        threads.create_thread(boost::bind(&SigCacheWorker, &cache, &vKeys[i], &vnHits[i]));
+    threads.join_all();
+    int64_t nElapsed = GetTimeMicros() - nStart;
+
+    unsigned int nHits = 0;
+    for (int i = 0; i < nThreads; i++)
+        nHits += vnHits[i];
+    double dLookups = (double)nThreads * nLookups;
+    BOOST_TEST_MESSAGE("sigcache: " << nThreads << " threads, " << dLookups << " lookups, hit rate "
+                       << 100.0 * nHits / dLookups << "%, " << 1000.0 * nElapsed * nThreads / dLookups
+                       << " ns/lookup per thread (" << 1000.0 * nElapsed / dLookups << " ns wall)");
+    BOOST_CHECK(nHits > 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
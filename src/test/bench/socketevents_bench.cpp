@@ -0,0 +1,101 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/foreach.hpp>
+
+#include "socketevents.h"
+#include "util.h"
+#include "test/socketevents_tests.h"
+
+#include <ctime>
+
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+// Whether the process may open enough descriptors for a number of loopback
+// connections, two sockets each, besides those it already has open
+static bool CanOpenConnections(size_t nCount)
+{
+#ifndef WIN32
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+        return limit.rlim_cur >= 2 * nCount + 64;
+#endif
+    return true;
+}
+
+BOOST_AUTO_TEST_SUITE(socketevents_bench)
+
+// Loopback stress test: one message at a time to one of many peers, as a
+// node spends most of its time waiting for a few of them to send
+BOOST_AUTO_TEST_CASE(socketevents_benchmark)
+{
+    const size_t vPeers[] = { 100, 500, 1000 };
+    const int nMessages = 20000;
+    const size_t nMessageSize = 32;
+
+    BOOST_FOREACH(size_t nPeers, vPeers)
+    {
+        if (!CanOpenConnections(nPeers))
+        {
+            BOOST_TEST_MESSAGE("socketevents: " << nPeers << " peers: skipped, too few file descriptors allowed");
+            continue;
+        }
+
+        TestConnections connections(nPeers);
+        BOOST_FOREACH(SocketEvents::Backend backend, BACKENDS)
+        {
+            if (!SocketEvents::IsSupported(backend))
+                continue;
+
+            SocketEvents events(backend);
+            bool fWatchable = true;
+            for (size_t i = 0; i < nPeers; i++)
+            {
+                fWatchable &= events.CanWatch(connections.vPairs[i].second);
+                events.Add(connections.vPairs[i].second, false);
+            }
+            if (!fWatchable)
+            {
+                BOOST_TEST_MESSAGE("socketevents: " << SocketEvents::GetName(backend) << ", " << nPeers << " peers: sockets out of reach");
+                continue;
+            }
+
+            // Take up the readiness reported when the sockets were added
+            SocketEventMap mapEvents;
+            events.Wait(mapEvents, 0);
+
+            char pchBuf[0x10000] = {};
+            int nReceived = 0;
+            int64_t nStart = GetTimeMicros();
+            clock_t nStartCpu = clock();
+            for (int n = 0; n < nMessages; n++)
+            {
+                size_t nPeer = (n * 7919) % nPeers;
+                BOOST_REQUIRE_EQUAL(send(connections.vPairs[nPeer].first, pchBuf, nMessageSize, 0), (int)nMessageSize);
+
+                if (!events.IsEdgeTriggered())
+                    for (size_t i = 0; i < nPeers; i++)
+                        events.Watch(connections.vPairs[i].second, true, false);
+                BOOST_REQUIRE(events.Wait(mapEvents, 1000));
+                for (const auto& item : mapEvents)
+                {
+                    int nBytes;
+                    while ((nBytes = recv(item.first, pchBuf, sizeof(pchBuf), 0)) > 0)
+                        nReceived += nBytes / nMessageSize;
+                }
+            }
+            int64_t nElapsed = std::max<int64_t>(1, GetTimeMicros() - nStart);
+            double dCpu = (double)(clock() - nStartCpu) / CLOCKS_PER_SEC;
+
+            BOOST_CHECK_EQUAL(nReceived, nMessages);
+            BOOST_TEST_MESSAGE("socketevents: " << SocketEvents::GetName(backend) << ", " << nPeers << " peers: "
+                               << (int64_t)(nMessages * 1000000.0 / nElapsed) << " messages/s, "
+                               << (int)(dCpu * 1000000 / nMessages) << "us cpu/message, "
+                               << (int)(dCpu * 100000000 / nElapsed) << "% cpu");
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,45 @@
+#include "superblock.h"
+#include "util.h"
+#include "test/superblock_tests.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+std::string UnpackBinarySuperblock(std::string sBlock);
+std::string PackBinarySuperblock(std::string sBlock);
+
+BOOST_AUTO_TEST_SUITE(superblock_bench);
+
+// Micro-benchmark: text scan lookups against the decoded superblock
+BOOST_AUTO_TEST_CASE(GetMagnitudeBenchmark)
+{
+   const unsigned int nResearchers = 2000;
+   const unsigned int nLookups = 200;
+   const std::string unpacked = UnpackBinarySuperblock(PackBinarySuperblock(TestContract(nResearchers, 50)));
+   std::vector<std::string> vCpids;
+   for (unsigned int i = 0; i < nLookups; ++i)
+      vCpids.push_back(TestCpid((i * 7) % nResearchers));
+   double dCheck = 0;
+
+   int64_t nStart = GetTimeMicros();
+   for (unsigned int i = 0; i < nLookups; ++i)
+      dCheck += LegacyMagnitudeByCPID(unpacked, vCpids[i]);
+   int64_t nLegacy = GetTimeMicros() - nStart;
+
+   nStart = GetTimeMicros();
+   const Superblock superblock = Superblock::Parse(unpacked);
+   int64_t nParse = GetTimeMicros() - nStart;
+
+   nStart = GetTimeMicros();
+   for (unsigned int i = 0; i < nLookups; ++i)
+      dCheck -= superblock.GetMagnitude(vCpids[i]);
+   int64_t nLookup = GetTimeMicros() - nStart;
+
+   BOOST_TEST_MESSAGE("superblock: " << nResearchers << " researchers, text scan " << (double)nLegacy / nLookups
+                      << " us/lookup, decode once " << nParse << " us, sorted lookup "
+                      << 1000.0 * nLookup / nLookups << " ns/lookup");
+   BOOST_CHECK_EQUAL(dCheck, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
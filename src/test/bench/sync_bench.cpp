@@ -0,0 +1,33 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+
+#include "sync.h"
+#include "util.h"
+
+BOOST_AUTO_TEST_SUITE(sync_bench)
+
+// How long a message handler sleeping between rounds takes to notice a
+// message, woken by the socket thread rather than polling every 100 ms
+BOOST_AUTO_TEST_CASE(wake_signal_latency)
+{
+    CWakeSignal wake;
+    const int nRounds = 50;
+    int64_t nTotal = 0;
+    for (int i = 0; i < nRounds; i++)
+    {
+        int64_t nSent = 0;
+        boost::thread sender([&]
+        {
+            MilliSleep(1 + i % 7);
+            nSent = GetTimeMicros();
+            wake.Signal();
+        });
+        BOOST_CHECK(wake.Wait(10000));
+        nTotal += GetTimeMicros() - nSent;
+        sender.join();
+    }
+    BOOST_TEST_MESSAGE("wake signal: woken " << nTotal / nRounds << "us after a signal on average, polling: 50000us");
+    BOOST_CHECK(nTotal / nRounds < 50000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/foreach.hpp>
+
+#include "main.h"
+#include "util.h"
+#include "test/txhash_tests.h"
+
+using namespace std;
+
+// GetHash() calls made for every transaction of a block on its way to the
+// best chain: CheckBlock (duplicate check and BuildMerkleTree), ConnectBlock,
+// SyncWithWallets and the mempool removal in SetBestChain.
+static const int CONNECT_HASHES_PER_TX = 5;
+
+static CBlock TestBlock(unsigned int nTx)
+{
+    CBlock block;
+    for (unsigned int n = 0; n < nTx; n++)
+        block.vtx.push_back(TestTx(n));
+    return block;
+}
+
+// A block as it arrives from the network: no hash cached yet.
+static CBlock ReceiveBlock(const CBlock& block)
+{
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << block;
+    CBlock blockRet;
+    ss >> blockRet;
+    return blockRet;
+}
+
+BOOST_AUTO_TEST_SUITE(txhash_bench)
+
+BOOST_AUTO_TEST_CASE(txhash_connect_benchmark)
+{
+    const unsigned int nTx = 1000;
+    const unsigned int nRounds = 20;
+    const CBlock block = TestBlock(nTx);
+
+    vector<CBlock> vBlocks;
+    for (unsigned int i = 0; i < nRounds; i++)
+        vBlocks.push_back(ReceiveBlock(block));
+
+    // Before: every GetHash() call serialised and hashed the transaction
+    uint256 hashCheck = 0;
+    int64_t nStart = GetTimeMicros();
+    for (unsigned int i = 0; i < nRounds; i++)
+        BOOST_FOREACH(const CTransaction& tx, vBlocks[i].vtx)
+            for (int n = 0; n < CONNECT_HASHES_PER_TX; n++)
+                hashCheck += SerializeHash(tx);
+    int64_t nUncached = GetTimeMicros() - nStart;
+
+    // After: the first call on a received transaction computes the hash
+    uint256 hashCached = 0;
+    nStart = GetTimeMicros();
+    for (unsigned int i = 0; i < nRounds; i++)
+    {
+        vBlocks[i].BuildMerkleTree();
+        BOOST_FOREACH(const CTransaction& tx, vBlocks[i].vtx)
+            for (int n = 1; n < CONNECT_HASHES_PER_TX; n++)
+                hashCached += tx.GetHash();
+    }
+    int64_t nCached = GetTimeMicros() - nStart;
+
+    // The merkle tree starts with the transaction hashes
+    for (unsigned int i = 0; i < nRounds; i++)
+        for (unsigned int n = 0; n < nTx; n++)
+            hashCached += vBlocks[i].vMerkleTree[n];
+    BOOST_CHECK(hashCheck == hashCached);
+    for (unsigned int n = 0; n < nTx; n++)
+        BOOST_CHECK(vBlocks[0].vtx[n].GetHash() == SerializeHash(block.vtx[n]));
+
+    BOOST_TEST_MESSAGE("txhash: " << nTx << " tx/block, hashes computed per block "
+                       << nTx * CONNECT_HASHES_PER_TX << " before, " << nTx << " after; "
+                       << (double)nUncached / nRounds << " us/block uncached, "
+                       << (double)nCached / nRounds << " us/block cached");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,28 @@
+#include <boost/test/unit_test.hpp>
+
+#include "voting.h"
+#include "util.h"
+#include "test/voting_tests.h"
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(voting_bench)
+
+BOOST_AUTO_TEST_CASE(voting_benchmark)
+{
+    ClearVoteIndex();
+    const int nVotes = 20000;
+    for (int i = 0; i < nVotes; i++)
+        IndexVote("Poll;" + to_string(i), TestVote("Poll " + to_string(i % 100), i % 3 ? "Yes" : "Yes;No", "10", "100"));
+
+    int64_t nStart = GetTimeMicros();
+    double dParticipants = 0;
+    for (int i = 0; i < 100; i++)
+        dParticipants += GetPollTallies("Poll " + to_string(i))["yes"].participants;
+    BOOST_TEST_MESSAGE("voting: tallied " << nVotes << " votes in " << (GetTimeMicros() - nStart) << "us");
+
+    BOOST_CHECK_CLOSE(dParticipants, nVotes * 2 / 3.0 + nVotes / 6.0, 0.01);
+    ClearVoteIndex();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
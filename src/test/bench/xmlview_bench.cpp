@@ -0,0 +1,120 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/foreach.hpp>
+
+#include "xmlview.h"
+#include "util.h"
+#include "test/xmlview_tests.h"
+
+using namespace std;
+
+namespace
+{
+    // Superblock as the neural network stakes it, with packed or text
+    // magnitudes
+    string TestSuperblock(unsigned int nResearchers, bool fBinary)
+    {
+        string magnitudes;
+        for (unsigned int i = 0; i < nResearchers; ++i)
+        {
+            uint256 hash = Hash(BEGIN(i), END(i));
+            if (fBinary)
+                magnitudes.append((const char*)hash.begin(), 18);
+            else
+                magnitudes += hash.GetHex().substr(0, 32) + "," + ToString((i * 7919) % 20000) + ";";
+        }
+        return (fBinary ? "<ZERO>12</ZERO><BINARY>" + magnitudes + "</BINARY>" : "<MAGNITUDES>" + magnitudes + "</MAGNITUDES>") +
+               "<AVERAGES>amicableNumbers,2415,122.1;asteroids@home,8612,14400.7;collatz,1544,9102.3;</AVERAGES>"
+               "<QUOTES>btc,6000.00;grc,0.03;</QUOTES>";
+    }
+
+    // Beacon advertisement as carried in a transaction
+    string TestBeacon(unsigned int n)
+    {
+        uint256 hash = Hash(BEGIN(n), END(n));
+        string cpid = hash.GetHex().substr(0, 32);
+        return "<MT>beacon</MT><MK>" + cpid + "</MK><MV>" + EncodeBase64(cpid + ";" + hash.GetHex() + ";S6ifJ6yEZUPEd9rzLuvWgTJDQhYvDGyEqs;"
+               "04" + hash.GetHex() + hash.GetHex()) + "</MV><MA>A</MA><MPK>" + hash.GetHex() + "</MPK><MS>"
+               + EncodeBase64(hash.GetHex() + hash.GetHex()) + "</MS>";
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(xmlview_bench)
+
+// Reading the sections of superblocks and the fields of beacons the way
+// Superblock::Parse and MemorizeMessage do
+BOOST_AUTO_TEST_CASE(xmlview_benchmark)
+{
+    const char* const METHODS[] = { "legacy ExtractXML", "ExtractXML", "XMLView" };
+
+    const string vSuperblocks[] = { TestSuperblock(2000, true), TestSuperblock(5000, false) };
+    const char* const SECTIONS[] = { "AVERAGES", "QUOTES", "BINARY", "ZERO", "MAGNITUDES" };
+    const int nRounds = 100;
+    BOOST_FOREACH(const string& superblock, vSuperblocks)
+    {
+        size_t nLegacySize = 0;
+        for (int nMethod = 0; nMethod < 3; ++nMethod)
+        {
+            size_t nSize = 0;
+            int64_t nStart = GetTimeMicros();
+            for (int n = 0; n < nRounds; ++n)
+            {
+                if (nMethod == 2)
+                {
+                    XMLView view(superblock, { "AVERAGES", "QUOTES", "BINARY", "ZERO", "MAGNITUDES" });
+                    for (size_t i = 0; i < view.size(); ++i)
+                        nSize += view.GetString(i).size();
+                    continue;
+                }
+                BOOST_FOREACH(const char* tag, SECTIONS)
+                {
+                    string key = string("<") + tag + ">";
+                    string key_end = string("</") + tag + ">";
+                    nSize += (nMethod ? ExtractXML(superblock, key, key_end) : LegacyExtractXML(superblock, key, key_end)).size();
+                }
+            }
+            int64_t nElapsed = GetTimeMicros() - nStart;
+
+            if (nMethod == 0)
+                nLegacySize = nSize;
+            BOOST_CHECK_EQUAL(nSize, nLegacySize);
+            BOOST_TEST_MESSAGE("xmlview: " << METHODS[nMethod] << ": " << superblock.size() << " byte superblock in "
+                               << nElapsed / nRounds << "us");
+        }
+    }
+
+    vector<string> vBeacons;
+    for (unsigned int i = 0; i < 1000; ++i)
+        vBeacons.push_back(TestBeacon(i));
+    const char* const FIELDS[] = { "MT", "MK", "MV", "MA", "MS", "MPK" };
+    size_t nLegacySize = 0;
+    for (int nMethod = 0; nMethod < 3; ++nMethod)
+    {
+        size_t nSize = 0;
+        int64_t nStart = GetTimeMicros();
+        BOOST_FOREACH(const string& beacon, vBeacons)
+        {
+            if (nMethod == 2)
+            {
+                XMLView view(beacon, { "MT", "MK", "MV", "MA", "MS", "MPK" });
+                for (size_t i = 0; i < view.size(); ++i)
+                    nSize += view.GetString(i).size();
+                continue;
+            }
+            BOOST_FOREACH(const char* tag, FIELDS)
+            {
+                string key = string("<") + tag + ">";
+                string key_end = string("</") + tag + ">";
+                nSize += (nMethod ? ExtractXML(beacon, key, key_end) : LegacyExtractXML(beacon, key, key_end)).size();
+            }
+        }
+        int64_t nElapsed = GetTimeMicros() - nStart;
+
+        if (nMethod == 0)
+            nLegacySize = nSize;
+        BOOST_CHECK_EQUAL(nSize, nLegacySize);
+        BOOST_TEST_MESSAGE("xmlview: " << METHODS[nMethod] << ": beacon in "
+                           << (double)nElapsed / vBeacons.size() << "us");
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -31,6 +31,7 @@ namespace
          pindexBest = &blocks.back();
          pindexGenesisBlock = &blocks.front();         
          nBestHeight = blocks.back().nHeight;
+         activeChain.SetTip(pindexBest);
       }
       
       std::array<CBlockIndex, Size> blocks;      
@@ -67,4 +68,31 @@ BOOST_AUTO_TEST_CASE(FindBlockByHeightShouldWorkOnChainsWithJustOneBlock)
    BOOST_CHECK_EQUAL(&chain.blocks.front(), finder.FindByHeight(-1));
 }
 
+BOOST_AUTO_TEST_CASE(ActiveChainShouldFollowReorganizations)
+{
+   BlockChain<10> chain;
+   BOOST_CHECK_EQUAL(9, activeChain.Height());
+   BOOST_CHECK_EQUAL(&chain.blocks[5], activeChain[5]);
+
+   // Fork off at height 4 with a longer branch.
+   std::array<CBlockIndex, 8> fork;
+   for(size_t i = 0; i < fork.size(); ++i)
+   {
+      fork[i].pprev = i == 0 ? &chain.blocks[4] : &fork[i - 1];
+      fork[i].nHeight = fork[i].pprev->nHeight + 1;
+   }
+
+   activeChain.SetTip(&fork.back());
+   BOOST_CHECK_EQUAL(12, activeChain.Height());
+   BOOST_CHECK_EQUAL(&chain.blocks[4], activeChain[4]);
+   BOOST_CHECK_EQUAL(&fork[0], activeChain[5]);
+   BOOST_CHECK_EQUAL(&fork.back(), activeChain.Tip());
+   BOOST_CHECK(activeChain[13] == nullptr);
+
+   // And back to the shorter original chain.
+   activeChain.SetTip(&chain.blocks.back());
+   BOOST_CHECK_EQUAL(9, activeChain.Height());
+   BOOST_CHECK_EQUAL(&chain.blocks[5], activeChain[5]);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
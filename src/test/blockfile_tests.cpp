@@ -0,0 +1,125 @@
+#include <boost/test/unit_test.hpp>
+
+#include "blockfile.h"
+#include "main.h"
+#include "util.h"
+#include "test/blockfile_tests.h"
+
+using namespace std;
+
+BOOST_FIXTURE_TEST_SUITE(blockfile_tests, BlockFileSetup)
+
+// Block files are not mapped on Windows
+#ifndef WIN32
+BOOST_AUTO_TEST_CASE(blockfile_read)
+{
+    vector<CBlock> vBlocks;
+    for (unsigned int n = 0; n < 10; n++)
+        vBlocks.push_back(TestBlock(n, 1 + n));
+    vector<unsigned int> vPos = AppendBlocks(path, vBlocks);
+
+    BlockFileReader reader(dir);
+    for (unsigned int n = 0; n < vBlocks.size(); n++)
+    {
+        CBlock block;
+        BOOST_CHECK(reader.Read(1, vPos[n], block, SER_DISK, CLIENT_VERSION));
+        BOOST_CHECK(block.GetHash() == vBlocks[n].GetHash());
+        BOOST_CHECK_EQUAL(block.vtx.size(), vBlocks[n].vtx.size());
+        BOOST_CHECK(block.vtx.back().GetHash() == vBlocks[n].vtx.back().GetHash());
+
+        // Header only
+        CBlock header;
+        BOOST_CHECK(reader.Read(1, vPos[n], header, SER_DISK | SER_BLOCKHEADERONLY, CLIENT_VERSION));
+        BOOST_CHECK(header.GetHash() == vBlocks[n].GetHash());
+        BOOST_CHECK(header.vtx.empty());
+    }
+
+    // A transaction straight from its offset within the block
+    CTransaction tx;
+    unsigned int nTxPos = vPos[3] + ::GetSerializeSize(vBlocks[3], SER_DISK | SER_BLOCKHEADERONLY, CLIENT_VERSION)
+                          + GetSizeOfCompactSize(vBlocks[3].vtx.size());
+    BOOST_CHECK(reader.Read(1, nTxPos, tx, SER_DISK, CLIENT_VERSION));
+    BOOST_CHECK(tx.GetHash() == vBlocks[3].vtx[0].GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(blockfile_growing_file)
+{
+    vector<CBlock> vBlocks(1, TestBlock(0, 2));
+    vector<unsigned int> vPos = AppendBlocks(path, vBlocks);
+
+    BlockFileReader reader(dir);
+    CBlock block;
+    BOOST_CHECK(reader.Read(1, vPos[0], block, SER_DISK, CLIENT_VERSION));
+
+    // Blocks appended after the file was mapped
+    vector<CBlock> vMore;
+    for (unsigned int n = 1; n < 4; n++)
+        vMore.push_back(TestBlock(n, 2));
+    vector<unsigned int> vMorePos = AppendBlocks(path, vMore);
+    for (unsigned int n = 0; n < vMore.size(); n++)
+    {
+        BOOST_CHECK(reader.Read(1, vMorePos[n], block, SER_DISK, CLIENT_VERSION));
+        BOOST_CHECK(block.GetHash() == vMore[n].GetHash());
+    }
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(blockfile_read_fails)
+{
+    vector<CBlock> vBlocks(1, TestBlock(0, 2));
+    vector<unsigned int> vPos = AppendBlocks(path, vBlocks);
+    unsigned int nFileSize = boost::filesystem::file_size(path);
+
+    BlockFileReader reader(dir);
+    CBlock block;
+    BOOST_CHECK(!reader.Read(0, vPos[0], block, SER_DISK, CLIENT_VERSION));
+    BOOST_CHECK(!reader.Read((unsigned int)-1, vPos[0], block, SER_DISK, CLIENT_VERSION));
+    BOOST_CHECK(!reader.Read(2, vPos[0], block, SER_DISK, CLIENT_VERSION));
+    BOOST_CHECK(!reader.Read(1, nFileSize, block, SER_DISK, CLIENT_VERSION));
+    BOOST_CHECK(!reader.Read(1, nFileSize - 10, block, SER_DISK, CLIENT_VERSION));
+}
+
+BOOST_AUTO_TEST_CASE(blockfile_disk_matches_network)
+{
+    // Blocks are served to peers as raw bytes from the block files
+    CBlock block = TestBlock(7, 5);
+    block.vchBlockSig = vector<unsigned char>(70, 0x30);
+    CDataStream ssDisk(SER_DISK, CLIENT_VERSION);
+    ssDisk << block;
+    CDataStream ssNetwork(SER_NETWORK, PROTOCOL_VERSION);
+    ssNetwork << block;
+    BOOST_CHECK(ssDisk.str() == ssNetwork.str());
+}
+
+BOOST_AUTO_TEST_CASE(rawblockcache_lru)
+{
+    RawBlockCache cache(250);
+    RawBlockPtr block1 = make_shared<RawBlock>(100, 1);
+    RawBlockPtr block2 = make_shared<RawBlock>(100, 2);
+    RawBlockPtr block3 = make_shared<RawBlock>(100, 3);
+
+    BOOST_CHECK(!cache.Get(1));
+    cache.Put(1, block1);
+    cache.Put(2, block2);
+    BOOST_CHECK(cache.Get(1) == block1);
+    BOOST_CHECK_EQUAL(cache.GetBytes(), 200);
+
+    // Block 2 is the least recently used
+    cache.Put(3, block3);
+    BOOST_CHECK(!cache.Get(2));
+    BOOST_CHECK(cache.Get(1) == block1);
+    BOOST_CHECK(cache.Get(3) == block3);
+    BOOST_CHECK_EQUAL(cache.GetBytes(), 200);
+
+    // Too large to cache at all
+    cache.Put(4, make_shared<RawBlock>(251, 4));
+    BOOST_CHECK(!cache.Get(4));
+    BOOST_CHECK(cache.Get(1) == block1);
+
+    RawBlockCache cacheDisabled(0);
+    cacheDisabled.Put(1, block1);
+    BOOST_CHECK(!cacheDisabled.Get(1));
+    BOOST_CHECK_EQUAL(cacheDisabled.GetBytes(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
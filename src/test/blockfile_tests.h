@@ -0,0 +1,62 @@
+#pragma once
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+
+#include "main.h"
+
+inline CBlock TestBlock(unsigned int n, unsigned int nTx)
+{
+    CBlock block;
+    block.nTime = 1500000000 + n;
+    block.nNonce = n;
+    for (unsigned int i = 0; i < nTx; i++)
+    {
+        CTransaction tx;
+        tx.nTime = block.nTime;
+        tx.vin.push_back(CTxIn(COutPoint(uint256(n * nTx + i + 1), 0)));
+        tx.vin[0].scriptSig << std::vector<unsigned char>(72, (unsigned char)i) << std::vector<unsigned char>(33, (unsigned char)n);
+        tx.vout.push_back(CTxOut(COIN + i, CScript() << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, (unsigned char)i) << OP_EQUALVERIFY << OP_CHECKSIG));
+        block.vtx.push_back(tx);
+    }
+    block.hashMerkleRoot = block.BuildMerkleTree();
+    return block;
+}
+
+// Append blocks in the blkNNNN.dat layout and return their offsets.
+inline std::vector<unsigned int> AppendBlocks(const boost::filesystem::path& path, const std::vector<CBlock>& vBlocks)
+{
+    unsigned char pchStart[4] = { 0xf9, 0xbe, 0xb4, 0xd9 };
+    std::vector<unsigned int> vPos;
+    CAutoFile fileout(fopen(path.string().c_str(), "ab"), SER_DISK, CLIENT_VERSION);
+    BOOST_REQUIRE(fileout != NULL);
+    fseek(fileout, 0, SEEK_END);
+    BOOST_FOREACH(const CBlock& block, vBlocks)
+    {
+        unsigned int nSize = fileout.GetSerializeSize(block);
+        fileout << FLATDATA(pchStart) << nSize;
+        vPos.push_back(ftell(fileout));
+        fileout << block;
+    }
+    fflush(fileout);
+    return vPos;
+}
+
+struct BlockFileSetup
+{
+    BlockFileSetup()
+    {
+        dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        boost::filesystem::create_directories(dir);
+        path = dir / "blk0001.dat";
+    }
+
+    ~BlockFileSetup()
+    {
+        boost::filesystem::remove_all(dir);
+    }
+
+    boost::filesystem::path dir;
+    boost::filesystem::path path;
+};
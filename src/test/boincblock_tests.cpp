@@ -0,0 +1,88 @@
+#include "boincblock.h"
+#include "main.h"
+#include "util.h"
+#include "test/boincblock_tests.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+MiningCPID DeserializeBoincBlock(std::string block, int BlockVersion);
+
+namespace
+{
+   void CheckSame(const MiningCPID& a, const MiningCPID& b)
+   {
+      BOOST_CHECK_EQUAL(a.cpid, b.cpid);
+      BOOST_CHECK_EQUAL(a.projectname, b.projectname);
+      BOOST_CHECK_EQUAL(a.aesskein, b.aesskein);
+      BOOST_CHECK_EQUAL(a.rac, b.rac);
+      BOOST_CHECK_EQUAL(a.pobdifficulty, b.pobdifficulty);
+      BOOST_CHECK_EQUAL(a.diffbytes, b.diffbytes);
+      BOOST_CHECK_EQUAL(a.enccpid, b.enccpid);
+      BOOST_CHECK_EQUAL(a.encboincpublickey, b.encboincpublickey);
+      BOOST_CHECK_EQUAL(a.encaes, b.encaes);
+      BOOST_CHECK_EQUAL(a.nonce, b.nonce);
+      BOOST_CHECK_EQUAL(a.NetworkRAC, b.NetworkRAC);
+      BOOST_CHECK_EQUAL(a.clientversion, b.clientversion);
+      BOOST_CHECK_EQUAL(a.ResearchSubsidy, b.ResearchSubsidy);
+      BOOST_CHECK_EQUAL(a.LastPaymentTime, b.LastPaymentTime);
+      BOOST_CHECK_EQUAL(a.RSAWeight, b.RSAWeight);
+      BOOST_CHECK_EQUAL(a.cpidv2, b.cpidv2);
+      BOOST_CHECK_EQUAL(a.Magnitude, b.Magnitude);
+      BOOST_CHECK_EQUAL(a.GRCAddress, b.GRCAddress);
+      BOOST_CHECK_EQUAL(a.lastblockhash, b.lastblockhash);
+      BOOST_CHECK_EQUAL(a.InterestSubsidy, b.InterestSubsidy);
+      BOOST_CHECK_EQUAL(a.Organization, b.Organization);
+      BOOST_CHECK_EQUAL(a.OrganizationKey, b.OrganizationKey);
+      BOOST_CHECK_EQUAL(a.NeuralHash, b.NeuralHash);
+      BOOST_CHECK_EQUAL(a.superblock, b.superblock);
+      BOOST_CHECK_EQUAL(a.ResearchSubsidy2, b.ResearchSubsidy2);
+      BOOST_CHECK_EQUAL(a.ResearchAge, b.ResearchAge);
+      BOOST_CHECK_EQUAL(a.ResearchMagnitudeUnit, b.ResearchMagnitudeUnit);
+      BOOST_CHECK_EQUAL(a.ResearchAverageMagnitude, b.ResearchAverageMagnitude);
+      BOOST_CHECK_EQUAL(a.LastPORBlockHash, b.LastPORBlockHash);
+      BOOST_CHECK_EQUAL(a.CurrentNeuralHash, b.CurrentNeuralHash);
+      BOOST_CHECK_EQUAL(a.BoincPublicKey, b.BoincPublicKey);
+      BOOST_CHECK_EQUAL(a.BoincSignature, b.BoincSignature);
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(boincblock_tests);
+
+BOOST_AUTO_TEST_CASE(ViewShouldSplitFields)
+{
+   BoincBlockView view(RESEARCHER);
+   BOOST_CHECK_EQUAL(view.size(), 31U);
+   BOOST_CHECK_EQUAL(view.GetString(BoincBlockView::CPID), "8cfe9864e18db32a334b7de997f5a4f2");
+   BOOST_CHECK(view[BoincBlockView::PROJECT_NAME].empty());
+   BOOST_CHECK_EQUAL(view.GetString(BoincBlockView::GRC_ADDRESS), "SFRXHvgQ7T6fTqXgwMJDnAPmjS2ZC4HZ8T");
+   BOOST_CHECK_EQUAL(view.GetDouble(BoincBlockView::RESEARCH_SUBSIDY, 2), 41.17);
+   BOOST_CHECK_EQUAL(view.GetDouble(BoincBlockView::MAGNITUDE, 0), 312);
+   BOOST_CHECK_EQUAL(view.GetValidFieldCount(), (size_t)BoincBlockView::FIELD_COUNT);
+
+   BoincBlockView empty("");
+   BOOST_CHECK_EQUAL(empty.size(), 1U);
+   BOOST_CHECK(empty[BoincBlockView::BOINC_SIGNATURE].empty());
+   BOOST_CHECK_EQUAL(empty.GetValidFieldCount(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(ViewShouldStopAtMalformedNumbers)
+{
+   BoincBlockView view(MALFORMED);
+   BOOST_CHECK_EQUAL(view.GetValidFieldCount(), (size_t)BoincBlockView::MAGNITUDE);
+   BOOST_CHECK_EQUAL(view.GetValidString(BoincBlockView::CPID_V2), "");
+   BOOST_CHECK_EQUAL(view.GetValidString(BoincBlockView::CURRENT_NEURAL_HASH), "");
+   BOOST_CHECK_EQUAL(view.GetString(BoincBlockView::GRC_ADDRESS), "SFRXHvgQ7T6fTqXgwMJDnAPmjS2ZC4HZ8T");
+}
+
+BOOST_AUTO_TEST_CASE(DeserializeShouldMatchLegacyParser)
+{
+   for (const std::string& sample : SAMPLES)
+   {
+      CheckSame(DeserializeBoincBlock(sample, 8), LegacyDeserialize(sample, 8));
+      CheckSame(DeserializeBoincBlock(sample, 7), LegacyDeserialize(sample, 7));
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
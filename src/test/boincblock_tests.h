@@ -0,0 +1,92 @@
+#pragma once
+
+#include "main.h"
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <string>
+#include <vector>
+
+std::vector<std::string> split(std::string s, std::string delim);
+double cdbl(std::string s, int place);
+MiningCPID GetMiningCPID();
+
+// Coinbase payloads laid out like the ones found on mainnet: a researcher
+// stake, an investor stake, a stake carrying a superblock, a pre research
+// age block and one with a malformed number.
+const std::string RESEARCHER =
+      "8cfe9864e18db32a334b7de997f5a4f2<|><|><|>0<|>0.00000<|>0<|><|><|>0<|>0<|>v3.5.8.8-g2d3c1d5-research"
+      "<|>41.17000000<|>0<|>0<|><|>312<|>SFRXHvgQ7T6fTqXgwMJDnAPmjS2ZC4HZ8T"
+      "<|>6d3e1b2f0a39b7c5bd1f0c4e6a1f8e29d97c2f0b3e5a4d7c8b9e0f1a2b3c4d5e<|>0.13000000<|><|><|><|><|>0"
+      "<|>1.450000<|>0.086000<|>305.51<|>f3c1a2b4c5d6e7f8091a2b3c4d5e6f708192a3b4c5d6e7f8091a2b3c4d5e6f70"
+      "<|>e3a1b2c3d4e5f60718293a4b5c6d7e8f<|>MIGfMA0GCSqGSIb3DQEBAQUAA4GNADCBiQKBgQC3u2Gu1t5l8y0Lq5m2Rk9ZhmT0Kxw"
+      "<|>Vb0pW6ZxJqq3o8v7Vn1iY1s0m3y3Pq6C4uJm5Qe8y1r2Wn6t3k9L0a7Z4xS2d5f8g1h4j7k0l3z6x9c2v5b8n1m4=";
+const std::string INVESTOR =
+      "INVESTOR<|><|><|>0<|>0.00000<|>0<|><|><|>0<|>0<|>v3.5.8.8-g2d3c1d5-research<|>0.00000000<|>0<|>0<|>"
+      "<|>0<|>S6Fz5Fny9cY4m2dJDyHjMZjhmjeL6rMqWY<|>2b0c8fd7e8b4a1c9d3e6f5a4b3c2d1e0f9a8b7c6d5e4f3a2b1c0d9e8f7a6b5c4"
+      "<|>1.56000000<|><|><|><|><|>0<|>0.000000<|>0.000000<|>0.00<|>0<|>8a4c2f1e3b5d7a9c0e2f4a6b8c0d2e4f<|><|>";
+const std::string SUPERBLOCK =
+      "f1e2d3c4b5a69788796a5b4c3d2e1f00<|><|><|>0<|>0.00000<|>0<|><|><|>0<|>0<|>v3.5.8.8-g2d3c1d5-research"
+      "<|>18.52000000<|>0<|>0<|><|>97<|>SAkRRkYbg2EEvk6Dn7P8X7j2bW3Q8mDKz9<|>9f8e7d6c5b4a39281706f5e4d3c2b1a09f8e7d6c5b4a39281706f5e4d3c2b1a0"
+      "<|>0.09000000<|><|><|>8a4c2f1e3b5d7a9c0e2f4a6b8c0d2e4f"
+      "<|><ZAVG>5000</ZAVG><AVERAGES>amicableNumbers,2415,122.1;asteroids@home,8612,14400.7;collatz,1544,9102.3;</AVERAGES>"
+      "<QUOTES>btc,6000.00;grc,0.03;</QUOTES><BINARY>00000000000000000000000000000000000000000000000000000000000000000000</BINARY>"
+      "<|>0<|>0.780000<|>0.086000<|>97.14<|>0<|>8a4c2f1e3b5d7a9c0e2f4a6b8c0d2e4f<|>MIGfMA0GCSqGSIb3DQEBAQUAA4GNADCBiQKBgQDa<|>c2lnbmF0dXJl";
+const std::string LEGACY =
+      "5b7c8e3d1a2f4c6e8b0d2f4a6c8e0b2d<|>rosetta@home<|>1fd3aa2c<|>1845<|>0.00500<|>0<|>a1b2c3d4e5<|>f6a7b8c9<|>1183<|>1820314";
+const std::string MALFORMED =
+      "8cfe9864e18db32a334b7de997f5a4f2<|><|><|>0<|>0.00000<|>0<|><|><|>0<|>0<|>v3.5.8.8<|>41.17<|>0<|>0<|><|>31x2"
+      "<|>SFRXHvgQ7T6fTqXgwMJDnAPmjS2ZC4HZ8T<|>0<|>0.13<|><|><|>e3a1b2c3d4e5f60718293a4b5c6d7e8f";
+
+const std::string SAMPLES[] = { RESEARCHER, INVESTOR, SUPERBLOCK, LEGACY, MALFORMED };
+
+// The split based parser which DeserializeBoincBlock used to be
+inline MiningCPID LegacyDeserialize(const std::string& block, int BlockVersion)
+{
+   MiningCPID surrogate = GetMiningCPID();
+   int subsidy_places= BlockVersion<8 ? 2 : 8;
+   try
+   {
+      std::vector<std::string> s = split(block,"<|>");
+      if (s.size() > 8)
+      {
+         surrogate.cpid = s[0];
+         surrogate.projectname = s[1];
+         boost::to_lower(surrogate.projectname);
+         surrogate.aesskein = s[2];
+         surrogate.rac = cdbl(s[3],0);
+         surrogate.pobdifficulty = cdbl(s[4],6);
+         surrogate.diffbytes = (unsigned int)cdbl(s[5],0);
+         surrogate.enccpid = s[6];
+         surrogate.encboincpublickey = s[6];
+         surrogate.encaes = s[7];
+         surrogate.nonce = cdbl(s[8],0);
+         if (s.size() > 9)  surrogate.NetworkRAC = cdbl(s[9],0);
+         if (s.size() > 10) surrogate.clientversion = s[10];
+         if (s.size() > 11) surrogate.ResearchSubsidy = cdbl(s[11],2);
+         if (s.size() > 12) surrogate.LastPaymentTime = cdbl(s[12],0);
+         if (s.size() > 13) surrogate.RSAWeight = cdbl(s[13],0);
+         if (s.size() > 14) surrogate.cpidv2 = s[14];
+         if (s.size() > 15) surrogate.Magnitude = cdbl(s[15],0);
+         if (s.size() > 16) surrogate.GRCAddress = s[16];
+         if (s.size() > 17) surrogate.lastblockhash = s[17];
+         if (s.size() > 18) surrogate.InterestSubsidy = cdbl(s[18],subsidy_places);
+         if (s.size() > 19) surrogate.Organization = s[19];
+         if (s.size() > 20) surrogate.OrganizationKey = s[20];
+         if (s.size() > 21) surrogate.NeuralHash = s[21];
+         if (s.size() > 22) surrogate.superblock = s[22];
+         if (s.size() > 23) surrogate.ResearchSubsidy2 = cdbl(s[23],subsidy_places);
+         if (s.size() > 24) surrogate.ResearchAge = cdbl(s[24],6);
+         if (s.size() > 25) surrogate.ResearchMagnitudeUnit = cdbl(s[25],6);
+         if (s.size() > 26) surrogate.ResearchAverageMagnitude = cdbl(s[26],2);
+         if (s.size() > 27) surrogate.LastPORBlockHash = s[27];
+         if (s.size() > 28) surrogate.CurrentNeuralHash = s[28];
+         if (s.size() > 29) surrogate.BoincPublicKey = s[29];
+         if (s.size() > 30) surrogate.BoincSignature = s[30];
+      }
+   }
+   catch (...)
+   {
+   }
+   return surrogate;
+}
@@ -0,0 +1,107 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+
+#include "checkqueue.h"
+
+class counter_check
+{
+private:
+    bool fOk;
+    boost::mutex* pmutex;
+    int* pnCount;
+
+public:
+    counter_check() : fOk(true), pmutex(NULL), pnCount(NULL) {}
+    counter_check(bool fOkIn, boost::mutex& mutexIn, int& nCountIn) : fOk(fOkIn), pmutex(&mutexIn), pnCount(&nCountIn) {}
+
+    bool operator()() const
+    {
+        boost::lock_guard<boost::mutex> lock(*pmutex);
+        (*pnCount)++;
+        return fOk;
+    }
+
+    void swap(counter_check& check)
+    {
+        std::swap(fOk, check.fOk);
+        std::swap(pmutex, check.pmutex);
+        std::swap(pnCount, check.pnCount);
+    }
+};
+
+static void RunWorker(CCheckQueue<counter_check>* pqueue)
+{
+    pqueue->Thread();
+}
+
+BOOST_AUTO_TEST_SUITE(checkqueue_tests)
+
+BOOST_AUTO_TEST_CASE(checkqueue_all_run)
+{
+    CCheckQueue<counter_check> queue(16);
+    boost::thread_group workers;
+    for (int i = 0; i < 3; i++)
+        workers.create_thread(boost::bind(&RunWorker, &queue));
+
+    boost::mutex mutex;
+    for (int nRound = 0; nRound < 10; nRound++)
+    {
+        int nCount = 0;
+        {
+            CCheckQueueControl<counter_check> control(&queue);
+            for (int nBatch = 0; nBatch < 20; nBatch++)
+            {
+                std::vector<counter_check> vChecks;
+                for (int i = 0; i < nBatch; i++)
+                    vChecks.push_back(counter_check(true, mutex, nCount));
+                control.Add(vChecks);
+            }
+            BOOST_CHECK(control.Wait());
+        }
+        // 0 + 1 + ... + 19 checks were queued
+        BOOST_CHECK_EQUAL(nCount, 190);
+    }
+
+    queue.Interrupt();
+    workers.join_all();
+}
+
+BOOST_AUTO_TEST_CASE(checkqueue_failure)
+{
+    CCheckQueue<counter_check> queue(16);
+    boost::thread_group workers;
+    for (int i = 0; i < 3; i++)
+        workers.create_thread(boost::bind(&RunWorker, &queue));
+
+    boost::mutex mutex;
+    int nCount = 0;
+    {
+        CCheckQueueControl<counter_check> control(&queue);
+        std::vector<counter_check> vChecks;
+        for (int i = 0; i < 100; i++)
+            vChecks.push_back(counter_check(i != 50, mutex, nCount));
+        control.Add(vChecks);
+        BOOST_CHECK(!control.Wait());
+    }
+
+    // The queue must be reusable after a failed round
+    {
+        CCheckQueueControl<counter_check> control(&queue);
+        std::vector<counter_check> vChecks;
+        vChecks.push_back(counter_check(true, mutex, nCount));
+        control.Add(vChecks);
+        BOOST_CHECK(control.Wait());
+    }
+
+    queue.Interrupt();
+    workers.join_all();
+}
+
+BOOST_AUTO_TEST_CASE(checkqueue_no_queue)
+{
+    // A NULL queue means checks are run inline by the caller
+    CCheckQueueControl<counter_check> control(NULL);
+    BOOST_CHECK(control.Wait());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,111 @@
+#include "debuglog.h"
+#include "util.h"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+
+#include <vector>
+
+namespace
+{
+   std::string TestLine(unsigned int nProducer, unsigned int n)
+   {
+      return "producer " + ToString(nProducer) + " line " + ToString(n) + "\n";
+   }
+
+   void PushLines(DebugLogQueue* queue, unsigned int nProducer, unsigned int nLines)
+   {
+      for (unsigned int i = 0; i < nLines; ++i)
+      {
+         std::string str = TestLine(nProducer, i);
+         while (!queue->Push(nProducer, str))
+            boost::this_thread::yield();
+      }
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(debuglog_tests);
+
+BOOST_AUTO_TEST_CASE(QueueKeepsOrderPerProducer)
+{
+   const unsigned int nProducers = 4;
+   const unsigned int nLines = 20000;
+   DebugLogQueue queue(64, 1024 * 1024);
+
+   boost::thread_group threads;
+   for (unsigned int i = 0; i < nProducers; ++i)
+      threads.create_thread(boost::bind(&PushLines, &queue, i, nLines));
+
+   std::vector<unsigned int> vNext(nProducers, 0);
+   unsigned int nPopped = 0;
+   int64_t nTime;
+   std::string str;
+   while (nPopped < nProducers * nLines)
+   {
+      if (!queue.Pop(nTime, str))
+      {
+         boost::this_thread::yield();
+         continue;
+      }
+
+      // The time carries the producer number
+      BOOST_REQUIRE(nTime >= 0 && nTime < nProducers);
+      BOOST_REQUIRE_EQUAL(str, TestLine(nTime, vNext[nTime]));
+      vNext[nTime]++;
+      nPopped++;
+   }
+   threads.join_all();
+
+   BOOST_CHECK(!queue.Pop(nTime, str));
+   for (unsigned int i = 0; i < nProducers; ++i)
+      BOOST_CHECK_EQUAL(vNext[i], nLines);
+}
+
+BOOST_AUTO_TEST_CASE(QueueDropsWhenSlotsAreFull)
+{
+   DebugLogQueue queue(3, 1024);
+
+   // Rounded up to four slots
+   for (int i = 0; i < 4; ++i)
+   {
+      std::string str = "line";
+      BOOST_CHECK(queue.Push(i, str));
+   }
+
+   std::string str = "dropped";
+   BOOST_CHECK(!queue.Push(4, str));
+   BOOST_CHECK_EQUAL(str, "dropped");
+   BOOST_CHECK_EQUAL(queue.TakeDropped(), 1);
+   BOOST_CHECK_EQUAL(queue.TakeDropped(), 0);
+
+   // Popping frees a slot again
+   int64_t nTime;
+   BOOST_CHECK(queue.Pop(nTime, str));
+   BOOST_CHECK_EQUAL(nTime, 0);
+   BOOST_CHECK_EQUAL(str, "line");
+
+   str = "queued";
+   BOOST_CHECK(queue.Push(5, str));
+}
+
+BOOST_AUTO_TEST_CASE(QueueDropsOverByteBudget)
+{
+   DebugLogQueue queue(16, 10);
+
+   std::string str = "123456";
+   BOOST_CHECK(queue.Push(0, str));
+   str = "123456";
+   BOOST_CHECK(!queue.Push(1, str));
+   str = "1234";
+   BOOST_CHECK(queue.Push(2, str));
+   BOOST_CHECK_EQUAL(queue.TakeDropped(), 1);
+
+   // Popped text no longer counts against the budget
+   int64_t nTime;
+   BOOST_CHECK(queue.Pop(nTime, str));
+   BOOST_CHECK_EQUAL(str, "123456");
+   str = "123456";
+   BOOST_CHECK(queue.Push(3, str));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
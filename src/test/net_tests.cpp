@@ -0,0 +1,192 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/foreach.hpp>
+
+#include "checkqueue.h"
+#include "main.h"
+#include "net.h"
+#include "util.h"
+#include "test/net_tests.h"
+
+#include <boost/thread.hpp>
+
+using namespace std;
+
+// A ping as a peer sends it, with a placeholder command nonce
+static CMessageDataPtr TestPing(uint64_t nonce)
+{
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << nonce << string("0,ping,hash,org,prefix,bhrn,pass");
+    return MakeMessage("ping", ss);
+}
+
+static void RunMessageWorker(CCheckQueue<CMessageWork>* pqueue)
+{
+    pqueue->Thread();
+}
+
+// Holds cs_main on its own thread, as block processing would, until
+// released or ten seconds have passed
+struct MainLockHolder
+{
+    boost::mutex mutex;
+    boost::condition_variable cond;
+    bool fLocked;
+    bool fRelease;
+    bool fTimedOut;
+
+    MainLockHolder() : fLocked(false), fRelease(false), fTimedOut(false) {}
+
+    void Run()
+    {
+        LOCK(cs_main);
+        boost::unique_lock<boost::mutex> lock(mutex);
+        fLocked = true;
+        cond.notify_all();
+        boost::system_time timeout = boost::get_system_time() + boost::posix_time::seconds(10);
+        while (!fRelease && !fTimedOut)
+            fTimedOut = !cond.timed_wait(lock, timeout);
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(net_tests)
+
+BOOST_AUTO_TEST_CASE(net_make_message)
+{
+    CDataStream ss = TestPayload(7, 100);
+    CMessageDataPtr message = MakeMessage("tx", ss);
+
+    // The same bytes as a message pushed to a node on its own
+    CNode node(INVALID_SOCKET, CAddress(), "test", true);
+    node.ssSend.SetVersion(PROTOCOL_VERSION);
+    node.PushMessage("tx", ss);
+    BOOST_REQUIRE_EQUAL(node.vSendMsg.size(), 1);
+    BOOST_CHECK(*node.vSendMsg.front() == *message);
+    BOOST_CHECK_EQUAL(node.nSendSize, message->size());
+    BOOST_CHECK_EQUAL(node.vSendMsg.front()->capacity(), message->size());
+    BOOST_CHECK(node.ssSend.empty());
+
+    // Queued to other nodes without a copy
+    node.PushMessageData(message);
+    BOOST_CHECK(node.vSendMsg.back() == message);
+    BOOST_CHECK_EQUAL(node.nSendSize, 2 * message->size());
+
+    CDataStream ssHeader(&(*message)[0], &(*message)[CMessageHeader::HEADER_SIZE], SER_NETWORK, PROTOCOL_VERSION);
+    CMessageHeader hdr;
+    ssHeader >> hdr;
+    BOOST_CHECK(hdr.IsValid());
+    BOOST_CHECK_EQUAL(hdr.GetCommand(), "tx");
+    BOOST_CHECK_EQUAL(hdr.nMessageSize, 100);
+}
+
+// More messages than the socket takes at once, sent a few at a time
+BOOST_AUTO_TEST_CASE(net_send_queue)
+{
+    TestPeers peers(1);
+    TestPeer& peer = *peers.vPeers[0];
+
+    vector<char> vExpected;
+    for (int i = 0; i < 500; i++)
+    {
+        CMessageDataPtr message = MakeMessage("tx", TestPayload(i, 1000 + 97 * i));
+        vExpected.insert(vExpected.end(), message->begin(), message->end());
+        peer.pnode->PushMessageData(message);
+    }
+
+    vector<char> vReceived;
+    BOOST_CHECK_EQUAL(peer.Drain(&vReceived), vExpected.size());
+    BOOST_CHECK(vReceived == vExpected);
+    BOOST_CHECK(peer.pnode->vSendMsg.empty());
+    BOOST_CHECK_EQUAL(peer.pnode->nSendSize, 0);
+    BOOST_CHECK_EQUAL(peer.pnode->nSendOffset, 0);
+}
+
+// Rounds of the message handler over several nodes on the message workers,
+// while another thread holds cs_main
+BOOST_AUTO_TEST_CASE(net_message_work)
+{
+    const int nNodes = 8;
+    const int nRounds = 5;
+    const int nPingsPerRound = 20;
+    TestPeers peers(nNodes);
+    vector<CNode*> vPeerNodes;
+    BOOST_FOREACH(TestPeer* peer, peers.vPeers)
+    {
+        peer->pnode->nVersion = PROTOCOL_VERSION;
+        peer->pnode->ssSend.SetVersion(PROTOCOL_VERSION);
+        vPeerNodes.push_back(peer->pnode);
+    }
+
+    CCheckQueue<CMessageWork> queue(1);
+    boost::thread_group workers;
+    for (int i = 0; i < 3; i++)
+        workers.create_thread(boost::bind(&RunMessageWorker, &queue));
+
+    // Pings are network commands, so are answered without cs_main
+    MainLockHolder holder;
+    boost::thread holderThread(boost::bind(&MainLockHolder::Run, &holder));
+    {
+        boost::unique_lock<boost::mutex> lock(holder.mutex);
+        while (!holder.fLocked)
+            holder.cond.wait(lock);
+    }
+
+    for (int nRound = 0; nRound < nRounds; nRound++)
+    {
+        for (int nNode = 0; nNode < nNodes; nNode++)
+        {
+            LOCK(vPeerNodes[nNode]->cs_vRecvMsg);
+            for (int i = 0; i < nPingsPerRound; i++)
+            {
+                CMessageDataPtr message = TestPing(nNode * 1000 + nRound * nPingsPerRound + i);
+                bool fComplete = false;
+                BOOST_CHECK(vPeerNodes[nNode]->ReceiveMsgBytes(&(*message)[0], message->size(), fComplete));
+                BOOST_CHECK(fComplete);
+            }
+        }
+
+        vector<char> vfMoreWork(nNodes, false);
+        {
+            CCheckQueueControl<CMessageWork> control(&queue);
+            vector<CMessageWork> vWork;
+            for (int nNode = 0; nNode < nNodes; nNode++)
+                vWork.push_back(CMessageWork(vPeerNodes[nNode], &vfMoreWork[nNode]));
+            control.Add(vWork);
+            BOOST_CHECK(control.Wait());
+        }
+        BOOST_FOREACH(char fMoreWork, vfMoreWork)
+            BOOST_CHECK(!fMoreWork);
+    }
+
+    {
+        boost::unique_lock<boost::mutex> lock(holder.mutex);
+        BOOST_CHECK(!holder.fTimedOut);
+        holder.fRelease = true;
+        holder.cond.notify_all();
+    }
+    holderThread.join();
+    queue.Interrupt();
+    workers.join_all();
+
+    // Each node answered its pings in the order they arrived
+    for (int nNode = 0; nNode < nNodes; nNode++)
+    {
+        CNode* pnode = vPeerNodes[nNode];
+        BOOST_CHECK(pnode->vRecvMsg.empty());
+        BOOST_CHECK(!pnode->fDisconnect);
+
+        vector<char> vReceived;
+        peers.vPeers[nNode]->Drain(&vReceived);
+        BOOST_REQUIRE_EQUAL(vReceived.size(), nRounds * nPingsPerRound * (CMessageHeader::HEADER_SIZE + sizeof(uint64_t)));
+        CDataStream ss(vReceived, SER_NETWORK, PROTOCOL_VERSION);
+        for (uint64_t nExpected = nNode * 1000; !ss.empty(); nExpected++)
+        {
+            CMessageHeader hdr;
+            uint64_t nonce = 0;
+            ss >> hdr >> nonce;
+            BOOST_CHECK_EQUAL(hdr.GetCommand(), "pong");
+            BOOST_CHECK_EQUAL(nonce, nExpected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <boost/test/unit_test.hpp>
+#include <boost/foreach.hpp>
+
+#include "net.h"
+#include "util.h"
+
+#include <vector>
+
+// A node on one end of a loopback connection, read from the other end
+struct TestPeer
+{
+    SOCKET hRecv;
+    CNode* pnode;
+
+    TestPeer(SOCKET hListenSocket, const struct sockaddr_in& addr)
+    {
+        hRecv = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        BOOST_REQUIRE(hRecv != INVALID_SOCKET);
+        BOOST_REQUIRE(connect(hRecv, (struct sockaddr*)&addr, sizeof(addr)) != SOCKET_ERROR);
+        SOCKET hSend = accept(hListenSocket, NULL, NULL);
+        BOOST_REQUIRE(hSend != INVALID_SOCKET);
+#ifdef WIN32
+        u_long nOne = 1;
+        ioctlsocket(hSend, FIONBIO, &nOne);
+        ioctlsocket(hRecv, FIONBIO, &nOne);
+#else
+        fcntl(hSend, F_SETFL, fcntl(hSend, F_GETFL, 0) | O_NONBLOCK);
+        fcntl(hRecv, F_SETFL, fcntl(hRecv, F_GETFL, 0) | O_NONBLOCK);
+#endif
+        pnode = new CNode(hSend, CAddress(), "test", true);
+    }
+
+    ~TestPeer()
+    {
+        delete pnode;
+        closesocket(hRecv);
+    }
+
+    // Send what is queued and read it at the other end
+    size_t Drain(std::vector<char>* pvReceived = NULL)
+    {
+        size_t nReceived = 0;
+        char pchBuf[0x10000];
+        for (int nTries = 0; nTries < 1000; nTries++)
+        {
+            {
+                LOCK(pnode->cs_vSend);
+                SocketSendData(pnode);
+            }
+            int nBytes;
+            while ((nBytes = recv(hRecv, pchBuf, sizeof(pchBuf), 0)) > 0)
+            {
+                nReceived += nBytes;
+                if (pvReceived)
+                    pvReceived->insert(pvReceived->end(), pchBuf, pchBuf + nBytes);
+            }
+            LOCK(pnode->cs_vSend);
+            if (pnode->vSendMsg.empty())
+                break;
+            MilliSleep(1);
+        }
+        return nReceived;
+    }
+};
+
+struct TestPeers
+{
+    SOCKET hListenSocket;
+    std::vector<TestPeer*> vPeers;
+
+    TestPeers(size_t nCount)
+    {
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        hListenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        BOOST_REQUIRE(hListenSocket != INVALID_SOCKET);
+        BOOST_REQUIRE(::bind(hListenSocket, (struct sockaddr*)&addr, len) != SOCKET_ERROR);
+        BOOST_REQUIRE(listen(hListenSocket, SOMAXCONN) != SOCKET_ERROR);
+        BOOST_REQUIRE(getsockname(hListenSocket, (struct sockaddr*)&addr, &len) != SOCKET_ERROR);
+        for (size_t i = 0; i < nCount; i++)
+            vPeers.push_back(new TestPeer(hListenSocket, addr));
+    }
+
+    ~TestPeers()
+    {
+        BOOST_FOREACH(TestPeer* peer, vPeers)
+            delete peer;
+        closesocket(hListenSocket);
+    }
+};
+
+inline CDataStream TestPayload(int n, size_t nSize)
+{
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    std::vector<char> vch(nSize, (char)n);
+    ss.write(&vch[0], vch.size());
+    return ss;
+}
@@ -0,0 +1,245 @@
+#include "main.h"
+#include "researcher.h"
+
+#include <boost/test/unit_test.hpp>
+#include <array>
+#include <set>
+
+StructCPID GetStructCPID();
+
+namespace
+{
+   const std::string CPID_A = "00000000000000000000000000000a0a";
+   const std::string CPID_B = "00000000000000000000000000000b0b";
+
+   template<size_t Size>
+   class ResearchChain
+   {
+   public:
+      ResearchChain()
+      {
+         for(size_t i = 0; i < Size; ++i)
+         {
+            CBlockIndex& block = blocks[i];
+            hashes[i] = Hash(BEGIN(i), END(i));
+            block.phashBlock = &hashes[i];
+            block.nHeight = i;
+            block.pprev = i ? &blocks[i - 1] : nullptr;
+            block.nTime = 1000000 + (i * 7919) % 5003;
+            block.SetCPID(i % 3 == 0 ? "INVESTOR" : i % 3 == 1 ? CPID_A : CPID_B);
+            block.nResearchSubsidy = i % 4 ? i * 1.5 : 0;
+            block.nInterestSubsidy = i * 0.25;
+            block.nMagnitude = i % 5 ? i % 50 : 0;
+         }
+      }
+
+      std::array<CBlockIndex, Size> blocks;
+      std::array<uint256, Size> hashes;
+   };
+
+   // The previous implementation: walk the hashes of a CPID in set order
+   StructCPID Rescan(const std::string& cpid, CBlockIndex* pindexTip)
+   {
+      std::set<uint256> hashes;
+      std::map<uint256, CBlockIndex*> index;
+      for(CBlockIndex* pindex = pindexTip; pindex; pindex = pindex->pprev)
+      {
+         if(pindex->GetCPID() != cpid)
+            continue;
+         hashes.insert(pindex->GetBlockHash());
+         index[pindex->GetBlockHash()] = pindex;
+      }
+
+      StructCPID stCPID = GetStructCPID();
+      stCPID.LowLockTime = std::numeric_limits<unsigned int>::max();
+      for(const uint256& hash : hashes)
+      {
+         CBlockIndex* pindex = index[hash];
+         if (pindex->nHeight > stCPID.LastBlock && pindex->nResearchSubsidy > 0)
+         {
+            stCPID.LastBlock = pindex->nHeight;
+            stCPID.BlockHash = pindex->GetBlockHash().GetHex();
+         }
+         stCPID.InterestSubsidy += pindex->nInterestSubsidy;
+         stCPID.ResearchSubsidy += pindex->nResearchSubsidy;
+         stCPID.Accuracy++;
+         if (pindex->nMagnitude > 0)
+         {
+            stCPID.TotalMagnitude += pindex->nMagnitude;
+            stCPID.ResearchAverageMagnitude = stCPID.TotalMagnitude/(stCPID.Accuracy+.01);
+         }
+         if (pindex->nTime < stCPID.LowLockTime)  stCPID.LowLockTime  = pindex->nTime;
+         if (pindex->nTime > stCPID.HighLockTime) stCPID.HighLockTime = pindex->nTime;
+      }
+      return stCPID;
+   }
+
+   void CheckTotals(const ResearcherTotals& totals, const std::string& cpid, CBlockIndex* pindexTip)
+   {
+      StructCPID expected = Rescan(cpid, pindexTip);
+      StructCPID actual = GetStructCPID();
+      totals.Get(cpid, actual);
+      BOOST_CHECK_EQUAL(actual.LastBlock, expected.LastBlock);
+      BOOST_CHECK_EQUAL(actual.BlockHash, expected.BlockHash);
+      BOOST_CHECK_CLOSE(actual.InterestSubsidy + 1, expected.InterestSubsidy + 1, 1e-9);
+      BOOST_CHECK_CLOSE(actual.ResearchSubsidy + 1, expected.ResearchSubsidy + 1, 1e-9);
+      BOOST_CHECK_EQUAL(actual.Accuracy, expected.Accuracy);
+      BOOST_CHECK_CLOSE(actual.TotalMagnitude + 1, expected.TotalMagnitude + 1, 1e-9);
+      BOOST_CHECK_CLOSE(actual.ResearchAverageMagnitude + 1, expected.ResearchAverageMagnitude + 1, 1e-9);
+      BOOST_CHECK_EQUAL(actual.LowLockTime, expected.LowLockTime);
+      BOOST_CHECK_EQUAL(actual.HighLockTime, expected.HighLockTime);
+   }
+
+   void CheckResearchAge(const StructCPID& actual, const StructCPID& expected)
+   {
+      BOOST_CHECK(actual.initialized);
+      BOOST_CHECK_EQUAL(actual.LastBlock, expected.LastBlock);
+      BOOST_CHECK_EQUAL(actual.BlockHash, expected.BlockHash);
+      BOOST_CHECK_EQUAL(actual.InterestSubsidy, expected.InterestSubsidy);
+      BOOST_CHECK_EQUAL(actual.ResearchSubsidy, expected.ResearchSubsidy);
+      BOOST_CHECK_EQUAL(actual.Accuracy, expected.Accuracy);
+      BOOST_CHECK_EQUAL(actual.TotalMagnitude, expected.TotalMagnitude);
+      BOOST_CHECK_EQUAL(actual.ResearchAverageMagnitude, expected.ResearchAverageMagnitude);
+      BOOST_CHECK_EQUAL(actual.LowLockTime, expected.LowLockTime);
+      BOOST_CHECK_EQUAL(actual.HighLockTime, expected.HighLockTime);
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(researcher_tests);
+
+BOOST_AUTO_TEST_CASE(TotalsShouldMatchRescan)
+{
+   ResearchChain<300> chain;
+   ResearcherTotals totals;
+   totals.SetTip(nullptr, &chain.blocks.back());
+
+   CheckTotals(totals, CPID_A, &chain.blocks.back());
+   CheckTotals(totals, CPID_B, &chain.blocks.back());
+}
+
+BOOST_AUTO_TEST_CASE(TotalsShouldFollowReorganizations)
+{
+   ResearchChain<300> chain;
+   ResearcherTotals totals;
+   totals.SetTip(nullptr, &chain.blocks.back());
+
+   // Roll back to a fork and grow a different branch from it
+   ResearchChain<300> fork;
+   for(size_t i = 250; i < 300; ++i)
+   {
+      const size_t n = i + 1000;
+      fork.hashes[i] = Hash(BEGIN(n), END(n));
+      fork.blocks[i].SetCPID(CPID_B);
+      fork.blocks[i].nMagnitude = 0;
+   }
+   fork.blocks[250].pprev = &chain.blocks[249];
+
+   totals.SetTip(&chain.blocks.back(), &chain.blocks[200]);
+   CheckTotals(totals, CPID_A, &chain.blocks[200]);
+   CheckTotals(totals, CPID_B, &chain.blocks[200]);
+
+   totals.SetTip(&chain.blocks[200], &fork.blocks.back());
+   CheckTotals(totals, CPID_A, &fork.blocks.back());
+   CheckTotals(totals, CPID_B, &fork.blocks.back());
+}
+
+BOOST_AUTO_TEST_CASE(TotalsShouldRestoreFromHeights)
+{
+   ResearchChain<300> chain;
+   ResearcherTotals totals;
+   totals.SetTip(nullptr, &chain.blocks.back());
+
+   // Counting the same heights again is how a snapshot is restored
+   ResearcherTotals restored;
+   for(const auto& researcher : totals.GetHeights())
+      for(int nHeight : researcher.second)
+         restored.Add(&chain.blocks[nHeight]);
+
+   CheckTotals(restored, CPID_A, &chain.blocks.back());
+   CheckTotals(restored, CPID_B, &chain.blocks.back());
+   BOOST_CHECK(restored.GetHeights() == totals.GetHeights());
+}
+
+BOOST_AUTO_TEST_CASE(SnapshotShouldMatchColdStart)
+{
+   ResearchChain<300> chain;
+   ActiveChain active;
+   active.SetTip(&chain.blocks.back());
+
+   // A start without a snapshot counts up to, but not including, the tip
+   std::map<std::string, StructCPID> expected;
+   ResearcherTotals expectedTotals;
+   for(size_t i = 2; i < chain.blocks.size() - 1; ++i)
+      CountResearchAge(&chain.blocks[i], expected, expectedTotals);
+   BOOST_REQUIRE_EQUAL(expected.size(), 2);
+   // The tip pays CPID_B, whose block before it is 293
+   BOOST_CHECK_EQUAL(expected[CPID_B].LastBlock, 293);
+
+   ResearchAgeSnapshot written;
+   written.Count(active);
+   CDataStream ss(SER_DISK, CLIENT_VERSION);
+   ss << written;
+   ResearchAgeSnapshot read;
+   ss >> read;
+
+   std::map<std::string, StructCPID> restored;
+   ResearcherTotals restoredTotals;
+   BOOST_REQUIRE(read.Restore(active, restored, restoredTotals));
+   BOOST_REQUIRE_EQUAL(restored.size(), expected.size());
+   CheckResearchAge(restored[CPID_A], expected[CPID_A]);
+   CheckResearchAge(restored[CPID_B], expected[CPID_B]);
+   BOOST_CHECK(restoredTotals.GetHeights() == expectedTotals.GetHeights());
+}
+
+BOOST_AUTO_TEST_CASE(SnapshotOfAnotherChainShouldBeRejected)
+{
+   ResearchChain<300> chain;
+   ActiveChain active;
+   active.SetTip(&chain.blocks.back());
+   ResearchAgeSnapshot snapshot;
+   snapshot.Count(active);
+
+   std::map<std::string, StructCPID> restored;
+   ResearcherTotals restoredTotals;
+
+   // Counted heights above the tip
+   ActiveChain shorter;
+   shorter.SetTip(&chain.blocks[150]);
+   BOOST_CHECK(!snapshot.Restore(shorter, restored, restoredTotals));
+
+   // Blocks staked by other CPIDs
+   ResearchChain<300> swapped;
+   for(CBlockIndex& block : swapped.blocks)
+      if(block.IsUserCPID())
+         block.SetCPID(block.GetCPID() == CPID_A ? CPID_B : CPID_A);
+   ActiveChain swappedActive;
+   swappedActive.SetTip(&swapped.blocks.back());
+   BOOST_CHECK(!snapshot.Restore(swappedActive, restored, restoredTotals));
+
+   // The same CPIDs with other last paid blocks
+   ResearchChain<300> other;
+   for(size_t i = 0; i < other.blocks.size(); ++i)
+   {
+      const size_t n = i + 1000;
+      other.hashes[i] = Hash(BEGIN(n), END(n));
+   }
+   ActiveChain otherActive;
+   otherActive.SetTip(&other.blocks.back());
+   BOOST_CHECK(!snapshot.Restore(otherActive, restored, restoredTotals));
+
+   // Nothing is restored from a snapshot which does not fit
+   BOOST_CHECK(restored.empty());
+   BOOST_CHECK(restoredTotals.GetHeights().empty());
+}
+
+BOOST_AUTO_TEST_CASE(UnknownCpidShouldHaveZeroTotals)
+{
+   ResearcherTotals totals;
+   StructCPID stCPID = GetStructCPID();
+   totals.Get(CPID_A, stCPID);
+   BOOST_CHECK_EQUAL(stCPID.Accuracy, 0);
+   BOOST_CHECK_EQUAL(stCPID.LastBlock, 0);
+   BOOST_CHECK(stCPID.BlockHash.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
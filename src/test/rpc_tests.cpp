@@ -8,6 +8,9 @@
 using namespace std;
 using namespace json_spirit;
 
+int ParseHTTPRequestHeader(const char* pbegin, const char* pend, map<string, string>& mapHeadersRet);
+string HTTPReply(int nStatus, const string& strMsg, bool keepalive);
+
 BOOST_AUTO_TEST_SUITE(rpc_tests)
 
 static Array
@@ -59,4 +62,54 @@ BOOST_AUTO_TEST_CASE(rpc_addmultisig)
     BOOST_CHECK_THROW(addmultisig(createArgs(2, short2.c_str()), false), runtime_error);
 }
 
+static int
+parseHeader(const string& strHeader, map<string, string>& mapHeaders)
+{
+    return ParseHTTPRequestHeader(strHeader.data(), strHeader.data() + strHeader.size(), mapHeaders);
+}
+
+BOOST_AUTO_TEST_CASE(rpc_parsehttprequestheader)
+{
+    map<string, string> mapHeaders;
+    BOOST_CHECK_EQUAL(parseHeader("POST / HTTP/1.1\r\n"
+                                  "Host: 127.0.0.1\r\n"
+                                  "Content-Length: 42\r\n"
+                                  "Authorization:  Basic dXNlcjpwYXNz \r\n"
+                                  "\r\n", mapHeaders), 42);
+    BOOST_CHECK_EQUAL(mapHeaders["host"], "127.0.0.1");
+    BOOST_CHECK_EQUAL(mapHeaders["content-length"], "42");
+    BOOST_CHECK_EQUAL(mapHeaders["authorization"], "Basic dXNlcjpwYXNz");
+    BOOST_CHECK_EQUAL(mapHeaders["connection"], "keep-alive");
+
+    // HTTP/1.0 closes unless asked otherwise; bare newlines are accepted
+    BOOST_CHECK_EQUAL(parseHeader("POST / HTTP/1.0\nContent-Length: 5\n\n", mapHeaders), 5);
+    BOOST_CHECK_EQUAL(mapHeaders["connection"], "close");
+    BOOST_CHECK_EQUAL(parseHeader("POST / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n", mapHeaders), 0);
+    BOOST_CHECK_EQUAL(mapHeaders["connection"], "keep-alive");
+    BOOST_CHECK_EQUAL(parseHeader("POST / HTTP/1.1\r\nConnection: close\r\n\r\n", mapHeaders), 0);
+    BOOST_CHECK_EQUAL(mapHeaders["connection"], "close");
+
+    BOOST_CHECK_EQUAL(parseHeader("POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n", mapHeaders), -HTTP_BAD_REQUEST);
+    BOOST_CHECK_EQUAL(parseHeader("POST / HTTP/1.1\r\nContent-Length: 999999999\r\n\r\n", mapHeaders), -HTTP_REQUEST_TOO_LARGE);
+    BOOST_CHECK_EQUAL(parseHeader("POST / HTTP/1.1\r\nContent-Length: 99999999999\r\n\r\n", mapHeaders), -HTTP_REQUEST_TOO_LARGE);
+}
+
+// Requests refused for their length are answered before the connection
+// closes, as they were before the header was parsed in memory
+BOOST_AUTO_TEST_CASE(rpc_refused_request_reply)
+{
+    map<string, string> mapHeaders;
+    int nLen = parseHeader("POST / HTTP/1.1\r\nContent-Length: -5\r\n\r\n", mapHeaders);
+    BOOST_REQUIRE(nLen < 0);
+    string strReply = HTTPReply(-nLen, "", false);
+    BOOST_CHECK(strReply.find("HTTP/1.1 400 Bad Request\r\n") == 0);
+    BOOST_CHECK(strReply.find("Connection: close\r\n") != string::npos);
+
+    nLen = parseHeader("POST / HTTP/1.1\r\nContent-Length: 999999999\r\n\r\n", mapHeaders);
+    BOOST_REQUIRE(nLen < 0);
+    strReply = HTTPReply(-nLen, "", false);
+    BOOST_CHECK(strReply.find("HTTP/1.1 413 Request Entity Too Large\r\n") == 0);
+    BOOST_CHECK(strReply.find("Content-Length: 0\r\n") != string::npos);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
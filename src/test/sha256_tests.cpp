@@ -0,0 +1,95 @@
+#include <boost/test/unit_test.hpp>
+
+#include "kernel.h"
+#include "main.h"
+#include "sha256.h"
+#include "util.h"
+#include "test/sha256_tests.h"
+
+using namespace std;
+
+// Merkle root as computed before pairs were hashed in batches
+static uint256 TestMerkleRoot(vector<uint256> vHashes)
+{
+    while (vHashes.size() > 1)
+    {
+        vector<uint256> vNext;
+        for (size_t i = 0; i < vHashes.size(); i += 2)
+        {
+            size_t i2 = std::min(i + 1, vHashes.size() - 1);
+            vNext.push_back(Hash(BEGIN(vHashes[i]), END(vHashes[i]), BEGIN(vHashes[i2]), END(vHashes[i2])));
+        }
+        vHashes.swap(vNext);
+    }
+    return vHashes.empty() ? 0 : vHashes[0];
+}
+
+BOOST_AUTO_TEST_SUITE(sha256_tests)
+
+BOOST_AUTO_TEST_CASE(sha256d_batch)
+{
+    BOOST_CHECK(Sha256DSupported(SHA256D_SCALAR));
+    BOOST_CHECK(Sha256DSupported(Sha256DBest()));
+
+    const size_t vSizes[] = { 0, 1, 32, 52, 55, 56, 63, 64, 65, 80 };
+    BOOST_FOREACH(Sha256DImplementation impl, IMPLEMENTATIONS)
+    {
+        if (!Sha256DSupported(impl))
+            continue;
+
+        BOOST_FOREACH(size_t nSize, vSizes)
+        {
+            // Counts around the widths of the implementations leave some messages over
+            for (size_t nCount = 0; nCount <= 19; nCount++)
+            {
+                vector<unsigned char> vIn = TestMessages(nSize, nCount);
+                vector<uint256> vOut(nCount + 1, 0);
+                Sha256DBatch(vOut[0].begin(), &vIn[0], nSize, nCount, impl);
+                for (size_t i = 0; i < nCount; i++)
+                    BOOST_CHECK_MESSAGE(vOut[i] == Hash(vIn.begin() + i * nSize, vIn.begin() + (i + 1) * nSize),
+                                        Sha256DName(impl) << " size " << nSize << " message " << i << " of " << nCount);
+                BOOST_CHECK(vOut[nCount] == 0);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sha256d_merkle)
+{
+    for (unsigned int nTx = 0; nTx <= 20; nTx++)
+    {
+        CBlock block;
+        vector<uint256> vHashes;
+        for (unsigned int n = 0; n < nTx; n++)
+        {
+            CTransaction tx;
+            tx.nTime = n;
+            block.vtx.push_back(tx);
+            vHashes.push_back(tx.GetHash());
+        }
+        BOOST_CHECK(block.BuildMerkleTree() == TestMerkleRoot(vHashes));
+
+        // Branches still lead from every transaction to the root
+        for (unsigned int n = 0; n < nTx; n++)
+            BOOST_CHECK(CBlock::CheckMerkleBranch(vHashes[n], block.GetMerkleBranch(n), n) == block.vMerkleTree.back());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sha256d_stake_kernel)
+{
+    CTransaction tx;
+    tx.nTime = 1500000000;
+    const uint64_t nStakeModifier = 0x0123456789abcdefULL;
+
+    // The kernel is what the stake modifier and fields serialise to
+    CDataStream ss(SER_GETHASH, 0);
+    ss << nStakeModifier << (1499990017u & ~STAKE_TIMESTAMP_MASK) << tx.GetHash() << 3u << (1500001234u & ~STAKE_TIMESTAMP_MASK);
+    BOOST_REQUIRE_EQUAL(ss.size(), STAKE_KERNEL_V8_SIZE);
+
+    unsigned char kernel[STAKE_KERNEL_V8_SIZE];
+    GetStakeKernelV8(kernel, 1499990017, tx, 3, 1500001234, nStakeModifier);
+    BOOST_CHECK(vector<unsigned char>(kernel, kernel + sizeof(kernel)) == vector<unsigned char>(ss.begin(), ss.end()));
+    BOOST_CHECK(CalculateStakeHashV8(1499990017, tx, 3, 1500001234, nStakeModifier) == CBigNum(Hash(ss.begin(), ss.end())));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
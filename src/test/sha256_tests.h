@@ -0,0 +1,15 @@
+#pragma once
+
+#include "sha256.h"
+
+#include <vector>
+
+static const Sha256DImplementation IMPLEMENTATIONS[] = { SHA256D_SCALAR, SHA256D_SSE41, SHA256D_AVX2 };
+
+inline std::vector<unsigned char> TestMessages(size_t nSize, size_t nCount)
+{
+    std::vector<unsigned char> vch(nSize * nCount + 1);
+    for (size_t i = 0; i < vch.size(); i++)
+        vch[i] = (unsigned char)(i * 7 + 3);
+    return vch;
+}
@@ -0,0 +1,67 @@
+#include <boost/test/unit_test.hpp>
+
+#include "sigcache.h"
+#include "util.h"
+#include "test/sigcache_tests.h"
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(sigcache_tests)
+
+BOOST_AUTO_TEST_CASE(sigcache_get_set)
+{
+    CSignatureCache cache(TestHash(1), 1000);
+    uint256 sighash = TestHash(2);
+    vector<unsigned char> vchSig = TestVch(3, 71);
+    vector<unsigned char> vchPubKey = TestVch(4, 33);
+
+    BOOST_CHECK(!cache.Get(sighash, vchSig, vchPubKey));
+    cache.Set(sighash, vchSig, vchPubKey);
+    BOOST_CHECK(cache.Get(sighash, vchSig, vchPubKey));
+
+    // Any change to one of the three parts must miss
+    BOOST_CHECK(!cache.Get(TestHash(5), vchSig, vchPubKey));
+    BOOST_CHECK(!cache.Get(sighash, TestVch(6, 71), vchPubKey));
+    BOOST_CHECK(!cache.Get(sighash, vchSig, TestVch(7, 33)));
+
+    // Moving a byte across the sig/pubkey boundary must miss
+    vector<unsigned char> vchSigShort(vchSig.begin(), vchSig.end() - 1);
+    vector<unsigned char> vchPubKeyLong(vchPubKey);
+    vchPubKeyLong.insert(vchPubKeyLong.begin(), vchSig.back());
+    BOOST_CHECK(!cache.Get(sighash, vchSigShort, vchPubKeyLong));
+}
+
+BOOST_AUTO_TEST_CASE(sigcache_bounded)
+{
+    CSignatureCache cache(TestHash(1), 1000);
+    BOOST_CHECK(cache.Capacity() >= 1000);
+    BOOST_CHECK(cache.Capacity() < 1000 + 64);
+
+    vector<unsigned char> vchSig = TestVch(3, 71);
+    vector<unsigned char> vchPubKey = TestVch(4, 33);
+    for (uint64_t n = 0; n < 10000; n++)
+        cache.Set(TestHash(n), vchSig, vchPubKey);
+
+    unsigned int nHits = 0;
+    for (uint64_t n = 0; n < 10000; n++)
+        if (cache.Get(TestHash(n), vchSig, vchPubKey))
+            nHits++;
+    BOOST_CHECK(nHits > 0);
+    BOOST_CHECK(nHits <= cache.Capacity());
+
+    // The most recent entry always survives
+    BOOST_CHECK(cache.Get(TestHash(9999), vchSig, vchPubKey));
+}
+
+BOOST_AUTO_TEST_CASE(sigcache_disabled)
+{
+    CSignatureCache cache(TestHash(1), 0);
+    uint256 sighash = TestHash(2);
+    vector<unsigned char> vchSig = TestVch(3, 71);
+    vector<unsigned char> vchPubKey = TestVch(4, 33);
+    cache.Set(sighash, vchSig, vchPubKey);
+    BOOST_CHECK(!cache.Get(sighash, vchSig, vchPubKey));
+    BOOST_CHECK_EQUAL(cache.Capacity(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
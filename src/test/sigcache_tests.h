@@ -0,0 +1,19 @@
+#pragma once
+
+#include "util.h"
+
+#include <vector>
+
+inline uint256 TestHash(uint64_t n)
+{
+    uint256 hash(n);
+    return Hash(hash.begin(), hash.end());
+}
+
+inline std::vector<unsigned char> TestVch(uint64_t n, size_t nSize)
+{
+    uint256 hash = TestHash(n ^ 0x5555);
+    std::vector<unsigned char> vch(hash.begin(), hash.end());
+    vch.resize(nSize, (unsigned char)n);
+    return vch;
+}
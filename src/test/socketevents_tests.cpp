@@ -0,0 +1,85 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/foreach.hpp>
+
+#include "socketevents.h"
+#include "util.h"
+#include "test/socketevents_tests.h"
+
+using namespace std;
+
+static bool IsReadyToRecv(SocketEvents& events, SOCKET hSocket, bool fWatch)
+{
+    if (fWatch)
+        events.Watch(hSocket, true, false);
+    SocketEventMap mapEvents;
+    BOOST_CHECK(events.Wait(mapEvents, 10));
+    return mapEvents.count(hSocket) && mapEvents[hSocket].fRecv;
+}
+
+BOOST_AUTO_TEST_SUITE(socketevents_tests)
+
+BOOST_AUTO_TEST_CASE(socketevents_readiness)
+{
+    BOOST_FOREACH(SocketEvents::Backend backend, BACKENDS)
+    {
+        if (!SocketEvents::IsSupported(backend))
+            continue;
+
+        SocketEvents events(backend);
+        BOOST_REQUIRE(events.GetBackend() == backend);
+        TestConnections connections(1);
+        SOCKET hSend = connections.vPairs[0].first;
+        SOCKET hRecv = connections.vPairs[0].second;
+        const bool fEdge = events.IsEdgeTriggered();
+        if (fEdge)
+        {
+            BOOST_CHECK(events.Add(hRecv, false));
+            BOOST_CHECK(events.Add(connections.hListenSocket, true));
+        }
+
+        // A new connection is writable at once
+        events.Watch(hRecv, false, true);
+        SocketEventMap mapEvents;
+        BOOST_CHECK(events.Wait(mapEvents, 10));
+        BOOST_CHECK(mapEvents.count(hRecv) && mapEvents[hRecv].fSend);
+
+        BOOST_CHECK(!IsReadyToRecv(events, hRecv, !fEdge));
+        char pchBuf[16] = {};
+        BOOST_REQUIRE_EQUAL(send(hSend, pchBuf, sizeof(pchBuf), 0), (int)sizeof(pchBuf));
+        MilliSleep(10);
+        BOOST_CHECK(IsReadyToRecv(events, hRecv, !fEdge));
+
+        // Data left unread is only reported again by select
+        BOOST_REQUIRE_EQUAL(recv(hRecv, pchBuf, 4, 0), 4);
+        BOOST_CHECK_EQUAL(IsReadyToRecv(events, hRecv, !fEdge), !fEdge);
+
+        // Until more data arrives
+        BOOST_REQUIRE_EQUAL(send(hSend, pchBuf, sizeof(pchBuf), 0), (int)sizeof(pchBuf));
+        MilliSleep(10);
+        BOOST_CHECK(IsReadyToRecv(events, hRecv, !fEdge));
+
+        // A closed peer reads as ready, so that the close is noticed
+        BOOST_REQUIRE_EQUAL(recv(hRecv, pchBuf, sizeof(pchBuf), 0), (int)sizeof(pchBuf));
+        BOOST_REQUIRE_EQUAL(recv(hRecv, pchBuf, sizeof(pchBuf), 0), 12);
+        closesocket(connections.vPairs[0].first);
+        MilliSleep(10);
+        BOOST_CHECK(IsReadyToRecv(events, hRecv, !fEdge));
+
+        // Listening sockets report pending connections until accepted
+        SOCKET hConnect = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        struct sockaddr_in addr = {};
+        socklen_t len = sizeof(addr);
+        getsockname(connections.hListenSocket, (struct sockaddr*)&addr, &len);
+        BOOST_REQUIRE(connect(hConnect, (struct sockaddr*)&addr, sizeof(addr)) != SOCKET_ERROR);
+        MilliSleep(10);
+        BOOST_CHECK(IsReadyToRecv(events, connections.hListenSocket, !fEdge));
+        BOOST_CHECK(IsReadyToRecv(events, connections.hListenSocket, !fEdge));
+        SOCKET hAccept = accept(connections.hListenSocket, NULL, NULL);
+        BOOST_CHECK(hAccept != INVALID_SOCKET);
+        BOOST_CHECK(!IsReadyToRecv(events, connections.hListenSocket, !fEdge));
+        closesocket(hAccept);
+        closesocket(hConnect);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <boost/test/unit_test.hpp>
+
+#include "socketevents.h"
+
+#include <utility>
+#include <vector>
+
+static const SocketEvents::Backend BACKENDS[] = { SocketEvents::SELECT, SocketEvents::EPOLL };
+
+inline void SetNonBlocking(SOCKET hSocket)
+{
+#ifdef WIN32
+    u_long nOne = 1;
+    ioctlsocket(hSocket, FIONBIO, &nOne);
+#else
+    fcntl(hSocket, F_SETFL, fcntl(hSocket, F_GETFL, 0) | O_NONBLOCK);
+#endif
+}
+
+// Loopback connections, each the pair of the connecting and accepted socket
+struct TestConnections
+{
+    SOCKET hListenSocket;
+    std::vector<std::pair<SOCKET, SOCKET> > vPairs;
+
+    TestConnections(size_t nCount)
+    {
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        hListenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        BOOST_REQUIRE(hListenSocket != INVALID_SOCKET);
+        BOOST_REQUIRE(::bind(hListenSocket, (struct sockaddr*)&addr, len) != SOCKET_ERROR);
+        BOOST_REQUIRE(listen(hListenSocket, SOMAXCONN) != SOCKET_ERROR);
+        BOOST_REQUIRE(getsockname(hListenSocket, (struct sockaddr*)&addr, &len) != SOCKET_ERROR);
+
+        for (size_t i = 0; i < nCount; i++)
+        {
+            SOCKET hConnect = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            BOOST_REQUIRE(hConnect != INVALID_SOCKET);
+            BOOST_REQUIRE(connect(hConnect, (struct sockaddr*)&addr, sizeof(addr)) != SOCKET_ERROR);
+            SOCKET hAccept = accept(hListenSocket, NULL, NULL);
+            BOOST_REQUIRE(hAccept != INVALID_SOCKET);
+            SetNonBlocking(hConnect);
+            SetNonBlocking(hAccept);
+            vPairs.push_back(std::make_pair(hConnect, hAccept));
+        }
+        SetNonBlocking(hListenSocket);
+    }
+
+    ~TestConnections()
+    {
+        for (size_t i = 0; i < vPairs.size(); i++)
+        {
+            closesocket(vPairs[i].first);
+            closesocket(vPairs[i].second);
+        }
+        closesocket(hListenSocket);
+    }
+};
@@ -0,0 +1,135 @@
+#include "superblock.h"
+#include "util.h"
+#include "xmlview.h"
+#include "test/superblock_tests.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+std::string ConvertBinToHex(std::string a);
+std::string ConvertHexToBin(std::string a);
+std::string DoubleToHexStr(double d, int iPlaces);
+int HexToInt(std::string sHex);
+std::string UnpackBinarySuperblock(std::string sBlock);
+std::string PackBinarySuperblock(std::string sBlock);
+
+namespace
+{
+   // The string based functions the Superblock class replaced
+   std::string LegacyUnpack(std::string sBlock)
+   {
+      std::string sBinary = ExtractXML(sBlock,"<BINARY>","</BINARY>");
+      if (sBinary.empty()) return sBlock;
+      double dZero = cdbl(ExtractXML(sBlock,"<ZERO>","</ZERO>"),0);
+      std::string sReconstructedMagnitudes = "";
+      for (unsigned int x = 0; x < sBinary.length(); x += 18)
+      {
+         if (sBinary.length() >= x+18)
+         {
+            std::string sCPID = ConvertBinToHex(sBinary.substr(x,16));
+            double dMagnitude = HexToInt("0x" + ConvertBinToHex(sBinary.substr(x+16,2)));
+            sReconstructedMagnitudes += sCPID + "," + RoundToString(dMagnitude,0) + ";";
+         }
+      }
+      for (double d0 = 1; d0 <= dZero; d0++)
+         sReconstructedMagnitudes += "0,15;";
+      return "<AVERAGES>" + ExtractXML(sBlock,"<AVERAGES>","</AVERAGES>") + "</AVERAGES><QUOTES>"
+            + ExtractXML(sBlock,"<QUOTES>","</QUOTES>") + "</QUOTES><MAGNITUDES>" + sReconstructedMagnitudes + "</MAGNITUDES>";
+   }
+
+   std::string LegacyPack(std::string sBlock)
+   {
+      std::vector<std::string> vSuperblock = split(ExtractXML(sBlock,"<MAGNITUDES>","</MAGNITUDES>"),";");
+      std::string sBinary = "";
+      double dZeroMagCPIDCount = 0;
+      for (unsigned int i = 0; i < vSuperblock.size(); i++)
+      {
+         if (vSuperblock[i].length() > 1)
+         {
+            std::string sPrefix = "00000000000000000000000000000000000" + ExtractValue(vSuperblock[i],",",0);
+            std::string sCPID = sPrefix.substr(sPrefix.length()-32,32);
+            double magnitude = cdbl(ExtractValue("0"+vSuperblock[i],",",1),0);
+            if (magnitude < 0)     magnitude=0;
+            if (magnitude > 32767) magnitude = 32767;
+            if (sCPID=="00000000000000000000000000000000")
+               dZeroMagCPIDCount += 1;
+            else
+               sBinary += ConvertHexToBin(sCPID) + ConvertHexToBin(DoubleToHexStr(magnitude,4));
+         }
+      }
+      return "<ZERO>" + RoundToString(dZeroMagCPIDCount,0) + "</ZERO><BINARY>" + sBinary + "</BINARY><AVERAGES>"
+            + ExtractXML(sBlock,"<AVERAGES>","</AVERAGES>") + "</AVERAGES><QUOTES>" + ExtractXML(sBlock,"<QUOTES>","</QUOTES>") + "</QUOTES>";
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(superblock_tests);
+
+BOOST_AUTO_TEST_CASE(PackAndUnpackShouldMatchLegacyFormat)
+{
+   const std::string contract = TestContract(300, 4);
+   const std::string packed = PackBinarySuperblock(contract);
+   BOOST_CHECK(packed == LegacyPack(contract));
+
+   const std::string unpacked = UnpackBinarySuperblock(packed);
+   BOOST_CHECK_EQUAL(unpacked, LegacyUnpack(packed));
+
+   // Packing the unpacked contract again must give the same bytes
+   BOOST_CHECK(PackBinarySuperblock(unpacked) == packed);
+
+   // Text contracts are returned unchanged
+   BOOST_CHECK_EQUAL(UnpackBinarySuperblock(contract), contract);
+}
+
+BOOST_AUTO_TEST_CASE(ParseShouldDecodeBothForms)
+{
+   const std::string contract = TestContract(300, 4);
+   const Superblock text = Superblock::Parse(contract);
+   const Superblock binary = Superblock::Parse(PackBinarySuperblock(contract));
+
+   BOOST_CHECK_EQUAL(text.GetEntries().size(), 300U);
+   BOOST_CHECK_EQUAL(text.GetZeroCount(), 4U);
+   BOOST_CHECK_EQUAL(text.size(), 304U);
+   BOOST_CHECK_EQUAL(text.GetAverages(), AVERAGES);
+   BOOST_CHECK_EQUAL(text.GetQuotes(), QUOTES);
+   BOOST_CHECK_EQUAL(binary.size(), text.size());
+   for (size_t i = 0; i < text.GetEntries().size(); ++i)
+   {
+      BOOST_CHECK(binary.GetEntries()[i].cpid == text.GetEntries()[i].cpid);
+      BOOST_CHECK_EQUAL(binary.GetEntries()[i].cpid.GetHex(), TestCpid(i));
+      BOOST_CHECK_EQUAL(binary.GetEntries()[i].magnitude, text.GetEntries()[i].magnitude);
+   }
+
+   BOOST_CHECK(Superblock::Parse("").empty());
+   BOOST_CHECK(Superblock().empty());
+}
+
+BOOST_AUTO_TEST_CASE(PackShouldClampMagnitudes)
+{
+   const Superblock superblock = Superblock::Parse(Superblock::Parse(
+         "<MAGNITUDES>" + TestCpid(1) + ",40000;" + TestCpid(2) + ",-5;</MAGNITUDES>").PackBinary());
+   BOOST_CHECK_EQUAL(superblock.GetMagnitude(TestCpid(1)), 32767);
+   BOOST_CHECK_EQUAL(superblock.GetMagnitude(TestCpid(2)), 0);
+}
+
+BOOST_AUTO_TEST_CASE(GetMagnitudeShouldMatchLegacyLookup)
+{
+   const std::string unpacked = UnpackBinarySuperblock(PackBinarySuperblock(TestContract(300, 4)));
+   const Superblock superblock = Superblock::Parse(unpacked);
+
+   for (unsigned int i = 0; i < 320; ++i)
+   {
+      std::string cpid = TestCpid(i);
+      BOOST_CHECK_EQUAL(superblock.GetMagnitude(cpid), LegacyMagnitudeByCPID(unpacked, cpid));
+
+      // Upper case and a different last digit still match
+      std::string variant = boost::to_upper_copy(cpid);
+      variant[31] = variant[31] == '0' ? '1' : '0';
+      BOOST_CHECK_EQUAL(superblock.GetMagnitude(variant), LegacyMagnitudeByCPID(unpacked, variant));
+   }
+
+   BOOST_CHECK_EQUAL(superblock.GetMagnitude(TestCpid(1).substr(0, 31)), -1);
+   BOOST_CHECK_EQUAL(superblock.GetMagnitude("INVESTOR"), -1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "util.h"
+#include "xmlview.h"
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <string>
+#include <vector>
+
+std::vector<std::string> split(std::string s, std::string delim);
+double cdbl(std::string s, int place);
+std::string ExtractValue(std::string data, std::string delimiter, int pos);
+
+const std::string AVERAGES = "amicableNumbers,2415,122.1;asteroids@home,8612,14400.7;collatz,1544,9102.3;";
+const std::string QUOTES = "btc,6000.00;grc,0.03;";
+
+inline std::string TestCpid(unsigned int n)
+{
+   uint256 hash = Hash(BEGIN(n), END(n));
+   return hash.GetHex().substr(0, 32);
+}
+
+// Text contract as produced by the neural network
+inline std::string TestContract(unsigned int nResearchers, unsigned int nZero)
+{
+   std::string magnitudes;
+   for (unsigned int i = 0; i < nResearchers; ++i)
+      magnitudes += TestCpid(i) + "," + ToString((i * 7919) % 20000) + ";";
+   for (unsigned int i = 0; i < nZero; ++i)
+      magnitudes += "00000000000000000000000000000000,0;";
+   return "<MAGNITUDES>" + magnitudes + "</MAGNITUDES><AVERAGES>" + AVERAGES + "</AVERAGES><QUOTES>" + QUOTES + "</QUOTES>";
+}
+
+// The text scan GetSuperblockMagnitudeByCPID did before the Superblock class
+inline double LegacyMagnitudeByCPID(std::string data, std::string cpid)
+{
+   std::vector<std::string> vSuperblock = split(ExtractXML(data,"<MAGNITUDES>","</MAGNITUDES>"),";");
+   if (vSuperblock.size() < 2) return -2;
+   if (cpid.length() < 31) return -3;
+   for (unsigned int i = 0; i < vSuperblock.size(); i++)
+   {
+      if (vSuperblock[i].length() > 1)
+      {
+         std::string sTempCPID = ExtractValue(vSuperblock[i],",",0);
+         double magnitude = cdbl(ExtractValue("0"+vSuperblock[i],",",1),0);
+         boost::to_lower(sTempCPID);
+         boost::to_lower(cpid);
+         if (sTempCPID.length() > 31 && cpid.length() > 31 && sTempCPID.substr(0,31) == cpid.substr(0,31))
+            return magnitude;
+      }
+   }
+   return -1;
+}
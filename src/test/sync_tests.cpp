@@ -0,0 +1,25 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+
+#include "sync.h"
+#include "util.h"
+
+BOOST_AUTO_TEST_SUITE(sync_tests)
+
+BOOST_AUTO_TEST_CASE(wake_signal)
+{
+    CWakeSignal wake;
+    int64_t nStart = GetTimeMillis();
+    BOOST_CHECK(!wake.Wait(20));
+    BOOST_CHECK(GetTimeMillis() - nStart >= 15);
+
+    // A signal sent before the wait is kept for it, once
+    wake.Signal();
+    wake.Signal();
+    nStart = GetTimeMillis();
+    BOOST_CHECK(wake.Wait(10000));
+    BOOST_CHECK(GetTimeMillis() - nStart < 5000);
+    BOOST_CHECK(!wake.Wait(0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,63 @@
+#include <boost/test/unit_test.hpp>
+
+#include "main.h"
+#include "util.h"
+#include "test/txhash_tests.h"
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(txhash_tests)
+
+BOOST_AUTO_TEST_CASE(txhash_cached)
+{
+    CTransaction tx = TestTx(1);
+    uint256 hash = tx.GetHash();
+    BOOST_CHECK(hash == SerializeHash(tx));
+
+    // Without invalidation the memoised hash is returned as is
+    tx.nLockTime = 1;
+    BOOST_CHECK(tx.GetHash() == hash);
+
+    tx.InvalidateHash();
+    BOOST_CHECK(tx.GetHash() != hash);
+    BOOST_CHECK(tx.GetHash() == SerializeHash(tx));
+
+    tx.SetNull();
+    BOOST_CHECK(tx.GetHash() == SerializeHash(tx));
+}
+
+BOOST_AUTO_TEST_CASE(txhash_copy)
+{
+    CTransaction tx = TestTx(2);
+    uint256 hash = tx.GetHash();
+
+    CTransaction txCopy(tx);
+    BOOST_CHECK(txCopy.GetHash() == hash);
+
+    CTransaction txAssigned = TestTx(3);
+    txAssigned.GetHash();
+    txAssigned = tx;
+    BOOST_CHECK(txAssigned.GetHash() == hash);
+
+    // Copies are independent once invalidated
+    txCopy.vout[0].nValue++;
+    txCopy.InvalidateHash();
+    BOOST_CHECK(txCopy.GetHash() != hash);
+    BOOST_CHECK(tx.GetHash() == hash);
+}
+
+BOOST_AUTO_TEST_CASE(txhash_unserialize)
+{
+    CTransaction tx = TestTx(4);
+    CTransaction txOther = TestTx(5);
+    uint256 hashOther = txOther.GetHash();
+
+    // Reading into a transaction which already has a hash replaces it
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << tx;
+    ss >> txOther;
+    BOOST_CHECK(txOther.GetHash() == tx.GetHash());
+    BOOST_CHECK(txOther.GetHash() != hashOther);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "main.h"
+
+inline CTransaction TestTx(unsigned int n)
+{
+    CTransaction tx;
+    tx.nTime = 1500000000 + n;
+    for (unsigned int i = 0; i < 2; i++)
+    {
+        CTxIn txin(COutPoint(uint256(n * 2 + i + 1), i));
+        txin.scriptSig << std::vector<unsigned char>(72, (unsigned char)n) << std::vector<unsigned char>(33, (unsigned char)i);
+        tx.vin.push_back(txin);
+
+        CScript scriptPubKey;
+        scriptPubKey << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, (unsigned char)i) << OP_EQUALVERIFY << OP_CHECKSIG;
+        tx.vout.push_back(CTxOut(COIN + n, scriptPubKey));
+    }
+    return tx;
+}
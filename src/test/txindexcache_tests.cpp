@@ -0,0 +1,106 @@
+#include <boost/test/unit_test.hpp>
+
+#include "txindexcache.h"
+
+using namespace std;
+
+static TxIndexEntry TestEntry(unsigned int nFile, unsigned int nOutputs)
+{
+    return TxIndexEntry{ true, CTxIndex(CDiskTxPos(nFile, 100, 200), nOutputs) };
+}
+
+BOOST_AUTO_TEST_SUITE(txindexcache_tests)
+
+BOOST_AUTO_TEST_CASE(txindexcache_get_put)
+{
+    TxIndexCache cache(1024 * 1024);
+    TxIndexEntry entry;
+    BOOST_CHECK(!cache.Get(1, entry));
+
+    cache.PutRead(1, TestEntry(1, 2), cache.GetGeneration());
+    BOOST_CHECK(cache.Get(1, entry));
+    BOOST_CHECK(entry.fExists);
+    BOOST_CHECK(entry.txindex.pos == CDiskTxPos(1, 100, 200));
+    BOOST_CHECK_EQUAL(entry.txindex.vSpent.size(), 2);
+
+    // The absence of an entry is cached as well
+    cache.PutRead(2, TxIndexEntry{ false, CTxIndex() }, cache.GetGeneration());
+    BOOST_CHECK(cache.Get(2, entry));
+    BOOST_CHECK(!entry.fExists);
+    BOOST_CHECK_EQUAL(cache.GetCount(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(txindexcache_apply)
+{
+    TxIndexCache cache(1024 * 1024);
+    cache.PutRead(1, TestEntry(1, 1), cache.GetGeneration());
+
+    TxIndexChanges changes;
+    changes[1] = TxIndexEntry{ false, CTxIndex() };
+    changes[3] = TestEntry(3, 1);
+    changes[3].txindex.vSpent[0] = CDiskTxPos(4, 5, 6);
+    cache.Apply(changes);
+
+    TxIndexEntry entry;
+    BOOST_CHECK(cache.Get(1, entry));
+    BOOST_CHECK(!entry.fExists);
+    BOOST_CHECK(cache.Get(3, entry));
+    BOOST_CHECK(entry.fExists);
+    BOOST_CHECK(entry.txindex.vSpent[0] == CDiskTxPos(4, 5, 6));
+}
+
+BOOST_AUTO_TEST_CASE(txindexcache_stale_read)
+{
+    TxIndexCache cache(1024 * 1024);
+
+    // A value read before a commit must not replace the committed one
+    uint64_t nGeneration = cache.GetGeneration();
+    TxIndexChanges changes;
+    changes[1] = TestEntry(2, 1);
+    cache.Apply(changes);
+    cache.PutRead(1, TestEntry(1, 1), nGeneration);
+
+    TxIndexEntry entry;
+    BOOST_CHECK(cache.Get(1, entry));
+    BOOST_CHECK(entry.txindex.pos.nFile == 2);
+
+    // Nor be cached at all when it was never cached
+    cache.PutRead(5, TestEntry(1, 1), nGeneration);
+    BOOST_CHECK(!cache.Get(5, entry));
+
+    cache.Clear();
+    BOOST_CHECK(!cache.Get(1, entry));
+    BOOST_CHECK_EQUAL(cache.GetBytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(txindexcache_bounded)
+{
+    const size_t nMaxBytes = 64 * 1024;
+    TxIndexCache cache(nMaxBytes);
+    for (uint64_t n = 1; n <= 10000; n++)
+    {
+        cache.PutRead(n, TestEntry(1, 1 + n % 5), cache.GetGeneration());
+        BOOST_REQUIRE(cache.GetBytes() <= nMaxBytes);
+    }
+
+    // The most recent entries survive, the oldest were evicted
+    TxIndexEntry entry;
+    BOOST_CHECK(cache.Get(10000, entry));
+    BOOST_CHECK(!cache.Get(1, entry));
+    BOOST_CHECK(cache.GetCount() < 10000);
+
+    // Using an entry keeps it from being evicted
+    BOOST_CHECK(cache.Get(9990, entry));
+    for (uint64_t n = 10001; n <= 10000 + cache.GetCount() / 2; n++)
+    {
+        cache.PutRead(n, TestEntry(1, 1), cache.GetGeneration());
+        cache.Get(9990, entry);
+    }
+    BOOST_CHECK(cache.Get(9990, entry));
+
+    TxIndexCache cacheDisabled(0);
+    cacheDisabled.PutRead(1, TestEntry(1, 1), cacheDisabled.GetGeneration());
+    BOOST_CHECK(!cacheDisabled.Get(1, entry));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
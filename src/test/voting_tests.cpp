@@ -0,0 +1,66 @@
+#include <boost/test/unit_test.hpp>
+
+#include "voting.h"
+#include "util.h"
+#include "test/voting_tests.h"
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(voting_tests)
+
+BOOST_AUTO_TEST_CASE(voting_tally)
+{
+    ClearVoteIndex();
+    IndexVote("Poll;a;1", TestVote("Poll", "Yes", "100", "1000"));
+    IndexVote("Poll;b;2", TestVote("poll", "yes;No", "50", "400"));
+    IndexVote("Other;c;3", TestVote("Other", "Yes", "10", "10"));
+
+    // Titles and answers match regardless of case
+    PollTallies tallies = GetPollTallies("POLL");
+    BOOST_REQUIRE_EQUAL(tallies.size(), 2);
+    const VoteTally& yes = tallies["yes"];
+    BOOST_CHECK_EQUAL(yes.magnitude, 125);
+    BOOST_CHECK_EQUAL(yes.balance, 1200);
+    BOOST_CHECK_EQUAL(yes.cpids, 2);
+    BOOST_CHECK_EQUAL(yes.addresses, 2);
+    BOOST_CHECK_EQUAL(yes.participants, 1.5);
+    BOOST_CHECK_EQUAL(tallies["no"].participants, 0.5);
+
+    BOOST_CHECK_EQUAL(GetVoteTallyShares(yes, 1, 0), 125);
+    BOOST_CHECK_EQUAL(GetVoteTallyShares(yes, 2, 0), 1200);
+    BOOST_CHECK_EQUAL(GetVoteTallyShares(yes, 3, 5.67), 1325);
+    BOOST_CHECK_EQUAL(GetVoteTallyShares(yes, 4, 0), 2);
+    BOOST_CHECK_EQUAL(GetVoteTallyShares(yes, 5, 0), 2);
+    BOOST_CHECK_EQUAL(GetVoteTallyShares(yes, 6, 0), 0);
+
+    BOOST_CHECK(GetPollTallies("missing").empty());
+    ClearVoteIndex();
+}
+
+BOOST_AUTO_TEST_CASE(voting_changes)
+{
+    ClearVoteIndex();
+    IndexVote("Poll;a;1", TestVote("Poll", "Yes", "100", "1000"));
+    BOOST_CHECK_EQUAL(GetPollTallies("Poll")["yes"].magnitude, 100);
+
+    // Voting again replaces the earlier vote, even when moving polls
+    IndexVote("Poll;a;1", TestVote("Poll", "No", "0", "1000"));
+    PollTallies tallies = GetPollTallies("Poll");
+    BOOST_CHECK(!tallies.count("yes"));
+    BOOST_CHECK_EQUAL(tallies["no"].cpids, 0);
+    IndexVote("Poll;a;1", TestVote("Other", "No", "0", "1000"));
+    BOOST_CHECK(GetPollTallies("Poll").empty());
+    BOOST_CHECK_EQUAL(GetPollTallies("Other")["no"].balance, 1000);
+
+    UnindexVote("Poll;a;1");
+    BOOST_CHECK(GetPollTallies("Other").empty());
+
+    // Votes with invalid weights still count as participants
+    IndexVote("Poll;b;2", TestVote("Poll", "Yes", "x", "1"));
+    tallies = GetPollTallies("Poll");
+    BOOST_CHECK_EQUAL(tallies["yes"].participants, 1);
+    BOOST_CHECK_EQUAL(tallies["yes"].magnitude, 0);
+    ClearVoteIndex();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
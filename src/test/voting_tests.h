@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+inline std::string TestVote(const std::string& title, const std::string& answer, const std::string& magnitude, const std::string& balance)
+{
+    return "<TITLE>" + title + "</TITLE><ANSWER>" + answer + "</ANSWER><CPID>abc</CPID>"
+        "<GRCADDRESS>SAddressOfTheVoter</GRCADDRESS><BALANCE>" + balance + "</BALANCE>"
+        "<MAGNITUDE>" + magnitude + "</MAGNITUDE>";
+}
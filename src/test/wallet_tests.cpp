@@ -1,5 +1,6 @@
 #include <boost/test/unit_test.hpp>
 
+#include "init.h"
 #include "main.h"
 #include "wallet.h"
 
@@ -294,4 +295,81 @@ BOOST_AUTO_TEST_CASE(coin_selection_tests)
     }
 }
 
+BOOST_AUTO_TEST_CASE(coin_index_tests)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    BOOST_CHECK(pwalletMain->AddKey(key));
+    CScript scriptMine;
+    scriptMine.SetDestination(key.GetPubKey().GetID());
+
+    // An unconfirmed payment to us, from someone else
+    CTransaction txReceive;
+    txReceive.nTime = GetAdjustedTime();
+    txReceive.vin.resize(1);
+    txReceive.vin[0].prevout = COutPoint(GetRandHash(), 0);
+    txReceive.vout.push_back(CTxOut(5 * COIN, scriptMine));
+    uint256 hashReceive = txReceive.GetHash();
+    mempool.addUnchecked(hashReceive, txReceive);
+    BOOST_CHECK(pwalletMain->AddToWallet(CWalletTx(pwalletMain, txReceive)));
+    BOOST_CHECK_EQUAL(pwalletMain->GetUnconfirmedBalance(), 5 * COIN);
+    BOOST_CHECK_EQUAL(pwalletMain->GetBalance(), 0);
+
+    vector<COutput> vCoins;
+    pwalletMain->AvailableCoins(vCoins, false);
+    BOOST_CHECK_EQUAL(vCoins.size(), 1);
+    pwalletMain->AvailableCoinsForStaking(vCoins, txReceive.nTime + nStakeMinAge);
+    BOOST_CHECK(vCoins.empty());
+
+    // Spending it elsewhere leaves nothing to count
+    CTransaction txSpend;
+    txSpend.nTime = txReceive.nTime;
+    txSpend.vin.push_back(CTxIn(COutPoint(hashReceive, 0)));
+    txSpend.vout.push_back(CTxOut(4 * COIN, CScript() << OP_TRUE));
+    BOOST_CHECK(pwalletMain->AddToWallet(CWalletTx(pwalletMain, txSpend)));
+    BOOST_CHECK_EQUAL(pwalletMain->GetUnconfirmedBalance(), 0);
+    pwalletMain->AvailableCoins(vCoins, false);
+    BOOST_CHECK(vCoins.empty());
+
+    // Nor once both are dropped from the wallet
+    BOOST_CHECK(pwalletMain->EraseFromWallet(txSpend.GetHash()));
+    BOOST_CHECK(pwalletMain->EraseFromWallet(hashReceive));
+    BOOST_CHECK_EQUAL(pwalletMain->GetUnconfirmedBalance(), 0);
+    mempool.remove(txReceive);
+}
+
+BOOST_AUTO_TEST_CASE(coin_index_key_import_tests)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    CScript scriptImported;
+    scriptImported.SetDestination(key.GetPubKey().GetID());
+
+    // A payment to a key the wallet does not have yet
+    CTransaction txReceive;
+    txReceive.nTime = GetAdjustedTime();
+    txReceive.vin.resize(1);
+    txReceive.vin[0].prevout = COutPoint(GetRandHash(), 0);
+    txReceive.vout.push_back(CTxOut(3 * COIN, scriptImported));
+    uint256 hashReceive = txReceive.GetHash();
+    mempool.addUnchecked(hashReceive, txReceive);
+    BOOST_CHECK(pwalletMain->AddToWallet(CWalletTx(pwalletMain, txReceive)));
+    BOOST_CHECK_EQUAL(pwalletMain->GetUnconfirmedBalance(), 0);
+
+    // Imported without a rescan, as importprivkey does when asked to
+    {
+        LOCK2(cs_main, pwalletMain->cs_wallet);
+        BOOST_CHECK(pwalletMain->AddKey(key));
+        pwalletMain->MarkDirty();
+    }
+    BOOST_CHECK_EQUAL(pwalletMain->GetUnconfirmedBalance(), 3 * COIN);
+    vector<COutput> vCoins;
+    pwalletMain->AvailableCoins(vCoins, false);
+    BOOST_CHECK_EQUAL(vCoins.size(), 1);
+
+    BOOST_CHECK(pwalletMain->EraseFromWallet(hashReceive));
+    BOOST_CHECK_EQUAL(pwalletMain->GetUnconfirmedBalance(), 0);
+    mempool.remove(txReceive);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
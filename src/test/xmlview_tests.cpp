@@ -0,0 +1,61 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/foreach.hpp>
+
+#include "xmlview.h"
+#include "util.h"
+#include "test/xmlview_tests.h"
+
+using namespace std;
+
+namespace
+{
+    const char* const TAGS[] = { "MT", "MK", "MV", "MAGNITUDE", "MAGNITUDES", "A" };
+}
+
+BOOST_AUTO_TEST_SUITE(xmlview_tests)
+
+// Every way of reading a tag gives what the original ExtractXML did
+BOOST_AUTO_TEST_CASE(xmlview_same_as_legacy)
+{
+    const char* const DOCUMENTS[] =
+    {
+        "",
+        "<MT>beacon</MT><MK>key</MK>",
+        "<MT></MT>",
+        "<MT>no end",
+        "</MT>end before start<MT>x",
+        "<MT>first</MT><MT>second</MT>",
+        "<MT>nested <MK>inner</MK> text</MT>",
+        "<MAGNITUDES>1,2;</MAGNITUDES><MAGNITUDE>5</MAGNITUDE>",
+        "<<MT>>double</MT>>",
+        "<A>a</A><MT>x</MT><A>b</A>",
+        "<MV>a<b</MV><</",
+        "<MK",
+        "<A></A",
+    };
+
+    BOOST_FOREACH(const char* document, DOCUMENTS)
+    {
+        string data = document;
+        XMLView view(data, { TAGS[0], TAGS[1], TAGS[2], TAGS[3], TAGS[4], TAGS[5] });
+        BOOST_CHECK_EQUAL(view.size(), 6);
+        for (size_t i = 0; i < view.size(); ++i)
+        {
+            string key = string("<") + TAGS[i] + ">";
+            string key_end = string("</") + TAGS[i] + ">";
+            string expected = LegacyExtractXML(data, key, key_end);
+            BOOST_CHECK_EQUAL(ExtractXML(data, key, key_end), expected);
+            BOOST_CHECK_EQUAL(ExtractXMLView(data, key, key_end).to_string(), expected);
+            BOOST_CHECK_EQUAL(view.GetString(i), expected);
+        }
+    }
+
+    // Odd keys keep the quirks of searching for the end from three
+    // characters into the start
+    BOOST_CHECK_EQUAL(ExtractXML("abcdef", "abcde", "d"), LegacyExtractXML("abcdef", "abcde", "d"));
+    BOOST_CHECK_EQUAL(ExtractXML("abcdef", "", ""), LegacyExtractXML("abcdef", "", ""));
+    BOOST_CHECK_EQUAL(ExtractXML("ab", "a", ""), LegacyExtractXML("ab", "a", ""));
+    BOOST_CHECK(XMLView("<MT>x</MT>", { "MT" })[1].empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+// ExtractXML as it was, copying the document for every tag
+inline std::string LegacyExtractXML(std::string XMLdata, std::string key, std::string key_end)
+{
+    std::string extraction = "";
+    std::string::size_type loc = XMLdata.find(key, 0);
+    if (loc != std::string::npos)
+    {
+        std::string::size_type loc_end = XMLdata.find(key_end, loc + 3);
+        if (loc_end != std::string::npos)
+            extraction = XMLdata.substr(loc + (key.length()), loc_end - loc - (key.length()));
+    }
+    return extraction;
+}
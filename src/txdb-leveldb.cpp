@@ -6,7 +6,9 @@
 #include <map>
 
 #include <boost/version.hpp>
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
 
 #include <leveldb/env.h>
 #include <leveldb/cache.h>
@@ -19,13 +21,14 @@
 #include "util.h"
 #include "main.h"
 #include "block.h"
+#include "checkqueue.h"
+#include "researcher.h"
 #include "ui_interface.h"
 
 using namespace std;
 using namespace boost;
 
 leveldb::DB *txdb; // global pointer for LevelDB object instance
-void AddCPIDBlockHash(const std::string& cpid, const uint256& blockhash);
 
 static leveldb::Options GetOptions() {
     leveldb::Options options;
@@ -101,6 +104,7 @@ CTxDB::CTxDB(const char* pszMode)
             txdb = pdb = NULL;
             delete activeBatch;
             activeBatch = NULL;
+            GetTxIndexCache().Clear();
 
             init_blockindex(options, true); // Remove directory and create new database
             pdb = txdb;
@@ -132,6 +136,8 @@ void CTxDB::Close()
     options.block_cache = NULL;
     delete activeBatch;
     activeBatch = NULL;
+    mapBatchTxIndex.clear();
+    GetTxIndexCache().Clear();
 }
 
 bool CTxDB::TxnBegin()
@@ -141,16 +147,43 @@ bool CTxDB::TxnBegin()
     return true;
 }
 
+static std::string TxIndexKey(const uint256& hash)
+{
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    ssKey << make_pair(string("tx"), hash);
+    return ssKey.str();
+}
+
 bool CTxDB::TxnCommit()
 {
     assert(activeBatch);
+
+    // Only the final state of each transaction index entry is written
+    for (const auto& change : mapBatchTxIndex)
+    {
+        if (change.second.fExists)
+        {
+            CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+            ssValue << change.second.txindex;
+            activeBatch->Put(TxIndexKey(change.first), ssValue.str());
+        }
+        else
+        {
+            activeBatch->Delete(TxIndexKey(change.first));
+        }
+    }
+
     leveldb::Status status = pdb->Write(leveldb::WriteOptions(), activeBatch);
     delete activeBatch;
     activeBatch = NULL;
     if (!status.ok()) {
+        mapBatchTxIndex.clear();
         printf("LevelDB batch commit failure: %s\n", status.ToString().c_str());
         return false;
     }
+
+    GetTxIndexCache().Apply(mapBatchTxIndex);
+    mapBatchTxIndex.clear();
     return true;
 }
 
@@ -198,15 +231,89 @@ bool CTxDB::ScanBatch(const CDataStream &key, string *value, bool *deleted) cons
     return scanner.foundEntry;
 }
 
+// Transaction index entries are looked up in the changes of the active
+// batch, then in the cache of committed entries, and only then in LevelDB.
+// Returns false on a read error, in which case nothing is known.
+bool CTxDB::ReadTxIndexEntry(const uint256& hash, TxIndexEntry& entry)
+{
+    if (activeBatch)
+    {
+        TxIndexChanges::const_iterator it = mapBatchTxIndex.find(hash);
+        if (it != mapBatchTxIndex.end())
+        {
+            entry = it->second;
+            return true;
+        }
+    }
+
+    TxIndexCache& cache = GetTxIndexCache();
+    if (cache.Get(hash, entry))
+        return true;
+
+    uint64_t nGeneration = cache.GetGeneration();
+    entry.fExists = false;
+    entry.txindex.SetNull();
+
+    std::string strValue;
+    leveldb::Status status = pdb->Get(leveldb::ReadOptions(), TxIndexKey(hash), &strValue);
+    if (status.ok())
+    {
+        try {
+            CDataStream ssValue(strValue.data(), strValue.data() + strValue.size(), SER_DISK, CLIENT_VERSION);
+            ssValue >> entry.txindex;
+        }
+        catch (std::exception &e) {
+            return false;
+        }
+        entry.fExists = true;
+    }
+    else if (!status.IsNotFound())
+    {
+        printf("LevelDB read failure: %s\n", status.ToString().c_str());
+        return false;
+    }
+
+    cache.PutRead(hash, entry, nGeneration);
+    return true;
+}
+
+bool CTxDB::WriteTxIndexEntry(const uint256& hash, const TxIndexEntry& entry)
+{
+    if (fReadOnly)
+        assert(!"Write called on database in read-only mode");
+
+    if (activeBatch)
+    {
+        mapBatchTxIndex[hash] = entry;
+        return true;
+    }
+
+    bool fWritten = entry.fExists
+        ? Write(make_pair(string("tx"), hash), entry.txindex)
+        : Erase(make_pair(string("tx"), hash));
+    if (!fWritten)
+        return false;
+
+    TxIndexChanges changes;
+    changes[hash] = entry;
+    GetTxIndexCache().Apply(changes);
+    return true;
+}
+
 bool CTxDB::ReadTxIndex(uint256 hash, CTxIndex& txindex)
 {
     txindex.SetNull();
-    return Read(make_pair(string("tx"), hash), txindex);
+    TxIndexEntry entry;
+    if (!ReadTxIndexEntry(hash, entry) || !entry.fExists)
+        return false;
+
+    txindex = entry.txindex;
+    return true;
 }
 
 bool CTxDB::UpdateTxIndex(uint256 hash, const CTxIndex& txindex)
 {
-    return Write(make_pair(string("tx"), hash), txindex);
+    return WriteTxIndexEntry(hash, TxIndexEntry{ true, txindex });
 }
 
 bool CTxDB::AddTxIndex(const CTransaction& tx, const CDiskTxPos& pos, int nHeight)
@@ -214,19 +321,20 @@ bool CTxDB::AddTxIndex(const CTransaction& tx, const CDiskTxPos& pos, int nHeigh
     // Add to tx index
     uint256 hash = tx.GetHash();
     CTxIndex txindex(pos, tx.vout.size());
-    return Write(make_pair(string("tx"), hash), txindex);
+    return WriteTxIndexEntry(hash, TxIndexEntry{ true, txindex });
 }
 
 bool CTxDB::EraseTxIndex(const CTransaction& tx)
 {
     uint256 hash = tx.GetHash();
 
-    return Erase(make_pair(string("tx"), hash));
+    return WriteTxIndexEntry(hash, TxIndexEntry{ false, CTxIndex() });
 }
 
 bool CTxDB::ContainsTx(uint256 hash)
 {
-    return Exists(make_pair(string("tx"), hash));
+    TxIndexEntry entry;
+    return ReadTxIndexEntry(hash, entry) && entry.fExists;
 }
 
 bool CTxDB::ReadDiskTx(uint256 hash, CTransaction& tx, CTxIndex& txindex)
@@ -310,6 +418,312 @@ bool CTxDB::WriteGenericData(const std::string& strKey,const std::string& strDat
 }
 
 
+namespace
+{
+    // Bump whenever the way chain trust, stake modifier checksums or the
+    // research age are derived changes, so that old snapshots are dropped.
+    const int DERIVED_STATE_VERSION = 2;
+
+    // Blocks per chain trust record of a snapshot
+    const unsigned int CHAIN_TRUST_CHUNK = 16384;
+
+    // Block index records read and decoded per batch
+    const unsigned int BLOCK_INDEX_BATCH = 16384;
+
+    // Blocks verified per batch, between progress updates
+    const unsigned int VERIFY_BATCH = 1000;
+
+    // Set once LoadBlockIndex completed, so that a node shut down while
+    // still starting up never writes a snapshot.
+    bool fDerivedStateLoaded = false;
+
+    // Marks the snapshot of the state derived from the block index as
+    // valid. Written in the same batch as the snapshot when the node shuts
+    // down cleanly, and erased as soon as the block index is loaded again.
+    struct DerivedStateMarker
+    {
+        int nVersion;
+        uint256 hashBestChain;
+        unsigned int nBlockCount;
+
+        IMPLEMENT_SERIALIZE
+        (
+            READWRITE(this->nVersion);
+            READWRITE(hashBestChain);
+            READWRITE(nBlockCount);
+        )
+    };
+
+    // Chain trust and stake modifier checksums of consecutive block index
+    // records, in the order LoadBlockIndex reads them.
+    struct ChainTrustChunk
+    {
+        uint256 hashFirst;
+        std::vector<uint256> vChainTrust;
+        std::vector<unsigned int> vStakeModifierChecksum;
+
+        IMPLEMENT_SERIALIZE
+        (
+            READWRITE(hashFirst);
+            READWRITE(vChainTrust);
+            READWRITE(vStakeModifierChecksum);
+        )
+    };
+
+    // A block index record together with what is computed from it
+    struct DecodedBlockIndex
+    {
+        CDiskBlockIndex diskindex;
+        uint256 hash;
+        uint256 trust;
+    };
+
+    // Decodes one block index record. Hashing the header and computing the
+    // block trust are the costly parts of loading an entry, so they are
+    // done here as well.
+    class CBlockIndexDecode
+    {
+    private:
+        const std::string* pvalue;
+        DecodedBlockIndex* pdecoded;
+
+    public:
+        CBlockIndexDecode() : pvalue(NULL), pdecoded(NULL) {}
+        CBlockIndexDecode(const std::string* pvalueIn, DecodedBlockIndex* pdecodedIn) :
+            pvalue(pvalueIn), pdecoded(pdecodedIn) {}
+
+        bool operator()()
+        {
+            try
+            {
+                CBufferReader ssValue(pvalue->data(), pvalue->data() + pvalue->size(), SER_DISK, CLIENT_VERSION);
+                ssValue >> pdecoded->diskindex;
+            }
+            catch (const std::exception&)
+            {
+                return false;
+            }
+
+            pdecoded->hash = pdecoded->diskindex.GetBlockHash();
+            pdecoded->trust = pdecoded->diskindex.GetBlockTrust();
+            return true;
+        }
+
+        void swap(CBlockIndexDecode& check)
+        {
+            std::swap(pvalue, check.pvalue);
+            std::swap(pdecoded, check.pdecoded);
+        }
+    };
+
+    // Positions of the verified blocks on disk
+    typedef std::map<std::pair<unsigned int, unsigned int>, CBlockIndex*> BlockPosMap;
+
+    // Verifies one block of the best chain at a -checklevel. Problems with
+    // the block are flagged in *pfBad, while a block that cannot be read at
+    // all fails the check and with it the whole verification.
+    class CBlockVerify
+    {
+    private:
+        CBlockIndex* pindex;
+        const BlockPosMap* pmapBlockPos;
+        int nCheckLevel;
+        char* pfBad;
+
+    public:
+        CBlockVerify() : pindex(NULL), pmapBlockPos(NULL), nCheckLevel(0), pfBad(NULL) {}
+        CBlockVerify(CBlockIndex* pindexIn, const BlockPosMap* pmapBlockPosIn, int nCheckLevelIn, char* pfBadIn) :
+            pindex(pindexIn), pmapBlockPos(pmapBlockPosIn), nCheckLevel(nCheckLevelIn), pfBad(pfBadIn) {}
+
+        bool operator()();
+
+        void swap(CBlockVerify& check)
+        {
+            std::swap(pindex, check.pindex);
+            std::swap(pmapBlockPos, check.pmapBlockPos);
+            std::swap(nCheckLevel, check.nCheckLevel);
+            std::swap(pfBad, check.pfBad);
+        }
+    };
+
+    // Worker threads helping LoadBlockIndex, which joins them while it
+    // waits for the queued work to finish.
+    template<typename T>
+    class LoadBlockIndexThreads
+    {
+    public:
+        explicit LoadBlockIndexThreads(int nThreads) : queue(128)
+        {
+            for (int i = 0; i < nThreads; i++)
+                threads.create_thread(boost::bind(&CCheckQueue<T>::Thread, &queue));
+        }
+
+        ~LoadBlockIndexThreads()
+        {
+            queue.Interrupt();
+            threads.join_all();
+        }
+
+        void Add(std::vector<T>& vChecks)
+        {
+            queue.Add(vChecks);
+        }
+
+        bool Wait()
+        {
+            return queue.Wait();
+        }
+
+    private:
+        CCheckQueue<T> queue;
+        boost::thread_group threads;
+    };
+
+    // Queue the records in vValue to be decoded into vDecoded
+    void QueueBlockIndexDecode(LoadBlockIndexThreads<CBlockIndexDecode>& decoders,
+                               const std::vector<std::string>& vValue,
+                               std::vector<DecodedBlockIndex>& vDecoded)
+    {
+        vDecoded.clear();
+        vDecoded.resize(vValue.size());
+        std::vector<CBlockIndexDecode> vChecks;
+        vChecks.reserve(vValue.size());
+        for (unsigned int i = 0; i < vValue.size(); i++)
+            vChecks.push_back(CBlockIndexDecode(&vValue[i], &vDecoded[i]));
+        decoders.Add(vChecks);
+    }
+
+    // Read the values of up to BLOCK_INDEX_BATCH block index records
+    void ReadBlockIndexBatch(leveldb::Iterator* iterator, std::vector<std::string>& vValue)
+    {
+        vValue.clear();
+        while (vValue.size() < BLOCK_INDEX_BATCH && iterator->Valid() && !fRequestShutdown)
+        {
+            // Did we reach the end of the data to read?
+            string strType;
+            try
+            {
+                CBufferReader ssKey(iterator->key().data(), iterator->key().data() + iterator->key().size(), SER_DISK, CLIENT_VERSION);
+                ssKey >> strType;
+            }
+            catch (const std::exception&)
+            {
+                break;
+            }
+            if (strType != "blockindex")
+                break;
+
+            vValue.push_back(iterator->value().ToString());
+            iterator->Next();
+        }
+    }
+
+    bool CBlockVerify::operator()()
+    {
+        CBlock block;
+        if (!block.ReadFromDisk(pindex))
+            return error("LoadBlockIndex() : block.ReadFromDisk failed");
+        // check level 1: verify block validity
+        // check level 7: verify block signature too
+        if (nCheckLevel>0 && !block.CheckBlock("LoadBlockIndex", pindex->nHeight,pindex->nMint, true, true, (nCheckLevel>6), true))
+        {
+            printf("LoadBlockIndex() : *** found bad block at %d, hash=%s\n", pindex->nHeight, pindex->GetBlockHash().ToString().c_str());
+            *pfBad = true;
+        }
+        // check level 2: verify transaction index validity
+        if (nCheckLevel>1)
+        {
+            CTxDB txdb("r");
+            BOOST_FOREACH(const CTransaction &tx, block.vtx)
+            {
+                uint256 hashTx = tx.GetHash();
+                CTxIndex txindex;
+                if (txdb.ReadTxIndex(hashTx, txindex))
+                {
+                    // check level 3: checker transaction hashes
+                    if (nCheckLevel>2 || pindex->nFile != txindex.pos.nFile || pindex->nBlockPos != txindex.pos.nBlockPos)
+                    {
+                        // either an error or a duplicate transaction
+                        CTransaction txFound;
+                        if (!txFound.ReadFromDisk(txindex.pos))
+                        {
+                            printf("LoadBlockIndex() : *** cannot read mislocated transaction %s\n", hashTx.ToString().c_str());
+                            *pfBad = true;
+                        }
+                        else
+                            if (txFound.GetHash() != hashTx) // not a duplicate tx
+                            {
+                                printf("LoadBlockIndex(): *** invalid tx position for %s\n", hashTx.ToString().c_str());
+                                *pfBad = true;
+                            }
+                    }
+                    // check level 4: check whether spent txouts were spent within the main chain
+                    unsigned int nOutput = 0;
+                    if (nCheckLevel>3)
+                    {
+                        BOOST_FOREACH(const CDiskTxPos &txpos, txindex.vSpent)
+                        {
+                            if (!txpos.IsNull())
+                            {
+                                pair<unsigned int, unsigned int> posFind = make_pair(txpos.nFile, txpos.nBlockPos);
+                                // Spends must be in a verified block at or above this one
+                                BlockPosMap::const_iterator mi = pmapBlockPos->find(posFind);
+                                if (mi == pmapBlockPos->end() || mi->second->nHeight < pindex->nHeight)
+                                {
+                                    printf("LoadBlockIndex(): *** found bad spend at %d, hashBlock=%s, hashTx=%s\n", pindex->nHeight, pindex->GetBlockHash().ToString().c_str(), hashTx.ToString().c_str());
+                                    *pfBad = true;
+                                }
+                                // check level 6: check whether spent txouts were spent by a valid transaction that consume them
+                                if (nCheckLevel>5)
+                                {
+                                    CTransaction txSpend;
+                                    if (!txSpend.ReadFromDisk(txpos))
+                                    {
+                                        printf("LoadBlockIndex(): *** cannot read spending transaction of %s:%i from disk\n", hashTx.ToString().c_str(), nOutput);
+                                        *pfBad = true;
+                                    }
+                                    else if (!txSpend.CheckTransaction())
+                                    {
+                                        printf("LoadBlockIndex(): *** spending transaction of %s:%i is invalid\n", hashTx.ToString().c_str(), nOutput);
+                                        *pfBad = true;
+                                    }
+                                    else
+                                    {
+                                        bool fFound = false;
+                                        BOOST_FOREACH(const CTxIn &txin, txSpend.vin)
+                                            if (txin.prevout.hash == hashTx && txin.prevout.n == nOutput)
+                                                fFound = true;
+                                        if (!fFound)
+                                        {
+                                            printf("LoadBlockIndex(): *** spending transaction of %s:%i does not spend it\n", hashTx.ToString().c_str(), nOutput);
+                                            *pfBad = true;
+                                        }
+                                    }
+                                }
+                            }
+                            nOutput++;
+                        }
+                    }
+                }
+                // check level 5: check whether all prevouts are marked spent
+                if (nCheckLevel>4)
+                {
+                     BOOST_FOREACH(const CTxIn &txin, tx.vin)
+                     {
+                          CTxIndex txindex;
+                          if (txdb.ReadTxIndex(txin.prevout.hash, txindex))
+                              if (txindex.vSpent.size()-1 < txin.prevout.n || txindex.vSpent[txin.prevout.n].IsNull())
+                              {
+                                  printf("LoadBlockIndex(): *** found unspent prevout %s:%i in %s\n", txin.prevout.hash.ToString().c_str(), txin.prevout.n, hashTx.ToString().c_str());
+                                  *pfBad = true;
+                              }
+                     }
+                }
+            }
+        }
+        return true;
+    }
+}
 
 static CBlockIndex *InsertBlockIndex(const uint256& hash)
 {
@@ -317,12 +731,12 @@ static CBlockIndex *InsertBlockIndex(const uint256& hash)
         return NULL;
 
     // Return existing
-    map<uint256, CBlockIndex*>::iterator mi = mapBlockIndex.find(hash);
+    BlockMap::iterator mi = mapBlockIndex.find(hash);
     if (mi != mapBlockIndex.end())
         return (*mi).second;
 
     // Create new
-    CBlockIndex* pindexNew = new CBlockIndex();
+    CBlockIndex* pindexNew = blockIndexArena.Create();
     if (!pindexNew)
         throw runtime_error("LoadBlockIndex() : new CBlockIndex failed");
     mi = mapBlockIndex.insert(make_pair(hash, pindexNew)).first;
@@ -331,8 +745,6 @@ static CBlockIndex *InsertBlockIndex(const uint256& hash)
     return pindexNew;
 }
 
-//Halford - todo - 6/19/2015 - Load block index on dedicated thread to decrease startup time by 90% - move checkblocks to separate thread
-
 bool CTxDB::LoadBlockIndex()
 {
     int64_t nStart = GetTimeMillis();
@@ -344,6 +756,15 @@ bool CTxDB::LoadBlockIndex()
         // from BDB.
         return true;
     }
+
+    // A snapshot of the derived state is only valid for the block index it
+    // was taken from, which is about to change. Drop the marker right away
+    // so that only the next clean shutdown makes a snapshot valid again.
+    DerivedStateMarker marker;
+    bool fSnapshot = !fReadOnly && Read(string("derivedstate"), marker) &&
+                     marker.nVersion == DERIVED_STATE_VERSION &&
+                     Erase(string("derivedstate"));
+
     // The block index is an in-memory structure that maps hashes to on-disk
     // locations where the contents of the block can be found. Here, we scan it
     // out of the DB and into mapBlockIndex.
@@ -354,106 +775,142 @@ bool CTxDB::LoadBlockIndex()
     iterator->Seek(ssStartKey.str());
 
     int nLoaded = 0;
-    
+
+    // Entries in the order of their records, to match them with a snapshot
+    std::vector<CBlockIndex*> vLoaded;
+
+    // Records are read in batches. While the decoders work on one batch,
+    // this thread reads the next one and then inserts the decoded entries
+    // of the previous one. The decoders are declared after the buffers so
+    // that they stop before the buffers go away.
+    std::vector<std::string> vValue[2];
+    std::vector<DecodedBlockIndex> vDecoded[2];
+    LoadBlockIndexThreads<CBlockIndexDecode> decoders(nScriptCheckThreads - 1);
+    int nCurrent = 0;
+    ReadBlockIndexBatch(iterator, vValue[nCurrent]);
+    QueueBlockIndexDecode(decoders, vValue[nCurrent], vDecoded[nCurrent]);
+
     // Now read each entry.
     printf("Loading DiskIndex %d\n",nHighest);
-    while (iterator->Valid())
+    while (!vValue[nCurrent].empty())
     {
-        // Unpack keys and values.
-        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
-        ssKey.write(iterator->key().data(), iterator->key().size());
-        CDataStream ssValue(SER_DISK, CLIENT_VERSION);
-        ssValue.write(iterator->value().data(), iterator->value().size());
-        string strType;
-        ssKey >> strType;
-        // Did we reach the end of the data to read?
-        if (fRequestShutdown || strType != "blockindex")
-            break;
-        CDiskBlockIndex diskindex;
-        ssValue >> diskindex;
-
-        uint256 blockHash = diskindex.GetBlockHash();
-
-        // Construct block index object
-        CBlockIndex* pindexNew    = InsertBlockIndex(blockHash);
-        pindexNew->pprev          = InsertBlockIndex(diskindex.hashPrev);
-        pindexNew->pnext          = InsertBlockIndex(diskindex.hashNext);
-        pindexNew->nFile          = diskindex.nFile;
-        pindexNew->nBlockPos      = diskindex.nBlockPos;
-        pindexNew->nHeight        = diskindex.nHeight;
-        pindexNew->nMint          = diskindex.nMint;
-        pindexNew->nMoneySupply   = diskindex.nMoneySupply;
-        pindexNew->nFlags         = diskindex.nFlags;
-        pindexNew->nStakeModifier = diskindex.nStakeModifier;
-        pindexNew->prevoutStake   = diskindex.prevoutStake;
-        pindexNew->nStakeTime     = diskindex.nStakeTime;
-        pindexNew->hashProof      = diskindex.hashProof;
-        pindexNew->nVersion       = diskindex.nVersion;
-        pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-        pindexNew->nTime          = diskindex.nTime;
-        pindexNew->nBits          = diskindex.nBits;
-        pindexNew->nNonce         = diskindex.nNonce;
-
-        //9-26-2016 - Gridcoin - New Accrual Fields
-        if (diskindex.nHeight > nNewIndex)
+        const int nNext = 1 - nCurrent;
+        ReadBlockIndexBatch(iterator, vValue[nNext]);
+        if (!decoders.Wait())
         {
-            pindexNew->cpid              = diskindex.cpid;
-            pindexNew->nResearchSubsidy  = diskindex.nResearchSubsidy;
-            pindexNew->nInterestSubsidy  = diskindex.nInterestSubsidy;
-            pindexNew->nMagnitude        = diskindex.nMagnitude;
-            pindexNew->nIsContract       = diskindex.nIsContract;
-            pindexNew->nIsSuperBlock     = diskindex.nIsSuperBlock;
+            delete iterator;
+            return error("CTxDB::LoadBlockIndex() : cannot decode block index");
         }
+        if (!vValue[nNext].empty())
+            QueueBlockIndexDecode(decoders, vValue[nNext], vDecoded[nNext]);
 
-        nBlockCount++;
-        // Watch for genesis block
-        if (pindexGenesisBlock == NULL && blockHash == (!fTestNet ? hashGenesisBlock : hashGenesisBlockTestNet))
-            pindexGenesisBlock = pindexNew;
-        #ifdef QT_GUI
-            if ((pindexNew->nHeight % 10000) == 0)
+        BOOST_FOREACH(const DecodedBlockIndex& decoded, vDecoded[nCurrent])
+        {
+            const CDiskBlockIndex& diskindex = decoded.diskindex;
+            const uint256& blockHash = decoded.hash;
+
+            // Construct block index object
+            CBlockIndex* pindexNew    = InsertBlockIndex(blockHash);
+            pindexNew->pprev          = InsertBlockIndex(diskindex.hashPrev);
+            pindexNew->pnext          = InsertBlockIndex(diskindex.hashNext);
+            pindexNew->nFile          = diskindex.nFile;
+            pindexNew->nBlockPos      = diskindex.nBlockPos;
+            pindexNew->nHeight        = diskindex.nHeight;
+            pindexNew->nMint          = diskindex.nMint;
+            pindexNew->nMoneySupply   = diskindex.nMoneySupply;
+            pindexNew->nFlags         = diskindex.nFlags;
+            pindexNew->nStakeModifier = diskindex.nStakeModifier;
+            pindexNew->prevoutStake   = diskindex.prevoutStake;
+            pindexNew->nStakeTime     = diskindex.nStakeTime;
+            pindexNew->hashProof      = diskindex.hashProof;
+            pindexNew->nVersion       = diskindex.nVersion;
+            pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
+            pindexNew->nTime          = diskindex.nTime;
+            pindexNew->nBits          = diskindex.nBits;
+            pindexNew->nNonce         = diskindex.nNonce;
+
+            // Trust of this block alone until the chain trust is calculated
+            pindexNew->nChainTrust    = decoded.trust;
+
+            //9-26-2016 - Gridcoin - New Accrual Fields
+            if (diskindex.nHeight > nNewIndex)
             {
-                nLoaded +=10000;
-                if (nLoaded > nHighest) nHighest=nLoaded;
-                if (nHighest < nGrandfather) nHighest=nGrandfather;
-                std::string sBlocksLoaded = ToString(nLoaded) + "/" + ToString(nHighest) + " Blocks Loaded";
-                uiInterface.InitMessage(_(sBlocksLoaded.c_str()));
-                fprintf(stdout,"%d ",nLoaded); fflush(stdout);
+                pindexNew->cpid              = diskindex.cpid;
+                pindexNew->nResearchSubsidy  = diskindex.nResearchSubsidy;
+                pindexNew->nInterestSubsidy  = diskindex.nInterestSubsidy;
+                pindexNew->nMagnitude        = diskindex.nMagnitude;
+                pindexNew->nIsContract       = diskindex.nIsContract;
+                pindexNew->nIsSuperBlock     = diskindex.nIsSuperBlock;
             }
-        #endif
 
-        // NovaCoin: build setStakeSeen
-        if (pindexNew->IsProofOfStake())
-            setStakeSeen.insert(make_pair(pindexNew->prevoutStake, pindexNew->nStakeTime));
+            nBlockCount++;
+            vLoaded.push_back(pindexNew);
+            // Watch for genesis block
+            if (pindexGenesisBlock == NULL && blockHash == (!fTestNet ? hashGenesisBlock : hashGenesisBlockTestNet))
+                pindexGenesisBlock = pindexNew;
+            #ifdef QT_GUI
+                if ((pindexNew->nHeight % 10000) == 0)
+                {
+                    nLoaded +=10000;
+                    if (nLoaded > nHighest) nHighest=nLoaded;
+                    if (nHighest < nGrandfather) nHighest=nGrandfather;
+                    std::string sBlocksLoaded = ToString(nLoaded) + "/" + ToString(nHighest) + " Blocks Loaded";
+                    uiInterface.InitMessage(_(sBlocksLoaded.c_str()));
+                    fprintf(stdout,"%d ",nLoaded); fflush(stdout);
+                }
+            #endif
+
+            // NovaCoin: build setStakeSeen
+            if (pindexNew->IsProofOfStake())
+                setStakeSeen.insert(make_pair(pindexNew->prevoutStake, pindexNew->nStakeTime));
+        }
 
-        iterator->Next();
+        nCurrent = nNext;
     }
     delete iterator;
-    
-    
+
+
     printf("Time to memorize diskindex containing %i blocks : %15" PRId64 "ms\r\n", nBlockCount, GetTimeMillis() - nStart);
     nStart = GetTimeMillis();
-    
+
 
     if (fRequestShutdown)
         return true;
 
-    // Calculate nChainTrust
-    vector<pair<int, CBlockIndex*> > vSortedByHeight;
-    vSortedByHeight.reserve(mapBlockIndex.size());
-    BOOST_FOREACH(const PAIRTYPE(uint256, CBlockIndex*)& item, mapBlockIndex)
+    // The snapshot applies if nothing was written since it was taken
+    uint256 hashBestChainStored = 0;
+    ReadHashBestChain(hashBestChainStored);
+    fSnapshot = fSnapshot && marker.nBlockCount == vLoaded.size() && marker.hashBestChain == hashBestChainStored;
+
+    if (fSnapshot && ReadChainTrustSnapshot(vLoaded))
     {
-        CBlockIndex* pindex = item.second;
-        vSortedByHeight.push_back(make_pair(pindex->nHeight, pindex));
+        BOOST_FOREACH(CBlockIndex* pindex, vLoaded)
+            if (!CheckStakeModifierCheckpoints(pindex->nHeight, pindex->nStakeModifierChecksum))
+                return error("CTxDB::LoadBlockIndex() : Failed stake modifier checkpoint height=%d, modifier=0x%016" PRIx64, pindex->nHeight, pindex->nStakeModifier);
+
+        printf("Chain Trust loaded from snapshot ");
     }
-    sort(vSortedByHeight.begin(), vSortedByHeight.end());
-    BOOST_FOREACH(const PAIRTYPE(int, CBlockIndex*)& item, vSortedByHeight)
+    else
     {
-        CBlockIndex* pindex = item.second;
-        pindex->nChainTrust = (pindex->pprev ? pindex->pprev->nChainTrust : 0) + pindex->GetBlockTrust();
-        // NovaCoin: calculate stake modifier checksum
-        pindex->nStakeModifierChecksum = GetStakeModifierChecksum(pindex);
-        if (!CheckStakeModifierCheckpoints(pindex->nHeight, pindex->nStakeModifierChecksum))
-            return error("CTxDB::LoadBlockIndex() : Failed stake modifier checkpoint height=%d, modifier=0x%016" PRIx64, pindex->nHeight, pindex->nStakeModifier);
+        // Calculate nChainTrust
+        vector<pair<int, CBlockIndex*> > vSortedByHeight;
+        vSortedByHeight.reserve(mapBlockIndex.size());
+        BOOST_FOREACH(const PAIRTYPE(uint256, CBlockIndex*)& item, mapBlockIndex)
+        {
+            CBlockIndex* pindex = item.second;
+            vSortedByHeight.push_back(make_pair(pindex->nHeight, pindex));
+        }
+        sort(vSortedByHeight.begin(), vSortedByHeight.end());
+        BOOST_FOREACH(const PAIRTYPE(int, CBlockIndex*)& item, vSortedByHeight)
+        {
+            CBlockIndex* pindex = item.second;
+            pindex->nChainTrust = (pindex->pprev ? pindex->pprev->nChainTrust : 0) + pindex->nChainTrust;
+            // NovaCoin: calculate stake modifier checksum
+            pindex->nStakeModifierChecksum = GetStakeModifierChecksum(pindex);
+            if (!CheckStakeModifierCheckpoints(pindex->nHeight, pindex->nStakeModifierChecksum))
+                return error("CTxDB::LoadBlockIndex() : Failed stake modifier checkpoint height=%d, modifier=0x%016" PRIx64, pindex->nHeight, pindex->nStakeModifier);
+        }
+        fSnapshot = false;
     }
 
 
@@ -471,6 +928,7 @@ bool CTxDB::LoadBlockIndex()
     if (!mapBlockIndex.count(hashBestChain))
         return error("CTxDB::LoadBlockIndex() : hashBestChain not found in the block index");
     pindexBest = mapBlockIndex[hashBestChain];
+    activeChain.SetTip(pindexBest);
     nBestHeight = pindexBest->nHeight;
     nBestChainTrust = pindexBest->nChainTrust;
 
@@ -499,126 +957,49 @@ bool CTxDB::LoadBlockIndex()
         nCheckDepth = nBestHeight;
     printf("Verifying last %i blocks at level %i\n", nCheckDepth, nCheckLevel);
     CBlockIndex* pindexFork = NULL;
-    map<pair<unsigned int, unsigned int>, CBlockIndex*> mapBlockPos;
+
+    // Blocks to verify from the tip down, with their positions on disk
+    std::vector<CBlockIndex*> vVerify;
+    BlockPosMap mapBlockPos;
     for (CBlockIndex* pindex = pindexBest; pindex && pindex->pprev; pindex = pindex->pprev)
     {
-        if (fRequestShutdown || pindex->nHeight < nBestHeight-nCheckDepth)
+        if (pindex->nHeight < nBestHeight-nCheckDepth)
             break;
-        CBlock block;
-        if (!block.ReadFromDisk(pindex))
-            return error("LoadBlockIndex() : block.ReadFromDisk failed");
-        // check level 1: verify block validity
-        // check level 7: verify block signature too
+        vVerify.push_back(pindex);
+        mapBlockPos[make_pair(pindex->nFile, pindex->nBlockPos)] = pindex;
+    }
 
-        #ifdef QT_GUI
-            if ((pindex->nHeight % 1000) == 0)
-            {
-                nLoaded +=1000;
+    // Blocks are independent of each other, so they are read and checked
+    // on the worker threads in batches, between which progress is shown.
+    std::vector<char> vBad(vVerify.size(), false);
+    {
+        LoadBlockIndexThreads<CBlockVerify> verifiers(nScriptCheckThreads - 1);
+        for (unsigned int nFirst = 0; nFirst < vVerify.size() && !fRequestShutdown; nFirst += VERIFY_BATCH)
+        {
+            const unsigned int nEnd = std::min<size_t>(nFirst + VERIFY_BATCH, vVerify.size());
+            std::vector<CBlockVerify> vChecks;
+            vChecks.reserve(nEnd - nFirst);
+            for (unsigned int i = nFirst; i < nEnd; i++)
+                vChecks.push_back(CBlockVerify(vVerify[i], &mapBlockPos, nCheckLevel, &vBad[i]));
+            verifiers.Add(vChecks);
+            if (!verifiers.Wait())
+                return false;
+
+            #ifdef QT_GUI
+                nLoaded += nEnd - nFirst;
                 if (nLoaded > nHighest) nHighest=nLoaded;
                 if (nHighest < nGrandfather) nHighest=nGrandfather;
                 std::string sBlocksLoaded = ToString(nLoaded) + "/" + ToString(nHighest) + " Blocks Verified";
                 uiInterface.InitMessage(_(sBlocksLoaded.c_str()));
-            }
-        #endif
-
-
-        if (nCheckLevel>0 && !block.CheckBlock("LoadBlockIndex", pindex->nHeight,pindex->nMint, true, true, (nCheckLevel>6), true))
-        {
-            printf("LoadBlockIndex() : *** found bad block at %d, hash=%s\n", pindex->nHeight, pindex->GetBlockHash().ToString().c_str());
-            pindexFork = pindex->pprev;
-        }
-        // check level 2: verify transaction index validity
-        if (nCheckLevel>1)
-        {
-            pair<unsigned int, unsigned int> pos = make_pair(pindex->nFile, pindex->nBlockPos);
-            mapBlockPos[pos] = pindex;
-            BOOST_FOREACH(const CTransaction &tx, block.vtx)
-            {
-                uint256 hashTx = tx.GetHash();
-                CTxIndex txindex;
-                if (ReadTxIndex(hashTx, txindex))
-                {
-                    // check level 3: checker transaction hashes
-                    if (nCheckLevel>2 || pindex->nFile != txindex.pos.nFile || pindex->nBlockPos != txindex.pos.nBlockPos)
-                    {
-                        // either an error or a duplicate transaction
-                        CTransaction txFound;
-                        if (!txFound.ReadFromDisk(txindex.pos))
-                        {
-                            printf("LoadBlockIndex() : *** cannot read mislocated transaction %s\n", hashTx.ToString().c_str());
-                            pindexFork = pindex->pprev;
-                        }
-                        else
-                            if (txFound.GetHash() != hashTx) // not a duplicate tx
-                            {
-                                printf("LoadBlockIndex(): *** invalid tx position for %s\n", hashTx.ToString().c_str());
-                                pindexFork = pindex->pprev;
-                            }
-                    }
-                    // check level 4: check whether spent txouts were spent within the main chain
-                    unsigned int nOutput = 0;
-                    if (nCheckLevel>3)
-                    {
-                        BOOST_FOREACH(const CDiskTxPos &txpos, txindex.vSpent)
-                        {
-                            if (!txpos.IsNull())
-                            {
-                                pair<unsigned int, unsigned int> posFind = make_pair(txpos.nFile, txpos.nBlockPos);
-                                if (!mapBlockPos.count(posFind))
-                                {
-                                    printf("LoadBlockIndex(): *** found bad spend at %d, hashBlock=%s, hashTx=%s\n", pindex->nHeight, pindex->GetBlockHash().ToString().c_str(), hashTx.ToString().c_str());
-                                    pindexFork = pindex->pprev;
-                                }
-                                // check level 6: check whether spent txouts were spent by a valid transaction that consume them
-                                if (nCheckLevel>5)
-                                {
-                                    CTransaction txSpend;
-                                    if (!txSpend.ReadFromDisk(txpos))
-                                    {
-                                        printf("LoadBlockIndex(): *** cannot read spending transaction of %s:%i from disk\n", hashTx.ToString().c_str(), nOutput);
-                                        pindexFork = pindex->pprev;
-                                    }
-                                    else if (!txSpend.CheckTransaction())
-                                    {
-                                        printf("LoadBlockIndex(): *** spending transaction of %s:%i is invalid\n", hashTx.ToString().c_str(), nOutput);
-                                        pindexFork = pindex->pprev;
-                                    }
-                                    else
-                                    {
-                                        bool fFound = false;
-                                        BOOST_FOREACH(const CTxIn &txin, txSpend.vin)
-                                            if (txin.prevout.hash == hashTx && txin.prevout.n == nOutput)
-                                                fFound = true;
-                                        if (!fFound)
-                                        {
-                                            printf("LoadBlockIndex(): *** spending transaction of %s:%i does not spend it\n", hashTx.ToString().c_str(), nOutput);
-                                            pindexFork = pindex->pprev;
-                                        }
-                                    }
-                                }
-                            }
-                            nOutput++;
-                        }
-                    }
-                }
-                // check level 5: check whether all prevouts are marked spent
-                if (nCheckLevel>4)
-                {
-                     BOOST_FOREACH(const CTxIn &txin, tx.vin)
-                     {
-                          CTxIndex txindex;
-                          if (ReadTxIndex(txin.prevout.hash, txindex))
-                              if (txindex.vSpent.size()-1 < txin.prevout.n || txindex.vSpent[txin.prevout.n].IsNull())
-                              {
-                                  printf("LoadBlockIndex(): *** found unspent prevout %s:%i in %s\n", txin.prevout.hash.ToString().c_str(), txin.prevout.n, hashTx.ToString().c_str());
-                                  pindexFork = pindex->pprev;
-                              }
-                     }
-                }
-            }
+            #endif
         }
     }
 
+    // Move back to below the lowest bad block
+    for (unsigned int i = 0; i < vVerify.size(); i++)
+        if (vBad[i])
+            pindexFork = vVerify[i]->pprev;
+
 
 
     printf("Time to Verify Blocks %15" PRId64 "ms\n", GetTimeMillis() - nStart);
@@ -637,62 +1018,144 @@ bool CTxDB::LoadBlockIndex()
     printf("Set up RA ");  
     nStart = GetTimeMillis();
     
-    //Gridcoin - In order, set up Research Age hashes and lifetime fields
-    CBlockIndex* pindex = BlockFinder().FindByHeight(1);
-    
-    nLoaded=pindex->nHeight;
-    if (pindex && pindexBest && pindexBest->nHeight > 10 && pindex->pnext)
+    // The snapshot holds the research age of the chain it was taken from
+    if (fSnapshot && hashBestChain == marker.hashBestChain && ReadResearchAgeSnapshot())
     {
-        printf(" RA Starting %i %i %i ", pindex->nHeight, pindex->pnext->nHeight, pindexBest->nHeight);
-        while (pindex->nHeight < pindexBest->nHeight)
+        printf(" RA loaded from snapshot ");
+    }
+    else
+    {
+        //Gridcoin - In order, set up Research Age hashes and lifetime fields
+        CBlockIndex* pindex = BlockFinder().FindByHeight(1);
+    
+        nLoaded=pindex->nHeight;
+        if (pindex && pindexBest && pindexBest->nHeight > 10 && pindex->pnext)
         {
-            if (!pindex || !pindex->pnext) break;  
-            pindex = pindex->pnext;
-            if (pindex == pindexBest) break;
-            if (pindex==NULL || !pindex->IsInMainChain()) continue;
+            printf(" RA Starting %i %i %i ", pindex->nHeight, pindex->pnext->nHeight, pindexBest->nHeight);
+            while (pindex->nHeight < pindexBest->nHeight)
+            {
+                if (!pindex || !pindex->pnext) break;  
+                pindex = pindex->pnext;
+                if (pindex == pindexBest) break;
+                if (pindex==NULL || !pindex->IsInMainChain()) continue;
             
 #ifdef QT_GUI
-            if ((pindex->nHeight % 10000) == 0)
-            {
-                nLoaded +=10000;
-                if (nLoaded > nHighest) nHighest=nLoaded;
-                if (nHighest < nGrandfather) nHighest=nGrandfather;
-                std::string sBlocksLoaded = ToString(nLoaded) + "/" + ToString(nHighest) + " POR Blocks Verified";
-                uiInterface.InitMessage(_(sBlocksLoaded.c_str()));
-            }
-#endif
-                        
-            if (pindex->nResearchSubsidy > 0 && pindex->IsUserCPID())
-            {
-                const std::string& scpid = pindex->GetCPID();
-                StructCPID stCPID = GetInitializedStructCPID2(scpid, mvResearchAge);
-                
-                stCPID.InterestSubsidy += pindex->nInterestSubsidy;
-                stCPID.ResearchSubsidy += pindex->nResearchSubsidy;
-                if (pindex->nHeight > stCPID.LastBlock) 
+                if ((pindex->nHeight % 10000) == 0)
                 {
-                    stCPID.LastBlock = pindex->nHeight;
-                    stCPID.BlockHash = pindex->GetBlockHash().GetHex();
+                    nLoaded +=10000;
+                    if (nLoaded > nHighest) nHighest=nLoaded;
+                    if (nHighest < nGrandfather) nHighest=nGrandfather;
+                    std::string sBlocksLoaded = ToString(nLoaded) + "/" + ToString(nHighest) + " POR Blocks Verified";
+                    uiInterface.InitMessage(_(sBlocksLoaded.c_str()));
                 }
-                
-                if (pindex->nMagnitude > 0)
-                {
-                    stCPID.Accuracy++;
-                    stCPID.TotalMagnitude += pindex->nMagnitude;
-                    stCPID.ResearchAverageMagnitude = stCPID.TotalMagnitude/(stCPID.Accuracy+.01);
-                }
-                
-                if (pindex->nTime < stCPID.LowLockTime)  stCPID.LowLockTime = pindex->nTime;
-                if (pindex->nTime > stCPID.HighLockTime) stCPID.HighLockTime = pindex->nTime;
-                
-                // Store the updated struct.
-                mvResearchAge[scpid] = stCPID;
-                AddCPIDBlockHash(scpid, pindex->GetBlockHash());
+#endif
+                        
+                CountResearchAge(pindex, mvResearchAge, researcherTotals);
             }
         }
     }
 
     printf("RA Complete - RA Time %15" PRId64 "ms\n", GetTimeMillis() - nStart);
 
+    fDerivedStateLoaded = true;
+    return true;
+}
+
+bool CTxDB::ReadChainTrustSnapshot(const std::vector<CBlockIndex*>& vLoaded)
+{
+    // Check every record before touching the block index, which still holds
+    // the trust of each block should the snapshot not fit.
+    std::vector<ChainTrustChunk> vChunks((vLoaded.size() + CHAIN_TRUST_CHUNK - 1) / CHAIN_TRUST_CHUNK);
+    for (unsigned int nChunk = 0; nChunk < vChunks.size(); nChunk++)
+    {
+        const unsigned int nFirst = nChunk * CHAIN_TRUST_CHUNK;
+        const size_t nCount = std::min<size_t>(CHAIN_TRUST_CHUNK, vLoaded.size() - nFirst);
+        ChainTrustChunk& chunk = vChunks[nChunk];
+        if (!Read(make_pair(string("chaintrust"), nChunk), chunk) ||
+            chunk.hashFirst != vLoaded[nFirst]->GetBlockHash() ||
+            chunk.vChainTrust.size() != nCount ||
+            chunk.vStakeModifierChecksum.size() != nCount)
+        {
+            printf("CTxDB::ReadChainTrustSnapshot() : snapshot does not match the block index\n");
+            return false;
+        }
+    }
+
+    for (unsigned int i = 0; i < vLoaded.size(); i++)
+    {
+        const ChainTrustChunk& chunk = vChunks[i / CHAIN_TRUST_CHUNK];
+        vLoaded[i]->nChainTrust = chunk.vChainTrust[i % CHAIN_TRUST_CHUNK];
+        vLoaded[i]->nStakeModifierChecksum = chunk.vStakeModifierChecksum[i % CHAIN_TRUST_CHUNK];
+    }
+
+    return true;
+}
+
+bool CTxDB::ReadResearchAgeSnapshot()
+{
+    ResearchAgeSnapshot snapshot;
+    if (!Read(string("researchage"), snapshot))
+        return false;
+
+    if (!snapshot.Restore(activeChain, mvResearchAge, researcherTotals))
+    {
+        printf("CTxDB::ReadResearchAgeSnapshot() : snapshot does not match the main chain\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool CTxDB::WriteDerivedStateSnapshot()
+{
+    if (!fDerivedStateLoaded || pindexBest == NULL)
+        return false;
+
+    int64_t nStart = GetTimeMillis();
+
+    // LoadBlockIndex reads the records in key order. Keys only differ in
+    // the block hash, which is serialized as its raw bytes.
+    std::vector<CBlockIndex*> vBlocks;
+    vBlocks.reserve(mapBlockIndex.size());
+    BOOST_FOREACH(const PAIRTYPE(uint256, CBlockIndex*)& item, mapBlockIndex)
+        vBlocks.push_back(item.second);
+    std::sort(vBlocks.begin(), vBlocks.end(), [](const CBlockIndex* a, const CBlockIndex* b) {
+        return memcmp(BEGIN(*a->phashBlock), BEGIN(*b->phashBlock), sizeof(uint256)) < 0;
+    });
+
+    // Counted again rather than copied: the running research age also has
+    // the tip and the blocks connected since startup, which a start without
+    // the snapshot would not count
+    ResearchAgeSnapshot research;
+    research.Count(activeChain);
+
+    DerivedStateMarker marker;
+    marker.nVersion = DERIVED_STATE_VERSION;
+    marker.hashBestChain = hashBestChain;
+    marker.nBlockCount = vBlocks.size();
+
+    // Written as one batch so that the marker never outlives a partial write
+    if (!TxnBegin())
+        return false;
+    for (unsigned int nFirst = 0; nFirst < vBlocks.size(); nFirst += CHAIN_TRUST_CHUNK)
+    {
+        const unsigned int nEnd = std::min<size_t>(nFirst + CHAIN_TRUST_CHUNK, vBlocks.size());
+        ChainTrustChunk chunk;
+        chunk.hashFirst = vBlocks[nFirst]->GetBlockHash();
+        chunk.vChainTrust.reserve(nEnd - nFirst);
+        chunk.vStakeModifierChecksum.reserve(nEnd - nFirst);
+        for (unsigned int i = nFirst; i < nEnd; i++)
+        {
+            chunk.vChainTrust.push_back(vBlocks[i]->nChainTrust);
+            chunk.vStakeModifierChecksum.push_back(vBlocks[i]->nStakeModifierChecksum);
+        }
+        Write(make_pair(string("chaintrust"), nFirst / CHAIN_TRUST_CHUNK), chunk);
+    }
+    Write(string("researchage"), research);
+    Write(string("derivedstate"), marker);
+    if (!TxnCommit())
+        return error("CTxDB::WriteDerivedStateSnapshot() : cannot write snapshot");
+
+    printf("Wrote snapshot of the derived state of %u blocks in %" PRId64 "ms\n", marker.nBlockCount, GetTimeMillis() - nStart);
     return true;
 }
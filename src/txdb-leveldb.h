@@ -7,6 +7,7 @@
 #define BITCOIN_LEVELDB_H
 
 #include "main.h"
+#include "txindexcache.h"
 
 #include <string>
 #include <leveldb/db.h>
@@ -43,6 +44,11 @@ private:
     // A batch stores up writes and deletes for atomic application. When this
     // field is non-NULL, writes/deletes go there instead of directly to disk.
     leveldb::WriteBatch *activeBatch;
+
+    // Transaction index changes made since TxnBegin. They are written to
+    // activeBatch, once per transaction, by TxnCommit.
+    TxIndexChanges mapBatchTxIndex;
+
     leveldb::Options options;
     bool fReadOnly;
     int nVersion;
@@ -166,6 +172,7 @@ public:
     {
         delete activeBatch;
         activeBatch = NULL;
+        mapBatchTxIndex.clear();
         return true;
     }
 
@@ -204,8 +211,17 @@ public:
 
 
     bool LoadBlockIndex();
+
+    // Persist chain trust, stake modifier checksums and research age so
+    // that the next LoadBlockIndex does not have to derive them again.
+    // Only meant for a clean shutdown, once nothing changes the chain.
+    bool WriteDerivedStateSnapshot();
 private:
     bool LoadBlockIndexGuts();
+    bool ReadChainTrustSnapshot(const std::vector<CBlockIndex*>& vLoaded);
+    bool ReadResearchAgeSnapshot();
+    bool ReadTxIndexEntry(const uint256& hash, TxIndexEntry& entry);
+    bool WriteTxIndexEntry(const uint256& hash, const TxIndexEntry& entry);
 };
 
 
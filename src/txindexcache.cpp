@@ -0,0 +1,107 @@
+#include "txindexcache.h"
+#include "util.h"
+
+namespace
+{
+    // Estimated memory taken by an entry: its list node, its lookup table
+    // node and bucket, and the spent positions it holds.
+    size_t EntryBytes(const TxIndexEntry& entry)
+    {
+        return sizeof(std::pair<uint256, TxIndexEntry>) + 2 * sizeof(void*)
+            + sizeof(uint256) + 4 * sizeof(void*)
+            + entry.txindex.vSpent.capacity() * sizeof(CDiskTxPos);
+    }
+}
+
+TxIndexCache::TxIndexCache(size_t nMaxBytes)
+    : nMaxBytes(nMaxBytes)
+    , nBytes(0)
+    , nGeneration(0)
+{
+}
+
+bool TxIndexCache::Get(const uint256& hash, TxIndexEntry& entry)
+{
+    LOCK(cs);
+    auto it = mapEntries.find(hash);
+    if (it == mapEntries.end())
+        return false;
+
+    entries.splice(entries.begin(), entries, it->second);
+    entry = it->second->second;
+    return true;
+}
+
+uint64_t TxIndexCache::GetGeneration()
+{
+    LOCK(cs);
+    return nGeneration;
+}
+
+void TxIndexCache::PutRead(const uint256& hash, const TxIndexEntry& entry, uint64_t nGenerationRead)
+{
+    LOCK(cs);
+    if (nGenerationRead == nGeneration && !mapEntries.count(hash))
+        Put(hash, entry);
+}
+
+void TxIndexCache::Apply(const TxIndexChanges& changes)
+{
+    LOCK(cs);
+    nGeneration++;
+    for (const auto& change : changes)
+    {
+        auto it = mapEntries.find(change.first);
+        if (it != mapEntries.end())
+            Erase(it);
+        Put(change.first, change.second);
+    }
+}
+
+void TxIndexCache::Clear()
+{
+    LOCK(cs);
+    nGeneration++;
+    mapEntries.clear();
+    entries.clear();
+    nBytes = 0;
+}
+
+size_t TxIndexCache::GetBytes()
+{
+    LOCK(cs);
+    return nBytes;
+}
+
+size_t TxIndexCache::GetCount()
+{
+    LOCK(cs);
+    return mapEntries.size();
+}
+
+void TxIndexCache::Put(const uint256& hash, const TxIndexEntry& entry)
+{
+    const size_t nEntryBytes = EntryBytes(entry);
+    if (nEntryBytes > nMaxBytes)
+        return;
+
+    while (!entries.empty() && nBytes + nEntryBytes > nMaxBytes)
+        Erase(mapEntries.find(entries.back().first));
+
+    entries.emplace_front(hash, entry);
+    mapEntries[hash] = entries.begin();
+    nBytes += EntryBytes(entries.front().second);
+}
+
+void TxIndexCache::Erase(std::unordered_map<uint256, EntryList::iterator, BlockHasher>::iterator it)
+{
+    nBytes -= EntryBytes(it->second->second);
+    entries.erase(it->second);
+    mapEntries.erase(it);
+}
+
+TxIndexCache& GetTxIndexCache()
+{
+    static TxIndexCache cache(std::max<int64_t>(0, GetArg("-txindexcache", 32)) * 1048576);
+    return cache;
+}
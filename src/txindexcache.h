@@ -0,0 +1,103 @@
+#pragma once
+
+#include "block.h"
+#include "main.h"
+#include "sync.h"
+
+#include <list>
+#include <map>
+#include <unordered_map>
+
+//!
+//! \brief What is known about the transaction index entry of a transaction.
+//!
+struct TxIndexEntry
+{
+    bool fExists;     //!< \c false if the transaction is not indexed.
+    CTxIndex txindex; //!< Index entry. Null unless \a fExists.
+};
+
+//!
+//! \brief Pending changes to the transaction index, by transaction hash.
+//!
+typedef std::map<uint256, TxIndexEntry> TxIndexChanges;
+
+//!
+//! \brief Least recently used cache of committed transaction index entries.
+//!
+//! Caches both entries and the absence of entries, bounded by an estimate
+//! of the memory they take. Entries read from the database are only added
+//! when no commit happened since the read began, so a slow reader cannot
+//! put back a value that a commit just replaced.
+//!
+class TxIndexCache
+{
+public:
+    //!
+    //! \brief Create a cache.
+    //! \param nMaxBytes Most memory the entries may take. Zero disables
+    //! the cache.
+    //!
+    explicit TxIndexCache(size_t nMaxBytes);
+
+    //!
+    //! \brief Look up a transaction and mark it as recently used.
+    //! \param hash Transaction hash.
+    //! \param entry Set to the cached entry when found.
+    //! \return \c false if the cache knows nothing about \p hash.
+    //!
+    bool Get(const uint256& hash, TxIndexEntry& entry);
+
+    //!
+    //! \brief Get the current commit generation, to be passed to
+    //! \a PutRead after reading the database.
+    //!
+    uint64_t GetGeneration();
+
+    //!
+    //! \brief Add an entry read from the database.
+    //! \param hash Transaction hash.
+    //! \param entry Entry as read.
+    //! \param nGeneration Result of \a GetGeneration before the read.
+    //!
+    void PutRead(const uint256& hash, const TxIndexEntry& entry, uint64_t nGeneration);
+
+    //!
+    //! \brief Apply changes that were written to the database.
+    //! \param changes Committed changes.
+    //!
+    void Apply(const TxIndexChanges& changes);
+
+    //!
+    //! \brief Drop every entry.
+    //!
+    void Clear();
+
+    //!
+    //! \brief Get the estimated memory taken by the entries.
+    //!
+    size_t GetBytes();
+
+    //!
+    //! \brief Get the number of cached entries.
+    //!
+    size_t GetCount();
+
+private:
+    typedef std::list<std::pair<uint256, TxIndexEntry>> EntryList;
+
+    void Put(const uint256& hash, const TxIndexEntry& entry);
+    void Erase(std::unordered_map<uint256, EntryList::iterator, BlockHasher>::iterator it);
+
+    CCriticalSection cs;
+    const size_t nMaxBytes;
+    size_t nBytes;
+    uint64_t nGeneration;
+    EntryList entries; //!< Most recently used first.
+    std::unordered_map<uint256, EntryList::iterator, BlockHasher> mapEntries;
+};
+
+//!
+//! \brief Get the cache in front of the transaction index database.
+//!
+TxIndexCache& GetTxIndexCache();
@@ -0,0 +1,152 @@
+#include "voting.h"
+#include "sync.h"
+#include "util.h"
+#include "xmlview.h"
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+double cdbl(std::string s, int place);
+std::vector<std::string> split(std::string s, std::string delim);
+
+namespace
+{
+    // A vote as parsed once when it is memorised. Answers and titles are
+    // kept in lower case since polls match them regardless of case.
+    struct IndexedVote
+    {
+        std::string title;
+        std::vector<std::string> answers;
+        double magnitude;
+        double balance;
+        bool fAddress;
+    };
+
+    struct PollVotes
+    {
+        // Keys of the votes cast in the poll, iterated in the order the
+        // application cache lists them so the sums come out the same.
+        std::set<std::string> keys;
+        PollTallies tallies;
+        bool fTallied;
+    };
+
+    CCriticalSection cs_votes;
+    std::unordered_map<std::string, IndexedVote> mapVotes;
+    std::unordered_map<std::string, PollVotes> mapPolls;
+
+    IndexedVote ParseVote(const std::string& contract)
+    {
+        const XMLView fields(contract, {"TITLE", "ANSWER", "GRCADDRESS", "MAGNITUDE", "BALANCE"});
+        IndexedVote vote;
+        vote.title = boost::to_lower_copy(fields.GetString(0));
+        vote.answers = split(boost::to_lower_copy(fields.GetString(1)),";");
+        vote.fAddress = fields[2].length() > 5;
+
+        // The weights the voter claimed. The provable weights introduced with
+        // the July 2017 security upgrade are not counted towards poll results.
+        try
+        {
+            vote.magnitude = cdbl(fields.GetString(3),2);
+            vote.balance = cdbl(fields.GetString(4),0);
+        }
+        catch (std::exception& e)
+        {
+            printf("ParseVote: invalid weight in vote for %s: %s\r\n", vote.title.c_str(), e.what());
+            vote.magnitude = 0;
+            vote.balance = 0;
+        }
+
+        return vote;
+    }
+
+    void EraseVote(const std::string& key)
+    {
+        auto it = mapVotes.find(key);
+        if (it == mapVotes.end())
+            return;
+
+        auto itPoll = mapPolls.find(it->second.title);
+        if (itPoll != mapPolls.end())
+        {
+            itPoll->second.keys.erase(key);
+            itPoll->second.fTallied = false;
+            if (itPoll->second.keys.empty())
+                mapPolls.erase(itPoll);
+        }
+        mapVotes.erase(it);
+    }
+
+    void Tally(PollVotes& poll)
+    {
+        poll.tallies.clear();
+        for (const std::string& key : poll.keys)
+        {
+            const IndexedVote& vote = mapVotes[key];
+            const double nAnswers = vote.answers.size();
+            for (const std::string& answer : vote.answers)
+            {
+                auto it = poll.tallies.insert(std::make_pair(answer, VoteTally{ 0, 0, 0, 0, 0 })).first;
+                VoteTally& tally = it->second;
+                tally.magnitude += vote.magnitude / nAnswers;
+                tally.balance += vote.balance / nAnswers;
+                tally.cpids += vote.magnitude > 0 ? 1 : 0;
+                tally.addresses += vote.fAddress ? 1 : 0;
+                tally.participants += 1.0 / nAnswers;
+            }
+        }
+        poll.fTallied = true;
+    }
+}
+
+void IndexVote(const std::string& key, const std::string& contract)
+{
+    IndexedVote vote = ParseVote(contract);
+
+    LOCK(cs_votes);
+    EraseVote(key);
+    PollVotes& poll = mapPolls[vote.title];
+    poll.keys.insert(key);
+    poll.fTallied = false;
+    mapVotes[key] = std::move(vote);
+}
+
+void UnindexVote(const std::string& key)
+{
+    LOCK(cs_votes);
+    EraseVote(key);
+}
+
+void ClearVoteIndex()
+{
+    LOCK(cs_votes);
+    mapVotes.clear();
+    mapPolls.clear();
+}
+
+PollTallies GetPollTallies(const std::string& title)
+{
+    LOCK(cs_votes);
+    auto it = mapPolls.find(boost::to_lower_copy(title));
+    if (it == mapPolls.end())
+        return PollTallies();
+
+    if (!it->second.fTallied)
+        Tally(it->second);
+    return it->second.tallies;
+}
+
+double GetVoteTallyShares(const VoteTally& tally, double sharetype, double MoneySupplyFactor)
+{
+    if (sharetype==1) return tally.magnitude;
+    if (sharetype==2) return tally.balance;
+
+    // https://github.com/gridcoin/Gridcoin-Research/issues/87#issuecomment-253999878
+    // Researchers weight is Total Money Supply / 5.67 * Magnitude
+    if (sharetype==3) return (MoneySupplyFactor/5.67) * tally.magnitude + tally.balance;
+    if (sharetype==4) return tally.cpids;
+    if (sharetype==5) return tally.addresses;
+    return 0;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+//!
+//! \brief Weight of the votes cast for one answer of a poll.
+//!
+//! Votes with several answers count towards each of them. Fields marked as
+//! split count a fraction of such a vote for each answer.
+//!
+struct VoteTally
+{
+    double magnitude;    //!< Magnitude of the voters, split.
+    double balance;      //!< Balance of the voters, split.
+    double cpids;        //!< Votes from a CPID with magnitude.
+    double addresses;    //!< Votes carrying a GRC address.
+    double participants; //!< Number of voters, split.
+};
+
+//!
+//! \brief Tallies of a poll keyed by lower case answer.
+//!
+typedef std::map<std::string, VoteTally> PollTallies;
+
+//!
+//! \brief Add a vote contract to the vote index, replacing the vote
+//! memorised under the same key.
+//! \param key Application cache key of the vote.
+//! \param contract Vote contract.
+//!
+void IndexVote(const std::string& key, const std::string& contract);
+
+//!
+//! \brief Remove a vote from the vote index.
+//! \param key Application cache key of the vote.
+//!
+void UnindexVote(const std::string& key);
+
+//!
+//! \brief Remove every vote from the vote index.
+//!
+void ClearVoteIndex();
+
+//!
+//! \brief Get the tallies of the answers voted for in a poll.
+//!
+//! The tallies of a poll are summed up from its indexed votes the first time
+//! they are read after a vote for the poll changed.
+//!
+//! \param title Poll title, matched regardless of case.
+//! \return Tallies of the answers which received votes.
+//!
+PollTallies GetPollTallies(const std::string& title);
+
+//!
+//! \brief Get the shares of a tally.
+//! \param tally Tally of an answer.
+//! \param sharetype Share type of the poll, 1 to 5.
+//! \param MoneySupplyFactor Weight of magnitude in share type 3 polls, as
+//! given by \c GetMoneySupplyFactor.
+//! \return Shares of \p tally, or 0 for an unknown share type.
+//!
+double GetVoteTallyShares(const VoteTally& tally, double sharetype, double MoneySupplyFactor);
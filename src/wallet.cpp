@@ -411,6 +411,7 @@ void CWallet::WalletUpdateSpent(const CTransaction &tx, bool fBlock)
                 {
                     if (fDebug) printf("WalletUpdateSpent found spent coin %s gC %s\n", FormatMoney(wtx.GetCredit()).c_str(), wtx.GetHash().ToString().c_str());
                     wtx.MarkSpent(txin.prevout.n);
+                    UpdateCoinIndex(wtx);
                     wtx.WriteToDisk();
                     NotifyTransactionChanged(this, txin.prevout.hash, CT_UPDATED);
                 }
@@ -428,6 +429,7 @@ void CWallet::WalletUpdateSpent(const CTransaction &tx, bool fBlock)
                 if (IsMine(txout))
                 {
                     wtx.MarkUnspent(&txout - &tx.vout[0]);
+                    UpdateCoinIndex(wtx);
                     wtx.WriteToDisk();
                     NotifyTransactionChanged(this, hash, CT_UPDATED);
                 }
@@ -443,9 +445,90 @@ void CWallet::MarkDirty()
         LOCK(cs_wallet);
         BOOST_FOREACH(PAIRTYPE(const uint256, CWalletTx)& item, mapWallet)
             item.second.MarkDirty();
+
+        // Outputs already in the wallet may have become ours, as when a key
+        // is imported without a rescan
+        RebuildCoinIndex();
     }
 }
 
+void CWallet::UpdateCoinIndex(const CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+    nCoinIndexVersion++;
+
+    bool fUnspent = false;
+    for (unsigned int i = 0; i < wtx.vout.size() && !fUnspent; i++)
+        fUnspent = !wtx.IsSpent(i) && IsMine(wtx.vout[i]);
+
+    pair<unsigned int, uint256> key(wtx.nTime, wtx.GetHash());
+    if (fUnspent)
+        setUnspentCoins.insert(key);
+    else
+        setUnspentCoins.erase(key);
+
+    // Maturity depends on the chain, so it is only checked when reading
+    if (wtx.IsCoinBase() || wtx.IsCoinStake())
+        setImmatureCoins.insert(key.second);
+}
+
+void CWallet::EraseFromCoinIndex(const CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+    nCoinIndexVersion++;
+
+    setUnspentCoins.erase(make_pair(wtx.nTime, wtx.GetHash()));
+    setImmatureCoins.erase(wtx.GetHash());
+}
+
+void CWallet::RebuildCoinIndex()
+{
+    LOCK(cs_wallet);
+    nCoinIndexVersion++;
+    setUnspentCoins.clear();
+    setImmatureCoins.clear();
+    BOOST_FOREACH(const PAIRTYPE(const uint256, CWalletTx)& item, mapWallet)
+        UpdateCoinIndex(item.second);
+}
+
+// Wallet transactions in the coin index, in mapWallet order
+vector<const CWalletTx*> CWallet::GetCoinIndexTransactions(bool fUnspent, bool fImmature) const
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    set<uint256> setHashes;
+    if (fUnspent)
+    {
+        BOOST_FOREACH(const PAIRTYPE(unsigned int, uint256)& item, setUnspentCoins)
+            setHashes.insert(item.second);
+    }
+    if (fImmature)
+    {
+        for (set<uint256>::iterator it = setImmatureCoins.begin(); it != setImmatureCoins.end(); )
+        {
+            // A reorganization can make a matured coin immature again, so
+            // only those spent as well are dropped
+            map<uint256, CWalletTx>::const_iterator mi = mapWallet.find(*it);
+            if (mi == mapWallet.end() ||
+                (mi->second.GetBlocksToMaturity() == 0 && !setUnspentCoins.count(make_pair(mi->second.nTime, *it))))
+                setImmatureCoins.erase(it++);
+            else
+                setHashes.insert(*it++);
+        }
+    }
+
+    vector<const CWalletTx*> vwtx;
+    vwtx.reserve(setHashes.size());
+    BOOST_FOREACH(const uint256& hash, setHashes)
+    {
+        map<uint256, CWalletTx>::const_iterator mi = mapWallet.find(hash);
+        if (mi != mapWallet.end())
+            vwtx.push_back(&mi->second);
+    }
+    return vwtx;
+}
+
 bool CWallet::AddToWallet(const CWalletTx& wtxIn)
 {
     uint256 hash = wtxIn.GetHash();
@@ -532,6 +615,7 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn)
             }
             fUpdated |= wtx.UpdateSpent(wtxIn.vfSpent);
         }
+        UpdateCoinIndex(wtx);
 
         //// debug print 12-9-2014 (received coins)
         if (fDebug) printf("AddToWallet %s  %s %s \n", wtxIn.GetHash().ToString().c_str(), (fInsertedNew ? "new" : ""), (fUpdated ? "update" : ""));
@@ -679,8 +763,13 @@ bool CWallet::EraseFromWallet(uint256 hash)
         return false;
     {
         LOCK(cs_wallet);
-        if (mapWallet.erase(hash))
+        map<uint256, CWalletTx>::iterator mi = mapWallet.find(hash);
+        if (mi != mapWallet.end())
+        {
+            EraseFromCoinIndex(mi->second);
+            mapWallet.erase(mi);
             CWalletDB(strWalletFile).EraseTx(hash);
+        }
     }
     return true;
 }
@@ -1124,6 +1213,7 @@ void CWallet::ReacceptWalletTransactions()
                 {
                     printf("ReacceptWalletTransactions found spent coin %s gC %s\n", FormatMoney(wtx.GetCredit()).c_str(), wtx.GetHash().ToString().c_str());
                     wtx.MarkDirty();
+                    UpdateCoinIndex(wtx);
                     wtx.WriteToDisk();
                 }
             }
@@ -1240,12 +1330,26 @@ int64_t CWallet::GetBalance() const
     int64_t nTotal = 0;
     {
         LOCK2(cs_main, cs_wallet);
-        for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+        if (fBalanceCached && pindexBalanceCached == pindexBest &&
+            nBalanceTransactionsUpdated == nTransactionsUpdated && nBalanceCoinIndexVersion == nCoinIndexVersion)
+            return nBalanceCached;
+
+        // Whether an unconfirmed transaction is trusted also depends on the
+        // time through its finality, so a balance counting one is not kept.
+        bool fCacheable = true;
+        BOOST_FOREACH(const CWalletTx* pcoin, GetCoinIndexTransactions(true, false))
         {
-            const CWalletTx* pcoin = &(*it).second;
+            if (pcoin->GetDepthInMainChain() == 0)
+                fCacheable = false;
             if (pcoin->IsTrusted())
                 nTotal += pcoin->GetAvailableCredit();
         }
+
+        fBalanceCached = fCacheable;
+        nBalanceCached = nTotal;
+        pindexBalanceCached = pindexBest;
+        nBalanceTransactionsUpdated = nTransactionsUpdated;
+        nBalanceCoinIndexVersion = nCoinIndexVersion;
     }
 
     return nTotal;
@@ -1256,9 +1360,8 @@ int64_t CWallet::GetUnconfirmedBalance() const
     int64_t nTotal = 0;
     {
         LOCK2(cs_main, cs_wallet);
-        for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+        BOOST_FOREACH(const CWalletTx* pcoin, GetCoinIndexTransactions(true, false))
         {
-            const CWalletTx* pcoin = &(*it).second;
             if (!IsFinalTx(*pcoin) || (!pcoin->IsTrusted() && pcoin->GetDepthInMainChain() == 0))
                 nTotal += pcoin->GetAvailableCredit();
         }
@@ -1271,9 +1374,9 @@ int64_t CWallet::GetImmatureBalance() const
     int64_t nTotal = 0;
     {
         LOCK2(cs_main, cs_wallet);
-        for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+        BOOST_FOREACH(const CWalletTx* ptx, GetCoinIndexTransactions(false, true))
         {
-            const CWalletTx& pcoin = (*it).second;
+            const CWalletTx& pcoin = *ptx;
             if (pcoin.IsCoinBase() && pcoin.GetBlocksToMaturity() > 0 && pcoin.IsInMainChain())
                 nTotal += GetCredit(pcoin);
         }
@@ -1288,9 +1391,8 @@ void CWallet::AvailableCoins(vector<COutput>& vCoins, bool fOnlyConfirmed, const
 
     {
         LOCK2(cs_main, cs_wallet);
-        for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+        BOOST_FOREACH(const CWalletTx* pcoin, GetCoinIndexTransactions(true, true))
         {
-            const CWalletTx* pcoin = &(*it).second;
 			int nDepth = pcoin->GetDepthInMainChain();
 		
 			if (!fIncludeStakedCoins)
@@ -1318,7 +1420,7 @@ void CWallet::AvailableCoins(vector<COutput>& vCoins, bool fOnlyConfirmed, const
             for (unsigned int i = 0; i < pcoin->vout.size(); i++)
 			{
                 if ((!(pcoin->IsSpent(i)) && IsMine(pcoin->vout[i]) && pcoin->vout[i].nValue >= nMinimumInputValue &&
-                   (!coinControl || !coinControl->HasSelected() || coinControl->IsSelected((*it).first, i))) 
+                   (!coinControl || !coinControl->HasSelected() || coinControl->IsSelected(pcoin->GetHash(), i))) 
 	     	 	   || (fIncludeStakedCoins && pcoin->IsCoinStake() && pcoin->GetBlocksToMaturity() > 0 && pcoin->GetDepthInMainChain() > 0))
 				   {
 				        vCoins.push_back(COutput(pcoin, i, nDepth));
@@ -1335,13 +1437,21 @@ void CWallet::AvailableCoinsForStaking(vector<COutput>& vCoins, unsigned int nSp
     vCoins.clear();
     {
         LOCK2(cs_main, cs_wallet);
-        for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+
+        // Filtering by tx timestamp instead of block timestamp may give false positives but never false negatives.
+        // The coin index is ordered by it, so stop at the first coin too young to stake.
+        set<uint256> setHashes;
+        for (set<pair<unsigned int, uint256> >::const_iterator it = setUnspentCoins.begin(); it != setUnspentCoins.end(); ++it)
         {
-            const CWalletTx* pcoin = &(*it).second;
+            if (it->first + nStakeMinAge > nSpendTime)
+                break;
+            setHashes.insert(it->second);
+        }
 
-            // Filtering by tx timestamp instead of block timestamp may give false positives but never false negatives
-            if (pcoin->nTime + nStakeMinAge > nSpendTime)
-                continue;
+        // Keep the mapWallet order the stake selection has always seen
+        BOOST_FOREACH(const uint256& hash, setHashes)
+        {
+            const CWalletTx* pcoin = &mapWallet.find(hash)->second;
 
             if (pcoin->GetBlocksToMaturity() > 0)
                 continue;
@@ -1408,9 +1518,8 @@ int64_t CWallet::GetStake() const
 {
     int64_t nTotal = 0;
     LOCK2(cs_main, cs_wallet);
-    for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+    BOOST_FOREACH(const CWalletTx* pcoin, GetCoinIndexTransactions(false, true))
     {
-        const CWalletTx* pcoin = &(*it).second;
         if (pcoin->IsCoinStake() && pcoin->GetBlocksToMaturity() > 0 && pcoin->GetDepthInMainChain() > 0)
             nTotal += CWallet::GetCredit(*pcoin);
     }
@@ -1421,9 +1530,8 @@ int64_t CWallet::GetNewMint() const
 {
     int64_t nTotal = 0;
     LOCK2(cs_main, cs_wallet);
-    for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+    BOOST_FOREACH(const CWalletTx* pcoin, GetCoinIndexTransactions(false, true))
     {
-        const CWalletTx* pcoin = &(*it).second;
         if (pcoin->IsCoinBase() && pcoin->GetBlocksToMaturity() > 0 && pcoin->GetDepthInMainChain() > 0)
             nTotal += CWallet::GetCredit(*pcoin);
     }
@@ -1700,6 +1808,7 @@ bool CWallet::CreateTransaction(const vector<pair<CScript, int64_t> >& vecSend,
                 // Fill vin
                 BOOST_FOREACH(const PAIRTYPE(const CWalletTx*,unsigned int)& coin, setCoins)
                     wtxNew.vin.push_back(CTxIn(coin.first->GetHash(),coin.second));
+                wtxNew.InvalidateHash();
 
                 // Sign
                 int nIn = 0;
@@ -1866,6 +1975,7 @@ bool CWallet::CommitTransaction(CWalletTx& wtxNew, CReserveKey& reservekey)
                 CWalletTx &coin = mapWallet[txin.prevout.hash];
                 coin.BindWallet(this);
                 coin.MarkSpent(txin.prevout.n);
+                UpdateCoinIndex(coin);
                 coin.WriteToDisk();
                 NotifyTransactionChanged(this, coin.GetHash(), CT_UPDATED);
             }
@@ -1986,6 +2096,8 @@ DBErrors CWallet::LoadWallet(bool& fFirstRunRet)
         return nLoadWalletRet;
     fFirstRunRet = !vchDefaultKey.IsValid();
 
+    RebuildCoinIndex();
+
     NewThread(ThreadFlushWalletDB, &strWalletFile);
     return DB_LOAD_OK;
 }
@@ -2416,6 +2528,7 @@ void CWallet::FixSpentCoins(int& nMismatchFound, int64_t& nBalanceInQuestion, bo
                 if (!fCheckOnly)
                 {
                     pcoin->MarkUnspent(n);
+                    UpdateCoinIndex(*pcoin);
                     pcoin->WriteToDisk();
                 }
             }
@@ -2428,6 +2541,7 @@ void CWallet::FixSpentCoins(int& nMismatchFound, int64_t& nBalanceInQuestion, bo
                 if (!fCheckOnly)
                 {
                     pcoin->MarkSpent(n);
+                    UpdateCoinIndex(*pcoin);
                     pcoin->WriteToDisk();
                 }
             }
@@ -2451,6 +2565,7 @@ void CWallet::DisableTransaction(const CTransaction &tx)
             if (txin.prevout.n < prev.vout.size() && IsMine(prev.vout[txin.prevout.n]))
             {
                 prev.MarkUnspent(txin.prevout.n);
+                UpdateCoinIndex(prev);
                 prev.WriteToDisk();
             }
         }
@@ -2607,7 +2722,7 @@ void CWallet::GetKeyBirthTimes(std::map<CKeyID, int64_t> &mapKeyBirth) const {
     for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); it++) {
         // iterate over all wallet transactions...
         const CWalletTx &wtx = (*it).second;
-        std::map<uint256, CBlockIndex*>::const_iterator blit = mapBlockIndex.find(wtx.hashBlock);
+        BlockMap::const_iterator blit = mapBlockIndex.find(wtx.hashBlock);
         if (blit != mapBlockIndex.end() && blit->second->IsInMainChain()) {
             // ... which are already in a block
             int nHeight = blit->second->nHeight;
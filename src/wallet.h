@@ -76,6 +76,27 @@ private:
     // the maximum wallet format version: memory-only variable that specifies to what version this wallet may be upgraded
     int nWalletMaxVersion;
 
+    // Wallet transactions which can still add to a balance, so that coin and
+    // balance queries need not walk all of mapWallet: those with an unspent
+    // output of ours, ordered by transaction time for the stake age cut-off,
+    // and the generated ones which may not have matured yet. Matured ones
+    // without unspent outputs are dropped from the latter when it is next
+    // read.
+    std::set<std::pair<unsigned int, uint256> > setUnspentCoins;
+    mutable std::set<uint256> setImmatureCoins;
+    unsigned int nCoinIndexVersion;
+
+    // GetBalance() as of the chain tip, memory pool and coin index versions it was computed at
+    mutable bool fBalanceCached;
+    mutable int64_t nBalanceCached;
+    mutable const CBlockIndex* pindexBalanceCached;
+    mutable unsigned int nBalanceTransactionsUpdated;
+    mutable unsigned int nBalanceCoinIndexVersion;
+
+    void UpdateCoinIndex(const CWalletTx& wtx);
+    void EraseFromCoinIndex(const CWalletTx& wtx);
+    std::vector<const CWalletTx*> GetCoinIndexTransactions(bool fUnspent, bool fImmature) const;
+
 public:
     /// Main wallet lock.
     /// This lock protects all the fields added by CWallet
@@ -115,6 +136,8 @@ public:
         pwalletdbEncryption = NULL;
         nOrderPosNext = 0;
         nTimeFirstKey = 0;
+        nCoinIndexVersion = 0;
+        fBalanceCached = false;
     }
 
     std::map<uint256, CWalletTx> mapWallet;
@@ -175,6 +198,7 @@ public:
     TxItems OrderedTxItems(std::list<CAccountingEntry>& acentries, std::string strAccount = "");
 
     void MarkDirty();
+    void RebuildCoinIndex();
     bool AddToWallet(const CWalletTx& wtxIn);
     bool AddToWalletIfInvolvingMe(const CTransaction& tx, const CBlock* pblock, bool fUpdate = false, bool fFindBlock = false);
     bool EraseFromWallet(uint256 hash);
@@ -0,0 +1,103 @@
+#include "xmlview.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+    const size_t npos = boost::string_ref::npos;
+
+    // Same as std::string::find, scanning for the first character with
+    // memchr rather than comparing at every position
+    size_t Find(boost::string_ref data, boost::string_ref needle, size_t pos)
+    {
+        if (pos > data.size() || needle.size() > data.size() - pos)
+            return npos;
+        if (needle.empty())
+            return pos;
+
+        const char* p = data.data() + pos;
+        const char* last = data.data() + data.size() - needle.size();
+        while (p <= last)
+        {
+            p = static_cast<const char*>(memchr(p, needle[0], last - p + 1));
+            if (!p)
+                return npos;
+            if (memcmp(p + 1, needle.data() + 1, needle.size() - 1) == 0)
+                return p - data.data();
+            ++p;
+        }
+        return npos;
+    }
+
+    // Whether a tag name followed by '>' starts at p
+    bool IsTagName(const char* p, const char* end, boost::string_ref name)
+    {
+        return static_cast<size_t>(end - p) > name.size() &&
+               memcmp(p, name.data(), name.size()) == 0 &&
+               p[name.size()] == '>';
+    }
+}
+
+std::string ExtractXML(boost::string_ref XMLdata, boost::string_ref key, boost::string_ref key_end)
+{
+    return ExtractXMLView(XMLdata, key, key_end).to_string();
+}
+
+boost::string_ref ExtractXMLView(boost::string_ref XMLdata, boost::string_ref key, boost::string_ref key_end)
+{
+    size_t loc = Find(XMLdata, key, 0);
+    if (loc == npos)
+        return boost::string_ref();
+    size_t loc_end = Find(XMLdata, key_end, loc + 3);
+    if (loc_end == npos)
+        return boost::string_ref();
+
+    // An end tag found inside the start tag takes the rest of the document,
+    // as substr did with the wrapped length
+    size_t start = loc + key.size();
+    return XMLdata.substr(start, loc_end >= start ? loc_end - start : npos);
+}
+
+XMLView::XMLView(boost::string_ref data, std::initializer_list<const char*> tags)
+    : count(tags.size())
+{
+    assert(count <= MAX_TAGS);
+    std::copy(tags.begin(), tags.end(), names.begin());
+
+    // Where the contents of each tag start, once its start tag is found
+    std::array<size_t, MAX_TAGS> starts;
+    starts.fill(npos);
+    std::array<bool, MAX_TAGS> done = {};
+    size_t remaining = count;
+
+    // Every occurrence of a tag starts with '<', so looking at each one in
+    // turn finds the same first start tag, and first end tag after it, as
+    // searching for each tag on its own
+    const char* begin = data.data();
+    const char* end = begin + data.size();
+    for (const char* p = begin; remaining > 0 && p < end; ++p)
+    {
+        p = static_cast<const char*>(memchr(p, '<', end - p));
+        if (!p)
+            break;
+
+        const bool fEnd = p + 1 < end && p[1] == '/';
+        const char* name = p + (fEnd ? 2 : 1);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (done[i] || (starts[i] == npos) == fEnd || !IsTagName(name, end, names[i]))
+                continue;
+
+            if (fEnd)
+            {
+                values[i] = data.substr(starts[i], (p - begin) - starts[i]);
+                done[i] = true;
+                --remaining;
+            }
+            else
+                starts[i] = (name - begin) + names[i].size() + 1;
+        }
+    }
+}
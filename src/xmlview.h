@@ -0,0 +1,86 @@
+#pragma once
+
+#include <boost/utility/string_ref.hpp>
+
+#include <array>
+#include <initializer_list>
+#include <string>
+
+//!
+//! \brief Get the text between two tags.
+//!
+//! Finds the first \p key and the first \p key_end after it, as contracts
+//! have always been read. The arguments are not copied, so extracting a
+//! field from a large superblock costs no more than a short one.
+//!
+//! \param XMLdata Document to search.
+//! \param key Start tag, such as \c <TITLE>.
+//! \param key_end End tag, such as \c </TITLE>.
+//! \return The text between the tags, or an empty string if either is
+//! missing.
+//!
+std::string ExtractXML(boost::string_ref XMLdata, boost::string_ref key, boost::string_ref key_end);
+
+//!
+//! \brief Get the text between two tags without copying it.
+//!
+//! Same as \a ExtractXML, but returns a view into \p XMLdata, which must
+//! outlive it.
+//!
+boost::string_ref ExtractXMLView(boost::string_ref XMLdata, boost::string_ref key, boost::string_ref key_end);
+
+//!
+//! \brief Non-owning view of the contents of several tags of a document.
+//!
+//! Finds every tag in one pass over the document rather than one search
+//! per tag, and gives the same contents as \a ExtractXML would for each.
+//! Tags are named without brackets, so \c TITLE covers the text between
+//! \c <TITLE> and \c </TITLE>. The document and the tag names must outlive
+//! the view.
+//!
+class XMLView
+{
+public:
+    //!
+    //! \brief Most tags one view finds.
+    //!
+    static const size_t MAX_TAGS = 16;
+
+    //!
+    //! \brief Constructor.
+    //!
+    //! \param data Document to search.
+    //! \param tags Names of the tags to find, at most \a MAX_TAGS.
+    //!
+    XMLView(boost::string_ref data, std::initializer_list<const char*> tags);
+
+    //!
+    //! \brief Get the number of tags searched for.
+    //!
+    size_t size() const { return count; }
+
+    //!
+    //! \brief Get the contents of a tag.
+    //!
+    //! \param tag Index of the tag in the list given to the constructor.
+    //! \return The text between the tags, or an empty reference if either
+    //! is missing.
+    //!
+    boost::string_ref operator[](size_t tag) const
+    {
+        return tag < count ? values[tag] : boost::string_ref();
+    }
+
+    //!
+    //! \brief Get the contents of a tag as a string.
+    //!
+    std::string GetString(size_t tag) const
+    {
+        return (*this)[tag].to_string();
+    }
+
+private:
+    std::array<boost::string_ref, MAX_TAGS> names;
+    std::array<boost::string_ref, MAX_TAGS> values;
+    size_t count;
+};